@@ -0,0 +1,56 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "benchmark.hpp"
+
+/*
+ * Replacement of the global allocation functions counting the allocations done by the benchmarked code
+ */
+
+static std::atomic<uint64_t> allocations(0);
+
+void*
+operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* ptr = malloc(size > 0 ? size : 1);
+
+    if (ptr == nullptr) throw std::bad_alloc();
+
+    return ptr;
+}
+
+void*
+operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+    free(ptr);
+}
+
+uint64_t
+PivotBench::allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
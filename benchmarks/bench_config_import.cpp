@@ -0,0 +1,245 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <rapidjson/document.h>
+
+#include "benchmark.hpp"
+#include "iec104_pivot_filter_config.hpp"
+
+/* exchanged_data as produced by the configuration tools: each datapoint also has a tase2 protocol, ignored by the filter */
+static std::string
+buildExchangedData(size_t size)
+{
+    std::string json = R"({"exchanged_data":{"name":"SAMPLE","version":"1.0","datapoints":[)";
+
+    for (size_t i = 0; i < size; i++) {
+        std::string ca = std::to_string(1 + i / 65536);
+        std::string ioa = std::to_string(i % 65536);
+
+        if (i > 0) json += ",";
+
+        json += R"({"label":"TM)" + std::to_string(i) + R"(","pivot_id":"ID-)" + ca + "-" + ioa +
+                R"(","pivot_type":"MvTyp","protocols":[{"name":"iec104","address":")" + ca + "-" + ioa +
+                R"(","typeid":"M_ME_NC_1"},{"name":"tase2","address":"S_)" + std::to_string(i) +
+                R"(","typeid":"Data_RealQ","options":{"deadband":0.5,"scan":[1,2,3]}}]})";
+    }
+
+    json += "]}}";
+
+    return json;
+}
+
+/* Value in kB of a field of /proc/self/status, 0 when not available */
+static long
+readStatusKb(const char* field)
+{
+    FILE* file = fopen("/proc/self/status", "r");
+    if (!file) return 0;
+
+    char line[256];
+    long value = 0;
+    size_t length = strlen(field);
+
+    while (fgets(line, sizeof(line), file)) {
+        if (strncmp(line, field, length) == 0 && line[length] == ':') {
+            value = atol(line + length + 1);
+            break;
+        }
+    }
+
+    fclose(file);
+
+    return value;
+}
+
+/* Reset the peak resident set size (VmHWM) to the current one */
+static bool
+resetPeakRss()
+{
+    FILE* file = fopen("/proc/self/clear_refs", "w");
+    if (!file) return false;
+
+    bool reset = fputs("5", file) >= 0;
+
+    return fclose(file) == 0 && reset;
+}
+
+/* Time, peak resident memory above the memory in use before the step, and memory kept at its end of an import step */
+struct StepMeasure {
+    double elapsedNs;
+    long peakKb;
+    long keptKb;
+};
+
+/* Measure a step in a child process, so that the memory it uses does not stay in the heap of the benchmark,
+   false when the child did not report its measure */
+static bool
+measureStep(const std::function<void()>& step, StepMeasure& measure)
+{
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+
+    fflush(stdout);
+
+    pid_t child = fork();
+
+    if (child < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+
+    if (child == 0) {
+        close(fds[0]);
+
+        bool peakReset = resetPeakRss();
+        long startKb = readStatusKb("VmRSS");
+
+        auto start = std::chrono::steady_clock::now();
+        step();
+        StepMeasure childMeasure;
+        childMeasure.elapsedNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                     std::chrono::steady_clock::now() - start).count());
+
+        childMeasure.peakKb = peakReset ? readStatusKb("VmHWM") - startKb : -1;
+        childMeasure.keptKb = readStatusKb("VmRSS") - startKb;
+
+        bool written = write(fds[1], &childMeasure, sizeof(childMeasure)) == sizeof(childMeasure);
+        _exit(written ? 0 : 1);
+    }
+
+    close(fds[1]);
+
+    bool received = read(fds[0], &measure, sizeof(measure)) == sizeof(measure);
+
+    close(fds[0]);
+    waitpid(child, nullptr, 0);
+
+    return received;
+}
+
+enum class ImportStep {
+    RAPIDJSON_DOCUMENT,
+    STREAMING_IMPORT,
+    IMAGE_LOAD
+};
+
+/*
+ * Each iteration runs the step in a new child process, the iteration time is the time of the step measured in the child
+ */
+static void
+benchImport(benchmark::State& state, ImportStep importStep)
+{
+    const size_t size = static_cast<size_t>(state.range(0));
+    const std::string json = buildExchangedData(size);
+
+    char directory[] = "/tmp/iec104pivot_bench_XXXXXX";
+    std::string imagePath;
+
+    if (importStep == ImportStep::IMAGE_LOAD) {
+        if (!mkdtemp(directory)) {
+            state.SkipWithError("cannot create the image directory");
+            return;
+        }
+
+        imagePath = std::string(directory) + "/config.cfgimg";
+
+        StepMeasure written;
+        measureStep([&json, &imagePath] {
+            IEC104PivotConfig config;
+            config.importExchangeConfig(json);
+            config.writeImage(imagePath);
+        }, written);
+    }
+
+    std::function<void()> step;
+
+    switch (importStep) {
+        case ImportStep::RAPIDJSON_DOCUMENT:
+            step = [&json] {
+                rapidjson::Document document;
+                document.Parse(json.c_str());
+                benchmark::DoNotOptimize(document);
+            };
+            break;
+        case ImportStep::STREAMING_IMPORT:
+            step = [&json] {
+                IEC104PivotConfig config;
+                config.importExchangeConfig(json);
+                benchmark::DoNotOptimize(config);
+            };
+            break;
+        case ImportStep::IMAGE_LOAD:
+            step = [&json, &imagePath] {
+                IEC104PivotConfig config;
+                config.loadImage(imagePath, json);
+                benchmark::DoNotOptimize(config);
+            };
+            break;
+    }
+
+    StepMeasure measure = {0, 0, 0};
+    bool peakAvailable = true;
+    long peakKb = 0;
+    long keptKb = 0;
+
+    for (auto _ : state) {
+        if (!measureStep(step, measure)) {
+            state.SkipWithError("the import step did not complete");
+            break;
+        }
+
+        state.SetIterationTime(measure.elapsedNs / 1e9);
+        peakAvailable = peakAvailable && measure.peakKb >= 0;
+        peakKb = std::max(peakKb, measure.peakKb);
+        keptKb = std::max(keptKb, measure.keptKb);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * size));
+    state.counters["json_MB"] = json.size() / (1024.0 * 1024.0);
+    state.counters["peak_MB"] = peakAvailable ? peakKb / 1024.0 : -1;
+    state.counters["kept_MB"] = keptKb / 1024.0;
+
+    if (!imagePath.empty()) {
+        unlink(imagePath.c_str());
+        rmdir(directory);
+    }
+}
+
+/*
+ * Import of growing exchanged_data documents: streaming JSON import, load of the binary image, and for reference the
+ * rapidjson document the JSON used to be parsed into before the definitions were built. The counters give the peak and
+ * kept resident memory of the step, peak_MB is -1 when it cannot be reset (Linux clear_refs).
+ */
+void
+PivotBench::registerConfigImport()
+{
+    const struct {
+        const char* name;
+        ImportStep step;
+    } steps[] = {
+        {"config_import/rapidjson_document_only", ImportStep::RAPIDJSON_DOCUMENT},
+        {"config_import/streaming_import", ImportStep::STREAMING_IMPORT},
+        {"config_import/binary_image_load", ImportStep::IMAGE_LOAD},
+    };
+
+    for (const auto& step : steps) {
+        benchmark::RegisterBenchmark(step.name, benchImport, step.step)
+            ->Arg(10000)->Arg(100000)->Arg(1000000)->UseManualTime()->Unit(benchmark::kMillisecond);
+    }
+}
@@ -0,0 +1,286 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#include <memory>
+
+#include <config_category.h>
+#include <datapoint.h>
+#include <reading.h>
+#include <reading_set.h>
+
+#include "benchmark.hpp"
+#include "filter_internals.hpp"
+#include "iec104_pivot_datapoint_pool.hpp"
+#include "iec104_pivot_filter.hpp"
+#include "iec104_pivot_object.hpp"
+
+static const size_t BATCH_SIZE = 1000;
+
+static void
+discardOutput(OUTPUT_HANDLE* outHandle, READINGSET* readingSet)
+{
+    (void)outHandle;
+    (void)readingSet;
+}
+
+/* Filter defining all cases, with the deterministic time source */
+class ConversionFilter
+{
+public:
+    ConversionFilter(): m_config("iec104pivot", PivotBench::filterConfig())
+    {
+        m_config.setItemsValueFromDefault();
+        m_filter.reset(new IEC104PivotFilter("iec104pivot", &m_config, nullptr, discardOutput));
+        m_filter->setTimeSource(PivotBench::fixedTimeMs);
+    };
+
+    IEC104PivotFilter& get() {return *m_filter;};
+
+private:
+    ConfigCategory m_config;
+    std::unique_ptr<IEC104PivotFilter> m_filter;
+};
+
+static void
+deleteReadings(std::vector<Reading*>& readings)
+{
+    for (Reading* reading : readings) {
+        delete reading;
+    }
+
+    readings.clear();
+}
+
+/* Give the converted datapoints back to the pool, outside of the timed part as the filter does it after sending */
+static void
+releaseOutputs(benchmark::State& state, DatapointPool& pool, std::vector<Datapoint*>& outputs)
+{
+    state.PauseTiming();
+
+    for (Datapoint* output : outputs) {
+        pool.release(output);
+    }
+
+    outputs.clear();
+
+    state.ResumeTiming();
+}
+
+/*
+ * IEC 104 -> pivot: IEC104PivotFilter::convertDataObjectToPivot called directly on data objects of a single ASDU family,
+ * read once with readDataObjectAttributes and converted with the definition of their label.
+ */
+static void
+benchDataObjectToPivot(benchmark::State& state, const PivotBench::ConversionCase* conversionCase)
+{
+    ConversionFilter converter;
+    IEC104PivotFilterInternals internals(converter.get());
+    Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig>::Reader config = internals.acquireConfig();
+    Iec104PivotUtility::ConversionClock clock = internals.clock();
+    IEC104PivotDataPoint* exchangeConfig = config->getExchangeDefinitionsByLabel(conversionCase->label);
+
+    std::vector<Reading*> readings;
+    std::vector<IEC104PivotFilter::Iec104DataObject> dataObjects(BATCH_SIZE);
+
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        readings.push_back(PivotBench::createIec104Reading(*conversionCase, false, (long)i));
+        IEC104PivotFilterInternals::readDataObjectAttributes(*readings.back()->getReadingData()[0]->getData().getDpVec(),
+                                                            dataObjects[i]);
+    }
+
+    DatapointPool pool;
+    std::vector<Datapoint*> outputs;
+    PivotBench::AllocationCounter allocations;
+
+    for (auto _ : state) {
+        allocations.start();
+
+        for (IEC104PivotFilter::Iec104DataObject& dataObject : dataObjects) {
+            outputs.push_back(internals.convertDataObjectToPivot(dataObject, exchangeConfig, pool, clock));
+        }
+
+        allocations.stop();
+
+        releaseOutputs(state, pool, outputs);
+    }
+
+    allocations.report(state, state.iterations() * BATCH_SIZE);
+
+    deleteReadings(readings);
+}
+
+/*
+ * IEC 104 -> pivot: IEC104PivotFilter::convertOperationObjectToPivot called directly on the co_* datapoints of commands
+ * of a single ASDU family.
+ */
+static void
+benchOperationToPivot(benchmark::State& state, const PivotBench::ConversionCase* conversionCase)
+{
+    ConversionFilter converter;
+    IEC104PivotFilterInternals internals(converter.get());
+    Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig>::Reader config = internals.acquireConfig();
+    Iec104PivotUtility::ConversionClock clock = internals.clock();
+
+    std::vector<Reading*> readings;
+
+    for (size_t i = 0; i < BATCH_SIZE; i++) {
+        readings.push_back(PivotBench::createIec104Reading(*conversionCase, true, (long)i));
+    }
+
+    DatapointPool pool;
+    std::vector<Datapoint*> outputs;
+    PivotBench::AllocationCounter allocations;
+
+    for (auto _ : state) {
+        allocations.start();
+
+        for (Reading* reading : readings) {
+            outputs.push_back(internals.convertOperationObjectToPivot(*config, reading->getReadingData(), pool, clock));
+        }
+
+        allocations.stop();
+
+        releaseOutputs(state, pool, outputs);
+    }
+
+    allocations.report(state, state.iterations() * BATCH_SIZE);
+
+    deleteReadings(readings);
+}
+
+/*
+ * Pivot -> IEC 104: PivotDataObject::toIec104DataObject or PivotOperationObject::toIec104OperationObject called
+ * directly on pivot objects of a single ASDU family, the output nodes are recycled between iterations as in the filter.
+ */
+static void
+benchPivotToIec104(benchmark::State& state, const PivotBench::ConversionCase* conversionCase, bool command)
+{
+    ConversionFilter converter;
+    std::vector<Reading*> pivotReadings = PivotBench::createPivotReadings(converter.get(), *conversionCase, command, BATCH_SIZE, 0);
+
+    std::string address = std::to_string(conversionCase->ca) + "-" + std::to_string(conversionCase->ioa);
+    IEC104PivotDataPoint exchangeConfig(conversionCase->label, "ID-" + address, conversionCase->pivotType, conversionCase->typeId,
+                                        conversionCase->ca, conversionCase->ioa, "");
+    DatapointPool pool;
+    std::vector<Datapoint*> outputs;
+    Iec104PivotUtility::ConversionClock clock(PivotBench::fixedTimeMs, Iec104PivotUtility::ClockMode::BATCH);
+    PivotBench::AllocationCounter allocations;
+
+    for (auto _ : state) {
+        allocations.start();
+
+        for (Reading* reading : pivotReadings) {
+            Datapoint* pivotDp = reading->getReadingData()[0];
+
+            if (command) {
+                PivotOperationObject pivotObject(pivotDp, &pool);
+                std::vector<Datapoint*> converted = pivotObject.toIec104OperationObject(&exchangeConfig);
+                outputs.insert(outputs.end(), converted.begin(), converted.end());
+            }
+            else {
+                PivotDataObject pivotObject(pivotDp, &pool);
+                outputs.push_back(pivotObject.toIec104DataObject(&exchangeConfig, clock));
+            }
+        }
+
+        allocations.stop();
+
+        releaseOutputs(state, pool, outputs);
+    }
+
+    allocations.report(state, state.iterations() * pivotReadings.size());
+
+    deleteReadings(pivotReadings);
+}
+
+/*
+ * Pivot trees rejected by the parser (Identifier removed), read through the status API as the filter does, or
+ * through the constructor that throws, as a misbehaving upstream component would make the filter do.
+ */
+static void
+benchMalformedPivot(benchmark::State& state, const PivotBench::ConversionCase* conversionCase, bool throwing)
+{
+    ConversionFilter converter;
+    std::vector<Reading*> pivotReadings = PivotBench::createPivotReadings(converter.get(), *conversionCase, false, BATCH_SIZE, 0);
+
+    for (Reading* reading : pivotReadings) {
+        Datapoint* ln = (*reading->getReadingData()[0]->getData().getDpVec())[0];
+        std::vector<Datapoint*>* elements = ln->getData().getDpVec();
+
+        for (size_t i = 0; i < elements->size(); i++) {
+            if ((*elements)[i]->getName() == "Identifier") {
+                delete (*elements)[i];
+                elements->erase(elements->begin() + i);
+                break;
+            }
+        }
+    }
+
+    DatapointPool pool;
+    uint64_t rejected = 0;
+    PivotBench::AllocationCounter allocations;
+
+    for (auto _ : state) {
+        allocations.start();
+
+        for (Reading* reading : pivotReadings) {
+            Datapoint* pivotDp = reading->getReadingData()[0];
+
+            if (throwing) {
+                try {
+                    PivotDataObject pivotObject(pivotDp, &pool);
+                }
+                catch (PivotObjectException&) {
+                    rejected++;
+                }
+            }
+            else {
+                PivotDataObject pivotObject(&pool);
+                if (!pivotObject.parse(pivotDp).ok()) rejected++;
+            }
+        }
+
+        allocations.stop();
+    }
+
+    const uint64_t objects = state.iterations() * pivotReadings.size();
+
+    if (rejected != objects) state.SkipWithError("malformed trees accepted");
+
+    allocations.report(state, objects);
+
+    deleteReadings(pivotReadings);
+}
+
+void
+PivotBench::registerConversion()
+{
+    for (size_t i = 0; i < dataCaseCount; i++) {
+        benchmark::RegisterBenchmark((std::string("conversion/data_object_to_pivot/") + dataCases[i].family).c_str(),
+                                     benchDataObjectToPivot, &dataCases[i]);
+    }
+
+    for (size_t i = 0; i < commandCaseCount; i++) {
+        benchmark::RegisterBenchmark((std::string("conversion/operation_to_pivot/") + commandCases[i].family).c_str(),
+                                     benchOperationToPivot, &commandCases[i]);
+    }
+
+    for (size_t i = 0; i < dataCaseCount; i++) {
+        benchmark::RegisterBenchmark((std::string("conversion/pivot_to_data_object/") + dataCases[i].family).c_str(),
+                                     benchPivotToIec104, &dataCases[i], false);
+    }
+
+    for (size_t i = 0; i < commandCaseCount; i++) {
+        benchmark::RegisterBenchmark((std::string("conversion/pivot_to_operation/") + commandCases[i].family).c_str(),
+                                     benchPivotToIec104, &commandCases[i], true);
+    }
+
+    benchmark::RegisterBenchmark("conversion/malformed_pivot/status/SP", benchMalformedPivot, &dataCases[0], false);
+    benchmark::RegisterBenchmark("conversion/malformed_pivot/exception/SP", benchMalformedPivot, &dataCases[0], true);
+}
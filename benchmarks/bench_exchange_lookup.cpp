@@ -0,0 +1,161 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "iec104_pivot_filter_config.hpp"
+
+static std::string
+buildExchangedData(size_t size)
+{
+    std::string json = R"({"exchanged_data":{"datapoints":[)";
+
+    for (size_t i = 0; i < size; i++) {
+        std::string ca = std::to_string(1 + i / 65536);
+        std::string ioa = std::to_string(i % 65536);
+
+        if (i > 0) json += ",";
+
+        json += R"({"label":"TS)" + std::to_string(i) + R"(","pivot_id":"ID-)" + ca + "-" + ioa +
+                R"(","pivot_type":"SpsTyp","protocols":[{"name":"iec104","address":")" + ca + "-" + ioa +
+                R"(","typeid":"M_SP_TB_1"}]})";
+    }
+
+    json += "]}}";
+
+    return json;
+}
+
+/* Exchange definitions and lookup keys of a benchmark, visited in a scattered order so that lookups are not served from a hot cache line */
+class LookupData
+{
+public:
+    explicit LookupData(size_t size): m_size(size)
+    {
+        config.importExchangeConfig(buildExchangedData(size));
+
+        for (size_t i = 0; i < size; i++) {
+            std::string ca = std::to_string(1 + i / 65536);
+            std::string ioa = std::to_string(i % 65536);
+            labels.push_back("TS" + std::to_string(i));
+            addresses.push_back(ca + "-" + ioa);
+            pivotIds.push_back("ID-" + ca + "-" + ioa);
+            mapIndex[labels.back()] = std::make_shared<IEC104PivotDataPoint>(labels.back(), pivotIds.back(), "SpsTyp",
+                                                                            "M_SP_TB_1", 1, static_cast<int>(i), "");
+        }
+    };
+
+    size_t next() {
+        m_lookup++;
+        return (m_lookup * STRIDE) % m_size;
+    };
+
+    IEC104PivotConfig config;
+    std::vector<std::string> labels;
+    std::vector<std::string> addresses;
+    std::vector<std::string> pivotIds;
+    std::map<std::string, std::shared_ptr<IEC104PivotDataPoint>> mapIndex;
+
+private:
+    static const size_t STRIDE = 7919;
+
+    size_t m_size;
+    size_t m_lookup = 0;
+};
+
+static void
+benchLabel(benchmark::State& state)
+{
+    LookupData data(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data.config.getExchangeDefinitionsByLabel(data.labels[data.next()]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void
+benchAddressString(benchmark::State& state)
+{
+    LookupData data(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data.config.getExchangeDefinitionsByAddress(data.addresses[data.next()]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void
+benchAddressCaIoa(benchmark::State& state)
+{
+    LookupData data(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        size_t index = data.next();
+        benchmark::DoNotOptimize(data.config.getExchangeDefinitionsByAddress(static_cast<int>(1 + index / 65536),
+                                                                            static_cast<int>(index % 65536)));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void
+benchPivotId(benchmark::State& state)
+{
+    LookupData data(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data.config.getExchangeDefinitionsByPivotId(data.pivotIds[data.next()]));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void
+benchLabelMap(benchmark::State& state)
+{
+    LookupData data(static_cast<size_t>(state.range(0)));
+
+    for (auto _ : state) {
+        std::string key = data.labels[data.next()];
+        auto it = data.mapIndex.find(key);
+        benchmark::DoNotOptimize(it == data.mapIndex.end() ? nullptr : it->second.get());
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * Lookup by label, address (string and packed CA/IOA) and pivot ID for growing exchanged_data sizes, compared with the
+ * previous std::map<std::string> index queried with a by-value std::string key.
+ */
+void
+PivotBench::registerExchangeLookup()
+{
+    const struct {
+        const char* name;
+        void (*function)(benchmark::State&);
+    } lookups[] = {
+        {"exchange_lookup/label/hash_index", benchLabel},
+        {"exchange_lookup/address_string/packed_index", benchAddressString},
+        {"exchange_lookup/address_ca_ioa/packed_index", benchAddressCaIoa},
+        {"exchange_lookup/pivot_id/hash_index", benchPivotId},
+        {"exchange_lookup/label/std_map_by_value_key", benchLabelMap},
+    };
+
+    for (const auto& lookup : lookups) {
+        benchmark::RegisterBenchmark(lookup.name, lookup.function)->Arg(100)->Arg(1000)->Arg(10000)->Arg(60000);
+    }
+}
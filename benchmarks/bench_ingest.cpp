@@ -0,0 +1,185 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#include <memory>
+
+#include <config_category.h>
+#include <datapoint.h>
+#include <reading.h>
+#include <reading_set.h>
+
+#include "benchmark.hpp"
+#include "iec104_pivot_filter.hpp"
+
+static void
+discardOutput(OUTPUT_HANDLE* outHandle, READINGSET* readingSet)
+{
+    (void)outHandle;
+    (void)readingSet;
+}
+
+/*
+ * Batch cycling through IEC 104 data objects, IEC 104 commands, pivot data objects, pivot operations
+ * and readings forwarded unchanged, over all ASDU families
+ */
+static ReadingSet*
+createMixedBatch(IEC104PivotFilter& converter, size_t size)
+{
+    std::vector<Reading*> readings;
+
+    for (size_t i = 0; i < size; i++) {
+        const PivotBench::ConversionCase& dataCase = PivotBench::dataCases[(i / 5) % PivotBench::dataCaseCount];
+        const PivotBench::ConversionCase& commandCase = PivotBench::commandCases[(i / 5) % PivotBench::commandCaseCount];
+
+        switch (i % 5) {
+            case 0:
+                readings.push_back(PivotBench::createIec104Reading(dataCase, false, (long)i));
+                break;
+            case 1:
+                readings.push_back(PivotBench::createIec104Reading(commandCase, true, (long)i));
+                break;
+            case 2:
+            case 3:
+            {
+                std::vector<Reading*> pivotReadings = PivotBench::createPivotReadings(converter, (i % 5 == 2) ? dataCase : commandCase,
+                                                                                      i % 5 == 3, 1, (long)i);
+                readings.insert(readings.end(), pivotReadings.begin(), pivotReadings.end());
+                break;
+            }
+            default:
+            {
+                DatapointValue value((long)i);
+                std::vector<Datapoint*> datapoints;
+                datapoints.push_back(new Datapoint("measure", value));
+                readings.push_back(new Reading("UNKNOWN", datapoints));
+                break;
+            }
+        }
+    }
+
+    ReadingSet* readingSet = new ReadingSet();
+    readingSet->append(readings);
+
+    return readingSet;
+}
+
+/* Filter category with conversion threads, and report by exception when enabled */
+static std::string
+ingestConfig(int conversionThreads, bool reportByException)
+{
+    std::string json = PivotBench::filterConfig(conversionThreads);
+
+    if (reportByException) {
+        json = json.substr(0, json.rfind('}')) +
+               R"(,"report_by_exception":{"description":"report by exception","type":"boolean","default":"true"}})";
+    }
+
+    return json;
+}
+
+/* Filter benchmarked with the deterministic time source */
+class IngestFilter
+{
+public:
+    IngestFilter(int conversionThreads, bool reportByException):
+        m_config("iec104pivot", ingestConfig(conversionThreads, reportByException))
+    {
+        m_config.setItemsValueFromDefault();
+        m_filter.reset(new IEC104PivotFilter("iec104pivot", &m_config, nullptr, discardOutput));
+        m_filter->setTimeSource(PivotBench::fixedTimeMs);
+    };
+
+    IEC104PivotFilter& get() {return *m_filter;};
+
+private:
+    ConfigCategory m_config;
+    std::unique_ptr<IEC104PivotFilter> m_filter;
+};
+
+/* Ingest of one reading set, built and deleted with the timing paused */
+static void
+ingestTimed(benchmark::State& state, IEC104PivotFilter& filter, ReadingSet* readingSet, PivotBench::AllocationCounter& allocations)
+{
+    state.ResumeTiming();
+    allocations.start();
+
+    filter.ingest(readingSet);
+
+    allocations.stop();
+    state.PauseTiming();
+
+    delete readingSet;
+}
+
+/*
+ * Full ingest of mixed batches, the batch size is the benchmark argument
+ */
+static void
+benchMixedIngest(benchmark::State& state, int conversionThreads)
+{
+    const size_t batchSize = static_cast<size_t>(state.range(0));
+
+    IngestFilter converter(0, false);
+    IngestFilter filter(conversionThreads, false);
+    PivotBench::AllocationCounter allocations;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        ReadingSet* readingSet = createMixedBatch(converter.get(), batchSize);
+
+        ingestTimed(state, filter.get(), readingSet, allocations);
+        state.ResumeTiming();
+    }
+
+    allocations.report(state, state.iterations() * batchSize);
+}
+
+/*
+ * Repeated scans of all the monitoring cases with unchanged values, as sent by cyclic or background scans
+ */
+static void
+benchScanIngest(benchmark::State& state, bool reportByException)
+{
+    IngestFilter filter(0, reportByException);
+    PivotBench::AllocationCounter allocations;
+    long scan = 0;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        std::vector<Reading*> scanReadings;
+
+        for (size_t i = 0; i < PivotBench::dataCaseCount; i++) {
+            /* even sequences: same values, later timestamps */
+            scanReadings.push_back(PivotBench::createIec104Reading(PivotBench::dataCases[i], false, scan * 2));
+        }
+
+        scan++;
+
+        ReadingSet* readingSet = new ReadingSet();
+        readingSet->append(scanReadings);
+
+        ingestTimed(state, filter.get(), readingSet, allocations);
+        state.ResumeTiming();
+    }
+
+    allocations.report(state, state.iterations() * PivotBench::dataCaseCount);
+}
+
+/*
+ * Full ingest of mixed batches of growing sizes, in the calling thread and with conversion threads, and of repeated scans
+ * with and without report by exception
+ */
+void
+PivotBench::registerIngest()
+{
+    benchmark::RegisterBenchmark("ingest/mixed", benchMixedIngest, 0)->Arg(1)->Arg(100)->Arg(10000);
+    benchmark::RegisterBenchmark("ingest/mixed_3_threads", benchMixedIngest, 3)->Arg(10000)->UseRealTime();
+    benchmark::RegisterBenchmark("ingest/scan/all_sent", benchScanIngest, false);
+    benchmark::RegisterBenchmark("ingest/scan/report_by_exception", benchScanIngest, true);
+}
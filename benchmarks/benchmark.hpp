@@ -0,0 +1,88 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#ifndef _IEC104_PIVOT_BENCHMARK_H
+#define _IEC104_PIVOT_BENCHMARK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+
+class Datapoint;
+class IEC104PivotFilter;
+class Reading;
+
+namespace PivotBench {
+
+    /* Number of heap allocations (operator new) since the start of the program */
+    uint64_t allocationCount();
+
+    /*
+     * Allocations done by the timed part of a benchmark: the code between start() and stop(), which are called
+     * while the timing is running, so that the allocations of the setup done with the timing paused are not counted
+     */
+    class AllocationCounter
+    {
+    public:
+        void start() {m_start = allocationCount();};
+        void stop() {m_allocations += allocationCount() - m_start;};
+
+        /* Objects/s rate and allocations/object counter of a conversion benchmark */
+        void report(benchmark::State& state, uint64_t objects) const {
+            state.SetItemsProcessed(static_cast<int64_t>(objects));
+            state.counters["allocs/object"] = objects > 0 ? static_cast<double>(m_allocations) / objects : 0;
+        };
+
+    private:
+        uint64_t m_start = 0;
+        uint64_t m_allocations = 0;
+    };
+
+    /*
+     * One exchange definition per ASDU family, in both directions
+     */
+    struct ConversionCase {
+        const char* family;
+        const char* typeId;
+        const char* label;
+        const char* pivotType;
+        int ca;
+        int ioa;
+    };
+
+    extern const ConversionCase dataCases[];
+    extern const size_t dataCaseCount;
+    extern const ConversionCase commandCases[];
+    extern const size_t commandCaseCount;
+
+    /* Deterministic time source given to the filters, so that results do not depend on the cost of reading the clock */
+    uint64_t fixedTimeMs();
+
+    /* Filter configuration category defining all cases */
+    std::string filterConfig(int conversionThreads = 0);
+
+    /* Reading received from the IEC 104 side: a data_object for monitoring types, co_* datapoints for commands */
+    Reading* createIec104Reading(const ConversionCase& conversionCase, bool command, long sequence);
+
+    /* Readings received from the pivot side, obtained by converting IEC 104 readings with the given filter */
+    std::vector<Reading*> createPivotReadings(IEC104PivotFilter& filter, const ConversionCase& conversionCase, bool command,
+                                              size_t count, long firstSequence);
+
+    /*
+     * Registration of the benchmarks of each group, named <group>/<benchmark>/... so that a group is selected with
+     * --benchmark_filter=<group>/
+     */
+    void registerExchangeLookup();
+    void registerConfigImport();
+    void registerConversion();
+    void registerIngest();
+}
+
+#endif /* _IEC104_PIVOT_BENCHMARK_H */
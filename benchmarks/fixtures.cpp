@@ -0,0 +1,126 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#include <reading.h>
+#include <reading_set.h>
+
+#include "benchmark.hpp"
+#include "datapoint_builders.hpp"
+#include "iec104_pivot_filter.hpp"
+
+const PivotBench::ConversionCase PivotBench::dataCases[] = {
+    {"SP", "M_SP_TB_1", "TS1", "SpsTyp", 45, 672},
+    {"DP", "M_DP_TB_1", "TS2", "DpsTyp", 45, 890},
+    {"ME_NORMALIZED", "M_ME_TD_1", "TM1", "MvTyp", 45, 984},
+    {"ME_SCALED", "M_ME_TE_1", "TM2", "MvTyp", 45, 985},
+    {"ME_FLOAT", "M_ME_TF_1", "TM3", "MvTyp", 45, 986},
+    {"ST", "M_ST_TB_1", "TS3", "BscTyp", 45, 921},
+};
+const size_t PivotBench::dataCaseCount = sizeof(PivotBench::dataCases) / sizeof(PivotBench::dataCases[0]);
+
+const PivotBench::ConversionCase PivotBench::commandCases[] = {
+    {"SC", "C_SC_TA_1", "CS1", "SpcTyp", 45, 1001},
+    {"DC", "C_DC_TA_1", "CD1", "DpcTyp", 45, 1002},
+    {"SE_NORMALIZED", "C_SE_TA_1", "CN1", "ApcTyp", 45, 1003},
+    {"SE_SCALED", "C_SE_TB_1", "CN2", "IncTyp", 45, 1004},
+    {"SE_FLOAT", "C_SE_TC_1", "CN3", "ApcTyp", 45, 1005},
+    {"RC", "C_RC_TA_1", "CR1", "BscTyp", 45, 1006},
+};
+const size_t PivotBench::commandCaseCount = sizeof(PivotBench::commandCases) / sizeof(PivotBench::commandCases[0]);
+
+static std::string
+exchangeDefinition(const PivotBench::ConversionCase& conversionCase)
+{
+    std::string address = std::to_string(conversionCase.ca) + "-" + std::to_string(conversionCase.ioa);
+
+    return std::string(R"({"label":")") + conversionCase.label + R"(","pivot_id":"ID-)" + address +
+           R"(","pivot_type":")" + conversionCase.pivotType + R"(","protocols":[{"name":"iec104","address":")" +
+           address + R"(","typeid":")" + conversionCase.typeId + R"("}]})";
+}
+
+uint64_t
+PivotBench::fixedTimeMs()
+{
+    return 1668631513250;
+}
+
+std::string
+PivotBench::filterConfig(int conversionThreads)
+{
+    std::string datapoints;
+
+    for (size_t i = 0; i < dataCaseCount; i++) {
+        if (datapoints.empty() == false) datapoints += ",";
+        datapoints += exchangeDefinition(dataCases[i]);
+    }
+
+    for (size_t i = 0; i < commandCaseCount; i++) {
+        datapoints += "," + exchangeDefinition(commandCases[i]);
+    }
+
+    return R"({"exchanged_data":{"description":"exchanged data list","type":"JSON","default":{"exchanged_data":{"name":"iec104pivot","version":"1.0","datapoints":[)" +
+           datapoints + R"(]}}},"conversion_threads":{"description":"conversion threads","type":"integer","default":")" +
+           std::to_string(conversionThreads) + R"("},"parallel_threshold":{"description":"parallel threshold","type":"integer","default":"256"}})";
+}
+
+Reading*
+PivotBench::createIec104Reading(const ConversionCase& conversionCase, bool command, long sequence)
+{
+    const long msTime = 1668631513250 + sequence;
+    const std::string family = conversionCase.family;
+    std::vector<Datapoint*> datapoints;
+
+    if (command) {
+        if (family == "SE_NORMALIZED" || family == "SE_FLOAT") {
+            datapoints = createCommandObject(conversionCase.typeId, conversionCase.ca, conversionCase.ioa, 6, 0, 0, 0, msTime, 0.5);
+        }
+        else {
+            datapoints = createCommandObject(conversionCase.typeId, conversionCase.ca, conversionCase.ioa, 6, 0, 0, 0, msTime, 1L);
+        }
+
+        return new Reading("IEC104Command", datapoints);
+    }
+
+    if (family == "ST") {
+        datapoints.push_back(createDataObject(0, conversionCase.typeId, conversionCase.ca, conversionCase.ioa, 3, "[1,true]",
+                                              false, false, false, false, false, msTime, false, false, false));
+    }
+    else if (family == "ME_NORMALIZED" || family == "ME_FLOAT") {
+        datapoints.push_back(createDataObject(0, conversionCase.typeId, conversionCase.ca, conversionCase.ioa, 3, 0.25f,
+                                              false, false, false, false, false, msTime, false, false, false));
+    }
+    else {
+        datapoints.push_back(createDataObject(0, conversionCase.typeId, conversionCase.ca, conversionCase.ioa, 3, (int64_t)(sequence % 2 + 1),
+                                              false, false, false, false, false, msTime, false, false, false));
+    }
+
+    return new Reading(conversionCase.label, datapoints);
+}
+
+std::vector<Reading*>
+PivotBench::createPivotReadings(IEC104PivotFilter& filter, const ConversionCase& conversionCase, bool command,
+                                size_t count, long firstSequence)
+{
+    std::vector<Reading*> readings;
+
+    for (size_t i = 0; i < count; i++) {
+        readings.push_back(createIec104Reading(conversionCase, command, firstSequence + (long)i));
+    }
+
+    ReadingSet readingSet;
+    readingSet.append(readings);
+
+    filter.ingest(&readingSet);
+
+    /* take the converted readings out of the set so that they are not deleted with it */
+    std::vector<Reading*>* converted = readingSet.getAllReadingsPtr();
+    readings.swap(*converted);
+
+    return readings;
+}
@@ -0,0 +1,31 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter benchmarks.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#include "benchmark.hpp"
+
+/*
+ * Usage: PivotBench [--benchmark_filter=<regex>] [Google Benchmark options...], runs all benchmarks by default.
+ * Groups: exchange_lookup, config_import, conversion, ingest
+ */
+int main(int argc, char** argv)
+{
+    PivotBench::registerExchangeLookup();
+    PivotBench::registerConfigImport();
+    PivotBench::registerConversion();
+    PivotBench::registerIngest();
+
+    benchmark::Initialize(&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
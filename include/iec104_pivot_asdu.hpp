@@ -0,0 +1,234 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter ASDU type identifiers.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_ASDU_H
+#define _IEC104_PIVOT_ASDU_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ * ASDU types supported by the filter. Types of the same family only differ by the presence of a timestamp.
+ */
+enum class Iec104AsduType : uint8_t {
+    UNKNOWN = 0,
+    M_SP_NA_1, M_SP_TB_1,
+    M_DP_NA_1, M_DP_TB_1,
+    M_ME_NA_1, M_ME_TD_1,
+    M_ME_NB_1, M_ME_TE_1,
+    M_ME_NC_1, M_ME_TF_1,
+    M_ST_NA_1, M_ST_TB_1,
+    C_SC_NA_1, C_SC_TA_1,
+    C_DC_NA_1, C_DC_TA_1,
+    C_SE_NA_1, C_SE_TA_1,
+    C_SE_NB_1, C_SE_TB_1,
+    C_SE_NC_1, C_SE_TC_1,
+    C_RC_NA_1, C_RC_TA_1,
+    COUNT
+};
+
+enum class Iec104AsduFamily : uint8_t {
+    UNKNOWN = 0,
+    SP,            /* single point */
+    DP,            /* double point */
+    ME_NORMALIZED, /* normalized measured value */
+    ME_SCALED,     /* scaled measured value */
+    ME_FLOAT,      /* short (float) measured value */
+    ST,            /* step position */
+    SC,            /* single command */
+    DC,            /* double command */
+    SE_NORMALIZED, /* normalized set point command */
+    SE_SCALED,     /* scaled set point command */
+    SE_FLOAT,      /* short (float) set point command */
+    RC             /* regulating step command */
+};
+
+/*
+ * Representation of the value of an ASDU type, each kind has its own converter
+ */
+enum class Iec104ValueKind : uint8_t {
+    NONE = 0,
+    SINGLE,        /* 0 or 1, boolean status or control value */
+    DOUBLE,        /* 0 to 3: intermediate-state, off, on, bad-state */
+    NORMALIZED,    /* -1 to 1 - 2^-15 */
+    SCALED,        /* 16 bits signed integer */
+    FLOAT,         /* IEEE 754 single precision */
+    STEP_POSITION, /* -64 to 63 with transient indication, "[position,transient]" */
+    STEP_COMMAND,  /* 0 to 3: stop, lower, higher, reserved */
+    COUNT
+};
+
+/*
+ * Compile-time description of an ASDU type: how it is named, converted and checked
+ */
+struct Iec104AsduTraits {
+    const char* name;
+    Iec104AsduFamily family;
+    bool hasTimestamp;
+    bool isCommand;          /* C_* types, their value is a control value (ctlVal) */
+    const char* pivotLN;     /* pivot logical node (GTIS, GTIM or GTIC), null for unsupported types */
+    const char* pivotCdc;    /* pivot common data class */
+    Iec104ValueKind valueKind;
+    double minValue;         /* valid range of the value, not used for FLOAT */
+    double maxValue;
+    const char* familyName;  /* family name used in log messages */
+};
+
+namespace Iec104PivotUtility {
+
+    /* defined in the header (as a member of a class template) so that the table can be read at compile time */
+    template <typename Unused = void>
+    struct AsduTraitsTable {
+        /* indexed by Iec104AsduType */
+        static constexpr Iec104AsduTraits entries[] = {
+            {"UNKNOWN",   Iec104AsduFamily::UNKNOWN,       false, false, nullptr, nullptr,  Iec104ValueKind::NONE,           0.0,     0.0,               "UNKNOWN"},
+            {"M_SP_NA_1", Iec104AsduFamily::SP,            false, false, "GTIS",  "SpsTyp", Iec104ValueKind::SINGLE,         0.0,     1.0,               "SP"},
+            {"M_SP_TB_1", Iec104AsduFamily::SP,            true,  false, "GTIS",  "SpsTyp", Iec104ValueKind::SINGLE,         0.0,     1.0,               "SP"},
+            {"M_DP_NA_1", Iec104AsduFamily::DP,            false, false, "GTIS",  "DpsTyp", Iec104ValueKind::DOUBLE,         0.0,     3.0,               "DP"},
+            {"M_DP_TB_1", Iec104AsduFamily::DP,            true,  false, "GTIS",  "DpsTyp", Iec104ValueKind::DOUBLE,         0.0,     3.0,               "DP"},
+            {"M_ME_NA_1", Iec104AsduFamily::ME_NORMALIZED, false, false, "GTIM",  "MvTyp",  Iec104ValueKind::NORMALIZED,     -1.0,    32767.0 / 32768.0, "ME normalized"},
+            {"M_ME_TD_1", Iec104AsduFamily::ME_NORMALIZED, true,  false, "GTIM",  "MvTyp",  Iec104ValueKind::NORMALIZED,     -1.0,    32767.0 / 32768.0, "ME normalized"},
+            {"M_ME_NB_1", Iec104AsduFamily::ME_SCALED,     false, false, "GTIM",  "MvTyp",  Iec104ValueKind::SCALED,         -32768.0, 32767.0,          "ME scaled"},
+            {"M_ME_TE_1", Iec104AsduFamily::ME_SCALED,     true,  false, "GTIM",  "MvTyp",  Iec104ValueKind::SCALED,         -32768.0, 32767.0,          "ME scaled"},
+            {"M_ME_NC_1", Iec104AsduFamily::ME_FLOAT,      false, false, "GTIM",  "MvTyp",  Iec104ValueKind::FLOAT,          0.0,     0.0,               "ME floating"},
+            {"M_ME_TF_1", Iec104AsduFamily::ME_FLOAT,      true,  false, "GTIM",  "MvTyp",  Iec104ValueKind::FLOAT,          0.0,     0.0,               "ME floating"},
+            {"M_ST_NA_1", Iec104AsduFamily::ST,            false, false, "GTIM",  "BscTyp", Iec104ValueKind::STEP_POSITION,  -64.0,   63.0,              "ST"},
+            {"M_ST_TB_1", Iec104AsduFamily::ST,            true,  false, "GTIM",  "BscTyp", Iec104ValueKind::STEP_POSITION,  -64.0,   63.0,              "ST"},
+            {"C_SC_NA_1", Iec104AsduFamily::SC,            false, true,  "GTIC",  "SpcTyp", Iec104ValueKind::SINGLE,         0.0,     1.0,               "SC"},
+            {"C_SC_TA_1", Iec104AsduFamily::SC,            true,  true,  "GTIC",  "SpcTyp", Iec104ValueKind::SINGLE,         0.0,     1.0,               "SC"},
+            {"C_DC_NA_1", Iec104AsduFamily::DC,            false, true,  "GTIC",  "DpcTyp", Iec104ValueKind::DOUBLE,         0.0,     3.0,               "DC"},
+            {"C_DC_TA_1", Iec104AsduFamily::DC,            true,  true,  "GTIC",  "DpcTyp", Iec104ValueKind::DOUBLE,         0.0,     3.0,               "DC"},
+            {"C_SE_NA_1", Iec104AsduFamily::SE_NORMALIZED, false, true,  "GTIC",  "ApcTyp", Iec104ValueKind::NORMALIZED,     -1.0,    32767.0 / 32768.0, "SE normalized"},
+            {"C_SE_TA_1", Iec104AsduFamily::SE_NORMALIZED, true,  true,  "GTIC",  "ApcTyp", Iec104ValueKind::NORMALIZED,     -1.0,    32767.0 / 32768.0, "SE normalized"},
+            {"C_SE_NB_1", Iec104AsduFamily::SE_SCALED,     false, true,  "GTIC",  "IncTyp", Iec104ValueKind::SCALED,         -32768.0, 32767.0,          "SE scaled"},
+            {"C_SE_TB_1", Iec104AsduFamily::SE_SCALED,     true,  true,  "GTIC",  "IncTyp", Iec104ValueKind::SCALED,         -32768.0, 32767.0,          "SE scaled"},
+            {"C_SE_NC_1", Iec104AsduFamily::SE_FLOAT,      false, true,  "GTIC",  "ApcTyp", Iec104ValueKind::FLOAT,          0.0,     0.0,               "SE floating"},
+            {"C_SE_TC_1", Iec104AsduFamily::SE_FLOAT,      true,  true,  "GTIC",  "ApcTyp", Iec104ValueKind::FLOAT,          0.0,     0.0,               "SE floating"},
+            {"C_RC_NA_1", Iec104AsduFamily::RC,            false, true,  "GTIC",  "BscTyp", Iec104ValueKind::STEP_COMMAND,   0.0,     3.0,               "RC"},
+            {"C_RC_TA_1", Iec104AsduFamily::RC,            true,  true,  "GTIC",  "BscTyp", Iec104ValueKind::STEP_COMMAND,   0.0,     3.0,               "RC"},
+        };
+    };
+
+    template <typename Unused>
+    constexpr Iec104AsduTraits AsduTraitsTable<Unused>::entries[];
+
+    /**
+     * Get the description of an ASDU type, usable in constant expressions
+     * @param type : ASDU type identifier
+     * @return Traits of the type, the ones of UNKNOWN for unsupported types
+    */
+    constexpr const Iec104AsduTraits& getAsduTraits(Iec104AsduType type) {
+        return AsduTraitsTable<>::entries[static_cast<size_t>(type) < static_cast<size_t>(Iec104AsduType::COUNT) ?
+                                          static_cast<size_t>(type) : 0];
+    }
+
+    /**
+     * Pivot string values of double points and regulating step commands
+     * @param value : IEC 104 value, 0 to 3
+     * @return Pivot value: for double points "bad-state" when out of range, for step commands null when out of range
+    */
+    const std::string& doublePointToString(int value);
+    const std::string* stepCommandToString(int value);
+
+    /**
+     * Parse the pivot string value of a double point or regulating step command
+     * @param value : Pivot value
+     * @param out : IEC 104 value, 0 to 3, unchanged when the string is not a valid value
+     * @return True if the string is a valid value
+    */
+    bool parseDoublePoint(const std::string& value, long& out);
+    bool parseStepCommand(const std::string& value, long& out);
+
+    /* longest "[position,transient]" written by formatStepPosition, with the terminating null character */
+    constexpr size_t STEP_POSITION_MAX_LENGTH = 32;
+
+    /**
+     * Parse a step position "[position,transient]" without allocating, blanks are allowed around the elements
+     * @param value : Step position, eg. "[-5,true]"
+     * @param length : Length of the value
+     * @param position : Position, unchanged when the value is not valid
+     * @param transient : Transient indication, "true" or "false", unchanged when the value is not valid
+     * @return True if the value is valid
+    */
+    bool parseStepPosition(const char* value, size_t length, long& position, bool& transient);
+
+    inline bool parseStepPosition(const std::string& value, long& position, bool& transient) {
+        return parseStepPosition(value.c_str(), value.size(), position, transient);
+    }
+
+    /**
+     * Write a step position as "[position,transient]"
+     * @param buffer : At least STEP_POSITION_MAX_LENGTH characters, null terminated
+     * @return Length of the value
+    */
+    size_t formatStepPosition(long position, bool transient, char* buffer);
+
+    enum class StepPositionFormat
+    {
+        STRING,        /* do_value is "[position,transient]" (default) */
+        STRUCTURED     /* do_value is a dictionary with the posVal and transInd integers */
+    };
+
+    /**
+     * Parse the step_position_format configuration value
+     * @param value : "string" or "structured"
+     * @param format : Parsed format, unchanged when the value is not valid
+     * @return True if the value is valid
+    */
+    bool parseStepPositionFormat(const std::string& value, StepPositionFormat& format);
+
+    /**
+     * Convert an ASDU type name (eg. "M_SP_TB_1") to its identifier
+     * @param name : ASDU type name
+     * @param length : Length of the name
+     * @return ASDU type identifier, UNKNOWN if the name is not a supported type
+    */
+    Iec104AsduType parseAsduType(const char* name, size_t length);
+
+    inline Iec104AsduType parseAsduType(const std::string& name) {
+        return parseAsduType(name.c_str(), name.size());
+    }
+
+    /**
+     * Get the name of an ASDU type
+     * @param type : ASDU type identifier
+     * @return ASDU type name, "UNKNOWN" for unsupported types
+    */
+    const char* asduTypeToString(Iec104AsduType type);
+
+    /**
+     * Get the family of an ASDU type, types of the same family can be converted into each other
+     * @param type : ASDU type identifier
+     * @return ASDU type family
+    */
+    Iec104AsduFamily getAsduFamily(Iec104AsduType type);
+
+    /**
+     * Check if an ASDU type carries a timestamp
+     * @param type : ASDU type identifier
+     * @return True if the type has a timestamp, else false
+    */
+    bool asduHasTimestamp(Iec104AsduType type);
+
+    /**
+     * Check if an incoming ASDU type matches the configured ASDU type, that is both types are of the same family
+     * @param incomingType : ASDU type received
+     * @param configuredType : ASDU type from the exchanged data configuration
+     * @return True if the types are compatible, else false
+    */
+    inline bool isAsduTypeCompatible(Iec104AsduType incomingType, Iec104AsduType configuredType) {
+        Iec104AsduFamily family = getAsduFamily(incomingType);
+        return family != Iec104AsduFamily::UNKNOWN && family == getAsduFamily(configuredType);
+    }
+}
+
+#endif /* _IEC104_PIVOT_ASDU_H */
@@ -0,0 +1,67 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter clock used to timestamp objects received without a time.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_CLOCK_H
+#define _IEC104_PIVOT_CLOCK_H
+
+#include <cstdint>
+#include <string>
+
+namespace Iec104PivotUtility {
+
+/* Source of the current time in ms since epoch, must be callable from several threads */
+typedef uint64_t (*TimeSource)();
+
+/* CLOCK_REALTIME, same time as gettimeofday */
+uint64_t realtimeClockMs();
+
+/* CLOCK_REALTIME_COARSE: cheaper to read, but only as precise as the kernel tick (a few ms) */
+uint64_t coarseRealtimeClockMs();
+
+enum class ClockMode
+{
+    BATCH,     /* sampled once per reading set, all objects of the set get the same time (default) */
+    OBJECT,    /* sampled for each object */
+    COARSE     /* coarse clock sampled for each object */
+};
+
+/**
+ * Parse the timestamp_clock configuration value
+ * @param value : "batch", "object" or "coarse"
+ * @param mode : Parsed mode, unchanged when the value is not valid
+ * @return True if the value is valid
+ */
+bool parseClockMode(const std::string& value, ClockMode& mode);
+
+/**
+ * Time given to the objects converted during one ingest call that have no timestamp of their own.
+ * Built at the start of ingest and only read afterwards, so that conversion threads can share it.
+ */
+class ConversionClock
+{
+public:
+    ConversionClock(TimeSource source, ClockMode mode):
+        m_source(source),
+        m_sampleEachObject(mode != ClockMode::BATCH),
+        m_batchTimeMs(m_sampleEachObject ? 0 : source())
+    {};
+
+    uint64_t nowMs() const {return m_sampleEachObject ? m_source() : m_batchTimeMs;};
+
+private:
+    TimeSource m_source;
+    bool m_sampleEachObject;
+    uint64_t m_batchTimeMs;
+};
+
+}
+
+#endif /* _IEC104_PIVOT_CLOCK_H */
@@ -0,0 +1,74 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter datapoint node pool.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_DATAPOINT_POOL_H
+#define _IEC104_PIVOT_DATAPOINT_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Datapoint;
+
+/**
+ * Recycles the Datapoint nodes of consumed input trees to build the converted output trees.
+ * Released dictionary nodes keep their (emptied) children vector and its capacity, released leaf
+ * nodes keep a numeric value, so that reusing a node only renames it and sets its value.
+ * The pool is owned by a filter instance and is not thread safe.
+ */
+class DatapointPool
+{
+public:
+    static constexpr size_t MAX_FREE_NODES = 4096;
+
+    DatapointPool() = default;
+    ~DatapointPool();
+
+    DatapointPool(const DatapointPool&) = delete;
+    DatapointPool& operator=(const DatapointPool&) = delete;
+
+    /**
+     * Give a tree back to the pool, the node and all its descendants may be reused by the next create calls
+     * @param dp : Root of the tree, must not be referenced anymore by the caller
+     */
+    void release(Datapoint* dp);
+
+    Datapoint* createDict(const std::string& name);
+    Datapoint* createValue(const std::string& name, long value);
+    Datapoint* createValue(const std::string& name, int value) {return createValue(name, (long)value);};
+    Datapoint* createValue(const std::string& name, double value);
+    Datapoint* createValue(const std::string& name, float value) {return createValue(name, (double)value);};
+    Datapoint* createValue(const std::string& name, const std::string& value);
+    Datapoint* createValue(const std::string& name, const char* value);
+
+    /**
+     * Deep copy of a tree built from pooled nodes
+     * @param source : Tree to copy
+     * @return Copy owned by the caller
+     */
+    Datapoint* clone(Datapoint* source);
+
+    uint64_t getHitCount() const {return m_hits;};
+    uint64_t getMissCount() const {return m_misses;};
+    size_t getFreeNodeCount() const {return m_freeDicts.size() + m_freeLeaves.size();};
+
+private:
+    Datapoint* takeLeaf(const std::string& name);
+
+    std::vector<Datapoint*> m_freeDicts;
+    std::vector<Datapoint*> m_freeLeaves;
+
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
+};
+
+#endif /* _IEC104_PIVOT_DATAPOINT_POOL_H */
@@ -12,8 +12,17 @@
 #ifndef _IEC104_PIVOT_FILTER_H
 #define _IEC104_PIVOT_FILTER_H
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
 #include <filter.h>
+#include "iec104_pivot_clock.hpp"
+#include "iec104_pivot_datapoint_pool.hpp"
 #include "iec104_pivot_filter_config.hpp"
+#include "iec104_pivot_metrics.hpp"
+#include "iec104_pivot_snapshot.hpp"
+#include "iec104_pivot_worker_pool.hpp"
 
 using namespace std;
 
@@ -24,7 +33,36 @@ public:
      * Struct used to store fields of a data object during processing
     */
     struct Iec104DataObject {
+        /*
+         * Presence flags of the do_* attributes, set in attributeFound by readDataObjectAttributes
+        */
+        enum Attribute : uint32_t {
+            TYPE = 1u << 0,
+            COT = 1u << 1,
+            VALUE = 1u << 2,
+            QUALITY_IV = 1u << 3,
+            QUALITY_BL = 1u << 4,
+            QUALITY_OV = 1u << 5,
+            QUALITY_SB = 1u << 6,
+            QUALITY_NT = 1u << 7,
+            TS = 1u << 8,
+            TS_IV = 1u << 9,
+            TS_SU = 1u << 10,
+            TS_SUB = 1u << 11,
+            TEST = 1u << 12,
+            COMING_FROM = 1u << 13,
+            NEGATIVE = 1u << 14,
+            CA = 1u << 15,
+            IOA = 1u << 16
+        };
+
+        bool hasAttribute(Attribute attribute) const {return (attributeFound & attribute) != 0;};
+
+        uint32_t attributeFound = 0;
         std::string doType = "";
+        Iec104AsduType doAsduType = Iec104AsduType::UNKNOWN;
+        int doCa = 0;
+        int doIoa = 0;
         int doCot = 0;
         bool doQualityIv = false;
         bool doQualityBl = false;
@@ -44,7 +82,26 @@ public:
      * Struct used to store fields of a command object during processing
     */
     struct Iec104CommandObject {
+        /*
+         * Presence flags of the co_* attributes, set in attributeFound by readCommandObjectAttributes
+        */
+        enum Attribute : uint32_t {
+            IOA = 1u << 0,
+            CA = 1u << 1,
+            TYPE = 1u << 2,
+            COT = 1u << 3,
+            VALUE = 1u << 4,
+            TS = 1u << 5,
+            SE = 1u << 6,
+            TEST = 1u << 7,
+            COMING_FROM = 1u << 8
+        };
+
+        bool hasAttribute(Attribute attribute) const {return (attributeFound & attribute) != 0;};
+
+        uint32_t attributeFound = 0;
         std::string coType = "";
+        Iec104AsduType coAsduType = Iec104AsduType::UNKNOWN;
         int coIoa = 0;
         int coCa = 0;
         int coCot = 0;
@@ -55,6 +112,11 @@ public:
         Datapoint* coValue = nullptr;
     };
 
+    /* Default minimum size of a reading set converted by the worker threads */
+    static constexpr size_t DEFAULT_PARALLEL_THRESHOLD = 1024;
+    static constexpr size_t MIN_PARALLEL_CHUNK_SIZE = 64;
+    static constexpr int MAX_CONVERSION_THREADS = 64;
+
     IEC104PivotFilter(const std::string& filterName,
         ConfigCategory* filterConfig,
         OUTPUT_HANDLE *outHandle,
@@ -65,7 +127,60 @@ public:
     void ingest(READINGSET* readingSet);
     void reconfigure(ConfigCategory* config);
 
+    const DatapointPool& getDatapointPool() const {return m_pool;};
+    size_t getConversionThreadCount() const;
+
+    /* conversion counters per ASDU type and latency histograms, can be called while readings are ingested */
+    Iec104PivotUtility::MetricsSnapshot getMetricsSnapshot() const {return m_metrics.snapshot();};
+
+    /* replace the clock selected by timestamp_clock (deterministic time in tests and benchmarks), nullptr to restore it */
+    void setTimeSource(Iec104PivotUtility::TimeSource source) {m_timeSource.store(source);};
+
 private:
+    /* unit tests and benchmarks reach the conversion steps directly, see tests/filter_internals.hpp */
+    friend class IEC104PivotFilterInternals;
+
+    /*
+     * Conversion threads and their node pools, shared by the settings versions until the number of threads changes
+    */
+    struct ConversionWorkers {
+        explicit ConversionWorkers(int threadCount);
+
+        Iec104PivotUtility::WorkerPool pool;
+        std::vector<std::unique_ptr<DatapointPool>> datapointPools;
+    };
+
+    /*
+     * Settings read by ingest, never modified once published: reconfigure publishes a modified copy, so that
+     * a reading set is converted with the settings current when its conversion started
+    */
+    struct RuntimeSettings {
+        /* optional conversion threads for large reading sets */
+        std::shared_ptr<ConversionWorkers> workers;
+        size_t parallelThreshold = DEFAULT_PARALLEL_THRESHOLD;
+
+        /* time of the objects received without a timestamp, m_timeSource overrides the clock of the mode when set */
+        Iec104PivotUtility::ClockMode clockMode = Iec104PivotUtility::ClockMode::BATCH;
+
+        /* do_value of the step positions sent to the IEC 104 side */
+        Iec104PivotUtility::StepPositionFormat stepPositionFormat = Iec104PivotUtility::StepPositionFormat::STRING;
+
+        /* monitoring data objects sent only when their state changed, disabled by default */
+        Iec104PivotUtility::ReportByException reportByException;
+    };
+
+    /*
+     * Report by exception: state of a data object that must be sent, as recorded by ReportByException::recordSent.
+     * It becomes the last state sent for its definition only once the object was converted, an object dropped by
+     * the conversion is not recorded.
+    */
+    struct PendingReport {
+        IEC104PivotDataPoint* definition;
+        Iec104PivotUtility::ReportState state;
+        /* input datapoint of the object, only compared until it is converted */
+        const Datapoint* input;
+        bool converted;
+    };
 
     Datapoint* addElement(Datapoint* dp, string elementPath);
 
@@ -78,28 +193,104 @@ private:
 
     Datapoint* createDp(string name);
 
-    template <typename T>
-    void static readAttribute(std::map<std::string, bool>& attributeFound, Datapoint* dp,
-                              const std::string& targetName, T& out);
-    void static readAttribute(std::map<std::string, bool>& attributeFound, Datapoint* dp,
-                              const std::string& targetName, Datapoint*& out);
-    void static readAttribute(std::map<std::string, bool>& attributeFound, Datapoint* dp,
-                              const std::string& targetName, std::string& out);
+    /*
+     * Read all do_* (resp. co_*) attributes in a single pass over the children of the object.
+     * The first occurrence of an attribute with the expected value type is kept.
+    */
+    void static readDataObjectAttributes(const std::vector<Datapoint*>& datapoints, Iec104DataObject& dataObject);
+    void static readCommandObjectAttributes(const std::vector<Datapoint*>& datapoints, Iec104CommandObject& commandObject);
+
+    static IEC104PivotDataPoint* findDataObjectDefinition(const IEC104PivotConfig& config, const Iec104DataObject& dataObject,
+                                                          const std::string& assetName);
+
+    Datapoint* convertDataObjectToPivot(Iec104DataObject& dataObject, IEC104PivotDataPoint* exchangeConfig, DatapointPool& pool,
+                                        Iec104PivotUtility::MetricsShard& metrics, const Iec104PivotUtility::ConversionClock& clock);
+
+    Datapoint* convertOperationObjectToPivot(const IEC104PivotConfig& config, const std::vector<Datapoint*>& sourceDp,
+                                             DatapointPool& pool, Iec104PivotUtility::MetricsShard& metrics,
+                                             const Iec104PivotUtility::ConversionClock& clock);
+
+    Datapoint* convertDatapointToIEC104DataObject(const IEC104PivotConfig& config, Datapoint* sourceDp, DatapointPool& pool,
+                                                  Iec104PivotUtility::MetricsShard& metrics,
+                                                  const Iec104PivotUtility::ConversionClock& clock,
+                                                  Iec104PivotUtility::StepPositionFormat stepPositionFormat);
+
+    std::vector<Datapoint*> convertReadingToIEC104OperationObject(const IEC104PivotConfig& config, Datapoint* datapoints,
+                                                                  DatapointPool& pool, Iec104PivotUtility::MetricsShard& metrics);
+
+    /*
+     * Convert the datapoints of a reading in place, nodes are taken from and given back to the pool.
+     * Only reads the exchange configuration and settings snapshots, so that readings can be converted concurrently
+     * with one pool and one metrics shard per thread. The pending reports of the reading, in the order of its
+     * datapoints, are marked when their object is converted: each reading is converted by a single thread.
+    */
+    void convertReading(const IEC104PivotConfig& config, const RuntimeSettings& settings, Reading* reading, DatapointPool& pool,
+                        Iec104PivotUtility::MetricsShard& metrics, const Iec104PivotUtility::ConversionClock& clock,
+                        PendingReport* pendingReports, size_t pendingReportCount);
+
+    void convertReadingsInParallel(const IEC104PivotConfig& config, const RuntimeSettings& settings, std::vector<Reading*>& readings,
+                                   const Iec104PivotUtility::ConversionClock& clock);
+
+    /* Convert reading i of the set with its pending reports, if any */
+    void convertReadingOfSet(const IEC104PivotConfig& config, const RuntimeSettings& settings, std::vector<Reading*>& readings,
+                             size_t i, DatapointPool& pool, Iec104PivotUtility::MetricsShard& metrics,
+                             const Iec104PivotUtility::ConversionClock& clock);
 
-    Datapoint* convertDataObjectToPivot(Datapoint* sourceDp, IEC104PivotDataPoint* exchangeConfig);
+    /*
+     * Report by exception: remove from the readings the monitoring data objects with the same state as the last one
+     * sent for their exchange definition, and keep the state of the others as pending reports. Run in reading order
+     * before the conversion, so that objects of a definition are compared in the order they were received even when
+     * the set is converted in parallel. An object is compared with the pending report of its definition when an
+     * earlier object of the set has one.
+    */
+    void suppressUnchangedDataObjects(const IEC104PivotConfig& config, const Iec104PivotUtility::ReportByException& reportByException,
+                                      std::vector<Reading*>& readings, Iec104PivotUtility::MetricsShard& metrics,
+                                      const Iec104PivotUtility::ConversionClock& clock);
 
-    Datapoint* convertOperationObjectToPivot(std::vector<Datapoint*> sourceDp);
+    /* Record the pending reports of the converted objects as the last states sent, in reading order, and clear them */
+    void recordSentDataObjects();
 
-    Datapoint* convertDatapointToIEC104DataObject(Datapoint* sourceDp);
+    /* Update the conversion threads of settings being built by reconfigure */
+    void setConversionThreads(RuntimeSettings& settings, int threadCount);
 
-    std::vector<Datapoint*> convertReadingToIEC104OperationObject(Datapoint* datapoints);
+    /* Build the exchange configuration from the cached binary image when there is one for this exchanged_data */
+    std::unique_ptr<IEC104PivotConfig> loadExchangeConfig(const std::string& filterName, const std::string& exchangedData,
+                                                          const IEC104PivotConfig* previous);
 
-    bool hasASDUTimestamp(const std::string& asduType);
+    /* Give the datapoints of a consumed reading to the node pool and empty the reading */
+    void releaseDatapoints(std::vector<Datapoint*>& datapoints, DatapointPool& pool);
 
     OUTPUT_HANDLE* m_outHandle = nullptr;
     OUTPUT_STREAM m_output = nullptr;
 
-    IEC104PivotConfig m_config;
+    /* immutable exchange configuration, replaced as a whole by reconfigure while readings are ingested */
+    Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig> m_config{std::unique_ptr<IEC104PivotConfig>(new IEC104PivotConfig())};
+
+    /* settings replaced as a whole by reconfigure, a replaced version (and its conversion threads) is deleted once no
+       ingest uses it anymore */
+    Iec104PivotUtility::SnapshotPointer<RuntimeSettings> m_settings{std::unique_ptr<RuntimeSettings>(new RuntimeSettings())};
+
+    /* node pool of the thread calling ingest, worker 0 of the conversion threads */
+    DatapointPool m_pool;
+
+    /* report by exception states of the reading set being ingested, only used by the ingest thread: the reports of
+       reading i are m_pendingReports[m_pendingReportStarts[i]] to m_pendingReports[m_pendingReportStarts[i + 1] - 1] */
+    std::vector<PendingReport> m_pendingReports;
+    std::vector<size_t> m_pendingReportStarts;
+    /* index in m_pendingReports of the last report pending for a definition, definitions of the set only */
+    std::unordered_map<const IEC104PivotDataPoint*, size_t> m_pendingReportIndexes;
+
+    /* true while this filter is a user of the asynchronous log sink */
+    bool m_asyncLogging = false;
+
+    /* directory of the compiled configuration images, empty when the cache is disabled */
+    std::string m_configCacheDir;
+
+    /* set by tests and benchmarks, may be changed while readings are ingested */
+    std::atomic<Iec104PivotUtility::TimeSource> m_timeSource{nullptr};
+
+    /* one shard for the ingest thread and one for each conversion thread */
+    Iec104PivotUtility::MetricsRegistry m_metrics{MAX_CONVERSION_THREADS + 1};
 };
 
 
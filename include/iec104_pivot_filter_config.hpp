@@ -12,23 +12,49 @@
 #ifndef PIVOT_IEC104_CONFIG_H
 #define PIVOT_IEC104_CONFIG_H
 
-#include <map>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
+#include <rapidjson/document.h>
+
+#include "iec104_pivot_asdu.hpp"
+#include "iec104_pivot_report.hpp"
 
 using namespace std;
 
+class Datapoint;
+
 class IEC104PivotDataPoint
 {
 public:
-    IEC104PivotDataPoint(string label, string pivotId, string pivotType, string typeIdString, int ca, int ioa, string altMappingRule);
+    IEC104PivotDataPoint(const string& label, const string& pivotId, const string& pivotType, const string& typeIdString, int ca, int ioa,
+                         const string& altMappingRule);
     ~IEC104PivotDataPoint();
 
+    IEC104PivotDataPoint(const IEC104PivotDataPoint&) = delete;
+    IEC104PivotDataPoint& operator=(const IEC104PivotDataPoint&) = delete;
+
     std::string& getLabel() {return m_label;};
     std::string& getPivotId() {return m_pivotId;};
     std::string& getPivotType() {return m_pivotType;};
     std::string& getTypeId() {return m_typeIdStr;};
+    Iec104AsduType getAsduType() {return m_typeId;};
     int getCA() {return m_ca;};
     int getIOA() {return m_ioa;};
+    std::string& getAlternateMappingRule() {return m_alternateMappingRule;};
+
+    /* True if the definition was built from these values */
+    bool hasDefinition(const string& label, const string& pivotId, const string& pivotType, const string& typeIdString,
+                       int ca, int ioa, const string& altMappingRule) const;
+
+    /* Output skeletons built once from the definition, conversions clone them (nullptr when not applicable) */
+    Datapoint* getPivotTemplate() {return m_pivotTemplate;};
+    Datapoint* getIec104DataObjectTemplate() {return m_dataObjectTemplate;};
+    Datapoint* getIec104OperationObjectTemplate() {return m_operationTemplate;};
+
+    /* Last state sent by report by exception, kept while the definition is unchanged by reconfigurations */
+    Iec104PivotUtility::ReportState& getReportState() {return m_reportState;};
 
 private:
     std::string m_label;
@@ -36,35 +62,182 @@ private:
     std::string m_pivotType;
 
     std::string m_typeIdStr;
+    Iec104AsduType m_typeId;
     int         m_ca;
     int         m_ioa;
     std::string m_alternateMappingRule;
+
+    Datapoint* m_pivotTemplate = nullptr;
+    Datapoint* m_dataObjectTemplate = nullptr;
+    Datapoint* m_operationTemplate = nullptr;
+
+    Iec104PivotUtility::ReportState m_reportState;
 };
 
-class IEC104PivotConfig
+/*
+ * Open addressing hash index of exchange definitions. The hash of each key is computed once at insertion,
+ * lookups take the key as a pointer and a length so that callers never have to build a temporary string.
+ */
+class ExchangeDefinitionIndex
 {
 public:
-    void importExchangeConfig(const string& exchangeConfig);
+    /**
+     * Add a definition to the index, replaces the definition already stored with the same key
+     * @param key : Key of the definition (label, address, pivot ID)
+     * @param dataPoint : Definition to store
+     */
+    void insert(const std::string& key, const std::shared_ptr<IEC104PivotDataPoint>& dataPoint) {
+        insert(key, hash(key.data(), key.size()), dataPoint);
+    }
+
+    /* same as insert(key, dataPoint), with the hash of the key already computed */
+    void insert(const std::string& key, uint64_t keyHash, const std::shared_ptr<IEC104PivotDataPoint>& dataPoint);
 
-    IEC104PivotDataPoint* getExchangeDefinitionsByLabel(std::string label);
-    IEC104PivotDataPoint* getExchangeDefinitionsByAddress(std::string address);
-    IEC104PivotDataPoint* getExchangeDefinitionsByPivotId(std::string pivotid);
+    IEC104PivotDataPoint* find(const char* key, size_t length) const;
+    IEC104PivotDataPoint* find(const std::string& key) const {return find(key.data(), key.size());};
+    std::shared_ptr<IEC104PivotDataPoint> findShared(const std::string& key) const;
+
+    /* make room for count definitions so that inserting them does not rehash */
+    void reserve(size_t count);
+    void clear();
+    size_t size() const {return m_count;};
+
+    static uint64_t hash(const char* key, size_t length);
 
 private:
-    
-    void m_deleteExchangeDefinitions();
+    struct Slot {
+        uint64_t hash = 0;
+        std::string key;
+        std::shared_ptr<IEC104PivotDataPoint> dataPoint;
+    };
+
+    const Slot* m_findSlot(const char* key, size_t length) const;
+    void m_rehash(size_t capacity);
+
+    std::vector<Slot> m_slots;
+    size_t m_count = 0;
+};
+
+/*
+ * Open addressing hash index of exchange definitions keyed by their IEC 104 address,
+ * packed into a 64-bit integer (see packAddress)
+ */
+class ExchangeAddressIndex
+{
+public:
+    static uint64_t packAddress(int ca, int ioa) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(ca)) << 32) | static_cast<uint32_t>(ioa);
+    };
+
+    /**
+     * Add a definition to the index, replaces the definition already stored with the same address
+     * @param ca : Common address of the definition
+     * @param ioa : Information object address of the definition
+     * @param dataPoint : Definition to store
+     */
+    void insert(int ca, int ioa, const std::shared_ptr<IEC104PivotDataPoint>& dataPoint);
 
-    static bool m_check_string(const rapidjson::Value &json, const char *key);
-    static bool m_check_array(const rapidjson::Value &json, const char *key);
-    static bool m_check_object(const rapidjson::Value &json, const char *key);
+    IEC104PivotDataPoint* find(int ca, int ioa) const;
 
-    static bool m_retrieve(const rapidjson::Value &json, const char *key, std::string *target);
+    void reserve(size_t count);
+    void clear();
+    size_t size() const {return m_count;};
+
+private:
+    struct Slot {
+        uint64_t address = 0;
+        std::shared_ptr<IEC104PivotDataPoint> dataPoint;
+    };
+
+    static uint64_t m_hash(uint64_t address);
+    void m_rehash(size_t capacity);
+
+    std::vector<Slot> m_slots;
+    size_t m_count = 0;
+};
+
+/*
+ * Definitions of an imported configuration compared with those of the previous one, by label
+ */
+struct ExchangeConfigChanges
+{
+    size_t added = 0;
+    size_t updated = 0;
+    size_t removed = 0;
+    size_t unchanged = 0;
+};
+
+class ExchangeConfigParser;
+
+class IEC104PivotConfig
+{
+public:
+    /**
+     * Import the exchanged_data configuration. The JSON is parsed as a stream, without building a document:
+     * the definitions are built as their datapoint ends and the other protocols are skipped.
+     * @param exchangeConfig : exchanged_data JSON
+     * @param previous : Configuration replaced by this one, its definitions that did not change are reused
+     */
+    void importExchangeConfig(const string& exchangeConfig, const IEC104PivotConfig* previous = nullptr);
+
+    /* True if the configuration was imported from this exchanged_data JSON (compared by hash and size) */
+    bool isImportedFrom(const string& exchangeConfig) const;
+
+    const ExchangeConfigChanges& getChanges() const {return m_changes;};
+
+    bool isComplete() const {return m_exchangeConfigComplete;};
+
+    /* Version of the binary image format, images written by another version are ignored */
+    static constexpr uint32_t IMAGE_VERSION = 1;
+
+    /**
+     * Load the definitions from a binary image written by writeImage instead of parsing the JSON
+     * @param path : Image file, memory-mapped while the definitions are built
+     * @param exchangeConfig : exchanged_data JSON the image must have been compiled from
+     * @param previous : Configuration replaced by this one, as for importExchangeConfig
+     * @return False if the image is missing, stale (other JSON or format version) or damaged, the configuration is then left empty
+     */
+    bool loadImage(const std::string& path, const string& exchangeConfig, const IEC104PivotConfig* previous = nullptr);
+
+    /**
+     * Write the compiled definitions as a binary image: string pool, fixed size entries and their key hashes
+     * @param path : Image file, written under a temporary name then renamed
+     * @return False if the configuration is not complete or the file cannot be written
+     */
+    bool writeImage(const std::string& path) const;
+
+    IEC104PivotDataPoint* getExchangeDefinitionsByLabel(const std::string& label) const {return m_exchangeDefinitionsLabel.find(label);};
+    IEC104PivotDataPoint* getExchangeDefinitionsByLabel(const char* label, size_t length) const {return m_exchangeDefinitionsLabel.find(label, length);};
+    IEC104PivotDataPoint* getExchangeDefinitionsByAddress(int ca, int ioa) const {return m_exchangeDefinitionsAddress.find(ca, ioa);};
+    IEC104PivotDataPoint* getExchangeDefinitionsByAddress(const std::string& address) const {return getExchangeDefinitionsByAddress(address.data(), address.size());};
+    IEC104PivotDataPoint* getExchangeDefinitionsByAddress(const char* address, size_t length) const;
+    IEC104PivotDataPoint* getExchangeDefinitionsByPivotId(const std::string& pivotid) const {return m_exchangeDefinitionsPivotId.find(pivotid);};
+    IEC104PivotDataPoint* getExchangeDefinitionsByPivotId(const char* pivotid, size_t length) const {return m_exchangeDefinitionsPivotId.find(pivotid, length);};
+
+private:
+
+    void m_addDefinition(const string& label, uint64_t labelHash, const string& pivotId, uint64_t pivotIdHash, const string& pivotType,
+                         const string& typeIdStr, int ca, int ioa, const string& alternateMappingRule, const IEC104PivotConfig* previous);
+    void m_finishImport(const IEC104PivotConfig* previous);
+
+    void m_deleteExchangeDefinitions();
+
+    /* builds the definitions while exchanged_data is parsed */
+    friend class ExchangeConfigParser;
 
     bool m_exchangeConfigComplete = false;
 
-    std::map<std::string, std::shared_ptr<IEC104PivotDataPoint>> m_exchangeDefinitionsLabel;
-    std::map<std::string, std::shared_ptr<IEC104PivotDataPoint>> m_exchangeDefinitionsAddress;
-    std::map<std::string, std::shared_ptr<IEC104PivotDataPoint>> m_exchangeDefinitionsPivotId;
+    bool m_sourceImported = false;
+    size_t m_sourceSize = 0;
+    uint64_t m_sourceHash = 0;
+    ExchangeConfigChanges m_changes;
+
+    /* definitions in the order of the configuration, used to write the binary image */
+    std::vector<std::shared_ptr<IEC104PivotDataPoint>> m_definitions;
+
+    ExchangeDefinitionIndex m_exchangeDefinitionsLabel;
+    ExchangeAddressIndex m_exchangeDefinitionsAddress;
+    ExchangeDefinitionIndex m_exchangeDefinitionsPivotId;
 
 };
 
@@ -0,0 +1,102 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter asynchronous log sink.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_LOG_SINK_H
+#define _IEC104_PIVOT_LOG_SINK_H
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "iec104_pivot_utility.hpp"
+
+namespace Iec104PivotUtility {
+
+/**
+ * Non-blocking log sink: log records are formatted by the calling thread into a bounded
+ * lock-free ring buffer (multi-producer, single consumer) and written to the Fledge logger
+ * by a background thread. When the buffer is full the record is dropped and counted.
+ * The sink is shared by the filter instances of the process: it runs while at least one of them uses it.
+ */
+class AsyncLogSink
+{
+public:
+    static constexpr size_t CAPACITY = 1024; /* must be a power of two */
+    static constexpr size_t MESSAGE_SIZE = 512;
+
+    static AsyncLogSink& getInstance();
+
+    /**
+     * Add a user of the sink, the background writer thread is started for the first one
+     */
+    void start();
+
+    /**
+     * Remove a user of the sink, does nothing if there is none. When the last one is removed, all pending records
+     * are written and the background writer thread is stopped. Log helpers fall back to synchronous logging once
+     * the sink is stopped.
+     */
+    void stop();
+
+    bool isRunning() const {return asyncLogEnabled.load(std::memory_order_relaxed);};
+
+    /**
+     * Format a record and queue it for the background writer, never blocks
+     * @param level : Level of the record
+     * @param format : printf style format
+     * @param args : Format arguments
+     * @return False if the sink is stopped, the caller must then log the record synchronously. A record dropped
+     *         because the buffer is full is counted and reported by the writer thread, true is returned for it.
+     */
+    bool enqueue(LogLevel level, const char* format, va_list args);
+
+    uint64_t getWrittenCount() const {return m_written.load(std::memory_order_relaxed);};
+    uint64_t getDroppedCount() const {return m_dropped.load(std::memory_order_relaxed);};
+
+private:
+    AsyncLogSink();
+    ~AsyncLogSink();
+
+    struct Record {
+        std::atomic<size_t> sequence;
+        LogLevel level;
+        char message[MESSAGE_SIZE];
+    };
+
+    /* queue a formatted record, or drop and count it when the buffer is full */
+    void push(LogLevel level, const char* format, va_list args);
+    size_t drain();
+    void run();
+    void reportDropped();
+
+    Record* m_buffer = nullptr;
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) size_t m_dequeuePos = 0;
+
+    std::atomic<uint64_t> m_written;
+    std::atomic<uint64_t> m_dropped;
+    uint64_t m_droppedReported = 0;
+
+    /* producers inside enqueue(), the writer thread only exits once the last ones published their record */
+    std::atomic<size_t> m_activeProducers;
+
+    std::atomic<bool> m_stopRequested;
+    std::thread m_thread;
+    std::mutex m_controlMutex;
+    size_t m_users = 0;
+};
+
+}
+
+#endif /* _IEC104_PIVOT_LOG_SINK_H */
@@ -0,0 +1,255 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter runtime metrics.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_METRICS_H
+#define _IEC104_PIVOT_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "iec104_pivot_asdu.hpp"
+
+namespace Iec104PivotUtility {
+
+enum class MetricsDirection : uint8_t {
+    IEC104_TO_PIVOT = 0,
+    PIVOT_TO_IEC104,
+    COUNT
+};
+
+/*
+ * What happened to a data object or command, the DROPPED_* values give the reason why it was removed
+ */
+enum class MetricsOutcome : uint8_t {
+    CONVERTED = 0,
+    PASSTHROUGH,             /* no exchange definition, forwarded unchanged */
+    TYPE_MISMATCH,           /* dropped, the ASDU type does not match the configured type */
+    DROPPED_INVALID,         /* missing or invalid attribute */
+    DROPPED_UNKNOWN_ADDRESS, /* command for an address (or pivot ID) not in the exchanged data */
+    DROPPED_NOT_FROM_IEC104, /* object not coming from the IEC 104 plugin */
+    SUPPRESSED_UNCHANGED,    /* not sent by report by exception, same state as the last one sent */
+    COUNT
+};
+
+/*
+ * Timed sections of the filter
+ */
+enum class MetricsLatency : uint8_t {
+    INGEST = 0,
+    CONVERT_DATA_OBJECT_TO_PIVOT,
+    CONVERT_OPERATION_OBJECT_TO_PIVOT,
+    CONVERT_PIVOT_TO_DATA_OBJECT,
+    CONVERT_PIVOT_TO_OPERATION_OBJECT,
+    COUNT
+};
+
+const char* metricsDirectionToString(MetricsDirection direction);
+const char* metricsOutcomeToString(MetricsOutcome outcome);
+const char* metricsLatencyToString(MetricsLatency latency);
+
+/**
+ * Log-linear bucketing of latencies in nanoseconds, in the manner of HDR histograms: each power of two
+ * is split in 2^SUB_BUCKET_BITS buckets, so that a value is known within 1/2^SUB_BUCKET_BITS (12.5%).
+ * Values above 2^MAX_EXPONENT ns (about 18 minutes) go to the last bucket.
+ */
+struct LatencyBuckets
+{
+    static constexpr unsigned SUB_BUCKET_BITS = 3;
+    static constexpr unsigned MAX_EXPONENT = 40;
+    static constexpr size_t COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) << SUB_BUCKET_BITS;
+
+    static size_t indexOf(uint64_t valueNs);
+
+    /* smallest value falling in the bucket */
+    static uint64_t lowerBound(size_t index);
+};
+
+/**
+ * Summed view of a latency histogram
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram(): m_buckets(LatencyBuckets::COUNT, 0) {};
+
+    uint64_t getCount() const {return m_count;};
+    uint64_t getSumNs() const {return m_sumNs;};
+    uint64_t getMaxNs() const {return m_maxNs;};
+    double getMeanNs() const {return m_count > 0 ? (double)m_sumNs / (double)m_count : 0.0;};
+
+    /**
+     * Get a latency quantile
+     * @param quantile : Quantile between 0 and 1 (eg. 0.99)
+     * @return Upper bound of the bucket holding the quantile, 0 when the histogram is empty
+     */
+    uint64_t getPercentileNs(double quantile) const;
+
+    const std::vector<uint64_t>& getBuckets() const {return m_buckets;};
+
+private:
+    friend class MetricsRegistry;
+
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count = 0;
+    uint64_t m_sumNs = 0;
+    uint64_t m_maxNs = 0;
+};
+
+/**
+ * Copy of all counters and histograms of a registry at a point in time
+ */
+class MetricsSnapshot
+{
+public:
+    MetricsSnapshot();
+
+    uint64_t getCount(MetricsDirection direction, Iec104AsduType type, MetricsOutcome outcome) const {
+        return m_counters[counterIndex(direction, type, outcome)];
+    }
+
+    /* count over all ASDU types */
+    uint64_t getTotal(MetricsDirection direction, MetricsOutcome outcome) const;
+
+    const LatencyHistogram& getLatency(MetricsLatency latency) const {return m_latencies[(size_t)latency];};
+
+    static size_t counterIndex(MetricsDirection direction, Iec104AsduType type, MetricsOutcome outcome) {
+        return ((size_t)direction * (size_t)Iec104AsduType::COUNT + (size_t)type) * (size_t)MetricsOutcome::COUNT + (size_t)outcome;
+    }
+
+    static constexpr size_t COUNTER_COUNT = (size_t)MetricsDirection::COUNT * (size_t)Iec104AsduType::COUNT * (size_t)MetricsOutcome::COUNT;
+
+private:
+    friend class MetricsRegistry;
+
+    std::vector<uint64_t> m_counters;
+    std::vector<LatencyHistogram> m_latencies;
+};
+
+/**
+ * Counters and histograms of a single thread, aligned on a cache line so that threads never write to a
+ * shared line. A shard has a single writer, which updates its values with plain relaxed loads and
+ * stores (no locked instruction); the atomics only make reading them from another thread safe.
+ */
+class alignas(64) MetricsShard
+{
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    MetricsShard();
+
+    MetricsShard(const MetricsShard&) = delete;
+    MetricsShard& operator=(const MetricsShard&) = delete;
+
+    void count(MetricsDirection direction, Iec104AsduType type, MetricsOutcome outcome) {
+        increment(m_counters[MetricsSnapshot::counterIndex(direction, type, outcome)], 1);
+    }
+
+    void recordLatency(MetricsLatency latency, uint64_t valueNs);
+
+private:
+    friend class MetricsRegistry;
+
+    struct Histogram {
+        std::atomic<uint64_t> buckets[LatencyBuckets::COUNT];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sumNs;
+        std::atomic<uint64_t> maxNs;
+    };
+
+    static void increment(std::atomic<uint64_t>& value, uint64_t delta) {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> m_counters[MetricsSnapshot::COUNTER_COUNT];
+    Histogram m_latencies[(size_t)MetricsLatency::COUNT];
+};
+
+/**
+ * Metrics of a filter instance, made of one shard per worker (worker 0 being the thread calling ingest,
+ * as for the WorkerPool). Shards are allocated on first use, snapshot() can be called from any thread.
+ */
+class MetricsRegistry
+{
+public:
+    explicit MetricsRegistry(size_t maxShards);
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    /**
+     * Get the shard of a worker, only this worker may record values in it
+     * @param worker : Worker index, lower than maxShards
+     */
+    MetricsShard& getShard(size_t worker) {
+        MetricsShard* shard = m_shards[worker].load(std::memory_order_acquire);
+        return shard ? *shard : createShard(worker);
+    }
+
+    /* sum of all shards */
+    MetricsSnapshot snapshot() const;
+
+private:
+    MetricsShard& createShard(size_t worker);
+
+    std::unique_ptr<std::atomic<MetricsShard*>[]> m_shards;
+    size_t m_maxShards;
+};
+
+/**
+ * Record the latency of a scope in a shard
+ */
+class ScopedLatency
+{
+public:
+    ScopedLatency(MetricsShard& shard, MetricsLatency latency):
+        m_shard(shard), m_latency(latency), m_start(std::chrono::steady_clock::now()) {};
+
+    ~ScopedLatency() {
+        m_shard.recordLatency(m_latency, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                              std::chrono::steady_clock::now() - m_start).count());
+    }
+
+private:
+    MetricsShard& m_shard;
+    MetricsLatency m_latency;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * Record the latency and the outcome of a conversion function. The outcome defaults to DROPPED_INVALID
+ * so that only the successful and the specific failure paths need to set it.
+ */
+class ConversionRecord : public ScopedLatency
+{
+public:
+    ConversionRecord(MetricsShard& shard, MetricsLatency latency, MetricsDirection direction):
+        ScopedLatency(shard, latency), m_shard(shard), m_direction(direction) {};
+
+    ~ConversionRecord() {m_shard.count(m_direction, m_type, m_outcome);}
+
+    void setAsduType(Iec104AsduType type) {m_type = type;};
+    void setOutcome(MetricsOutcome outcome) {m_outcome = outcome;};
+
+private:
+    MetricsShard& m_shard;
+    MetricsDirection m_direction;
+    Iec104AsduType m_type = Iec104AsduType::UNKNOWN;
+    MetricsOutcome m_outcome = MetricsOutcome::DROPPED_INVALID;
+};
+
+}
+
+#endif /* _IEC104_PIVOT_METRICS_H */
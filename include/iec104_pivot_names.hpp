@@ -0,0 +1,121 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter names and constant values of the converted trees.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_NAMES_H
+#define _IEC104_PIVOT_NAMES_H
+
+#include <string>
+
+/*
+ * One string per datapoint name and constant value of the pivot and IEC 104 trees, built once when the
+ * plugin is loaded. The builders pass them by reference instead of making a std::string out of a literal
+ * for each element, and the parsers compare against them, which rejects names of another length at once.
+ * Identifiers are the strings themselves.
+ */
+namespace Iec104PivotNames {
+
+/* pivot tree */
+extern const std::string PIVOT;
+extern const std::string GTIS;
+extern const std::string GTIM;
+extern const std::string GTIC;
+extern const std::string SpsTyp;
+extern const std::string MvTyp;
+extern const std::string DpsTyp;
+extern const std::string SpcTyp;
+extern const std::string DpcTyp;
+extern const std::string IncTyp;
+extern const std::string ApcTyp;
+extern const std::string BscTyp;
+extern const std::string Identifier;
+extern const std::string ComingFrom;
+extern const std::string Cause;
+extern const std::string Confirmation;
+extern const std::string TmOrg;
+extern const std::string TmValidity;
+extern const std::string Select;
+extern const std::string stVal;
+extern const std::string ctlVal;
+extern const std::string mag;
+extern const std::string f;
+extern const std::string i;
+extern const std::string valWtr;
+extern const std::string posVal;
+extern const std::string transInd;
+extern const std::string q;
+extern const std::string Validity;
+extern const std::string Source;
+extern const std::string DetailQuality;
+extern const std::string badReference;
+extern const std::string failure;
+extern const std::string inconsistent;
+extern const std::string inaccurate;
+extern const std::string oldData;
+extern const std::string oscillatory;
+extern const std::string outOfRange;
+extern const std::string overflow;
+extern const std::string operatorBlocked;
+extern const std::string test;
+extern const std::string t;
+extern const std::string SecondSinceEpoch;
+extern const std::string FractionOfSecond;
+extern const std::string TimeQuality;
+extern const std::string clockFailure;
+extern const std::string clockNotSynchronized;
+extern const std::string leapSecondKnown;
+extern const std::string timeAccuracy;
+
+/* IEC 104 data object */
+extern const std::string data_object;
+extern const std::string do_type;
+extern const std::string do_ca;
+extern const std::string do_ioa;
+extern const std::string do_cot;
+extern const std::string do_test;
+extern const std::string do_negative;
+extern const std::string do_value;
+extern const std::string do_comingfrom;
+extern const std::string do_quality_iv;
+extern const std::string do_quality_bl;
+extern const std::string do_quality_ov;
+extern const std::string do_quality_sb;
+extern const std::string do_quality_nt;
+extern const std::string do_ts;
+extern const std::string do_ts_iv;
+extern const std::string do_ts_su;
+extern const std::string do_ts_sub;
+
+/* IEC 104 command object */
+extern const std::string command_object;
+extern const std::string co_type;
+extern const std::string co_ca;
+extern const std::string co_ioa;
+extern const std::string co_cot;
+extern const std::string co_test;
+extern const std::string co_negative;
+extern const std::string co_se;
+extern const std::string co_value;
+extern const std::string co_comingfrom;
+extern const std::string co_ts;
+
+/* values */
+extern const std::string iec104;
+extern const std::string good;
+extern const std::string invalid;
+extern const std::string questionable;
+extern const std::string reserved;
+extern const std::string process;
+extern const std::string substituted;
+extern const std::string genuine;
+
+}
+
+#endif /* _IEC104_PIVOT_NAMES_H */
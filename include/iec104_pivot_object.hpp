@@ -14,6 +14,12 @@
 
 class IEC104PivotDataPoint;
 class Datapoint;
+class DatapointPool;
+
+namespace Iec104PivotUtility {
+    class ConversionClock;
+    enum class StepPositionFormat;
+}
 
 using namespace std;
 
@@ -29,18 +35,64 @@ class PivotObjectException : public std::exception //NOSONAR
     const std::string m_context;
 };
 
+/*
+ * Outcome of parsing an incoming pivot tree. An error only records its reason and the datapoint concerned:
+ * the message is built by toString() when the error is reported, so rejecting a tree builds no string.
+ */
+class PivotParseStatus
+{
+public:
+    typedef enum
+    {
+        OK,
+        NOT_PIVOT,          /* root not named PIVOT */
+        NOT_A_DICT,         /* root without children */
+        UNSUPPORTED_TYPE,   /* no logical node accepted for the object, datapoint is the root */
+        MISSING_CHILD,      /* mandatory element missing, name is the one of the element */
+        NOT_A_STRING,       /* value of another type, datapoint is the element */
+        NOT_AN_INT,
+        NOT_A_FLOAT,
+        CDC_MISSING,        /* logical node without children */
+        CDC_UNKNOWN,        /* no known CDC, datapoint is the logical node */
+        CDC_UNSUPPORTED,    /* CDC not accepted for the object */
+        INVALID_VALIDITY,   /* datapoint is the Validity element */
+        INVALID_SOURCE      /* datapoint is the Source element */
+    } Reason;
+
+    PivotParseStatus() {};
+    PivotParseStatus(Reason reason, Datapoint* dp, const char* name = nullptr):
+        m_reason(reason), m_dp(dp), m_name(name) {};
+
+    bool ok() const {return m_reason == OK;};
+    Reason getReason() const {return m_reason;};
+
+    /* The datapoint concerned must still be alive */
+    std::string toString() const;
+
+private:
+    Reason m_reason = OK;
+    Datapoint* m_dp = nullptr;
+    const char* m_name = nullptr;
+};
+
 class PivotTimestamp
 {
 public:
+    /* SecondSinceEpoch on 4 bytes followed by FractionOfSecond on 3 bytes, most significant byte first */
+    static constexpr size_t ENCODED_SIZE = 7;
+
+    PivotTimestamp() {};
+    /* throws PivotObjectException when the tree is malformed */
     PivotTimestamp(Datapoint* timestampData);
     PivotTimestamp(long ms);
-    ~PivotTimestamp();
 
-    void setTimeInMs(long ms);
+    PivotParseStatus parse(Datapoint* timestampData);
+
+    void setTimeInMs(long ms) {encodeTimeInMs(ms, m_valueArray);};
 
-    int SecondSinceEpoch();
-    int FractionOfSecond();
-    uint64_t getTimeInMs();
+    int SecondSinceEpoch() const {return (int32_t)decodeSecondSinceEpoch(m_valueArray);};
+    int FractionOfSecond() const {return (int)decodeFractionOfSecond(m_valueArray);};
+    uint64_t getTimeInMs() const {return decodeTimeInMs(m_valueArray);};
 
     bool ClockFailure() {return m_clockFailure;};
     bool LeapSecondKnown() {return m_leapSecondKnown;};
@@ -49,14 +101,54 @@ public:
 
     static uint64_t GetCurrentTimeInMs();
 
-private:
+    /**
+     * Encode a time in ms since epoch. The fraction of second is the number of 1/2^24 s, 1 ms being 16777.216.
+     * @param ms : Time in ms since epoch
+     * @param value : Encoded time, ENCODED_SIZE bytes
+     */
+    static void encodeTimeInMs(long ms, uint8_t* value) {
+        uint32_t secondSinceEpoch = (uint32_t)(ms / 1000LL);
+        uint32_t remainder = (uint32_t)(ms % 1000LL);
+        uint32_t fractionOfSecond = remainder * 16777 + ((remainder * 216) / 1000);
+
+        value[0] = (uint8_t)(secondSinceEpoch >> 24);
+        value[1] = (uint8_t)(secondSinceEpoch >> 16);
+        value[2] = (uint8_t)(secondSinceEpoch >> 8);
+        value[3] = (uint8_t)secondSinceEpoch;
+        value[4] = (uint8_t)(fractionOfSecond >> 16);
+        value[5] = (uint8_t)(fractionOfSecond >> 8);
+        value[6] = (uint8_t)fractionOfSecond;
+    }
+
+    /**
+     * Decode a time encoded by encodeTimeInMs, the fraction of second is truncated to the ms
+     * @param value : Encoded time, ENCODED_SIZE bytes
+     * @return Time in ms since epoch
+     */
+    static uint64_t decodeTimeInMs(const uint8_t* value) {
+        return (uint64_t)decodeSecondSinceEpoch(value) * 1000 + decodeFractionOfSecond(value) / 16777;
+    }
+
+    static uint32_t decodeSecondSinceEpoch(const uint8_t* value) {
+        return ((uint32_t)value[0] << 24) | ((uint32_t)value[1] << 16) | ((uint32_t)value[2] << 8) | value[3];
+    }
+
+    static uint32_t decodeFractionOfSecond(const uint8_t* value) {
+        return ((uint32_t)value[4] << 16) | ((uint32_t)value[5] << 8) | value[6];
+    }
+
+    /**
+     * Encode or decode a batch of times in a single pass
+     * @param values : count * ENCODED_SIZE bytes, the encoded times one after the other
+     */
+    static void encodeTimesInMs(const long* ms, uint8_t* values, size_t count);
+    static void decodeTimesInMs(const uint8_t* values, uint64_t* ms, size_t count);
 
-    void handleTimeQuality(Datapoint* timeQuality);
+private:
 
-    uint8_t* m_valueArray = nullptr;
+    PivotParseStatus handleTimeQuality(Datapoint* timeQuality);
 
-    int m_secondSinceEpoch = 0;
-    int m_fractionOfSecond = 0;
+    uint8_t m_valueArray[ENCODED_SIZE] = {0, 0, 0, 0, 0, 0, 0};
 
     int m_timeAccuracy = 0;
     bool m_clockFailure = false;
@@ -100,19 +192,72 @@ public:
 
     Datapoint* toDatapoint() {return m_dp;};
 
+    /**
+     * Build the static part of the pivot objects produced for an exchange definition: PIVOT, logical node,
+     * ComingFrom, CDC and Identifier elements. Conversions clone it and only add the variable elements.
+     * @param exchangeConfig : Exchange definition
+     * @return Pivot skeleton owned by the caller, nullptr if the ASDU type of the definition is not supported
+     */
+    static Datapoint* createPivotTemplate(IEC104PivotDataPoint* exchangeConfig);
+
     std::string& getIdentifier() {return m_identifier;};
     std::string& getComingFrom() {return m_comingFrom;};
     int getCause() {return m_cause;};
     bool isConfirmation() {return m_confirmation;};
     bool Test() {return m_test;};
 
+    /* number of tree shapes with a cached parse plan, for the calling thread */
+    static size_t getShapePlanCount();
+
 protected:
 
-    Datapoint* getCdc(Datapoint* dp);
+    /*
+     * Elements read from an incoming PIVOT tree, each one is searched in the children of the element it is
+     * listed under (LN in the root, CDC in LN)
+     */
+    enum Element
+    {
+        LN,
+        IDENTIFIER,
+        COMING_FROM,
+        CAUSE,
+        CAUSE_ST_VAL,
+        CONFIRMATION,
+        CONFIRMATION_ST_VAL,
+        TM_ORG,
+        TM_ORG_ST_VAL,
+        TM_VALIDITY,
+        TM_VALIDITY_ST_VAL,
+        SELECT,
+        SELECT_ST_VAL,
+        CDC,
+        Q,
+        T,
+        ST_VAL,
+        CTL_VAL,
+        MAG,
+        VAL_WTR,
+        ELEMENT_COUNT
+    };
+
+    /**
+     * Locate the elements of an incoming tree and set m_ln, m_pivotClass and m_pivotCdc. The child indexes found
+     * for a tree are cached per shape (names of the nodes down to the children of the CDC), trees of a known
+     * shape are resolved by direct index without comparing names.
+     * @param pivotData : PIVOT root
+     * @param operation : True to only accept a GTIC logical node
+     * @param elements : Found elements, nullptr for missing ones
+     */
+    void findElements(Datapoint* pivotData, bool operation, Datapoint* (&elements)[ELEMENT_COUNT]);
+
+    PivotParseStatus getCdc(Datapoint* dp, Datapoint*& cdc);
+    void initFromTemplate(IEC104PivotDataPoint* exchangeConfig, const char* pivotLN, const char* valueType);
 
     Datapoint* m_dp = nullptr;
     Datapoint* m_ln = nullptr;
     Datapoint* m_cdc = nullptr;
+    /* when set, output elements are built from recycled nodes */
+    DatapointPool* m_pool = nullptr;
     PivotClass m_pivotClass;
     PivotCdc m_pivotCdc;
 
@@ -122,7 +267,9 @@ protected:
     bool m_confirmation = false;
     bool m_test = false;
 
-    PivotTimestamp* m_timestamp = nullptr;
+    /* only meaningful when m_hasTimestamp is set */
+    PivotTimestamp m_timestamp;
+    bool m_hasTimestamp = false;
 
     bool hasIntVal = true;
     long intVal = 0;
@@ -148,9 +295,13 @@ public:
         SUBSTITUTED
     } Source;
 
-    PivotDataObject(Datapoint* pivotData);
+    /* throws PivotObjectException when the tree is malformed */
+    PivotDataObject(Datapoint* pivotData, DatapointPool* pool = nullptr);
+    /* empty object, to be read from a tree by parse() */
+    explicit PivotDataObject(DatapointPool* pool) {m_pool = pool;};
     PivotDataObject(const string& pivotLN, const string& valueType);
-    ~PivotDataObject();
+    /* Pivot object with Identifier, cloned from the pivot template of the exchange definition when there is one */
+    PivotDataObject(IEC104PivotDataPoint* exchangeConfig, const char* pivotLN, const char* valueType, DatapointPool* pool = nullptr);
 
     void setStVal(bool value);
     void setStValStr(const std::string& value);
@@ -164,7 +315,24 @@ public:
     void addTmOrg(bool substituted);
     void addTmValidity(bool invalid);
 
-    Datapoint* toIec104DataObject(IEC104PivotDataPoint* exchangeConfig);
+    /**
+     * Read an incoming pivot tree, which stays owned by the caller
+     * @param pivotData : PIVOT root
+     * @return Status, the object must not be used when it is not ok
+     */
+    PivotParseStatus parse(Datapoint* pivotData);
+
+    /* step positions (M_ST) are written as "[position,transient]" by the first version */
+    Datapoint* toIec104DataObject(IEC104PivotDataPoint* exchangeConfig, const Iec104PivotUtility::ConversionClock& clock);
+    Datapoint* toIec104DataObject(IEC104PivotDataPoint* exchangeConfig, const Iec104PivotUtility::ConversionClock& clock,
+                                  Iec104PivotUtility::StepPositionFormat stepPositionFormat);
+
+    /**
+     * Build the static part of the IEC 104 data objects produced for an exchange definition (do_type, do_ca, do_ioa)
+     * @param exchangeConfig : Exchange definition
+     * @return data_object skeleton owned by the caller
+     */
+    static Datapoint* createIec104DataObjectTemplate(IEC104PivotDataPoint* exchangeConfig);
 
     Validity getValidity() {return m_validity;};
     Source getSource() {return m_source;};
@@ -185,8 +353,8 @@ public:
 
 private:
 
-    void handleDetailQuality(Datapoint* detailQuality);
-    void handleQuality(Datapoint* q);
+    PivotParseStatus handleDetailQuality(Datapoint* detailQuality);
+    PivotParseStatus handleQuality(Datapoint* q);
 
     Validity m_validity = Validity::GOOD;
     bool m_badReference = false;
@@ -209,15 +377,33 @@ class PivotOperationObject : public PivotObject
 {
 public:
 
-    PivotOperationObject(Datapoint* pivotData);
+    /* throws PivotObjectException when the tree is malformed */
+    PivotOperationObject(Datapoint* pivotData, DatapointPool* pool = nullptr);
+    /* empty object, to be read from a tree by parse() */
+    explicit PivotOperationObject(DatapointPool* pool) {m_pool = pool;};
     PivotOperationObject(const string& pivotLN, const string& valueType);
-    ~PivotOperationObject();
+    /* Pivot object with Identifier, cloned from the pivot template of the exchange definition when there is one */
+    PivotOperationObject(IEC104PivotDataPoint* exchangeConfig, const char* pivotLN, const char* valueType, DatapointPool* pool = nullptr);
 
     void setSelect(int select);
     void addTimestamp(long ts);
 
+    /**
+     * Read an incoming pivot tree, which stays owned by the caller
+     * @param pivotData : PIVOT root
+     * @return Status, the object must not be used when it is not ok
+     */
+    PivotParseStatus parse(Datapoint* pivotData);
+
     std::vector<Datapoint*> toIec104OperationObject(IEC104PivotDataPoint* exchangeConfig);
 
+    /**
+     * Build the static part of the IEC 104 command objects produced for an exchange definition (co_type, co_ca, co_ioa)
+     * @param exchangeConfig : Exchange definition
+     * @return Dictionary holding the static co_* elements, owned by the caller
+     */
+    static Datapoint* createIec104OperationObjectTemplate(IEC104PivotDataPoint* exchangeConfig);
+
     int getSelect() {return m_select;}
 
 private:
@@ -0,0 +1,111 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter report by exception.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_REPORT_H
+#define _IEC104_PIVOT_REPORT_H
+
+#include <cstdint>
+#include <string>
+
+namespace Iec104PivotUtility {
+
+/*
+ * Content of a monitoring object as compared by report by exception, and last one sent for an exchange definition
+ */
+struct ReportState
+{
+    enum Flag : uint16_t {
+        HAS_VALUE = 1u << 0,
+        QUALITY_IV = 1u << 1,
+        QUALITY_BL = 1u << 2,
+        QUALITY_OV = 1u << 3,
+        QUALITY_SB = 1u << 4,
+        QUALITY_NT = 1u << 5,
+        TEST = 1u << 6,
+        NEGATIVE = 1u << 7,
+        /* only compared with the timestamp */
+        TS = 1u << 8,
+        TS_IV = 1u << 9,
+        TS_SU = 1u << 10,
+        TS_SUB = 1u << 11
+    };
+
+    static constexpr uint16_t TIMESTAMP_FLAGS = TS | TS_IV | TS_SU | TS_SUB;
+
+    /* integer value, bits of a float value or hash of any other value */
+    uint64_t value = 0;
+    int64_t timestamp = 0;
+    /* time the state was last sent, in ms since epoch */
+    uint64_t sentMs = 0;
+    /* ReportByException generation the state was recorded in, 0 when nothing was sent yet */
+    uint32_t generation = 0;
+    uint16_t flags = 0;
+};
+
+/**
+ * Parse a list of causes of transmission such as "3,20-41"
+ * @param value : Comma separated causes and ranges of causes (0 to 63), blanks are ignored
+ * @param causes : One bit per cause, unchanged when the value is not valid
+ * @return True if the value is valid, an empty list is valid
+ */
+bool parseCauseList(const std::string& value, uint64_t& causes);
+
+/**
+ * Report by exception: monitoring objects whose value and quality did not change since the last one sent for
+ * their exchange definition are not sent again. Objects with a cause of transmission of the list (interrogation
+ * responses by default) are always sent, and an unchanged state is sent again once the refresh interval elapsed.
+ * States are kept by the exchange definitions, which are only used by the ingest thread.
+ */
+class ReportByException
+{
+public:
+    /* station (20) to group (36) interrogation and counter interrogation (37 to 41) */
+    static constexpr uint64_t DEFAULT_ALWAYS_SENT_CAUSES = ((1ULL << 42) - 1) & ~((1ULL << 20) - 1);
+
+    bool isEnabled() const {return m_enabled;};
+
+    /* the states recorded before the filter was disabled are forgotten when it is enabled again */
+    void setEnabled(bool enabled);
+
+    /* 0 to never send an unchanged state again */
+    void setRefreshIntervalMs(uint64_t intervalMs) {m_refreshIntervalMs = intervalMs;};
+    void setCompareTimestamp(bool compareTimestamp) {m_compareTimestamp = compareTimestamp;};
+    void setAlwaysSentCauses(uint64_t causes) {m_alwaysSentCauses = causes;};
+
+    /**
+     * Decide whether an object must be sent, nothing is recorded
+     * @param last : Last state sent for the exchange definition of the object
+     * @param current : State of the object
+     * @param cot : Cause of transmission of the object
+     * @param nowMs : Current time in ms since epoch
+     * @return True if the object must be sent, always true when the filter is disabled
+     */
+    bool mustSend(const ReportState& last, const ReportState& current, int cot, uint64_t nowMs) const;
+
+    /**
+     * Record the state of an object actually sent as the last one sent for its exchange definition
+     * @param last : Last state sent for the exchange definition of the object, replaced by current
+     * @param current : State of the object
+     * @param nowMs : Time the object was sent in ms since epoch
+     */
+    void recordSent(ReportState& last, const ReportState& current, uint64_t nowMs) const;
+
+private:
+    bool m_enabled = false;
+    uint32_t m_generation = 0;
+    uint64_t m_refreshIntervalMs = 0;
+    bool m_compareTimestamp = false;
+    uint64_t m_alwaysSentCauses = DEFAULT_ALWAYS_SENT_CAUSES;
+};
+
+}
+
+#endif /* _IEC104_PIVOT_REPORT_H */
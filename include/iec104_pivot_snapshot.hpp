@@ -0,0 +1,199 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter immutable snapshot publication.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_SNAPSHOT_H
+#define _IEC104_PIVOT_SNAPSHOT_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Iec104PivotUtility {
+
+/**
+ * Pointer to the current version of an object that is never modified once published. Readers get the
+ * current version without any lock: they announce the version they use in a reader slot (hazard pointer).
+ * A version replaced by publish() is retired, and deleted by a later publish() or acquire() once no slot
+ * refers to it anymore, so that neither the publisher nor the readers ever wait for each other.
+ */
+template <class T>
+class SnapshotPointer
+{
+public:
+    /* maximum number of concurrent readers, more readers wait for a free slot */
+    static constexpr size_t MAX_READERS = 32;
+
+    /**
+     * Hold on a version of the object, which stays valid until the reader is destroyed
+     */
+    class Reader
+    {
+    public:
+        Reader(Reader&& other): m_owner(other.m_owner), m_slot(other.m_slot), m_snapshot(other.m_snapshot) {
+            other.m_owner = nullptr;
+        }
+
+        ~Reader() {
+            if (m_owner) m_owner->release(m_slot);
+        }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        const T* get() const {return m_snapshot;};
+        const T& operator*() const {return *m_snapshot;};
+        const T* operator->() const {return m_snapshot;};
+
+    private:
+        friend class SnapshotPointer;
+
+        Reader(const SnapshotPointer* owner, size_t slot, const T* snapshot): m_owner(owner), m_slot(slot), m_snapshot(snapshot) {};
+
+        const SnapshotPointer* m_owner;
+        size_t m_slot;
+        const T* m_snapshot;
+    };
+
+    explicit SnapshotPointer(std::unique_ptr<T> initial): m_current(initial.release()) {
+        for (Slot& slot : m_slots) {
+            slot.claimed.store(false);
+            slot.snapshot.store(nullptr);
+        }
+    }
+
+    ~SnapshotPointer() {
+        for (T* retired : m_retired) {
+            delete retired;
+        }
+
+        delete m_current.load();
+    }
+
+    SnapshotPointer(const SnapshotPointer&) = delete;
+    SnapshotPointer& operator=(const SnapshotPointer&) = delete;
+
+    /**
+     * Get the current version, lock free as long as less than MAX_READERS readers are alive
+     */
+    Reader acquire() const {
+        size_t index = claimSlot();
+        const Slot& slot = m_slots[index];
+        const T* snapshot = m_current.load();
+
+        /* the version is announced before checking that it is still the current one: a version replaced
+           after the check is protected by the announcement, so it is not deleted while the reader uses it */
+        for (;;) {
+            slot.snapshot.store(snapshot);
+
+            const T* current = m_current.load();
+            if (current == snapshot) break;
+
+            snapshot = current;
+        }
+
+        /* skipped when another thread is deleting the retired versions, the next call deletes them */
+        if (m_retiredCount.load(std::memory_order_relaxed) != 0) {
+            std::unique_lock<std::mutex> lock(m_retiredMutex, std::try_to_lock);
+            if (lock.owns_lock()) reclaim();
+        }
+
+        return Reader(this, index, snapshot);
+    }
+
+    /**
+     * Replace the current version without waiting for its readers. New readers get the new version at once,
+     * the previous one is deleted by this call or a later one once its readers are gone.
+     * @param snapshot : New version, fully built
+     */
+    void publish(std::unique_ptr<T> snapshot) {
+        std::lock_guard<std::mutex> guard(m_retiredMutex);
+
+        /* reserved first, the previous version is never lost */
+        m_retired.reserve(m_retired.size() + 1);
+        m_retired.push_back(m_current.exchange(snapshot.release()));
+
+        reclaim();
+    }
+
+    /**
+     * Number of replaced versions not deleted yet
+     */
+    size_t getRetiredCount() const {return m_retiredCount.load();};
+
+private:
+    /* one cache line per slot so that readers of different threads do not share a line */
+    struct Slot {
+        mutable std::atomic<bool> claimed;
+        mutable std::atomic<const T*> snapshot;
+        char padding[64 - sizeof(std::atomic<bool>) - sizeof(std::atomic<const T*>)];
+    };
+
+    size_t claimSlot() const {
+        for (;;) {
+            for (size_t i = 0; i < MAX_READERS; i++) {
+                if (!m_slots[i].claimed.load(std::memory_order_relaxed) &&
+                    !m_slots[i].claimed.exchange(true, std::memory_order_acquire)) {
+                    return i;
+                }
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    void release(size_t index) const {
+        m_slots[index].snapshot.store(nullptr, std::memory_order_release);
+        m_slots[index].claimed.store(false, std::memory_order_release);
+    }
+
+    bool hasReader(const T* snapshot) const {
+        for (const Slot& slot : m_slots) {
+            if (slot.snapshot.load() == snapshot) return true;
+        }
+
+        return false;
+    }
+
+    /* delete the retired versions without reader, called with m_retiredMutex held */
+    void reclaim() const {
+        size_t kept = 0;
+
+        for (T* retired : m_retired) {
+            if (hasReader(retired)) {
+                m_retired[kept++] = retired;
+            }
+            else {
+                delete retired;
+            }
+        }
+
+        m_retired.resize(kept);
+        m_retiredCount.store(kept, std::memory_order_relaxed);
+    }
+
+    std::atomic<T*> m_current;
+    Slot m_slots[MAX_READERS];
+
+    /* versions replaced by publish() that may still have readers */
+    mutable std::mutex m_retiredMutex;
+    mutable std::vector<T*> m_retired;
+    mutable std::atomic<size_t> m_retiredCount{0};
+};
+
+template <class T>
+constexpr size_t SnapshotPointer<T>::MAX_READERS;
+
+}
+
+#endif /* _IEC104_PIVOT_SNAPSHOT_H */
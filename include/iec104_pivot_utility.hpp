@@ -12,12 +12,43 @@
 #ifndef _IEC104_PIVOT_UTILITY_H
 #define _IEC104_PIVOT_UTILITY_H
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <logger.h>
 
 #define PLUGIN_NAME "iec104_pivot_filter"
 
+/*
+ * Lazy variants of the log helpers: the level is checked before the arguments are evaluated,
+ * so expensive arguments such as Reading::toJSON() are only computed when the message is logged
+ */
+#define IEC104_PIVOT_LOG_DEBUG(...) \
+    do { if (Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::DEBUG)) Iec104PivotUtility::log_debug(__VA_ARGS__); } while (0)
+#define IEC104_PIVOT_LOG_INFO(...) \
+    do { if (Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::INFO)) Iec104PivotUtility::log_info(__VA_ARGS__); } while (0)
+
+/*
+ * Rate-limited variants of the log helpers for messages that can repeat for every reading (fault storms):
+ * each call site logs the first occurrences per key (label, address, pivot ID...) then a periodic summary
+ * of the suppressed occurrences, see LogThrottle
+ */
+#define IEC104_PIVOT_LOG_WARN_THROTTLED(key, format, ...) \
+    do { \
+        static Iec104PivotUtility::LogThrottle iec104PivotLogThrottle(format); \
+        if (Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::WARNING) && iec104PivotLogThrottle.allow(key)) \
+            Iec104PivotUtility::log_warn(format, __VA_ARGS__); \
+    } while (0)
+#define IEC104_PIVOT_LOG_ERROR_THROTTLED(key, format, ...) \
+    do { \
+        static Iec104PivotUtility::LogThrottle iec104PivotLogThrottle(format); \
+        if (Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::ERROR) && iec104PivotLogThrottle.allow(key)) \
+            Iec104PivotUtility::log_error(format, __VA_ARGS__); \
+    } while (0)
+
 namespace Iec104PivotUtility {
 
     static const std::string PluginName = PLUGIN_NAME;
@@ -30,52 +61,210 @@ namespace Iec104PivotUtility {
     */
     std::string join(const std::vector<std::string> &list, const std::string &sep = ", ");
 
+    /**
+     * Log levels in increasing order of severity, named after the Fledge logger levels
+     */
+    enum class LogLevel {
+        DEBUG = 0,
+        INFO,
+        WARNING,
+        ERROR,
+        FATAL
+    };
+
+    /*
+     * Minimum level currently enabled in the Fledge logger, cached so that a disabled level costs a single branch
+     */
+    extern std::atomic<int> minLogLevel;
+
+    /**
+     * Read the minimum log level from the Fledge logger and cache it. Called when the plugin is (re)configured.
+     */
+    void refreshLogLevel();
+
+    /**
+     * Check if messages at the given level would be logged
+     * @param level : Level to check
+     * @return True if the level is enabled, else false
+    */
+    inline bool isLogLevelEnabled(LogLevel level) {
+        return static_cast<int>(level) >= minLogLevel.load(std::memory_order_relaxed);
+    }
+
+    /*
+     * Set while the asynchronous log sink is running: warnings and errors are then queued for a background writer
+     */
+    extern std::atomic<bool> asyncLogEnabled;
+
+    /**
+     * Format a record into the asynchronous log sink (see iec104_pivot_log_sink.hpp), never blocks
+     * @param level : Level of the record
+     * @param format : printf style format
+     * @return False if the sink is stopped and the record must be logged synchronously
+    */
+    bool enqueueAsyncLog(LogLevel level, const char* format, ...);
+
     /*
      * Log helper function that will log both in the Fledge syslog file and in stdout for unit tests
      */
     template<class... Args>
-    void log_debug(const std::string& format, Args&&... args) {  
+    void log_debug(const char* format, Args&&... args) {
+        if (!isLogLevelEnabled(LogLevel::DEBUG)) return;
         #ifdef UNIT_TEST
         printf(std::string(format).append("\n").c_str(), std::forward<Args>(args)...);
         fflush(stdout);
         #endif
-        Logger::getLogger()->debug(format.c_str(), std::forward<Args>(args)...);
+        Logger::getLogger()->debug(format, std::forward<Args>(args)...);
     }
 
     template<class... Args>
-    void log_info(const std::string& format, Args&&... args) {    
+    void log_info(const char* format, Args&&... args) {
+        if (!isLogLevelEnabled(LogLevel::INFO)) return;
         #ifdef UNIT_TEST
         printf(std::string(format).append("\n").c_str(), std::forward<Args>(args)...);
         fflush(stdout);
         #endif
-        Logger::getLogger()->info(format.c_str(), std::forward<Args>(args)...);
+        Logger::getLogger()->info(format, std::forward<Args>(args)...);
     }
 
     template<class... Args>
-    void log_warn(const std::string& format, Args&&... args) { 
-        #ifdef UNIT_TEST  
+    void log_warn(const char* format, Args&&... args) {
+        if (!isLogLevelEnabled(LogLevel::WARNING)) return;
+        #ifdef UNIT_TEST
         printf(std::string(format).append("\n").c_str(), std::forward<Args>(args)...);
         fflush(stdout);
         #endif
-        Logger::getLogger()->warn(format.c_str(), std::forward<Args>(args)...);
+        /* the sink may have been stopped since the flag was read, the record is then logged here */
+        if (asyncLogEnabled.load(std::memory_order_relaxed) && enqueueAsyncLog(LogLevel::WARNING, format, args...)) {
+            return;
+        }
+        Logger::getLogger()->warn(format, std::forward<Args>(args)...);
     }
 
     template<class... Args>
-    void log_error(const std::string& format, Args&&... args) {   
+    void log_error(const char* format, Args&&... args) {
+        if (!isLogLevelEnabled(LogLevel::ERROR)) return;
         #ifdef UNIT_TEST
         printf(std::string(format).append("\n").c_str(), std::forward<Args>(args)...);
         fflush(stdout);
         #endif
-        Logger::getLogger()->error(format.c_str(), std::forward<Args>(args)...);
+        /* the sink may have been stopped since the flag was read, the record is then logged here */
+        if (asyncLogEnabled.load(std::memory_order_relaxed) && enqueueAsyncLog(LogLevel::ERROR, format, args...)) {
+            return;
+        }
+        Logger::getLogger()->error(format, std::forward<Args>(args)...);
     }
 
+    /**
+     * Suppression state of one log call site. For each key, the first BURST occurrences of a window are logged,
+     * the following ones are only counted and reported in a single summary line once the window is over: on the
+     * next occurrence for the key, or when the throttles are flushed, whichever comes first.
+     */
+    class LogThrottle
+    {
+    public:
+        static constexpr unsigned int BURST = 5;
+        static constexpr uint64_t WINDOW_MS = 10000;
+        /* beyond this number of distinct keys, all new keys share the same state to bound memory */
+        static constexpr size_t MAX_KEYS = 1024;
+        /* minimum time between two flushes by flushExpired */
+        static constexpr uint64_t FLUSH_INTERVAL_MS = 1000;
+
+        /**
+         * @param site : Message format of the call site, used to identify it in the summary
+         * @param burst : Number of occurrences logged per key and per window
+         * @param windowMs : Duration of a window in milliseconds
+         */
+        explicit LogThrottle(const char* site, unsigned int burst = BURST, uint64_t windowMs = WINDOW_MS);
+        ~LogThrottle();
+
+        LogThrottle(const LogThrottle&) = delete;
+        LogThrottle& operator=(const LogThrottle&) = delete;
+
+        /**
+         * Count an occurrence for the given key and tell if it should be logged.
+         * Logs the summary of the previous window for that key if occurrences were suppressed.
+         * @param key : Label (or address, pivot ID...) the message is about
+         * @return True if the occurrence should be logged, false if it is suppressed
+         */
+        bool allow(const std::string& key);
+        bool allow(const std::string& key, uint64_t nowMs);
+
+        /**
+         * Same with an integer key, such as an IEC 104 address packed by ExchangeAddressIndex::packAddress, so that
+         * call sites on allocation-free paths do not have to build a string. The summary shows the key as its upper
+         * and lower 32 bits separated by '-', CA-IOA for a packed address.
+         */
+        bool allow(uint64_t key);
+        bool allow(uint64_t key, uint64_t nowMs);
+
+        /**
+         * Number of occurrences suppressed so far in the current window for the given key
+         */
+        uint64_t getSuppressedCount(const std::string& key);
+        uint64_t getSuppressedCount(uint64_t key);
+
+        /**
+         * Log the summary of the keys whose window is over and forget them, so that the suppressed occurrences
+         * are reported even if the key does not occur again
+         * @return Number of summaries logged
+         */
+        size_t flush(uint64_t nowMs);
+
+        /**
+         * Flush all the throttles of the process
+         */
+        static void flushAll(uint64_t nowMs);
+
+        /**
+         * Flush all the throttles at most once per FLUSH_INTERVAL_MS, cheap enough to be called for each reading set
+         */
+        static void flushExpired();
+
+    private:
+        struct KeyState {
+            uint64_t windowStart = 0;
+            unsigned int logged = 0;
+            uint64_t suppressed = 0;
+        };
+
+        /* summary of a window, logged once the locks are released: the log helpers may block on syslog */
+        struct Summary {
+            const char* site;
+            std::string key;
+            uint64_t suppressed;
+            uint64_t elapsedMs;
+        };
+
+        /* called with m_mutex held, summaryKey is only set when suppressed is not 0 */
+        template <class Key>
+        bool allowKey(std::unordered_map<Key, KeyState>& states, const Key& key, const Key& overflowKey, uint64_t nowMs,
+                      Key& summaryKey, uint64_t& suppressed, uint64_t& elapsedMs);
+
+        /* called with m_mutex held */
+        template <class Key>
+        void collectExpired(std::unordered_map<Key, KeyState>& states, uint64_t nowMs, std::vector<Summary>& summaries);
+
+        /* summaries of the keys whose window is over, which are forgotten */
+        void collectExpired(uint64_t nowMs, std::vector<Summary>& summaries);
+
+        static void logSummary(const Summary& summary);
+
+        const char* m_site;
+        unsigned int m_burst;
+        uint64_t m_windowMs;
+        std::mutex m_mutex;
+        std::unordered_map<std::string, KeyState> m_states;
+        std::unordered_map<uint64_t, KeyState> m_integerStates;
+    };
+
     template<class... Args>
-    void log_fatal(const std::string& format, Args&&... args) {  
+    void log_fatal(const char* format, Args&&... args) {
         #ifdef UNIT_TEST
         printf(std::string(format).append("\n").c_str(), std::forward<Args>(args)...);
         fflush(stdout);
         #endif
-        Logger::getLogger()->fatal(format.c_str(), std::forward<Args>(args)...);
+        Logger::getLogger()->fatal(format, std::forward<Args>(args)...);
     }
 }
 
@@ -0,0 +1,78 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter conversion worker pool.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#ifndef _IEC104_PIVOT_WORKER_POOL_H
+#define _IEC104_PIVOT_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Iec104PivotUtility {
+
+/**
+ * Fixed set of threads processing the chunks of an index range. The thread calling run() takes part
+ * in the work as worker 0, the pool threads are the workers 1 to getThreadCount(), so that a task can
+ * keep per-worker state (such as a DatapointPool) without any locking.
+ */
+class WorkerPool
+{
+public:
+    /* task(begin, end, worker) processes the indexes [begin, end) */
+    typedef std::function<void(size_t, size_t, size_t)> Task;
+
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t getThreadCount() const {return m_threads.size();};
+
+    /**
+     * Process the indexes [0, count) in chunks spread over the calling thread and the pool threads,
+     * returns once all chunks are processed. An exception thrown by the task is rethrown here.
+     * @param count : Number of indexes to process
+     * @param chunkSize : Number of indexes given to a worker at a time
+     * @param task : Function called for each chunk
+     */
+    void run(size_t count, size_t chunkSize, const Task& task);
+
+private:
+    void work(size_t worker);
+    void processChunks(size_t worker);
+
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobCondition;
+    std::condition_variable m_doneCondition;
+    uint64_t m_generation = 0;
+    size_t m_busyThreads = 0;
+    bool m_stopRequested = false;
+
+    /* current job, only valid while run() is in progress */
+    const Task* m_task = nullptr;
+    size_t m_count = 0;
+    size_t m_chunkSize = 1;
+    std::atomic<size_t> m_nextIndex;
+    std::exception_ptr m_exception;
+};
+
+}
+
+#endif /* _IEC104_PIVOT_WORKER_POOL_H */
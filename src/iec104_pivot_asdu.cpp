@@ -0,0 +1,262 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter ASDU type identifiers.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include <cstring>
+
+#include "iec104_pivot_asdu.hpp"
+
+namespace {
+
+using Iec104PivotUtility::getAsduTraits;
+
+constexpr size_t ASDU_TYPE_COUNT = static_cast<size_t>(Iec104AsduType::COUNT);
+
+static_assert(sizeof(Iec104PivotUtility::AsduTraitsTable<>::entries) / sizeof(Iec104AsduTraits) == ASDU_TYPE_COUNT,
+              "AsduTraitsTable must have one entry per Iec104AsduType");
+
+constexpr bool sameString(const char* a, const char* b)
+{
+    return (a == nullptr || b == nullptr) ? a == b : (*a == *b && (*a == '\0' || sameString(a + 1, b + 1)));
+}
+
+/* types come by pairs, without then with timestamp, which only differ by the timestamp */
+constexpr bool samePairTraits(const Iec104AsduTraits& a, const Iec104AsduTraits& b)
+{
+    return a.family == b.family && a.isCommand == b.isCommand && sameString(a.pivotLN, b.pivotLN) &&
+           sameString(a.pivotCdc, b.pivotCdc) && sameString(a.familyName, b.familyName) && a.valueKind == b.valueKind && a.minValue == b.minValue && a.maxValue == b.maxValue && !a.hasTimestamp && b.hasTimestamp;
+}
+
+constexpr bool checkTraitPairs(size_t type)
+{
+    return type >= ASDU_TYPE_COUNT ||
+           (samePairTraits(getAsduTraits(static_cast<Iec104AsduType>(type)), getAsduTraits(static_cast<Iec104AsduType>(type + 1))) &&
+            checkTraitPairs(type + 2));
+}
+
+static_assert(checkTraitPairs(1), "ASDU types of a pair must have the same traits but the timestamp");
+
+/* built once, the encoders hand out references so that building a value does not copy the name */
+const std::string doublePointValues[] = {"intermediate-state", "off", "on", "bad-state"};
+const std::string stepCommandValues[] = {"stop", "lower", "higher", "reserved"};
+
+bool
+parseValueName(const std::string (&names)[4], const std::string& value, long& out)
+{
+    for (int i = 0; i < 4; i++) {
+        if (value == names[i]) {
+            out = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Pack the variable characters of a "X_YY_ZZ_1" name into a switch key */
+constexpr uint64_t asduKey(char x, char y1, char y2, char z1, char z2)
+{
+    return (static_cast<uint64_t>(static_cast<uint8_t>(x)) << 32) |
+           (static_cast<uint64_t>(static_cast<uint8_t>(y1)) << 24) |
+           (static_cast<uint64_t>(static_cast<uint8_t>(y2)) << 16) |
+           (static_cast<uint64_t>(static_cast<uint8_t>(z1)) << 8) |
+           static_cast<uint64_t>(static_cast<uint8_t>(z2));
+}
+
+}
+
+Iec104AsduType Iec104PivotUtility::parseAsduType(const char* name, size_t length)
+{
+    if (length != 9 || name[1] != '_' || name[4] != '_' || name[7] != '_' || name[8] != '1') {
+        return Iec104AsduType::UNKNOWN;
+    }
+
+    switch (asduKey(name[0], name[2], name[3], name[5], name[6])) {
+        case asduKey('M', 'S', 'P', 'N', 'A'): return Iec104AsduType::M_SP_NA_1;
+        case asduKey('M', 'S', 'P', 'T', 'B'): return Iec104AsduType::M_SP_TB_1;
+        case asduKey('M', 'D', 'P', 'N', 'A'): return Iec104AsduType::M_DP_NA_1;
+        case asduKey('M', 'D', 'P', 'T', 'B'): return Iec104AsduType::M_DP_TB_1;
+        case asduKey('M', 'M', 'E', 'N', 'A'): return Iec104AsduType::M_ME_NA_1;
+        case asduKey('M', 'M', 'E', 'T', 'D'): return Iec104AsduType::M_ME_TD_1;
+        case asduKey('M', 'M', 'E', 'N', 'B'): return Iec104AsduType::M_ME_NB_1;
+        case asduKey('M', 'M', 'E', 'T', 'E'): return Iec104AsduType::M_ME_TE_1;
+        case asduKey('M', 'M', 'E', 'N', 'C'): return Iec104AsduType::M_ME_NC_1;
+        case asduKey('M', 'M', 'E', 'T', 'F'): return Iec104AsduType::M_ME_TF_1;
+        case asduKey('M', 'S', 'T', 'N', 'A'): return Iec104AsduType::M_ST_NA_1;
+        case asduKey('M', 'S', 'T', 'T', 'B'): return Iec104AsduType::M_ST_TB_1;
+        case asduKey('C', 'S', 'C', 'N', 'A'): return Iec104AsduType::C_SC_NA_1;
+        case asduKey('C', 'S', 'C', 'T', 'A'): return Iec104AsduType::C_SC_TA_1;
+        case asduKey('C', 'D', 'C', 'N', 'A'): return Iec104AsduType::C_DC_NA_1;
+        case asduKey('C', 'D', 'C', 'T', 'A'): return Iec104AsduType::C_DC_TA_1;
+        case asduKey('C', 'S', 'E', 'N', 'A'): return Iec104AsduType::C_SE_NA_1;
+        case asduKey('C', 'S', 'E', 'T', 'A'): return Iec104AsduType::C_SE_TA_1;
+        case asduKey('C', 'S', 'E', 'N', 'B'): return Iec104AsduType::C_SE_NB_1;
+        case asduKey('C', 'S', 'E', 'T', 'B'): return Iec104AsduType::C_SE_TB_1;
+        case asduKey('C', 'S', 'E', 'N', 'C'): return Iec104AsduType::C_SE_NC_1;
+        case asduKey('C', 'S', 'E', 'T', 'C'): return Iec104AsduType::C_SE_TC_1;
+        case asduKey('C', 'R', 'C', 'N', 'A'): return Iec104AsduType::C_RC_NA_1;
+        case asduKey('C', 'R', 'C', 'T', 'A'): return Iec104AsduType::C_RC_TA_1;
+        default: return Iec104AsduType::UNKNOWN;
+    }
+}
+
+const char* Iec104PivotUtility::asduTypeToString(Iec104AsduType type)
+{
+    return getAsduTraits(type).name;
+}
+
+Iec104AsduFamily Iec104PivotUtility::getAsduFamily(Iec104AsduType type)
+{
+    return getAsduTraits(type).family;
+}
+
+bool Iec104PivotUtility::asduHasTimestamp(Iec104AsduType type)
+{
+    return getAsduTraits(type).hasTimestamp;
+}
+
+const std::string& Iec104PivotUtility::doublePointToString(int value)
+{
+    return (value >= 0 && value <= 2) ? doublePointValues[value] : doublePointValues[3];
+}
+
+const std::string* Iec104PivotUtility::stepCommandToString(int value)
+{
+    return (value >= 0 && value <= 3) ? &stepCommandValues[value] : nullptr;
+}
+
+bool Iec104PivotUtility::parseDoublePoint(const std::string& value, long& out)
+{
+    return parseValueName(doublePointValues, value, out);
+}
+
+bool Iec104PivotUtility::parseStepCommand(const std::string& value, long& out)
+{
+    return parseValueName(stepCommandValues, value, out);
+}
+
+bool Iec104PivotUtility::parseStepPosition(const char* value, size_t length, long& position, bool& transient)
+{
+    /* more digits cannot be a position of the -64 to 63 range, and would overflow */
+    constexpr size_t MAX_DIGITS = 18;
+
+    const char* current = value;
+    const char* end = value + length;
+
+    auto skipBlanks = [&current, end]() {
+        while (current < end && (*current == ' ' || *current == '\t')) current++;
+    };
+
+    auto expect = [&current, end](const char* token, size_t tokenLength) {
+        if ((size_t)(end - current) < tokenLength || memcmp(current, token, tokenLength) != 0) return false;
+        current += tokenLength;
+        return true;
+    };
+
+    skipBlanks();
+    if (!expect("[", 1)) return false;
+    skipBlanks();
+
+    bool negative = false;
+
+    if (current < end && (*current == '-' || *current == '+')) {
+        negative = (*current == '-');
+        current++;
+    }
+
+    const char* digits = current;
+    long parsedPosition = 0;
+
+    while (current < end && *current >= '0' && *current <= '9') {
+        if ((size_t)(current - digits) == MAX_DIGITS) return false;
+        parsedPosition = parsedPosition * 10 + (*current - '0');
+        current++;
+    }
+
+    if (current == digits) return false;
+
+    skipBlanks();
+    if (!expect(",", 1)) return false;
+    skipBlanks();
+
+    bool parsedTransient;
+
+    if (expect("true", 4)) {
+        parsedTransient = true;
+    }
+    else if (expect("false", 5)) {
+        parsedTransient = false;
+    }
+    else {
+        return false;
+    }
+
+    skipBlanks();
+    if (!expect("]", 1)) return false;
+    skipBlanks();
+
+    if (current != end) return false;
+
+    position = negative ? -parsedPosition : parsedPosition;
+    transient = parsedTransient;
+
+    return true;
+}
+
+size_t Iec104PivotUtility::formatStepPosition(long position, bool transient, char* buffer)
+{
+    char digits[24];
+    size_t digitCount = 0;
+    /* unsigned so that the most negative value can be negated */
+    unsigned long magnitude = (position < 0) ? 0UL - (unsigned long)position : (unsigned long)position;
+
+    do {
+        digits[digitCount++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    size_t length = 0;
+
+    buffer[length++] = '[';
+
+    if (position < 0) buffer[length++] = '-';
+
+    while (digitCount > 0) {
+        buffer[length++] = digits[--digitCount];
+    }
+
+    buffer[length++] = ',';
+
+    const char* transientStr = transient ? "true" : "false";
+    size_t transientLength = transient ? 4 : 5;
+
+    memcpy(buffer + length, transientStr, transientLength);
+    length += transientLength;
+
+    buffer[length++] = ']';
+    buffer[length] = '\0';
+
+    return length;
+}
+
+bool Iec104PivotUtility::parseStepPositionFormat(const std::string& value, StepPositionFormat& format)
+{
+    if (value == "string") {
+        format = StepPositionFormat::STRING;
+    }
+    else if (value == "structured") {
+        format = StepPositionFormat::STRUCTURED;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter clock used to timestamp objects received without a time.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include <time.h>
+
+#include "iec104_pivot_clock.hpp"
+
+using namespace Iec104PivotUtility;
+
+static uint64_t
+readClockMs(clockid_t clock)
+{
+    struct timespec now;
+
+    clock_gettime(clock, &now);
+
+    return ((uint64_t) now.tv_sec * 1000LL) + (now.tv_nsec / 1000000);
+}
+
+uint64_t
+Iec104PivotUtility::realtimeClockMs()
+{
+    return readClockMs(CLOCK_REALTIME);
+}
+
+uint64_t
+Iec104PivotUtility::coarseRealtimeClockMs()
+{
+#ifdef CLOCK_REALTIME_COARSE
+    return readClockMs(CLOCK_REALTIME_COARSE);
+#else
+    return readClockMs(CLOCK_REALTIME);
+#endif
+}
+
+bool
+Iec104PivotUtility::parseClockMode(const std::string& value, ClockMode& mode)
+{
+    if (value == "batch") {
+        mode = ClockMode::BATCH;
+    }
+    else if (value == "object") {
+        mode = ClockMode::OBJECT;
+    }
+    else if (value == "coarse") {
+        mode = ClockMode::COARSE;
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
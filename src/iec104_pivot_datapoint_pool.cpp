@@ -0,0 +1,195 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter datapoint node pool.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include <datapoint.h>
+
+#include "iec104_pivot_datapoint_pool.hpp"
+
+constexpr size_t DatapointPool::MAX_FREE_NODES;
+
+DatapointPool::~DatapointPool()
+{
+    for (Datapoint* dp : m_freeDicts) {
+        delete dp;
+    }
+
+    for (Datapoint* dp : m_freeLeaves) {
+        delete dp;
+    }
+}
+
+void
+DatapointPool::release(Datapoint* dp)
+{
+    if (dp == nullptr) return;
+
+    DatapointValue& value = dp->getData();
+
+    switch (value.getType()) {
+        case DatapointValue::T_DP_DICT:
+        {
+            std::vector<Datapoint*>* children = value.getDpVec();
+
+            for (Datapoint* child : *children) {
+                release(child);
+            }
+
+            /* the emptied vector keeps its capacity for the next dictionary built from this node */
+            children->clear();
+
+            if (m_freeDicts.size() < MAX_FREE_NODES) {
+                m_freeDicts.push_back(dp);
+                return;
+            }
+            break;
+        }
+
+        case DatapointValue::T_STRING:
+            if (m_freeLeaves.size() < MAX_FREE_NODES) {
+                /* free leaves only hold numeric values so that setValue() can be used on them */
+                value = DatapointValue((long)0);
+                m_freeLeaves.push_back(dp);
+                return;
+            }
+            break;
+
+        case DatapointValue::T_INTEGER:
+        case DatapointValue::T_FLOAT:
+            if (m_freeLeaves.size() < MAX_FREE_NODES) {
+                m_freeLeaves.push_back(dp);
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    delete dp;
+}
+
+Datapoint*
+DatapointPool::createDict(const std::string& name)
+{
+    if (m_freeDicts.empty() == false) {
+        Datapoint* dp = m_freeDicts.back();
+        m_freeDicts.pop_back();
+        dp->setName(name);
+        m_hits++;
+        return dp;
+    }
+
+    m_misses++;
+
+    std::vector<Datapoint*>* datapoints = new std::vector<Datapoint*>;
+    DatapointValue dpv(datapoints, true);
+
+    return new Datapoint(name, dpv);
+}
+
+Datapoint*
+DatapointPool::takeLeaf(const std::string& name)
+{
+    if (m_freeLeaves.empty()) {
+        m_misses++;
+        return nullptr;
+    }
+
+    Datapoint* dp = m_freeLeaves.back();
+    m_freeLeaves.pop_back();
+    dp->setName(name);
+    m_hits++;
+
+    return dp;
+}
+
+Datapoint*
+DatapointPool::createValue(const std::string& name, long value)
+{
+    Datapoint* dp = takeLeaf(name);
+
+    if (dp) {
+        dp->getData().setValue(value);
+        return dp;
+    }
+
+    DatapointValue dpv(value);
+
+    return new Datapoint(name, dpv);
+}
+
+Datapoint*
+DatapointPool::createValue(const std::string& name, double value)
+{
+    Datapoint* dp = takeLeaf(name);
+
+    if (dp) {
+        dp->getData().setValue(value);
+        return dp;
+    }
+
+    DatapointValue dpv(value);
+
+    return new Datapoint(name, dpv);
+}
+
+Datapoint*
+DatapointPool::createValue(const std::string& name, const std::string& value)
+{
+    Datapoint* dp = takeLeaf(name);
+
+    if (dp) {
+        dp->getData() = DatapointValue(value);
+        return dp;
+    }
+
+    DatapointValue dpv(value);
+
+    return new Datapoint(name, dpv);
+}
+
+Datapoint*
+DatapointPool::createValue(const std::string& name, const char* value)
+{
+    return createValue(name, std::string(value));
+}
+
+Datapoint*
+DatapointPool::clone(Datapoint* source)
+{
+    DatapointValue& value = source->getData();
+
+    switch (value.getType()) {
+        case DatapointValue::T_DP_DICT:
+        {
+            Datapoint* dp = createDict(source->getName());
+            std::vector<Datapoint*>* children = dp->getData().getDpVec();
+
+            for (Datapoint* child : *value.getDpVec()) {
+                children->push_back(clone(child));
+            }
+
+            return dp;
+        }
+
+        case DatapointValue::T_INTEGER:
+            return createValue(source->getName(), value.toInt());
+
+        case DatapointValue::T_FLOAT:
+            return createValue(source->getName(), value.toDouble());
+
+        case DatapointValue::T_STRING:
+            return createValue(source->getName(), value.toStringValue());
+
+        default:
+            return new Datapoint(source->getName(), value);
+    }
+}
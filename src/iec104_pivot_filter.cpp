@@ -9,12 +9,32 @@
  *
  */
 
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <config_category.h>
+#include <dirent.h>
+#include <unistd.h>
 
 #include "iec104_pivot_filter.hpp"
+#include "iec104_pivot_log_sink.hpp"
+#include "iec104_pivot_metrics.hpp"
+#include "iec104_pivot_names.hpp"
 #include "iec104_pivot_object.hpp"
 #include "iec104_pivot_utility.hpp"
 
+using Iec104PivotUtility::ClockMode;
+using Iec104PivotUtility::ConversionRecord;
+using Iec104PivotUtility::MetricsDirection;
+using Iec104PivotUtility::MetricsLatency;
+using Iec104PivotUtility::MetricsOutcome;
+using Iec104PivotUtility::MetricsShard;
+
+namespace Names = Iec104PivotNames;
+
 IEC104PivotFilter::IEC104PivotFilter(const std::string& filterName,
         ConfigCategory* filterConfig,
         OUTPUT_HANDLE *outHandle,
@@ -28,95 +48,118 @@ IEC104PivotFilter::IEC104PivotFilter(const std::string& filterName,
     reconfigure(filterConfig);
 }
 
+constexpr size_t IEC104PivotFilter::DEFAULT_PARALLEL_THRESHOLD;
+constexpr size_t IEC104PivotFilter::MIN_PARALLEL_CHUNK_SIZE;
+constexpr int IEC104PivotFilter::MAX_CONVERSION_THREADS;
+
 IEC104PivotFilter::~IEC104PivotFilter()
 {
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::~IEC104PivotFilter -"; //LCOV_EXCL_LINE
+    IEC104_PIVOT_LOG_DEBUG("%s Datapoint pool: %lu hits, %lu misses", beforeLog, //LCOV_EXCL_LINE
+                            (unsigned long)m_pool.getHitCount(), (unsigned long)m_pool.getMissCount()); //LCOV_EXCL_LINE
 
+    /* the records still queued are written if this filter was the last user of the sink */
+    if (m_asyncLogging) {
+        Iec104PivotUtility::AsyncLogSink::getInstance().stop();
+    }
 }
 
 static bool
-checkTypeMatch(std::string& incomingType, IEC104PivotDataPoint* exchangeConfig)
+parseConfigInteger(const std::string& value, long& out)
 {
-    if (incomingType == "M_SP_NA_1" || incomingType == "M_SP_TB_1") {
-        if (exchangeConfig->getTypeId() == "M_SP_NA_1" || exchangeConfig->getTypeId() == "M_SP_TB_1")
-            return true;
-    }
-    else if (incomingType == "M_DP_NA_1" || incomingType == "M_DP_TB_1") {
-        if (exchangeConfig->getTypeId() == "M_DP_NA_1" || exchangeConfig->getTypeId() == "M_DP_TB_1")
-            return true;
-    }
-    else if (incomingType == "M_ME_NA_1" || incomingType == "M_ME_TD_1") { /* normalized measured value */
-        if (exchangeConfig->getTypeId() == "M_ME_NA_1" || exchangeConfig->getTypeId() == "M_ME_TD_1")
-            return true;
-    }
-    else if (incomingType == "M_ME_NB_1" || incomingType == "M_ME_TE_1") { /* scaled measured value */
-        if (exchangeConfig->getTypeId() == "M_ME_NB_1" || exchangeConfig->getTypeId() == "M_ME_TE_1")
-            return true;
-    }
-    else if (incomingType == "M_ME_NC_1" || incomingType == "M_ME_TF_1") { /* short (float) measured value */
-        if (exchangeConfig->getTypeId() == "M_ME_NC_1" || exchangeConfig->getTypeId() == "M_ME_TF_1")
-            return true;
-    }
-    if (incomingType == "M_ST_NA_1" || incomingType == "M_ST_TB_1") {
-        if (exchangeConfig->getTypeId() == "M_ST_NA_1" || exchangeConfig->getTypeId() == "M_ST_TB_1")
-            return true;
-    }
-    else if (incomingType == "C_SC_NA_1" || incomingType == "C_SC_TA_1") {
-        if (exchangeConfig->getTypeId() == "C_SC_NA_1" || exchangeConfig->getTypeId() == "C_SC_TA_1")
-            return true;
-    }
-    else if (incomingType == "C_DC_NA_1" || incomingType == "C_DC_TA_1") {
-        if (exchangeConfig->getTypeId() == "C_DC_NA_1" || exchangeConfig->getTypeId() == "C_DC_TA_1")
-            return true;
-    }
-    else if (incomingType == "C_SE_NA_1" || incomingType == "C_SE_TA_1") {
-        if (exchangeConfig->getTypeId() == "C_SE_NA_1" || exchangeConfig->getTypeId() == "C_SE_TA_1")
-            return true;
-    }
-    else if (incomingType == "C_SE_NB_1" || incomingType == "C_SE_TB_1") {
-        if (exchangeConfig->getTypeId() == "C_SE_NB_1" || exchangeConfig->getTypeId() == "C_SE_TB_1")
-            return true;
-    }
-    else if (incomingType == "C_SE_NC_1" || incomingType == "C_SE_TC_1") {
-        if (exchangeConfig->getTypeId() == "C_SE_NC_1" || exchangeConfig->getTypeId() == "C_SE_TC_1")
-            return true;
+    if (value.empty()) return false;
+
+    char* end = nullptr;
+    errno = 0;
+    out = strtol(value.c_str(), &end, 10);
+
+    return errno == 0 && *end == '\0';
+}
+
+static bool
+checkTypeMatch(Iec104AsduType incomingType, IEC104PivotDataPoint* exchangeConfig)
+{
+    return Iec104PivotUtility::isAsduTypeCompatible(incomingType, exchangeConfig->getAsduType());
+}
+
+/* State of a monitoring data object compared by report by exception, read from its attributes before conversion */
+static void
+readReportState(const IEC104PivotFilter::Iec104DataObject& dataObject, Iec104PivotUtility::ReportState& state)
+{
+    typedef Iec104PivotUtility::ReportState ReportState;
+    uint16_t flags = 0;
+
+    if (dataObject.hasAttribute(IEC104PivotFilter::Iec104DataObject::VALUE) && dataObject.doValue) {
+        const DatapointValue& value = dataObject.doValue->getData();
+
+        flags |= ReportState::HAS_VALUE;
+
+        if (value.getType() == DatapointValue::T_INTEGER) {
+            state.value = (uint64_t)value.toInt();
+        }
+        else if (value.getType() == DatapointValue::T_FLOAT) {
+            double floatValue = value.toDouble();
+            memcpy(&state.value, &floatValue, sizeof(state.value));
+        }
+        else if (value.getType() == DatapointValue::T_STRING) {
+            const std::string stringValue = value.toStringValue();
+            state.value = ExchangeDefinitionIndex::hash(stringValue.data(), stringValue.size());
+        }
+        else {
+            const std::string stringValue = value.toString();
+            state.value = ExchangeDefinitionIndex::hash(stringValue.data(), stringValue.size());
+        }
     }
-    else if (incomingType == "C_RC_NA_1" || incomingType == "C_RC_TA_1") {
-        if (exchangeConfig->getTypeId() == "C_RC_NA_1" || exchangeConfig->getTypeId() == "C_RC_TA_1")
-            return true;
+
+    if (dataObject.doQualityIv) flags |= ReportState::QUALITY_IV;
+    if (dataObject.doQualityBl) flags |= ReportState::QUALITY_BL;
+    if (dataObject.doQualityOv) flags |= ReportState::QUALITY_OV;
+    if (dataObject.doQualitySb) flags |= ReportState::QUALITY_SB;
+    if (dataObject.doQualityNt) flags |= ReportState::QUALITY_NT;
+    if (dataObject.doTest) flags |= ReportState::TEST;
+    if (dataObject.doNegative) flags |= ReportState::NEGATIVE;
+
+    if (dataObject.hasAttribute(IEC104PivotFilter::Iec104DataObject::TS)) {
+        flags |= ReportState::TS;
+        if (dataObject.doTsIv) flags |= ReportState::TS_IV;
+        if (dataObject.doTsSu) flags |= ReportState::TS_SU;
+        if (dataObject.doTsSub) flags |= ReportState::TS_SUB;
+        state.timestamp = dataObject.doTs;
     }
 
-    return false;
+    state.flags = flags;
 }
 
-static bool checkValueRange(const std::string& beforeLog, int value, int min, int max, const std::string& type)
+static bool checkValueRange(const char* beforeLog, const std::string& label, int value, int min, int max, const char* type)
 {
     if (value < min || value > max) {
-        Iec104PivotUtility::log_warn("%s do_value out of range [%d..%d] for %s: %d", beforeLog.c_str(), min, max, type.c_str(), value); //LCOV_EXCL_LINE
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s do_value out of range [%d..%d] for %s: %d", beforeLog, min, max, type, value); //LCOV_EXCL_LINE
         return false;
     }
     return true;
 }
 
-static bool checkValueRange(const std::string& beforeLog, long value, long min, long max, const std::string& type)
+static bool checkValueRange(const char* beforeLog, const std::string& label, long value, long min, long max, const char* type)
 {
     if (value < min || value > max) {
-        Iec104PivotUtility::log_warn("%s do_value out of range [%ld..%ld] for %s: %ld", beforeLog.c_str(), min, max, type.c_str(), value); //LCOV_EXCL_LINE
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s do_value out of range [%ld..%ld] for %s: %ld", beforeLog, min, max, type, value); //LCOV_EXCL_LINE
         return false;
     }
     return true;
 }
 
-static bool checkValueRange(const std::string& beforeLog, double value, double min, double max, const std::string& type)
+static bool checkValueRange(const char* beforeLog, const std::string& label, double value, double min, double max, const char* type)
 {
     if (value < min || value > max) {
-        Iec104PivotUtility::log_warn("%s do_value out of range [%x..%x] for %s: %x", beforeLog.c_str(), min, max, type.c_str(), value); //LCOV_EXCL_LINE
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s do_value out of range [%f..%f] for %s: %f", beforeLog, min, max, type, value); //LCOV_EXCL_LINE
         return false;
     }
     return true;
 }
 
 static void
-appendTimestampDataObject(PivotDataObject& pivot, bool hasDoTs, long doTs, bool doTsIv, bool doTsSu, bool doTsSub)
+appendTimestampDataObject(PivotDataObject& pivot, bool hasDoTs, long doTs, bool doTsIv, bool doTsSu, bool doTsSub,
+                          const Iec104PivotUtility::ConversionClock& clock)
 {
     if (hasDoTs) {
         pivot.addTimestamp(doTs, doTsIv, doTsSu, doTsSub);
@@ -124,996 +167,1366 @@ appendTimestampDataObject(PivotDataObject& pivot, bool hasDoTs, long doTs, bool
         pivot.addTmValidity(doTsIv);
     }
     else {
-        doTs = (long)PivotTimestamp::GetCurrentTimeInMs();
+        doTs = (long)clock.nowMs();
         pivot.addTimestamp(doTs, false, false, true);
         pivot.addTmOrg(true);
     }
 }
 
 static void
-appendTimestampOperationObject(PivotOperationObject& pivot, bool hasCoTs, long coTs)
+appendTimestampOperationObject(PivotOperationObject& pivot, bool hasCoTs, long coTs, const Iec104PivotUtility::ConversionClock& clock)
 {
     if (hasCoTs) {
         pivot.addTimestamp(coTs);
     }
     else {
-        coTs = (long)PivotTimestamp::GetCurrentTimeInMs();
+        coTs = (long)clock.nowMs();
         pivot.addTimestamp(coTs);
     }
 }
 
-template <typename T>
-void IEC104PivotFilter::readAttribute(std::map<std::string, bool>& attributeFound, Datapoint* dp,
-                                          const std::string& targetName, T& out) {
-    const auto& name = dp->getName();
-    if (name != targetName) {
-        return;
-    }
-    if (attributeFound[name]) {
-        return;
-    }
+namespace {
 
-    if (dp->getData().getType() == DatapointValue::T_INTEGER) {
-        out = static_cast<T>(dp->getData().toInt());
-        attributeFound[name] = true;
-    }
-}
+/*
+ * Conversion of do_value / co_value into the pivot value, one encoder per value kind. toStatus gives the status value
+ * of a monitored data object (stVal, mag, valWtr), toControl the control value (ctlVal) of a command or of its
+ * acknowledgment. The range and the name used in the messages come from the traits of the ASDU type.
+ */
+struct NoValueEncoder {
+    static void toStatus(PivotDataObject&, const DatapointValue&, const Iec104AsduTraits&, const std::string&, const char*) {}
+    static void toControl(PivotObject&, const DatapointValue&, const Iec104AsduTraits&, const std::string&, const char*) {}
+};
 
-void IEC104PivotFilter::readAttribute(std::map<std::string, bool>& attributeFound, Datapoint* dp,
-                                               const std::string& targetName, Datapoint*& out) {
-    const auto& name = dp->getName();
-    if (name != targetName) {
-        return;
-    }
-    if (attributeFound[name]) {
-        return;
-    }
+template <Iec104ValueKind Kind>
+struct ValueEncoder : NoValueEncoder {};
 
-    out = dp;
-    attributeFound[name] = true;
-}
+template <>
+struct ValueEncoder<Iec104ValueKind::SINGLE> : NoValueEncoder
+{
+    static bool encode(const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label, const char* beforeLog) {
+        if (value.getType() != DatapointValue::T_INTEGER) return false;
 
-void IEC104PivotFilter::readAttribute(std::map<std::string, bool>& attributeFound, Datapoint* dp,
-                                                const std::string& targetName, std::string& out) {
-    const auto& name = dp->getName();
-    if (name != targetName) {
-        return;
+        int intValue = static_cast<int>(value.toInt());
+        checkValueRange(beforeLog, label, intValue, (int)traits.minValue, (int)traits.maxValue, traits.familyName);
+
+        return intValue > 0;
     }
-    if (attributeFound[name]) {
-        return;
+
+    static void toStatus(PivotDataObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                         const char* beforeLog) {
+        pivot.setStVal(encode(value, traits, label, beforeLog));
     }
 
-    if (dp->getData().getType() == DatapointValue::T_STRING) {
-        out = dp->getData().toStringValue();
-        attributeFound[name] = true;
+    static void toControl(PivotObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                          const char* beforeLog) {
+        pivot.setCtlValBool(encode(value, traits, label, beforeLog));
     }
-}
+};
 
-Datapoint*
-IEC104PivotFilter::convertDataObjectToPivot(Datapoint* sourceDp, IEC104PivotDataPoint* exchangeConfig)
+template <>
+struct ValueEncoder<Iec104ValueKind::DOUBLE> : NoValueEncoder
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotFilter::convertDataObjectToPivot -"; //LCOV_EXCL_LINE
-    Datapoint* convertedDatapoint = nullptr;
-
-    DatapointValue& dpv = sourceDp->getData();
+    static const std::string* encode(const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                                     const char* beforeLog) {
+        if (value.getType() != DatapointValue::T_INTEGER) return nullptr;
 
-    if (dpv.getType() != DatapointValue::T_DP_DICT)
-        return nullptr;
+        int intValue = static_cast<int>(value.toInt());
+        checkValueRange(beforeLog, label, intValue, (int)traits.minValue, (int)traits.maxValue, traits.familyName);
 
-    std::vector<Datapoint*>* datapoints = dpv.getDpVec();
-    std::map<std::string, bool> attributeFound = {
-        {"do_type", false},
-        {"do_cot", false},
-        {"do_value", false},
-        {"do_quality_iv", false},
-        {"do_quality_bl", false},
-        {"do_quality_ov", false},
-        {"do_quality_sb", false},
-        {"do_quality_nt", false},
-        {"do_ts", false},
-        {"do_ts_iv", false},
-        {"do_ts_su", false},
-        {"do_ts_sub", false},
-        {"do_test", false},
-        {"do_comingfrom", false},
-        {"do_negative", false},
-    };
+        return &Iec104PivotUtility::doublePointToString(intValue);
+    }
 
-    Iec104DataObject dataObject;
+    static void toStatus(PivotDataObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                         const char* beforeLog) {
+        const std::string* state = encode(value, traits, label, beforeLog);
+        if (state) pivot.setStValStr(*state);
+    }
 
-    for (Datapoint* dp : *datapoints)
-    {
-        readAttribute(attributeFound, dp, "do_type", dataObject.doType);
-        readAttribute(attributeFound, dp, "do_cot", dataObject.doCot);
-        readAttribute(attributeFound, dp, "do_value", dataObject.doValue);
-        readAttribute(attributeFound, dp, "do_quality_iv", dataObject.doQualityIv);
-        readAttribute(attributeFound, dp, "do_quality_bl", dataObject.doQualityBl);
-        readAttribute(attributeFound, dp, "do_quality_ov", dataObject.doQualityOv);
-        readAttribute(attributeFound, dp, "do_quality_sb", dataObject.doQualitySb);
-        readAttribute(attributeFound, dp, "do_quality_nt", dataObject.doQualityNt);
-        readAttribute(attributeFound, dp, "do_ts", dataObject.doTs);
-        readAttribute(attributeFound, dp, "do_ts_iv", dataObject.doTsIv);
-        readAttribute(attributeFound, dp, "do_ts_su", dataObject.doTsSu);
-        readAttribute(attributeFound, dp, "do_ts_sub", dataObject.doTsSub);
-        readAttribute(attributeFound, dp, "do_test", dataObject.doTest);
-        readAttribute(attributeFound, dp, "do_comingfrom", dataObject.comingFromValue);
-        readAttribute(attributeFound, dp, "do_negative", dataObject.doNegative);
-    }
-
-    if (!attributeFound["do_type"]) {
-        Iec104PivotUtility::log_error("%s Missing do_type", beforeLog.c_str()); //LCOV_EXCL_LINE
-        return nullptr;
+    static void toControl(PivotObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                          const char* beforeLog) {
+        const std::string* state = encode(value, traits, label, beforeLog);
+        if (state) pivot.setCtlValStr(*state);
     }
-    if (!attributeFound["do_cot"]) {
-        Iec104PivotUtility::log_error("%s Missing do_cot", beforeLog.c_str()); //LCOV_EXCL_LINE
-        return nullptr;
+};
+
+template <>
+struct ValueEncoder<Iec104ValueKind::NORMALIZED> : NoValueEncoder
+{
+    static void toStatus(PivotDataObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                         const char* beforeLog) {
+        if (value.getType() == DatapointValue::T_INTEGER) {
+            long intValue = value.toInt();
+            checkValueRange(beforeLog, label, intValue, -1L, 1L, traits.familyName);
+            pivot.setMagI(static_cast<int>(intValue));
+        }
+        else if (value.getType() == DatapointValue::T_FLOAT) {
+            double floatValue = value.toDouble();
+            checkValueRange(beforeLog, label, floatValue, traits.minValue, traits.maxValue, traits.familyName);
+            pivot.setMagF(static_cast<float>(floatValue));
+        }
     }
-    if (dataObject.comingFromValue != "iec104") {
-        Iec104PivotUtility::log_warn("%s data_object for %s is not from IEC 104 plugin -> ignore", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                    exchangeConfig->getLabel().c_str()); //LCOV_EXCL_LINE
-        return nullptr;
+
+    static void toControl(PivotObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                          const char* beforeLog) {
+        double floatValue = value.toDouble();
+        checkValueRange(beforeLog, label, floatValue, traits.minValue, traits.maxValue, traits.familyName);
+        pivot.setCtlValF(static_cast<float>(floatValue));
     }
-    if (!checkTypeMatch(dataObject.doType, exchangeConfig)) {
-        Iec104PivotUtility::log_warn("%s Input type (%s) does not match configured type (%s) for label %s", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                    dataObject.doType.c_str(), exchangeConfig->getTypeId().c_str(), exchangeConfig->getLabel().c_str()); //LCOV_EXCL_LINE
-        return nullptr;
+};
+
+template <>
+struct ValueEncoder<Iec104ValueKind::SCALED> : NoValueEncoder
+{
+    static void toStatus(PivotDataObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                         const char* beforeLog) {
+        if (value.getType() == DatapointValue::T_INTEGER) {
+            long intValue = value.toInt();
+            checkValueRange(beforeLog, label, intValue, (long)traits.minValue, (long)traits.maxValue, traits.familyName);
+            pivot.setMagI(static_cast<int>(intValue));
+        }
+        else if (value.getType() == DatapointValue::T_FLOAT) {
+            double floatValue = value.toDouble();
+            checkValueRange(beforeLog, label, floatValue, traits.minValue, traits.maxValue, traits.familyName);
+            pivot.setMagF(static_cast<float>(floatValue));
+        }
     }
 
-    if(!attributeFound["do_ts"] && hasASDUTimestamp(dataObject.doType)) {
-        Iec104PivotUtility::log_warn("%s Data object has ASDU type with timestamp (%s), but no timestamp was received", //LCOV_EXCL_LINE
-                                    beforeLog.c_str(), dataObject.doType.c_str()); //LCOV_EXCL_LINE
+    static void toControl(PivotObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                          const char* beforeLog) {
+        long intValue = value.toInt();
+        checkValueRange(beforeLog, label, intValue, (long)traits.minValue, (long)traits.maxValue, traits.familyName);
+        pivot.setCtlValI(static_cast<int>(intValue));
     }
+};
 
-    //NOTE: when doValue is missing it could be an ACK!
+template <>
+struct ValueEncoder<Iec104ValueKind::FLOAT> : NoValueEncoder
+{
+    /* the value must be representable as a single precision float */
+    static float encode(double value, const Iec104AsduTraits& traits, const std::string& label, const char* beforeLog) {
+        float floatValue = static_cast<float>(value);
 
-    if (dataObject.doType == "M_SP_NA_1" || dataObject.doType == "M_SP_TB_1")
-    {
-        // Message structure checks
-        if (!attributeFound["do_value"]) {
-            if (!attributeFound["do_negative"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_negative in SP ACK", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
+        if (static_cast<double>(floatValue) != value) {
+            IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s do_value out of range (float) for %s: %f", beforeLog, traits.familyName, value); //LCOV_EXCL_LINE
         }
-        
-        // Pivot conversion
-        PivotDataObject pivot("GTIS", "SpsTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            bool spsValue = false;
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_INTEGER) {
-                int value = static_cast<int>(dataObject.doValue->getData().toInt());
-                checkValueRange(beforeLog, value, 0, 1, "SP");
-                spsValue = (value > 0);
-            }
 
-            pivot.setStVal(spsValue);
-        }
-        else {
-            pivot.setConfirmation(dataObject.doNegative);
-        }
+        return floatValue;
+    }
 
-        pivot.addQuality(dataObject.doQualityBl, dataObject.doQualityIv, dataObject.doQualityNt,
-                        dataObject.doQualityOv, dataObject.doQualitySb, dataObject.doTest);
+    static void toStatus(PivotDataObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                         const char* beforeLog) {
+        if (value.getType() == DatapointValue::T_INTEGER) {
+            long intValue = value.toInt();
+            float floatValue = static_cast<float>(intValue);
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
+            if (static_cast<long>(floatValue) != intValue) {
+                IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s do_value out of range (int) for %s: %ld", beforeLog, traits.familyName, intValue); //LCOV_EXCL_LINE
+            }
+            pivot.setMagI(static_cast<int>(floatValue));
+        }
+        else if (value.getType() == DatapointValue::T_FLOAT) {
+            pivot.setMagF(encode(value.toDouble(), traits, label, beforeLog));
+        }
+    }
 
-        convertedDatapoint = pivot.toDatapoint();
+    static void toControl(PivotObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                          const char* beforeLog) {
+        pivot.setCtlValF(encode(value.toDouble(), traits, label, beforeLog));
     }
-    else if (dataObject.doType == "M_DP_NA_1" || dataObject.doType == "M_DP_TB_1")
-    {
-        // Message structure checks
-        if (!attributeFound["do_value"]) {
-            if (!attributeFound["do_negative"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_negative in DP ACK", beforeLog.c_str()); //LCOV_EXCL_LINE
+};
+
+template <>
+struct ValueEncoder<Iec104ValueKind::STEP_POSITION> : NoValueEncoder
+{
+    static void toStatus(PivotDataObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                         const char* beforeLog) {
+        long position = 0;
+        bool transient = false;
+
+        if (value.getType() == DatapointValue::T_STRING) {
+            /* a copy of a value of this size stays in the string object itself */
+            const std::string str = value.toStringValue();
+
+            if (!Iec104PivotUtility::parseStepPosition(str, position, transient)) {
+                IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Cannot convert value '%s' to a step position", //LCOV_EXCL_LINE
+                                                beforeLog, str.c_str()); //LCOV_EXCL_LINE
+                return;
             }
         }
-        
-        // Pivot conversion
-        PivotDataObject pivot("GTIS", "DpsTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
+        else if (value.getType() == DatapointValue::T_DP_DICT) {
+            /* structured value: posVal and transInd integers, as written with step_position_format "structured" */
+            /* getDpVec() has no const version, the elements are only read */
+            const std::vector<Datapoint*>* elements = const_cast<DatapointValue&>(value).getDpVec();
+            bool positionFound = false;
 
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
+            for (Datapoint* element : *elements) {
+                const std::string& name = element->getName();
+                const DatapointValue& elementValue = element->getData();
 
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_INTEGER) {
-                int dpsValue = static_cast<int>(dataObject.doValue->getData().toInt());
-                checkValueRange(beforeLog, dpsValue, 0, 3, "DP");
+                if (elementValue.getType() != DatapointValue::T_INTEGER) continue;
 
-                if (dpsValue == 0) {
-                    pivot.setStValStr("intermediate-state");
+                if (name == Names::posVal) {
+                    position = elementValue.toInt();
+                    positionFound = true;
                 }
-                else if (dpsValue == 1) {
-                    pivot.setStValStr("off");
-                }
-                else if (dpsValue == 2) {
-                    pivot.setStValStr("on");
-                }
-                else {
-                    pivot.setStValStr("bad-state");
+                else if (name == Names::transInd) {
+                    transient = (elementValue.toInt() != 0);
                 }
             }
+
+            if (!positionFound) return;
         }
         else {
-            pivot.setConfirmation(dataObject.doNegative);
+            return;
         }
 
-        pivot.addQuality(dataObject.doQualityBl, dataObject.doQualityIv, dataObject.doQualityNt,
-                        dataObject.doQualityOv, dataObject.doQualitySb, dataObject.doTest);
+        checkValueRange(beforeLog, label, position, (long)traits.minValue, (long)traits.maxValue, traits.familyName);
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
-
-        convertedDatapoint = pivot.toDatapoint();
+        pivot.setPosVal(static_cast<int>(position), transient);
     }
-    else if (dataObject.doType == "M_ME_NA_1" || dataObject.doType == "M_ME_TD_1") /* normalized measured value */
-    {
-        // Message structure checks
-        if (!attributeFound["do_value"]) {
-            if (!attributeFound["do_negative"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_negative in ME normalized ACK", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-        }
-        
-        // Pivot conversion
-        PivotDataObject pivot("GTIM", "MvTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_INTEGER) {
-                long value = dataObject.doValue->getData().toInt();
-                checkValueRange(beforeLog, value, -1L, 1L, "ME normalized");
-                pivot.setMagI(static_cast<int>(value));
-            }
-            else if (dataObject.doValue->getData().getType() == DatapointValue::T_FLOAT) {
-                double value = dataObject.doValue->getData().toDouble();
-                checkValueRange(beforeLog, value, -1.0, 32767.0/32768.0, "ME normalized");
-                pivot.setMagF(static_cast<float>(value));
-            }
-        }
-        else {
-            pivot.setConfirmation(dataObject.doNegative);
-        }
+};
 
-        pivot.addQuality(dataObject.doQualityBl, dataObject.doQualityIv, dataObject.doQualityNt,
-                        dataObject.doQualityOv, dataObject.doQualitySb, dataObject.doTest);
+template <>
+struct ValueEncoder<Iec104ValueKind::STEP_COMMAND> : NoValueEncoder
+{
+    static void toControl(PivotObject& pivot, const DatapointValue& value, const Iec104AsduTraits& traits, const std::string& label,
+                          const char* beforeLog) {
+        int intValue = static_cast<int>(value.toInt());
+        checkValueRange(beforeLog, label, intValue, (int)traits.minValue, (int)traits.maxValue, traits.familyName);
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
+        const std::string* command = Iec104PivotUtility::stepCommandToString(intValue);
 
-        convertedDatapoint = pivot.toDatapoint();
-    }
-    else if (dataObject.doType == "M_ME_NB_1" || dataObject.doType == "M_ME_TE_1") /* scaled measured value */
-    {
-        // Message structure checks
-        if (!attributeFound["do_value"]) {
-            if (!attributeFound["do_negative"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_negative in ME scaled ACK", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-        }
-        if (dataObject.doType == "M_ME_TE_1") {
-            if (!attributeFound["do_ts"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_ts in ME scaled with timestamp", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-            if (!attributeFound["do_ts_iv"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_ts_iv in ME scaled with timestamp", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-            if (!attributeFound["do_ts_su"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_ts_su in ME scaled with timestamp", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-            if (!attributeFound["do_ts_sub"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_ts_sub in ME scaled with timestamp", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-        }
-        
-        // Pivot conversion
-        PivotDataObject pivot("GTIM", "MvTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_INTEGER) {
-                long value = dataObject.doValue->getData().toInt();
-                checkValueRange(beforeLog, value, -32768L, 32767L, "ME scaled");
-                pivot.setMagI(static_cast<int>(value));
-            }
-            else if (dataObject.doValue->getData().getType() == DatapointValue::T_FLOAT) {
-                double value = dataObject.doValue->getData().toDouble();
-                checkValueRange(beforeLog, value, -32768.0, 32767.0, "ME scaled");
-                pivot.setMagF(static_cast<float>(value));
-            }
+        if (command) {
+            pivot.setCtlValStr(*command);
         }
         else {
-            pivot.setConfirmation(dataObject.doNegative);
+            IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Invalid step command value for %s: %d", beforeLog, label.c_str(), intValue); //LCOV_EXCL_LINE
         }
+    }
+};
 
-        pivot.addQuality(dataObject.doQualityBl, dataObject.doQualityIv, dataObject.doQualityNt,
-                        dataObject.doQualityOv, dataObject.doQualitySb, dataObject.doTest);
-
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
+/* Converter of the value of one ASDU type, its traits are resolved at compile time */
+template <size_t Type>
+void
+convertDataObjectValue(PivotDataObject& pivot, const DatapointValue& value, const std::string& label, const char* beforeLog)
+{
+    constexpr const Iec104AsduTraits& traits = Iec104PivotUtility::getAsduTraits(static_cast<Iec104AsduType>(Type));
 
-        convertedDatapoint = pivot.toDatapoint();
+    if (traits.isCommand) {
+        ValueEncoder<traits.valueKind>::toControl(pivot, value, traits, label, beforeLog);
     }
-    else if (dataObject.doType == "M_ME_NC_1" || dataObject.doType == "M_ME_TF_1") /* short (float) measured value */
-    {
-        // Message structure checks
-        if (!attributeFound["do_value"]) {
-            if (!attributeFound["do_negative"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_negative in ME floating ACK", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-        }
-        
-        // Pivot conversion
-        PivotDataObject pivot("GTIM", "MvTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_INTEGER ) {
-                long value = dataObject.doValue->getData().toInt();
-                float iValue = static_cast<int>(value);
-                if (static_cast<long>(iValue) != value) {
-                    Iec104PivotUtility::log_warn("%s do_value out of range (int) for ME floating: %f", beforeLog.c_str(), value); //LCOV_EXCL_LINE
-                }
-                pivot.setMagI(iValue);
-            }
-            else if (dataObject.doValue->getData().getType() == DatapointValue::T_FLOAT) {
-                double value = dataObject.doValue->getData().toDouble();
-                float fValue = static_cast<float>(value);
-                if (static_cast<double>(fValue) != value) {
-                    Iec104PivotUtility::log_warn("%s do_value out of range (float) for ME floating: %f", beforeLog.c_str(), value); //LCOV_EXCL_LINE
-                }
-                pivot.setMagF(fValue);
-            }
-        }
-        else {
-            pivot.setConfirmation(dataObject.doNegative);
-        }
+    else {
+        ValueEncoder<traits.valueKind>::toStatus(pivot, value, traits, label, beforeLog);
+    }
+}
 
-        pivot.addQuality(dataObject.doQualityBl, dataObject.doQualityIv, dataObject.doQualityNt,
-                        dataObject.doQualityOv, dataObject.doQualitySb, dataObject.doTest);
+template <size_t Type>
+void
+convertOperationValue(PivotOperationObject& pivot, const DatapointValue& value, const std::string& label, const char* beforeLog)
+{
+    constexpr const Iec104AsduTraits& traits = Iec104PivotUtility::getAsduTraits(static_cast<Iec104AsduType>(Type));
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
+    ValueEncoder<traits.valueKind>::toControl(pivot, value, traits, label, beforeLog);
+}
 
-        convertedDatapoint = pivot.toDatapoint();
-    }
-    else if (dataObject.doType == "M_ST_NA_1" || dataObject.doType == "M_ST_TB_1")
-    {
-        // Message structure checks
-        if (!attributeFound["do_value"]) {
-            if (!attributeFound["do_negative"]) {
-                Iec104PivotUtility::log_warn("%s Missing attribute do_negative in ST ACK", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
-        }
-        
-        // Pivot conversion
-        PivotDataObject pivot("GTIM", "BscTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_STRING) {
-                int wtrVal;
-                int transInd;
-                std::string str = dataObject.doValue->getData().toString();
-                std::string cleaned_str = str.substr(2, str.length() - 4);
-                std::size_t commaPos = cleaned_str.find(',');
-
-                if(commaPos != std::string::npos) {
-                    std::string numStr = cleaned_str.substr(0, commaPos);
-                    std::string boolStr = cleaned_str.substr(commaPos+1);
-                    int wtrVal = 0;
-                    try {
-                        wtrVal = std::stoi(numStr);
-                    } catch (const std::invalid_argument &e) {
-                        Iec104PivotUtility::log_warn("%s Cannot convert value '%s' to integer: %s", //LCOV_EXCL_LINE
-                                                    beforeLog.c_str(), numStr.c_str(), e.what()); //LCOV_EXCL_LINE
-                    } catch (const std::out_of_range &e) {
-                        Iec104PivotUtility::log_warn("%s Cannot convert value '%s' to integer: %s", //LCOV_EXCL_LINE
-                                                    beforeLog.c_str(), numStr.c_str(), e.what()); //LCOV_EXCL_LINE
-                    }
-                    checkValueRange(beforeLog, wtrVal, -64, 63, "ST");
-                    bool transInd = (boolStr == "true");
+typedef void (*DataObjectValueConverter)(PivotDataObject&, const DatapointValue&, const std::string&, const char*);
+typedef void (*OperationValueConverter)(PivotOperationObject&, const DatapointValue&, const std::string&, const char*);
 
-                    pivot.setPosVal(wtrVal, transInd);
-                }
-            }
-        }
-        else {
-            pivot.setConfirmation(dataObject.doNegative);
-        }
+template <size_t... Types>
+struct IndexSequence {};
 
-        pivot.addQuality(dataObject.doQualityBl, dataObject.doQualityIv, dataObject.doQualityNt,
-                        dataObject.doQualityOv, dataObject.doQualitySb, dataObject.doTest);
+template <size_t Count, size_t... Types>
+struct MakeIndexSequence : MakeIndexSequence<Count - 1, Count - 1, Types...> {};
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
+template <size_t... Types>
+struct MakeIndexSequence<0, Types...> {
+    typedef IndexSequence<Types...> type;
+};
 
-        convertedDatapoint = pivot.toDatapoint();
+constexpr size_t ASDU_TYPE_COUNT = static_cast<size_t>(Iec104AsduType::COUNT);
+
+/* Jump tables indexed by Iec104AsduType, null for the types that have no converter in this direction */
+struct ValueConverters {
+    DataObjectValueConverter dataObject[ASDU_TYPE_COUNT];
+    OperationValueConverter operation[ASDU_TYPE_COUNT];
+};
+
+template <size_t... Types>
+constexpr ValueConverters
+makeValueConverters(IndexSequence<Types...>)
+{
+    return ValueConverters{
+        {(Iec104PivotUtility::getAsduTraits(static_cast<Iec104AsduType>(Types)).valueKind != Iec104ValueKind::NONE ?
+          &convertDataObjectValue<Types> : nullptr)...},
+        {(Iec104PivotUtility::getAsduTraits(static_cast<Iec104AsduType>(Types)).isCommand ? &convertOperationValue<Types> : nullptr)...}
+    };
+}
+
+constexpr ValueConverters valueConverters = makeValueConverters(MakeIndexSequence<ASDU_TYPE_COUNT>::type());
+
+}
+
+template <typename T>
+static inline void
+readIntAttribute(uint32_t& attributeFound, uint32_t attribute, Datapoint* dp, T& out)
+{
+    if ((attributeFound & attribute) || dp->getData().getType() != DatapointValue::T_INTEGER) {
+        return;
     }
 
-    else if (dataObject.doType == "C_SC_NA_1" || dataObject.doType == "C_SC_TA_1")
-    {
-        // Pivot conversion
-        PivotDataObject pivot("GTIC", "SpcTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-        if(attributeFound["do_test"])pivot.setTest(dataObject.doTest);
-        if(attributeFound["do_negative"]) pivot.setConfirmation(dataObject.doNegative);
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            bool spsValue = false;
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_INTEGER) {
-                int value = static_cast<int>(dataObject.doValue->getData().toInt());
-                checkValueRange(beforeLog, value, 0, 1, "SC");
-                spsValue = (value > 0);
-            }
+    out = static_cast<T>(dp->getData().toInt());
+    attributeFound |= attribute;
+}
 
-            pivot.setCtlValBool(spsValue);
-        }
+static inline void
+readStringAttribute(uint32_t& attributeFound, uint32_t attribute, Datapoint* dp, std::string& out)
+{
+    if ((attributeFound & attribute) || dp->getData().getType() != DatapointValue::T_STRING) {
+        return;
+    }
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
-        convertedDatapoint = pivot.toDatapoint();
+    out = dp->getData().toStringValue();
+    attributeFound |= attribute;
+}
+
+static inline void
+readDatapointAttribute(uint32_t& attributeFound, uint32_t attribute, Datapoint* dp, Datapoint*& out)
+{
+    if (attributeFound & attribute) {
+        return;
     }
-    else if (dataObject.doType == "C_DC_NA_1" || dataObject.doType == "C_DC_TA_1")
-    {
-        // Pivot conversion
-        PivotDataObject pivot("GTIC", "DpcTyp");
 
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-        if(attributeFound["do_test"])pivot.setTest(dataObject.doTest);
-        if(attributeFound["do_negative"]) pivot.setConfirmation(dataObject.doNegative);
+    out = dp;
+    attributeFound |= attribute;
+}
+
+void
+IEC104PivotFilter::readDataObjectAttributes(const std::vector<Datapoint*>& datapoints, Iec104DataObject& dataObject)
+{
+    uint32_t& found = dataObject.attributeFound;
 
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
+    for (Datapoint* dp : datapoints)
+    {
+        const std::string& name = dp->getName();
+        size_t size = name.size();
 
-            if (dataObject.doValue->getData().getType() == DatapointValue::T_INTEGER) {
-                int dpsValue = static_cast<int>(dataObject.doValue->getData().toInt());
-                checkValueRange(beforeLog, dpsValue, 0, 3, "DC");
+        if (size < 5 || name[0] != 'd' || name[1] != 'o' || name[2] != '_') {
+            continue;
+        }
 
-                if (dpsValue == 0) {
-                    pivot.setCtlValStr("intermediate-state");
+        /* dispatch on the first character after the prefix, then a single compare to confirm the name */
+        switch (name[3]) {
+            case 't':
+                if (name == Names::do_ts) {
+                    readIntAttribute(found, Iec104DataObject::TS, dp, dataObject.doTs);
                 }
-                else if (dpsValue == 1) {
-                    pivot.setCtlValStr("off");
+                else if (name == Names::do_type) {
+                    readStringAttribute(found, Iec104DataObject::TYPE, dp, dataObject.doType);
                 }
-                else if (dpsValue == 2) {
-                    pivot.setCtlValStr("on");
+                else if (name == Names::do_test) {
+                    readIntAttribute(found, Iec104DataObject::TEST, dp, dataObject.doTest);
                 }
-                else {
-                    pivot.setCtlValStr("bad-state");
+                else if (name == Names::do_ts_iv) {
+                    readIntAttribute(found, Iec104DataObject::TS_IV, dp, dataObject.doTsIv);
                 }
-            }
+                else if (name == Names::do_ts_su) {
+                    readIntAttribute(found, Iec104DataObject::TS_SU, dp, dataObject.doTsSu);
+                }
+                else if (name == Names::do_ts_sub) {
+                    readIntAttribute(found, Iec104DataObject::TS_SUB, dp, dataObject.doTsSub);
+                }
+                break;
+            case 'c':
+                if (name == Names::do_ca) {
+                    readIntAttribute(found, Iec104DataObject::CA, dp, dataObject.doCa);
+                }
+                else if (name == Names::do_cot) {
+                    readIntAttribute(found, Iec104DataObject::COT, dp, dataObject.doCot);
+                }
+                else if (name == Names::do_comingfrom) {
+                    readStringAttribute(found, Iec104DataObject::COMING_FROM, dp, dataObject.comingFromValue);
+                }
+                break;
+            case 'i':
+                if (name == Names::do_ioa) {
+                    readIntAttribute(found, Iec104DataObject::IOA, dp, dataObject.doIoa);
+                }
+                break;
+            case 'v':
+                if (name == Names::do_value) {
+                    readDatapointAttribute(found, Iec104DataObject::VALUE, dp, dataObject.doValue);
+                }
+                break;
+            case 'n':
+                if (name == Names::do_negative) {
+                    readIntAttribute(found, Iec104DataObject::NEGATIVE, dp, dataObject.doNegative);
+                }
+                break;
+            case 'q':
+                if (size != 13 || name.compare(0, 11, "do_quality_") != 0) {
+                    break;
+                }
+                if (name[11] == 'i' && name[12] == 'v') {
+                    readIntAttribute(found, Iec104DataObject::QUALITY_IV, dp, dataObject.doQualityIv);
+                }
+                else if (name[11] == 'b' && name[12] == 'l') {
+                    readIntAttribute(found, Iec104DataObject::QUALITY_BL, dp, dataObject.doQualityBl);
+                }
+                else if (name[11] == 'o' && name[12] == 'v') {
+                    readIntAttribute(found, Iec104DataObject::QUALITY_OV, dp, dataObject.doQualityOv);
+                }
+                else if (name[11] == 's' && name[12] == 'b') {
+                    readIntAttribute(found, Iec104DataObject::QUALITY_SB, dp, dataObject.doQualitySb);
+                }
+                else if (name[11] == 'n' && name[12] == 't') {
+                    readIntAttribute(found, Iec104DataObject::QUALITY_NT, dp, dataObject.doQualityNt);
+                }
+                break;
+            default:
+                break;
         }
-
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
-        convertedDatapoint = pivot.toDatapoint();
     }
+}
 
-    else if (dataObject.doType == "C_SE_NA_1" || dataObject.doType == "C_SE_TA_1" || dataObject.doType == "C_SE_NC_1" || dataObject.doType == "C_SE_TC_1")
-    {
-        // Pivot conversion
-        PivotDataObject pivot("GTIC", "ApcTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-        if(attributeFound["do_test"])pivot.setTest(dataObject.doTest);
-        if(attributeFound["do_negative"]) pivot.setConfirmation(dataObject.doNegative);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            double value = dataObject.doValue->getData().toDouble();
-            float fValue = static_cast<float>(value);
-            if (dataObject.doType == "C_SE_NA_1" || dataObject.doType == "C_SE_TA_1") {
-                checkValueRange(beforeLog, value, -1.0, 32767.0/32768.0, "SE normalized");
-            }
-            else if (dataObject.doType == "C_SE_NC_1" || dataObject.doType == "C_SE_TC_1") {
-                if (static_cast<double>(fValue) != value) {
-                    Iec104PivotUtility::log_warn("%s do_value out of range (float) for SE floating: %f", beforeLog.c_str(), value); //LCOV_EXCL_LINE
-                }
-            }
-            pivot.setCtlValF(fValue);
-        }
+void
+IEC104PivotFilter::readCommandObjectAttributes(const std::vector<Datapoint*>& datapoints, Iec104CommandObject& commandObject)
+{
+    uint32_t& found = commandObject.attributeFound;
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
-        convertedDatapoint = pivot.toDatapoint();
-    }
-    else if (dataObject.doType == "C_SE_NB_1" || dataObject.doType == "C_SE_TB_1")
+    for (Datapoint* dp : datapoints)
     {
-        // Pivot conversion
-        PivotDataObject pivot("GTIC", "IncTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-        if(attributeFound["do_test"])pivot.setTest(dataObject.doTest);
-        if(attributeFound["do_negative"]) pivot.setConfirmation(dataObject.doNegative);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            long value = dataObject.doValue->getData().toInt();
-            checkValueRange(beforeLog, value, -64L, 63L, "SE scaled");
-            pivot.setCtlValI(static_cast<int>(value));
-        }
+        const std::string& name = dp->getName();
+        size_t size = name.size();
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
-        convertedDatapoint = pivot.toDatapoint();
-    }
-    else if (dataObject.doType == "C_RC_NA_1" || dataObject.doType == "C_RC_TA_1")
-    {
-        // Pivot conversion
-        PivotDataObject pivot("GTIC", "BscTyp");
-
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(dataObject.doCot);
-        if(attributeFound["do_test"])pivot.setTest(dataObject.doTest);
-        if(attributeFound["do_negative"]) pivot.setConfirmation(dataObject.doNegative);
-
-        if (attributeFound["do_value"] && dataObject.doValue != nullptr) {
-            int ctlValue = dataObject.doValue->getData().toInt();
-            checkValueRange(beforeLog, ctlValue, 0, 3, "RC");
-            switch(ctlValue){
-                case 0:
-                    pivot.setCtlValStr("stop");
-                    break; //LCOV_EXCL_LINE
-                case 1:
-                    pivot.setCtlValStr("lower");
-                    break; //LCOV_EXCL_LINE
-                case 2:
-                    pivot.setCtlValStr("higher");
-                    break; //LCOV_EXCL_LINE
-                case 3:
-                    pivot.setCtlValStr("reserved");
-                    break; //LCOV_EXCL_LINE
-                default:
-                    Iec104PivotUtility::log_warn("%s Invalid step command response value: %s", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                                (exchangeConfig->getPivotId()).c_str()); //LCOV_EXCL_LINE
-                    break; //LCOV_EXCL_LINE
-            }
+        if (size < 5 || name[0] != 'c' || name[1] != 'o' || name[2] != '_') {
+            continue;
         }
 
-        appendTimestampDataObject(pivot, attributeFound["do_ts"], dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub);
-        convertedDatapoint = pivot.toDatapoint();
-    }
-    else {
-        Iec104PivotUtility::log_warn("%s Unknown do_type: %s -> ignore", beforeLog.c_str(), dataObject.doType.c_str()); //LCOV_EXCL_LINE
+        /* dispatch on the first character after the prefix, then a single compare to confirm the name */
+        switch (name[3]) {
+            case 'i':
+                if (name == Names::co_ioa) {
+                    readIntAttribute(found, Iec104CommandObject::IOA, dp, commandObject.coIoa);
+                }
+                break;
+            case 'c':
+                if (name == Names::co_ca) {
+                    readIntAttribute(found, Iec104CommandObject::CA, dp, commandObject.coCa);
+                }
+                else if (name == Names::co_cot) {
+                    readIntAttribute(found, Iec104CommandObject::COT, dp, commandObject.coCot);
+                }
+                else if (name == Names::co_comingfrom) {
+                    readStringAttribute(found, Iec104CommandObject::COMING_FROM, dp, commandObject.comingFromValue);
+                }
+                break;
+            case 't':
+                if (name == Names::co_ts) {
+                    readIntAttribute(found, Iec104CommandObject::TS, dp, commandObject.coTs);
+                }
+                else if (name == Names::co_type) {
+                    readStringAttribute(found, Iec104CommandObject::TYPE, dp, commandObject.coType);
+                }
+                else if (name == Names::co_test) {
+                    readIntAttribute(found, Iec104CommandObject::TEST, dp, commandObject.coTest);
+                }
+                break;
+            case 'v':
+                if (name == Names::co_value) {
+                    readDatapointAttribute(found, Iec104CommandObject::VALUE, dp, commandObject.coValue);
+                }
+                break;
+            case 's':
+                if (name == Names::co_se) {
+                    readIntAttribute(found, Iec104CommandObject::SE, dp, commandObject.coSe);
+                }
+                break;
+            default:
+                break;
+        }
     }
-
-    return convertedDatapoint;
 }
 
-Datapoint*
-IEC104PivotFilter::convertOperationObjectToPivot(std::vector<Datapoint*> datapoints)
+IEC104PivotDataPoint*
+IEC104PivotFilter::findDataObjectDefinition(const IEC104PivotConfig& config, const Iec104DataObject& dataObject, const std::string& assetName)
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotFilter::convertOperationObjectToPivot -"; //LCOV_EXCL_LINE
+    /* the address index avoids hashing the label, but the label stays the reference:
+       a data object is only converted when its asset name is the label of its definition */
+    if (dataObject.hasAttribute(Iec104DataObject::CA) && dataObject.hasAttribute(Iec104DataObject::IOA)) {
+        IEC104PivotDataPoint* exchangeConfig = config.getExchangeDefinitionsByAddress(dataObject.doCa, dataObject.doIoa);
 
-    Datapoint* convertedDatapoint = nullptr;
-    std::map<std::string, bool> attributeFound = {
-        {"co_ioa", false},
-        {"co_ca", false},
-        {"co_type", false},
-        {"co_cot", false},
-        {"co_value", false},
-        {"co_ts", false},
-        {"co_se", false},
-        {"co_test", false},
-        {"co_comingfrom", false},
-    };
+        if (exchangeConfig && exchangeConfig->getLabel() == assetName) {
+            return exchangeConfig;
+        }
+    }
 
-    Iec104CommandObject commandObject;
+    return config.getExchangeDefinitionsByLabel(assetName);
+}
 
-    for(Datapoint* dp : datapoints){
-        readAttribute(attributeFound, dp, "co_ioa", commandObject.coIoa);
-        readAttribute(attributeFound, dp, "co_ca", commandObject.coCa);
-        readAttribute(attributeFound, dp, "co_type", commandObject.coType);
-        readAttribute(attributeFound, dp, "co_cot", commandObject.coCot);
-        readAttribute(attributeFound, dp, "co_value", commandObject.coValue);
-        readAttribute(attributeFound, dp, "co_ts", commandObject.coTs);
-        readAttribute(attributeFound, dp, "co_se", commandObject.coSe);
-        readAttribute(attributeFound, dp, "co_test", commandObject.coTest);
-        readAttribute(attributeFound, dp, "co_comingfrom", commandObject.comingFromValue);
-    }
+Datapoint*
+IEC104PivotFilter::convertDataObjectToPivot(Iec104DataObject& dataObject, IEC104PivotDataPoint* exchangeConfig, DatapointPool& pool,
+                                            MetricsShard& metrics, const Iec104PivotUtility::ConversionClock& clock)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::convertDataObjectToPivot -"; //LCOV_EXCL_LINE
+    Datapoint* convertedDatapoint = nullptr;
+    ConversionRecord record(metrics, MetricsLatency::CONVERT_DATA_OBJECT_TO_PIVOT, MetricsDirection::IEC104_TO_PIVOT);
 
-    if(attributeFound["co_ts"] && commandObject.coTs == 0){
-        attributeFound["co_ts"] = false;
-    }
+    const std::string& label = exchangeConfig->getLabel();
 
-    if(!attributeFound["co_ca"]){
-        Iec104PivotUtility::log_error("%s Missing co_ca", beforeLog.c_str()); //LCOV_EXCL_LINE
+    if (!dataObject.hasAttribute(Iec104DataObject::TYPE)) {
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(label, "%s Missing do_type", beforeLog); //LCOV_EXCL_LINE
         return nullptr;
     }
-    if(!attributeFound["co_ioa"]){
-        Iec104PivotUtility::log_error("%s Missing co_ioa", beforeLog.c_str()); //LCOV_EXCL_LINE
+    dataObject.doAsduType = Iec104PivotUtility::parseAsduType(dataObject.doType);
+    record.setAsduType(dataObject.doAsduType);
+    if (!dataObject.hasAttribute(Iec104DataObject::COT)) {
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(label, "%s Missing do_cot", beforeLog); //LCOV_EXCL_LINE
         return nullptr;
     }
-    
-    std::string address(std::to_string(commandObject.coCa) + "-" + std::to_string(commandObject.coIoa));
-    IEC104PivotDataPoint* exchangeConfig = m_config.getExchangeDefinitionsByAddress(address);
-
-    if(!exchangeConfig){
-        Iec104PivotUtility::log_error("%s CA (%d) and IOA (%d) not found in exchange data", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                    commandObject.coCa, commandObject.coIoa); //LCOV_EXCL_LINE
+    if (dataObject.comingFromValue != Names::iec104) {
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s data_object for %s is not from IEC 104 plugin -> ignore", beforeLog, //LCOV_EXCL_LINE
+                                    exchangeConfig->getLabel().c_str()); //LCOV_EXCL_LINE
+        record.setOutcome(MetricsOutcome::DROPPED_NOT_FROM_IEC104);
         return nullptr;
     }
-
-    if (!attributeFound["co_type"]) {
-        Iec104PivotUtility::log_error("%s Missing co_type", beforeLog.c_str()); //LCOV_EXCL_LINE
+    if (!checkTypeMatch(dataObject.doAsduType, exchangeConfig)) {
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Input type (%s) does not match configured type (%s) for label %s", beforeLog, //LCOV_EXCL_LINE
+                                    dataObject.doType.c_str(), exchangeConfig->getTypeId().c_str(), exchangeConfig->getLabel().c_str()); //LCOV_EXCL_LINE
+        record.setOutcome(MetricsOutcome::TYPE_MISMATCH);
         return nullptr;
     }
-    if (!attributeFound["co_cot"]) {
-        Iec104PivotUtility::log_error("%s Missing co_cot", beforeLog.c_str()); //LCOV_EXCL_LINE
+
+    if(!dataObject.hasAttribute(Iec104DataObject::TS) && Iec104PivotUtility::asduHasTimestamp(dataObject.doAsduType)) {
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Data object has ASDU type with timestamp (%s), but no timestamp was received", //LCOV_EXCL_LINE
+                                    beforeLog, dataObject.doType.c_str()); //LCOV_EXCL_LINE
+    }
+
+    const Iec104AsduTraits& traits = Iec104PivotUtility::getAsduTraits(dataObject.doAsduType);
+    DataObjectValueConverter convertValue = valueConverters.dataObject[static_cast<size_t>(dataObject.doAsduType)];
+
+    if (!convertValue) {
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Unknown do_type: %s -> ignore", beforeLog, dataObject.doType.c_str()); //LCOV_EXCL_LINE
         return nullptr;
     }
-    else {
-        if (commandObject.coCot < 0 || commandObject.coCot > 63) {
-            Iec104PivotUtility::log_error("%s COT value out of range [0..63] for address %s: %d", beforeLog.c_str(), address.c_str(), commandObject.coCot); //LCOV_EXCL_LINE
-            return nullptr;
+
+    //NOTE: when doValue is missing it could be an ACK!
+
+    if (!traits.isCommand) {
+        // Message structure checks
+        if (!dataObject.hasAttribute(Iec104DataObject::VALUE) && !dataObject.hasAttribute(Iec104DataObject::NEGATIVE)) {
+            IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Missing attribute do_negative in %s ACK", beforeLog, traits.familyName); //LCOV_EXCL_LINE
+        }
+        if (traits.hasTimestamp && dataObject.hasAttribute(Iec104DataObject::TS)) {
+            if (!dataObject.hasAttribute(Iec104DataObject::TS_IV)) {
+                IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Missing attribute do_ts_iv in %s with timestamp", beforeLog, traits.familyName); //LCOV_EXCL_LINE
+            }
+            if (!dataObject.hasAttribute(Iec104DataObject::TS_SU)) {
+                IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Missing attribute do_ts_su in %s with timestamp", beforeLog, traits.familyName); //LCOV_EXCL_LINE
+            }
+            if (!dataObject.hasAttribute(Iec104DataObject::TS_SUB)) {
+                IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Missing attribute do_ts_sub in %s with timestamp", beforeLog, traits.familyName); //LCOV_EXCL_LINE
+            }
         }
     }
 
-    if (!checkTypeMatch(commandObject.coType, exchangeConfig)) {
-        Iec104PivotUtility::log_warn("%s Input type (%s) does not match configured type (%s) for address %s", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                    commandObject.coType.c_str(), exchangeConfig->getTypeId().c_str(), address.c_str()); //LCOV_EXCL_LINE
-        return nullptr;
+    // Pivot conversion
+    PivotDataObject pivot(exchangeConfig, traits.pivotLN, traits.pivotCdc, &pool);
+
+    pivot.setCause(dataObject.doCot);
+
+    if (traits.isCommand) {
+        /* acknowledgment of a command */
+        if (dataObject.hasAttribute(Iec104DataObject::TEST)) pivot.setTest(dataObject.doTest);
+        if (dataObject.hasAttribute(Iec104DataObject::NEGATIVE)) pivot.setConfirmation(dataObject.doNegative);
     }
 
-    if (commandObject.comingFromValue != "iec104") {
-        Iec104PivotUtility::log_warn("%s data_object for %s is not from IEC 104 plugin -> ignore", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                    exchangeConfig->getLabel().c_str()); //LCOV_EXCL_LINE
-        return nullptr;
+    if (dataObject.hasAttribute(Iec104DataObject::VALUE) && dataObject.doValue != nullptr) {
+        convertValue(pivot, dataObject.doValue->getData(), label, beforeLog);
+    }
+    else if (!traits.isCommand) {
+        pivot.setConfirmation(dataObject.doNegative);
     }
 
-    if(!attributeFound["co_ts"] && hasASDUTimestamp(commandObject.coType)) {
-        Iec104PivotUtility::log_error("%s Command has ASDU type with timestamp (%s), but no timestamp was received -> ignore", //LCOV_EXCL_LINE
-                                    beforeLog.c_str(), commandObject.coType.c_str()); //LCOV_EXCL_LINE
-        return nullptr;
+    if (!traits.isCommand) {
+        pivot.addQuality(dataObject.doQualityBl, dataObject.doQualityIv, dataObject.doQualityNt,
+                        dataObject.doQualityOv, dataObject.doQualitySb, dataObject.doTest);
     }
 
+    appendTimestampDataObject(pivot, dataObject.hasAttribute(Iec104DataObject::TS), dataObject.doTs, dataObject.doTsIv, dataObject.doTsSu, dataObject.doTsSub,
+                              clock);
 
-    if (commandObject.coType == "C_SC_NA_1" || commandObject.coType == "C_SC_TA_1")
-    {
-        PivotOperationObject pivot("GTIC", "SpcTyp");
+    convertedDatapoint = pivot.toDatapoint();
 
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(commandObject.coCot);
-        if(attributeFound["co_se"])pivot.setSelect(commandObject.coSe);
-        if(attributeFound["co_test"])pivot.setTest(commandObject.coTest);
-
-        if (attributeFound["co_value"] && commandObject.coValue != nullptr) {
-            bool spsValue = false;
-            if (commandObject.coValue->getData().getType() == DatapointValue::T_INTEGER) {
-                bool value = commandObject.coValue->getData().toInt();
-                checkValueRange(beforeLog, value, 0, 1, "SC");
-                spsValue = (value > 0);
-            }
+    if (convertedDatapoint) record.setOutcome(MetricsOutcome::CONVERTED);
 
-            pivot.setCtlValBool(spsValue);
-        }
+    return convertedDatapoint;
+}
 
-        appendTimestampOperationObject(pivot, attributeFound["co_ts"], commandObject.coTs);
+Datapoint*
+IEC104PivotFilter::convertOperationObjectToPivot(const IEC104PivotConfig& config, const std::vector<Datapoint*>& datapoints,
+                                                 DatapointPool& pool, MetricsShard& metrics,
+                                                 const Iec104PivotUtility::ConversionClock& clock)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::convertOperationObjectToPivot -"; //LCOV_EXCL_LINE
 
-        convertedDatapoint = pivot.toDatapoint();
-    }
-    else if (commandObject.coType == "C_DC_NA_1" || commandObject.coType == "C_DC_TA_1")
-    {
-        PivotOperationObject pivot("GTIC", "DpcTyp");
+    Datapoint* convertedDatapoint = nullptr;
+    Iec104CommandObject commandObject;
+    ConversionRecord record(metrics, MetricsLatency::CONVERT_OPERATION_OBJECT_TO_PIVOT, MetricsDirection::IEC104_TO_PIVOT);
 
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(commandObject.coCot);
-        if(attributeFound["co_se"])pivot.setSelect(commandObject.coSe);
-        if(attributeFound["co_test"])pivot.setTest(commandObject.coTest);
+    readCommandObjectAttributes(datapoints, commandObject);
 
-        if (attributeFound["co_value"] && commandObject.coValue != nullptr) {
+    /* parsed before the checks so that commands dropped for any reason are counted under their type */
+    commandObject.coAsduType = Iec104PivotUtility::parseAsduType(commandObject.coType);
+    record.setAsduType(commandObject.coAsduType);
 
-            if (commandObject.coValue->getData().getType() == DatapointValue::T_INTEGER) {
-                int dpsValue = commandObject.coValue->getData().toInt();
-            
-                checkValueRange(beforeLog, dpsValue, 0, 3, "DC");
+    if(commandObject.hasAttribute(Iec104CommandObject::TS) && commandObject.coTs == 0){
+        commandObject.attributeFound &= ~Iec104CommandObject::TS;
+    }
 
-                if (dpsValue == 0) {
-                    pivot.setCtlValStr("intermediate-state");
-                }
-                else if (dpsValue == 1) {
-                    pivot.setCtlValStr("off");
-                }
-                else if (dpsValue == 2) {
-                    pivot.setCtlValStr("on");
-                }
-                else {
-                    pivot.setCtlValStr("bad-state");
-                }
-            }
-        }
+    if(!commandObject.hasAttribute(Iec104CommandObject::CA)){
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(Names::co_ca, "%s Missing co_ca", beforeLog); //LCOV_EXCL_LINE
+        return nullptr;
+    }
+    if(!commandObject.hasAttribute(Iec104CommandObject::IOA)){
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(Names::co_ioa, "%s Missing co_ioa", beforeLog); //LCOV_EXCL_LINE
+        return nullptr;
+    }
 
-        appendTimestampOperationObject(pivot, attributeFound["co_ts"], commandObject.coTs);
+    IEC104PivotDataPoint* exchangeConfig = config.getExchangeDefinitionsByAddress(commandObject.coCa, commandObject.coIoa);
 
-        convertedDatapoint = pivot.toDatapoint();
+    if(!exchangeConfig){
+        /* integer key, an unknown address does not cost any allocation */
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(ExchangeAddressIndex::packAddress(commandObject.coCa, commandObject.coIoa), //LCOV_EXCL_LINE
+                                    "%s CA (%d) and IOA (%d) not found in exchange data", beforeLog, //LCOV_EXCL_LINE
+                                    commandObject.coCa, commandObject.coIoa); //LCOV_EXCL_LINE
+        record.setOutcome(MetricsOutcome::DROPPED_UNKNOWN_ADDRESS);
+        return nullptr;
     }
-    else if (commandObject.coType == "C_SE_NB_1" || commandObject.coType == "C_SE_TB_1")
-    {
-        PivotOperationObject pivot("GTIC", "IncTyp");
 
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(commandObject.coCot);
-        if(attributeFound["co_se"])pivot.setSelect(commandObject.coSe);
-        if(attributeFound["co_test"])pivot.setTest(commandObject.coTest);
+    const std::string& label = exchangeConfig->getLabel();
 
-        if (attributeFound["co_value"]  && commandObject.coValue != nullptr) {
-            int value = commandObject.coValue->getData().toInt();
-            checkValueRange(beforeLog, value, -32768, 32767, "SE scaled");
-            pivot.setCtlValI(value);
+    if (!commandObject.hasAttribute(Iec104CommandObject::TYPE)) {
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(label, "%s Missing co_type", beforeLog); //LCOV_EXCL_LINE
+        return nullptr;
+    }
+    if (!commandObject.hasAttribute(Iec104CommandObject::COT)) {
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(label, "%s Missing co_cot", beforeLog); //LCOV_EXCL_LINE
+        return nullptr;
+    }
+    else {
+        if (commandObject.coCot < 0 || commandObject.coCot > 63) {
+            IEC104_PIVOT_LOG_ERROR_THROTTLED(label, "%s COT value out of range [0..63] for address %d-%d: %d", beforeLog, //LCOV_EXCL_LINE
+                                            commandObject.coCa, commandObject.coIoa, commandObject.coCot); //LCOV_EXCL_LINE
+            return nullptr;
         }
+    }
+
+    if (!checkTypeMatch(commandObject.coAsduType, exchangeConfig)) {
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s Input type (%s) does not match configured type (%s) for address %d-%d", beforeLog, //LCOV_EXCL_LINE
+                                    commandObject.coType.c_str(), exchangeConfig->getTypeId().c_str(), commandObject.coCa, commandObject.coIoa); //LCOV_EXCL_LINE
+        record.setOutcome(MetricsOutcome::TYPE_MISMATCH);
+        return nullptr;
+    }
 
-        appendTimestampOperationObject(pivot, attributeFound["co_ts"], commandObject.coTs);
+    if (commandObject.comingFromValue != Names::iec104) {
+        IEC104_PIVOT_LOG_WARN_THROTTLED(label, "%s data_object for %s is not from IEC 104 plugin -> ignore", beforeLog, //LCOV_EXCL_LINE
+                                    exchangeConfig->getLabel().c_str()); //LCOV_EXCL_LINE
+        record.setOutcome(MetricsOutcome::DROPPED_NOT_FROM_IEC104);
+        return nullptr;
+    }
 
-        convertedDatapoint = pivot.toDatapoint();
+    if(!commandObject.hasAttribute(Iec104CommandObject::TS) && Iec104PivotUtility::asduHasTimestamp(commandObject.coAsduType)) {
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(label, "%s Command has ASDU type with timestamp (%s), but no timestamp was received -> ignore", //LCOV_EXCL_LINE
+                                    beforeLog, commandObject.coType.c_str()); //LCOV_EXCL_LINE
+        return nullptr;
     }
-    else if (commandObject.coType == "C_SE_NA_1" || commandObject.coType == "C_SE_TA_1" || commandObject.coType == "C_SE_NC_1" || commandObject.coType == "C_SE_TC_1")
-    {
-        PivotOperationObject pivot("GTIC", "ApcTyp");
 
-        pivot.setIdentifier(exchangeConfig->getPivotId());
-        pivot.setCause(commandObject.coCot);
-        if(attributeFound["co_se"])pivot.setSelect(commandObject.coSe);
-        if(attributeFound["co_test"])pivot.setTest(commandObject.coTest);
-
-        if (attributeFound["co_value"]  && commandObject.coValue != nullptr) {
-            double value = commandObject.coValue->getData().toDouble();
-            float fValue = static_cast<float>(value);
-            if (commandObject.coType == "C_SE_NA_1" || commandObject.coType == "C_SE_TA_1") {
-                checkValueRange(beforeLog, value, -1.0, 32767.0/32768.0, "SE normalized");
-            }
-            else if (commandObject.coType == "C_SE_NC_1" || commandObject.coType == "C_SE_TC_1") {
-                if (static_cast<double>(fValue) != value) {
-                    Iec104PivotUtility::log_warn("%s do_value out of range (float) for SE floating: %f", beforeLog.c_str(), value); //LCOV_EXCL_LINE
-                }
-            }
-            pivot.setCtlValF(fValue);
-        }
 
-        appendTimestampOperationObject(pivot, attributeFound["co_ts"], commandObject.coTs);
+    OperationValueConverter convertValue = valueConverters.operation[static_cast<size_t>(commandObject.coAsduType)];
 
-        convertedDatapoint = pivot.toDatapoint();
-    }
-    else if (commandObject.coType == "C_RC_NA_1" || commandObject.coType == "C_RC_TA_1")
-    {
-        PivotOperationObject pivot("GTIC", "BscTyp");
+    if (convertValue) {
+        const Iec104AsduTraits& traits = Iec104PivotUtility::getAsduTraits(commandObject.coAsduType);
+        PivotOperationObject pivot(exchangeConfig, traits.pivotLN, traits.pivotCdc, &pool);
 
-        pivot.setIdentifier(exchangeConfig->getPivotId());
         pivot.setCause(commandObject.coCot);
-        if(attributeFound["co_se"])pivot.setSelect(commandObject.coSe);
-        if(attributeFound["co_test"])pivot.setTest(commandObject.coTest);
-
-        if (attributeFound["co_value"]  && commandObject.coValue != nullptr) {
-            int ctlValue = commandObject.coValue->getData().toInt();
-            checkValueRange(beforeLog, ctlValue, 0, 3, "RC");
-            switch(ctlValue){
-                case 0:
-                    pivot.setCtlValStr("stop");
-                    break; //LCOV_EXCL_LINE
-                case 1:
-                    pivot.setCtlValStr("lower");
-                    break; //LCOV_EXCL_LINE
-                case 2:
-                    pivot.setCtlValStr("higher");
-                    break; //LCOV_EXCL_LINE
-                case 3:
-                    pivot.setCtlValStr("reserved");
-                    break; //LCOV_EXCL_LINE
-                default:
-                    Iec104PivotUtility::log_warn("%s Invalid step command value: %s", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                                (exchangeConfig->getPivotId()).c_str()); //LCOV_EXCL_LINE
-                    break; //LCOV_EXCL_LINE
-            }
+        if(commandObject.hasAttribute(Iec104CommandObject::SE))pivot.setSelect(commandObject.coSe);
+        if(commandObject.hasAttribute(Iec104CommandObject::TEST))pivot.setTest(commandObject.coTest);
+
+        if (commandObject.hasAttribute(Iec104CommandObject::VALUE) && commandObject.coValue != nullptr) {
+            convertValue(pivot, commandObject.coValue->getData(), label, beforeLog);
         }
 
-        appendTimestampOperationObject(pivot, attributeFound["co_ts"], commandObject.coTs);
+        appendTimestampOperationObject(pivot, commandObject.hasAttribute(Iec104CommandObject::TS), commandObject.coTs, clock);
 
         convertedDatapoint = pivot.toDatapoint();
     }
 
+    if (convertedDatapoint) record.setOutcome(MetricsOutcome::CONVERTED);
+
     return convertedDatapoint;
 }
 
 Datapoint*
-IEC104PivotFilter::convertDatapointToIEC104DataObject(Datapoint* sourceDp)
+IEC104PivotFilter::convertDatapointToIEC104DataObject(const IEC104PivotConfig& config, Datapoint* sourceDp, DatapointPool& pool,
+                                                      MetricsShard& metrics, const Iec104PivotUtility::ConversionClock& clock,
+                                                      Iec104PivotUtility::StepPositionFormat stepPositionFormat)
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotFilter::convertDatapointToIEC104DataObject -"; //LCOV_EXCL_LINE
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::convertDatapointToIEC104DataObject -"; //LCOV_EXCL_LINE
     Datapoint* convertedDatapoint = nullptr;
+    ConversionRecord record(metrics, MetricsLatency::CONVERT_PIVOT_TO_DATA_OBJECT, MetricsDirection::PIVOT_TO_IEC104);
 
-    try {
-        PivotDataObject pivotObject(sourceDp);
-        const std::string& pivotId = pivotObject.getIdentifier();
-        IEC104PivotDataPoint* exchangeConfig = m_config.getExchangeDefinitionsByPivotId(pivotId);
-        
-        if(exchangeConfig){
-            convertedDatapoint = pivotObject.toIec104DataObject(exchangeConfig);
-        }
-        else {
-            Iec104PivotUtility::log_warn("%s PivotId '%s' not found in exchangedData, ensure that this is intentional", //LCOV_EXCL_LINE
-                                             beforeLog.c_str(), pivotId.c_str()); //LCOV_EXCL_LINE
-        }
+    PivotDataObject pivotObject(&pool);
+    PivotParseStatus status = pivotObject.parse(sourceDp);
+
+    /* the message is only built when it is logged, a flood of malformed trees costs no string building */
+    if (!status.ok()) {
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(Names::PIVOT, "%s Failed to convert pivot object: %s", //LCOV_EXCL_LINE
+                                         beforeLog, status.toString().c_str()); //LCOV_EXCL_LINE
+        return nullptr;
     }
-    catch (PivotObjectException& e)
-    {
-        Iec104PivotUtility::log_error("%s Failed to convert pivot object: %s", beforeLog.c_str(), e.getContext().c_str()); //LCOV_EXCL_LINE
+
+    const std::string& pivotId = pivotObject.getIdentifier();
+    IEC104PivotDataPoint* exchangeConfig = config.getExchangeDefinitionsByPivotId(pivotId);
+
+    if(exchangeConfig){
+        record.setAsduType(exchangeConfig->getAsduType());
+        convertedDatapoint = pivotObject.toIec104DataObject(exchangeConfig, clock, stepPositionFormat);
+        if (convertedDatapoint) record.setOutcome(MetricsOutcome::CONVERTED);
+    }
+    else {
+        IEC104_PIVOT_LOG_WARN_THROTTLED(pivotId, "%s PivotId '%s' not found in exchangedData, ensure that this is intentional", //LCOV_EXCL_LINE
+                                         beforeLog, pivotId.c_str()); //LCOV_EXCL_LINE
+        record.setOutcome(MetricsOutcome::PASSTHROUGH);
     }
 
     return convertedDatapoint;
 }
 
 std::vector<Datapoint*>
-IEC104PivotFilter::convertReadingToIEC104OperationObject(Datapoint* sourceDp)
+IEC104PivotFilter::convertReadingToIEC104OperationObject(const IEC104PivotConfig& config, Datapoint* sourceDp, DatapointPool& pool,
+                                                         MetricsShard& metrics)
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotFilter::convertReadingToIEC104OperationObject -"; //LCOV_EXCL_LINE
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::convertReadingToIEC104OperationObject -"; //LCOV_EXCL_LINE
     std::vector<Datapoint*> convertedDatapoints;
+    ConversionRecord record(metrics, MetricsLatency::CONVERT_PIVOT_TO_OPERATION_OBJECT, MetricsDirection::PIVOT_TO_IEC104);
 
-    try {
-        PivotOperationObject pivotOperationObject(sourceDp);
-        const std::string& pivotId = pivotOperationObject.getIdentifier();
-        IEC104PivotDataPoint* exchangeConfig = m_config.getExchangeDefinitionsByPivotId(pivotId);
+    PivotOperationObject pivotOperationObject(&pool);
+    PivotParseStatus status = pivotOperationObject.parse(sourceDp);
 
-        if(!exchangeConfig){
-            Iec104PivotUtility::log_error("%s Pivot ID not in exchangedData: %s", beforeLog.c_str(), pivotId.c_str()); //LCOV_EXCL_LINE
-        }
-        else{
-            convertedDatapoints = pivotOperationObject.toIec104OperationObject(exchangeConfig);
-        }
+    if (!status.ok()) {
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(Names::PIVOT, "%s Failed to convert pivot operation object: %s", //LCOV_EXCL_LINE
+                                         beforeLog, status.toString().c_str()); //LCOV_EXCL_LINE
+        return convertedDatapoints;
     }
-    catch (PivotObjectException& e)
-    {
-        Iec104PivotUtility::log_error("%s Failed to convert pivot operation object: %s", beforeLog.c_str(), e.getContext().c_str()); //LCOV_EXCL_LINE
+
+    const std::string& pivotId = pivotOperationObject.getIdentifier();
+    IEC104PivotDataPoint* exchangeConfig = config.getExchangeDefinitionsByPivotId(pivotId);
+
+    if(!exchangeConfig){
+        IEC104_PIVOT_LOG_ERROR_THROTTLED(pivotId, "%s Pivot ID not in exchangedData: %s", beforeLog, pivotId.c_str()); //LCOV_EXCL_LINE
+        record.setOutcome(MetricsOutcome::DROPPED_UNKNOWN_ADDRESS);
+    }
+    else{
+        record.setAsduType(exchangeConfig->getAsduType());
+        convertedDatapoints = pivotOperationObject.toIec104OperationObject(exchangeConfig);
+        if (!convertedDatapoints.empty()) record.setOutcome(MetricsOutcome::CONVERTED);
     }
 
     return convertedDatapoints;
 }
 
 void
-IEC104PivotFilter::ingest(READINGSET* readingSet)
+IEC104PivotFilter::releaseDatapoints(std::vector<Datapoint*>& datapoints, DatapointPool& pool)
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotFilter::ingest -"; //LCOV_EXCL_LINE
-    /* apply transformation */
-    std::vector<Reading*>* readings = readingSet->getAllReadingsPtr();
+    for (Datapoint* dp : datapoints) {
+        pool.release(dp);
+    }
 
-    std::vector<Reading*>::iterator readIt = readings->begin();
+    datapoints.clear();
+}
 
-    while(readIt != readings->end())
-    {
-        Reading* reading = *readIt;
+void
+IEC104PivotFilter::convertReading(const IEC104PivotConfig& config, const RuntimeSettings& settings, Reading* reading, DatapointPool& pool,
+                                  MetricsShard& metrics, const Iec104PivotUtility::ConversionClock& clock,
+                                  PendingReport* pendingReports, size_t pendingReportCount)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::convertReading -"; //LCOV_EXCL_LINE
 
-        std::string assetName = reading->getAssetName();
+    const std::string& assetName = reading->getAssetName();
 
+    std::vector<Datapoint*>& datapoints = reading->getReadingData();
 
-        std::vector<Datapoint*>& datapoints = reading->getReadingData();
+    IEC104_PIVOT_LOG_DEBUG("%s original Reading: (%s)", beforeLog, reading->toJSON().c_str()); //LCOV_EXCL_LINE
 
-        std::vector<Datapoint*> convertedDatapoints;
+    if(assetName == "IEC104Command"){
+        Datapoint* convertedOperation = convertOperationObjectToPivot(config, datapoints, pool, metrics, clock);
 
+        releaseDatapoints(datapoints, pool);
 
-        Iec104PivotUtility::log_debug("%s original Reading: (%s)", beforeLog.c_str(), reading->toJSON().c_str()); //LCOV_EXCL_LINE
+        if (!convertedOperation) {
+            IEC104_PIVOT_LOG_ERROR_THROTTLED(assetName, "%s Failed to convert IEC command object", beforeLog); //LCOV_EXCL_LINE
+        }
+        else{
+            reading->addDatapoint(convertedOperation);
+        }
+
+        reading->setAssetName("PivotCommand");
+    }
+
+    else if(assetName == "PivotCommand"){
+        std::vector<Datapoint*> convertedReadingDatapoints = convertReadingToIEC104OperationObject(config, datapoints[0], pool, metrics);
+
+        if (convertedReadingDatapoints.empty()) {
+            IEC104_PIVOT_LOG_ERROR_THROTTLED(assetName, "%s Failed to convert Pivot operation object", beforeLog); //LCOV_EXCL_LINE
+        }
 
-        if(assetName == "IEC104Command"){
-            Datapoint* convertedOperation = convertOperationObjectToPivot(datapoints);
+        releaseDatapoints(datapoints, pool);
 
-            if (!convertedOperation) {
-                Iec104PivotUtility::log_error("%s Failed to convert IEC command object", beforeLog.c_str()); //LCOV_EXCL_LINE
+        for(Datapoint* dp : convertedReadingDatapoints)
+            reading->addDatapoint(dp);
+
+        reading->setAssetName("IEC104Command");
+    }
+
+    else{
+        /* datapoints are replaced in place: converted ones are swapped with their conversion result,
+           passthrough ones keep their original object, so a reading without anything to convert is left untouched */
+        size_t kept = 0;
+
+        for (size_t i = 0; i < datapoints.size(); i++) {
+            Datapoint* dp = datapoints[i];
+            Datapoint* outputDp = dp;
+
+            if (dp->getName() == Names::data_object) {
+                Iec104DataObject dataObject;
+
+                if (dp->getData().getType() == DatapointValue::T_DP_DICT) {
+                    readDataObjectAttributes(*dp->getData().getDpVec(), dataObject);
+                }
+
+                IEC104PivotDataPoint* exchangeConfig = findDataObjectDefinition(config, dataObject, assetName);
+
+                if(exchangeConfig){
+                    outputDp = convertDataObjectToPivot(dataObject, exchangeConfig, pool, metrics, clock);
+                    if (!outputDp) {
+                        IEC104_PIVOT_LOG_ERROR_THROTTLED(assetName, "%s Failed to convert object", beforeLog); //LCOV_EXCL_LINE
+                    }
+
+                    if (pendingReportCount > 0 && pendingReports->input == dp) {
+                        pendingReports->converted = (outputDp != nullptr);
+                        pendingReports++;
+                        pendingReportCount--;
+                    }
+                }
+                else {
+                    Iec104PivotUtility::log_debug("%s Asset '%s' not found in exchangedData, forwarding reading unchanged", //LCOV_EXCL_LINE
+                                        beforeLog, assetName.c_str()); //LCOV_EXCL_LINE
+                    metrics.count(MetricsDirection::IEC104_TO_PIVOT, Iec104PivotUtility::parseAsduType(dataObject.doType),
+                                  MetricsOutcome::PASSTHROUGH);
+                }
+            }
+            else if (dp->getName() == Names::PIVOT) {
+                Datapoint* convertedDp = convertDatapointToIEC104DataObject(config, dp, pool, metrics, clock, settings.stepPositionFormat);
+
+                if (convertedDp) {
+                    outputDp = convertedDp;
+                }
+                else {
+                    Iec104PivotUtility::log_debug("%s PivotId not found in exchangedData, forwarding reading unchanged", //LCOV_EXCL_LINE
+                                                    beforeLog); //LCOV_EXCL_LINE
+                }
             }
-            else{
-                convertedDatapoints.push_back(convertedOperation);
+            else {
+                Iec104PivotUtility::log_debug("%s Unhandled datapoint type '%s', forwarding reading unchanged", //LCOV_EXCL_LINE
+                                                beforeLog, dp->getName().c_str()); //LCOV_EXCL_LINE
             }
 
-            reading->setAssetName("PivotCommand");
+            if (outputDp != dp) {
+                /* the consumed input nodes are recycled by the next conversions */
+                pool.release(dp);
+            }
+
+            if (outputDp) {
+                datapoints[kept++] = outputDp;
+            }
         }
 
-        else if(assetName == "PivotCommand"){
-            std::vector<Datapoint*> convertedReadingDatapoints = convertReadingToIEC104OperationObject(datapoints[0]);
+        datapoints.resize(kept);
+    }
 
-            if (convertedReadingDatapoints.empty()) {
-                Iec104PivotUtility::log_error("%s Failed to convert Pivot operation object", beforeLog.c_str()); //LCOV_EXCL_LINE
-            }
+    IEC104_PIVOT_LOG_DEBUG("%s converted Reading: (%s)", beforeLog, reading->toJSON().c_str()); //LCOV_EXCL_LINE
+}
 
-            for(Datapoint* dp : convertedReadingDatapoints)
-                convertedDatapoints.push_back(dp);
+void
+IEC104PivotFilter::suppressUnchangedDataObjects(const IEC104PivotConfig& config, const Iec104PivotUtility::ReportByException& reportByException,
+                                                std::vector<Reading*>& readings, MetricsShard& metrics,
+                                                const Iec104PivotUtility::ConversionClock& clock)
+{
+    /* cleared here rather than after the conversion, so that a set whose conversion threw leaves nothing behind */
+    m_pendingReports.clear();
+    m_pendingReportIndexes.clear();
+    m_pendingReportStarts.assign(1, 0);
 
-            reading->setAssetName("IEC104Command");
+    for (Reading* reading : readings) {
+        const std::string& assetName = reading->getAssetName();
+
+        if (assetName == "IEC104Command" || assetName == "PivotCommand") {
+            m_pendingReportStarts.push_back(m_pendingReports.size());
+            continue;
         }
 
-        else{
-            for (Datapoint* dp : datapoints) {
-                if (dp->getName() == "data_object") {                    
-                    IEC104PivotDataPoint* exchangeConfig = m_config.getExchangeDefinitionsByLabel(assetName);
-                    
-                    if(exchangeConfig){
-                        Datapoint* convertedDp = convertDataObjectToPivot(dp, exchangeConfig);
-                        if (convertedDp) {
-                            convertedDatapoints.push_back(convertedDp);
+        std::vector<Datapoint*>& datapoints = reading->getReadingData();
+        size_t kept = 0;
+
+        for (size_t i = 0; i < datapoints.size(); i++) {
+            Datapoint* dp = datapoints[i];
+            bool send = true;
+
+            if (dp->getName() == Names::data_object && dp->getData().getType() == DatapointValue::T_DP_DICT) {
+                Iec104DataObject dataObject;
+                readDataObjectAttributes(*dp->getData().getDpVec(), dataObject);
+
+                IEC104PivotDataPoint* exchangeConfig = findDataObjectDefinition(config, dataObject, assetName);
+
+                /* only the objects the conversion accepts are recorded, command acknowledgments are always sent */
+                if (exchangeConfig && dataObject.hasAttribute(Iec104DataObject::TYPE) && dataObject.hasAttribute(Iec104DataObject::COT) &&
+                    dataObject.comingFromValue == Names::iec104) {
+                    Iec104AsduType asduType = Iec104PivotUtility::parseAsduType(dataObject.doType);
+
+                    if (checkTypeMatch(asduType, exchangeConfig) && !Iec104PivotUtility::getAsduTraits(asduType).isCommand) {
+                        Iec104PivotUtility::ReportState state;
+                        readReportState(dataObject, state);
+
+                        /* an earlier object of the set pending for the definition is the last one sent if converted */
+                        auto pending = m_pendingReportIndexes.find(exchangeConfig);
+                        const Iec104PivotUtility::ReportState& last = (pending != m_pendingReportIndexes.end()) ?
+                            m_pendingReports[pending->second].state : exchangeConfig->getReportState();
+
+                        send = reportByException.mustSend(last, state, dataObject.doCot, clock.nowMs());
+
+                        if (send) {
+                            PendingReport report;
+                            reportByException.recordSent(report.state, state, clock.nowMs());
+                            report.definition = exchangeConfig;
+                            report.input = dp;
+                            report.converted = false;
+                            m_pendingReportIndexes[exchangeConfig] = m_pendingReports.size();
+                            m_pendingReports.push_back(report);
                         }
                         else {
-                            Iec104PivotUtility::log_error("%s Failed to convert object", beforeLog.c_str()); //LCOV_EXCL_LINE
+                            metrics.count(MetricsDirection::IEC104_TO_PIVOT, asduType, MetricsOutcome::SUPPRESSED_UNCHANGED);
                         }
                     }
-                    else {
-                        Iec104PivotUtility::log_debug("%s Asset '%s' not found in exchangedData, forwarding reading unchanged", //LCOV_EXCL_LINE
-                                            beforeLog.c_str(), assetName.c_str()); //LCOV_EXCL_LINE
-                        Datapoint* dpCopy = new Datapoint(dp->getName(),dp->getData());
-                        convertedDatapoints.push_back(dpCopy);
-                    }
                 }
-                else if (dp->getName() == "PIVOT") {
-                    Datapoint* convertedDp = convertDatapointToIEC104DataObject(dp);
+            }
 
-                    if (convertedDp) {
-                        convertedDatapoints.push_back(convertedDp);
-                    }
-                    else {
-                        Iec104PivotUtility::log_debug("%s PivotId not found in exchangedData, forwarding reading unchanged", //LCOV_EXCL_LINE
-                                                        beforeLog.c_str()); //LCOV_EXCL_LINE
-                        Datapoint* dpCopy = new Datapoint(dp->getName(),dp->getData());
-                        convertedDatapoints.push_back(dpCopy);
-                    }
-                }
-                else {
-                    Iec104PivotUtility::log_debug("%s Unhandled datapoint type '%s', forwarding reading unchanged", //LCOV_EXCL_LINE
-                                                    beforeLog.c_str(), dp->getName().c_str()); //LCOV_EXCL_LINE
-                    Datapoint* dpCopy = new Datapoint(dp->getName(),dp->getData());
-                    convertedDatapoints.push_back(dpCopy);
-                }
+            if (send) {
+                datapoints[kept++] = dp;
+            }
+            else {
+                m_pool.release(dp);
             }
         }
 
-        reading->removeAllDatapoints();
+        datapoints.resize(kept);
+        m_pendingReportStarts.push_back(m_pendingReports.size());
+    }
+}
 
-        for (Datapoint* convertedDatapoint : convertedDatapoints) {
-            reading->addDatapoint(convertedDatapoint);
+void
+IEC104PivotFilter::recordSentDataObjects()
+{
+    for (PendingReport& report : m_pendingReports) {
+        if (report.converted) {
+            report.definition->getReportState() = report.state;
         }
+    }
+
+    m_pendingReports.clear();
+    m_pendingReportIndexes.clear();
+}
 
-        Iec104PivotUtility::log_debug("%s converted Reading: (%s)", beforeLog.c_str(), reading->toJSON().c_str()); //LCOV_EXCL_LINE
+void
+IEC104PivotFilter::convertReadingOfSet(const IEC104PivotConfig& config, const RuntimeSettings& settings, std::vector<Reading*>& readings,
+                                       size_t i, DatapointPool& pool, MetricsShard& metrics,
+                                       const Iec104PivotUtility::ConversionClock& clock)
+{
+    PendingReport* pendingReports = nullptr;
+    size_t pendingReportCount = 0;
 
+    /* no pending reports when report by exception is disabled */
+    if (i + 1 < m_pendingReportStarts.size()) {
+        pendingReports = m_pendingReports.data() + m_pendingReportStarts[i];
+        pendingReportCount = m_pendingReportStarts[i + 1] - m_pendingReportStarts[i];
+    }
+
+    convertReading(config, settings, readings[i], pool, metrics, clock, pendingReports, pendingReportCount);
+}
 
-        if (reading->getReadingData().size() == 0) {
-            readIt = readings->erase(readIt);
+void
+IEC104PivotFilter::ingest(READINGSET* readingSet)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::ingest -"; //LCOV_EXCL_LINE
+    std::vector<Reading*>* readings = readingSet->getAllReadingsPtr();
+
+    {
+        /* the time spent by the next filters in m_output is not part of the ingest latency */
+        MetricsShard& metrics = m_metrics.getShard(0);
+        Iec104PivotUtility::ScopedLatency ingestLatency(metrics, MetricsLatency::INGEST);
+
+        /* the whole set is converted with the configuration current at this point, even if it is replaced meanwhile */
+        Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig>::Reader config = m_config.acquire();
+
+        /* the settings and the conversion threads they refer to stay alive until the set is converted */
+        Iec104PivotUtility::SnapshotPointer<RuntimeSettings>::Reader settings = m_settings.acquire();
+
+        Iec104PivotUtility::TimeSource timeSource = m_timeSource.load();
+
+        if (!timeSource) {
+            timeSource = (settings->clockMode == ClockMode::COARSE) ? Iec104PivotUtility::coarseRealtimeClockMs : Iec104PivotUtility::realtimeClockMs;
+        }
+
+        /* in batch mode the time of the objects without timestamp is sampled here, once for the whole set */
+        Iec104PivotUtility::ConversionClock clock(timeSource, settings->clockMode);
+
+        bool reportByException = settings->reportByException.isEnabled();
+
+        if (reportByException) {
+            suppressUnchangedDataObjects(*config, settings->reportByException, *readings, metrics, clock);
+        }
+        else {
+            m_pendingReportStarts.clear();
+        }
+
+        /* apply transformation */
+        if (settings->workers && readings->size() >= settings->parallelThreshold) {
+            convertReadingsInParallel(*config, *settings, *readings, clock);
         }
         else {
-            readIt++;
+            for (size_t i = 0; i < readings->size(); i++) {
+                convertReadingOfSet(*config, *settings, *readings, i, m_pool, metrics, clock);
+            }
+        }
+
+        /* only the objects actually converted are recorded as sent */
+        if (reportByException) {
+            recordSentDataObjects();
         }
+
+        /* readings left without datapoints are removed, the others keep their order */
+        readings->erase(std::remove_if(readings->begin(), readings->end(),
+                                       [](Reading* reading) {return reading->getReadingData().empty();}),
+                        readings->end());
     }
 
     if (readings->empty() == false)
     {
         if (m_output) {
-            Iec104PivotUtility::log_debug("%s Send %lu converted readings", beforeLog.c_str(), readings->size()); //LCOV_EXCL_LINE
+            Iec104PivotUtility::log_debug("%s Send %lu converted readings", beforeLog, readings->size()); //LCOV_EXCL_LINE
 
             m_output(m_outHandle, readingSet);
         }
         else {
-            Iec104PivotUtility::log_error("%s No function to call, discard %lu converted readings", beforeLog.c_str(), readings->size()); //LCOV_EXCL_LINE
+            Iec104PivotUtility::log_error("%s No function to call, discard %lu converted readings", beforeLog, readings->size()); //LCOV_EXCL_LINE
         }
     }
+
+    /* the suppressed warnings are summed up even when their key does not occur again */
+    Iec104PivotUtility::LogThrottle::flushExpired();
+}
+
+void
+IEC104PivotFilter::convertReadingsInParallel(const IEC104PivotConfig& config, const RuntimeSettings& settings, std::vector<Reading*>& readings,
+                                             const Iec104PivotUtility::ConversionClock& clock)
+{
+    ConversionWorkers& workers = *settings.workers;
+
+    /* a few chunks per worker so that workers finishing early can take over part of the work of the others */
+    size_t workerCount = workers.pool.getThreadCount() + 1;
+    size_t chunkSize = readings.size() / (workerCount * 4);
+
+    if (chunkSize < MIN_PARALLEL_CHUNK_SIZE) chunkSize = MIN_PARALLEL_CHUNK_SIZE;
+
+    /* each reading is converted in its own slot, which keeps the order of the set */
+    workers.pool.run(readings.size(), chunkSize, [this, &config, &settings, &workers, &readings, &clock](size_t begin, size_t end, size_t worker) {
+        DatapointPool& pool = (worker == 0) ? m_pool : *workers.datapointPools[worker - 1];
+        MetricsShard& metrics = m_metrics.getShard(worker);
+
+        for (size_t i = begin; i < end; i++) {
+            convertReadingOfSet(config, settings, readings, i, pool, metrics, clock);
+        }
+    });
 }
 
 void
 IEC104PivotFilter::reconfigure(ConfigCategory* config)
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotFilter::reconfigure -"; //LCOV_EXCL_LINE
-    Iec104PivotUtility::log_debug("%s (re)configure called", beforeLog.c_str()); //LCOV_EXCL_LINE
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::reconfigure -"; //LCOV_EXCL_LINE
+    Iec104PivotUtility::refreshLogLevel();
+    Iec104PivotUtility::log_debug("%s (re)configure called", beforeLog); //LCOV_EXCL_LINE
 
     if (config)
     {
+        if (config->itemExists("config_cache_dir")) {
+            m_configCacheDir = config->getValue("config_cache_dir");
+        }
+
         if (config->itemExists("exchanged_data")) {
             const std::string exchangedData = config->getValue("exchanged_data");
 
-            m_config.importExchangeConfig(exchangedData);
+            /* the new configuration is built aside, readings being converted keep using the previous one */
+            std::unique_ptr<IEC104PivotConfig> newConfig;
+
+            {
+                /* released before publishing, so that publish() deletes the previous configuration if ingest does not use it */
+                Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig>::Reader currentConfig = m_config.acquire();
+
+                if (currentConfig->isImportedFrom(exchangedData)) {
+                    Iec104PivotUtility::log_debug("%s exchanged_data unchanged", beforeLog); //LCOV_EXCL_LINE
+                }
+                else {
+                    newConfig = loadExchangeConfig(config->getName(), exchangedData, currentConfig.get());
+
+                    const ExchangeConfigChanges& changes = newConfig->getChanges();
+                    Iec104PivotUtility::log_info("%s exchanged_data: %lu added, %lu updated, %lu removed, %lu unchanged", beforeLog, //LCOV_EXCL_LINE
+                                                (unsigned long)changes.added, (unsigned long)changes.updated, //LCOV_EXCL_LINE
+                                                (unsigned long)changes.removed, (unsigned long)changes.unchanged); //LCOV_EXCL_LINE
+                }
+            }
+
+            if (newConfig) {
+                m_config.publish(std::move(newConfig));
+            }
         }
         else {
-            Iec104PivotUtility::log_error("%s Missing exchanged_data configuation", beforeLog.c_str()); //LCOV_EXCL_LINE
+            Iec104PivotUtility::log_error("%s Missing exchanged_data configuation", beforeLog); //LCOV_EXCL_LINE
+        }
+
+        if (config->itemExists("async_logging")) {
+            bool asyncLogging = (config->getValue("async_logging") == "true");
+
+            /* the sink is shared by the filter instances, each one counts once as a user */
+            if (asyncLogging != m_asyncLogging) {
+                if (asyncLogging) {
+                    Iec104PivotUtility::AsyncLogSink::getInstance().start();
+                }
+                else {
+                    Iec104PivotUtility::AsyncLogSink::getInstance().stop();
+                }
+
+                m_asyncLogging = asyncLogging;
+            }
+        }
+
+        /* the new settings are built aside from a copy of the current ones, ingest keeps using the current ones */
+        std::unique_ptr<RuntimeSettings> settings;
+
+        {
+            Iec104PivotUtility::SnapshotPointer<RuntimeSettings>::Reader currentSettings = m_settings.acquire();
+            settings.reset(new RuntimeSettings(*currentSettings));
+        }
+
+        if (config->itemExists("timestamp_clock")) {
+            if (!Iec104PivotUtility::parseClockMode(config->getValue("timestamp_clock"), settings->clockMode)) {
+                Iec104PivotUtility::log_error("%s Invalid timestamp_clock value '%s', expected batch, object or coarse", beforeLog, //LCOV_EXCL_LINE
+                                                config->getValue("timestamp_clock").c_str()); //LCOV_EXCL_LINE
+            }
+        }
+
+        if (config->itemExists("step_position_format")) {
+            if (!Iec104PivotUtility::parseStepPositionFormat(config->getValue("step_position_format"), settings->stepPositionFormat)) {
+                Iec104PivotUtility::log_error("%s Invalid step_position_format value '%s', expected string or structured", beforeLog, //LCOV_EXCL_LINE
+                                                config->getValue("step_position_format").c_str()); //LCOV_EXCL_LINE
+            }
+        }
+
+        if (config->itemExists("report_refresh_interval")) {
+            long interval = 0;
+
+            if (parseConfigInteger(config->getValue("report_refresh_interval"), interval) && interval >= 0) {
+                settings->reportByException.setRefreshIntervalMs((uint64_t)interval * 1000);
+            }
+            else {
+                Iec104PivotUtility::log_error("%s Invalid report_refresh_interval value '%s'", beforeLog, //LCOV_EXCL_LINE
+                                                config->getValue("report_refresh_interval").c_str()); //LCOV_EXCL_LINE
+            }
+        }
+
+        if (config->itemExists("report_compare_timestamp")) {
+            settings->reportByException.setCompareTimestamp(config->getValue("report_compare_timestamp") == "true");
+        }
+
+        if (config->itemExists("report_always_sent_cot")) {
+            uint64_t causes = 0;
+
+            if (Iec104PivotUtility::parseCauseList(config->getValue("report_always_sent_cot"), causes)) {
+                settings->reportByException.setAlwaysSentCauses(causes);
+            }
+            else {
+                Iec104PivotUtility::log_error("%s Invalid report_always_sent_cot value '%s', expected causes or ranges such as 20-41", //LCOV_EXCL_LINE
+                                                beforeLog, config->getValue("report_always_sent_cot").c_str()); //LCOV_EXCL_LINE
+            }
         }
+
+        if (config->itemExists("report_by_exception")) {
+            settings->reportByException.setEnabled(config->getValue("report_by_exception") == "true");
+        }
+
+        if (config->itemExists("parallel_threshold")) {
+            long threshold = 0;
+
+            if (parseConfigInteger(config->getValue("parallel_threshold"), threshold) && threshold > 0) {
+                settings->parallelThreshold = (size_t)threshold;
+            }
+            else {
+                Iec104PivotUtility::log_error("%s Invalid parallel_threshold value '%s'", beforeLog, //LCOV_EXCL_LINE
+                                                config->getValue("parallel_threshold").c_str()); //LCOV_EXCL_LINE
+            }
+        }
+
+        if (config->itemExists("conversion_threads")) {
+            long threadCount = 0;
+
+            if (parseConfigInteger(config->getValue("conversion_threads"), threadCount) &&
+                threadCount >= 0 && threadCount <= MAX_CONVERSION_THREADS) {
+                setConversionThreads(*settings, (int)threadCount);
+            }
+            else {
+                Iec104PivotUtility::log_error("%s Invalid conversion_threads value '%s', expected 0 to %d", beforeLog, //LCOV_EXCL_LINE
+                                                config->getValue("conversion_threads").c_str(), MAX_CONVERSION_THREADS); //LCOV_EXCL_LINE
+            }
+        }
+
+        /* the previous settings are deleted with the conversion threads they were the last ones to use once no
+           ingest uses them, by this call or by the next ingest */
+        m_settings.publish(std::move(settings));
     }
     else {
-        Iec104PivotUtility::log_error("%s No configuration provided", beforeLog.c_str()); //LCOV_EXCL_LINE
+        Iec104PivotUtility::log_error("%s No configuration provided", beforeLog); //LCOV_EXCL_LINE
+    }
+}
+
+static const char CONFIG_IMAGE_EXTENSION[] = ".cfgimg";
+
+/* Image files are named after the filter and the hash of the JSON they were compiled from */
+static std::string
+configImagePrefix(const std::string& filterName)
+{
+    std::string prefix;
+
+    for (char c : filterName) {
+        prefix += (isalnum((unsigned char)c) || c == '-' || c == '_') ? c : '_';
+    }
+
+    return prefix + "-";
+}
+
+/* Length of the hash in the image names, written as hexadecimal digits */
+static constexpr size_t CONFIG_IMAGE_HASH_LENGTH = 16;
+
+/* True for the names of the images of a filter: its prefix, the hash of the JSON, the extension. The names of the
+   filters whose name starts with the same characters have more characters between the prefix and the extension. */
+static bool
+isConfigImageName(const std::string& name, const std::string& prefix)
+{
+    const size_t extensionLength = sizeof(CONFIG_IMAGE_EXTENSION) - 1;
+
+    if (name.size() != prefix.size() + CONFIG_IMAGE_HASH_LENGTH + extensionLength) return false;
+    if (name.compare(0, prefix.size(), prefix) != 0) return false;
+    if (name.compare(name.size() - extensionLength, extensionLength, CONFIG_IMAGE_EXTENSION) != 0) return false;
+
+    for (size_t i = prefix.size(); i < prefix.size() + CONFIG_IMAGE_HASH_LENGTH; i++) {
+        if (!isxdigit((unsigned char)name[i])) return false;
+    }
+
+    return true;
+}
+
+static void
+removeStaleConfigImages(const std::string& directory, const std::string& prefix, const std::string& currentName)
+{
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) return;
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+
+        if (name != currentName && isConfigImageName(name, prefix)) {
+            unlink((directory + "/" + name).c_str());
+        }
     }
+
+    closedir(dir);
 }
 
-bool IEC104PivotFilter::hasASDUTimestamp(const std::string& asduType) {
-    return asduType[5] == 'T';
-}
\ No newline at end of file
+std::unique_ptr<IEC104PivotConfig>
+IEC104PivotFilter::loadExchangeConfig(const std::string& filterName, const std::string& exchangedData, const IEC104PivotConfig* previous)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::loadExchangeConfig -"; //LCOV_EXCL_LINE
+    std::unique_ptr<IEC104PivotConfig> config(new IEC104PivotConfig());
+
+    if (m_configCacheDir.empty()) {
+        config->importExchangeConfig(exchangedData, previous);
+        return config;
+    }
+
+    char hash[CONFIG_IMAGE_HASH_LENGTH + 1];
+    snprintf(hash, sizeof(hash), "%016llx",
+             (unsigned long long)ExchangeDefinitionIndex::hash(exchangedData.data(), exchangedData.size()));
+
+    std::string prefix = configImagePrefix(filterName);
+    std::string imageName = prefix + hash + CONFIG_IMAGE_EXTENSION;
+    std::string imagePath = m_configCacheDir + "/" + imageName;
+
+    if (config->loadImage(imagePath, exchangedData, previous)) {
+        Iec104PivotUtility::log_info("%s exchanged_data loaded from %s", beforeLog, imagePath.c_str()); //LCOV_EXCL_LINE
+        return config;
+    }
+
+    config->importExchangeConfig(exchangedData, previous);
+
+    /* an incomplete configuration is parsed again on each start, so that its errors are logged */
+    if (config->isComplete() && config->writeImage(imagePath)) {
+        removeStaleConfigImages(m_configCacheDir, prefix, imageName);
+    }
+
+    return config;
+}
+
+IEC104PivotFilter::ConversionWorkers::ConversionWorkers(int threadCount): pool(threadCount)
+{
+    for (int i = 0; i < threadCount; i++) {
+        datapointPools.push_back(std::unique_ptr<DatapointPool>(new DatapointPool()));
+    }
+}
+
+size_t
+IEC104PivotFilter::getConversionThreadCount() const
+{
+    Iec104PivotUtility::SnapshotPointer<RuntimeSettings>::Reader settings = m_settings.acquire();
+
+    return settings->workers ? settings->workers->pool.getThreadCount() : 0;
+}
+
+void
+IEC104PivotFilter::setConversionThreads(RuntimeSettings& settings, int threadCount)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotFilter::setConversionThreads -"; //LCOV_EXCL_LINE
+
+    size_t currentCount = settings.workers ? settings.workers->pool.getThreadCount() : 0;
+
+    if ((size_t)threadCount == currentCount) return;
+
+    /* the previous threads are only released here, the settings being replaced still hold them */
+    settings.workers.reset();
+
+    if (threadCount > 0) {
+        settings.workers = std::make_shared<ConversionWorkers>(threadCount);
+
+        Iec104PivotUtility::log_info("%s Reading sets of %lu readings or more converted with %d additional threads", beforeLog, //LCOV_EXCL_LINE
+                                        (unsigned long)settings.parallelThreshold, threadCount); //LCOV_EXCL_LINE
+    }
+    else {
+        Iec104PivotUtility::log_info("%s Parallel conversion disabled", beforeLog); //LCOV_EXCL_LINE
+    }
+}
@@ -9,28 +9,60 @@
  *
  */
 
-#include <rapidjson/document.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/error/en.h>
+#include <datapoint.h>
 
 #include "iec104_pivot_filter_config.hpp"
+#include "iec104_pivot_object.hpp"
 #include "iec104_pivot_utility.hpp"
 
 using namespace rapidjson;
 
-IEC104PivotDataPoint::IEC104PivotDataPoint(string label, string pivotId, string pivotType, string typeIdString, int ca, int ioa, string altMappingRule)
+IEC104PivotDataPoint::IEC104PivotDataPoint(const string& label, const string& pivotId, const string& pivotType, const string& typeIdString,
+                                           int ca, int ioa, const string& altMappingRule):
+    m_label(label),
+    m_pivotId(pivotId),
+    m_pivotType(pivotType),
+    m_typeIdStr(typeIdString),
+    m_typeId(Iec104PivotUtility::parseAsduType(typeIdString)),
+    m_ca(ca),
+    m_ioa(ioa),
+    m_alternateMappingRule(altMappingRule)
 {
-    m_label = label;
-    m_pivotId = pivotId;
-    m_pivotType = pivotType;
-    m_typeIdStr = typeIdString;
-    m_ca = ca;
-    m_ioa = ioa;
-    m_alternateMappingRule = altMappingRule;
+
+    /* built once per definition when the configuration is imported, never on the conversion path */
+    m_pivotTemplate = PivotObject::createPivotTemplate(this);
+
+    if (m_pivotTemplate) {
+        m_dataObjectTemplate = PivotDataObject::createIec104DataObjectTemplate(this);
+
+        if (m_typeIdStr.compare(0, 2, "C_") == 0) {
+            m_operationTemplate = PivotOperationObject::createIec104OperationObjectTemplate(this);
+        }
+    }
 }
 
-IEC104PivotDataPoint::~IEC104PivotDataPoint()
+bool
+IEC104PivotDataPoint::hasDefinition(const string& label, const string& pivotId, const string& pivotType, const string& typeIdString,
+                                    int ca, int ioa, const string& altMappingRule) const
 {
+    return m_ca == ca && m_ioa == ioa && m_label == label && m_pivotId == pivotId && m_pivotType == pivotType &&
+           m_typeIdStr == typeIdString && m_alternateMappingRule == altMappingRule;
+}
 
+IEC104PivotDataPoint::~IEC104PivotDataPoint()
+{
+    delete m_pivotTemplate;
+    delete m_dataObjectTemplate;
+    delete m_operationTemplate;
 }
 
 #define PROTOCOL_IEC104 "iec104"
@@ -38,129 +70,745 @@ IEC104PivotDataPoint::~IEC104PivotDataPoint()
 #define JSON_PROT_ADDR "address"
 #define JSON_PROT_TYPEID "typeid"
 
-IEC104PivotDataPoint*
-IEC104PivotConfig::getExchangeDefinitionsByLabel(std::string label) {
-    auto it = m_exchangeDefinitionsLabel.find(label);
-    if (it != m_exchangeDefinitionsLabel.end()) {
-        return it->second.get();
+uint64_t
+ExchangeDefinitionIndex::hash(const char* key, size_t length)
+{
+    /* FNV-1a */
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= static_cast<uint8_t>(key[i]);
+        hash *= 1099511628211ULL;
     }
-    else {
-        return nullptr;
+
+    return hash;
+}
+
+/*
+ * Smallest power of two capacity keeping the load factor of count entries under 1/2
+ */
+static size_t
+indexCapacity(size_t count)
+{
+    size_t capacity = 16;
+
+    while (capacity < count * 2) {
+        capacity *= 2;
     }
+
+    return capacity;
 }
 
-IEC104PivotDataPoint*
-IEC104PivotConfig::getExchangeDefinitionsByAddress(std::string address) {
-    auto it = m_exchangeDefinitionsAddress.find(address);
-    if (it != m_exchangeDefinitionsAddress.end()) {
-        return it->second.get();
+void
+ExchangeDefinitionIndex::insert(const std::string& key, uint64_t keyHash, const std::shared_ptr<IEC104PivotDataPoint>& dataPoint)
+{
+    /* keep the load factor under 1/2 so that probe sequences stay short */
+    if ((m_count + 1) * 2 > m_slots.size()) {
+        m_rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
     }
-    else {
-        return nullptr;
+
+    size_t mask = m_slots.size() - 1;
+
+    for (size_t i = keyHash & mask;; i = (i + 1) & mask) {
+        Slot& slot = m_slots[i];
+
+        if (!slot.dataPoint) {
+            slot.hash = keyHash;
+            slot.key = key;
+            slot.dataPoint = dataPoint;
+            m_count++;
+            return;
+        }
+
+        if (slot.hash == keyHash && slot.key == key) {
+            slot.dataPoint = dataPoint;
+            return;
+        }
     }
 }
 
 IEC104PivotDataPoint*
-IEC104PivotConfig::getExchangeDefinitionsByPivotId(std::string pivotid) {
-    auto it = m_exchangeDefinitionsPivotId.find(pivotid);
-    if (it != m_exchangeDefinitionsPivotId.end()) {
-        return it->second.get();
+ExchangeDefinitionIndex::find(const char* key, size_t length) const
+{
+    const Slot* slot = m_findSlot(key, length);
+
+    return slot ? slot->dataPoint.get() : nullptr;
+}
+
+std::shared_ptr<IEC104PivotDataPoint>
+ExchangeDefinitionIndex::findShared(const std::string& key) const
+{
+    const Slot* slot = m_findSlot(key.data(), key.size());
+
+    return slot ? slot->dataPoint : nullptr;
+}
+
+const ExchangeDefinitionIndex::Slot*
+ExchangeDefinitionIndex::m_findSlot(const char* key, size_t length) const
+{
+    if (m_count == 0) {
+        return nullptr;
     }
-    else {
+
+    uint64_t keyHash = hash(key, length);
+    size_t mask = m_slots.size() - 1;
+
+    for (size_t i = keyHash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = m_slots[i];
+
+        if (!slot.dataPoint) {
+            return nullptr;
+        }
+
+        if (slot.hash == keyHash && slot.key.size() == length && slot.key.compare(0, length, key, length) == 0) {
+            return &slot;
+        }
+    }
+}
+
+void
+ExchangeDefinitionIndex::reserve(size_t count)
+{
+    size_t capacity = indexCapacity(count);
+
+    if (capacity > m_slots.size()) {
+        m_rehash(capacity);
+    }
+}
+
+void
+ExchangeDefinitionIndex::clear()
+{
+    m_slots.clear();
+    m_count = 0;
+}
+
+void
+ExchangeDefinitionIndex::m_rehash(size_t capacity)
+{
+    std::vector<Slot> oldSlots(capacity);
+    oldSlots.swap(m_slots);
+
+    size_t mask = m_slots.size() - 1;
+
+    for (Slot& oldSlot : oldSlots) {
+        if (!oldSlot.dataPoint) continue;
+
+        size_t i = oldSlot.hash & mask;
+
+        while (m_slots[i].dataPoint) {
+            i = (i + 1) & mask;
+        }
+
+        m_slots[i].hash = oldSlot.hash;
+        m_slots[i].key.swap(oldSlot.key);
+        m_slots[i].dataPoint.swap(oldSlot.dataPoint);
+    }
+}
+
+uint64_t
+ExchangeAddressIndex::m_hash(uint64_t address)
+{
+    /* splitmix64 finalizer: consecutive IOAs must not end up in consecutive slots */
+    address ^= address >> 30;
+    address *= 0xbf58476d1ce4e5b9ULL;
+    address ^= address >> 27;
+    address *= 0x94d049bb133111ebULL;
+    address ^= address >> 31;
+    return address;
+}
+
+void
+ExchangeAddressIndex::insert(int ca, int ioa, const std::shared_ptr<IEC104PivotDataPoint>& dataPoint)
+{
+    /* keep the load factor under 1/2 so that probe sequences stay short */
+    if ((m_count + 1) * 2 > m_slots.size()) {
+        m_rehash(m_slots.empty() ? 16 : m_slots.size() * 2);
+    }
+
+    uint64_t address = packAddress(ca, ioa);
+    size_t mask = m_slots.size() - 1;
+
+    for (size_t i = m_hash(address) & mask;; i = (i + 1) & mask) {
+        Slot& slot = m_slots[i];
+
+        if (!slot.dataPoint) {
+            slot.address = address;
+            slot.dataPoint = dataPoint;
+            m_count++;
+            return;
+        }
+
+        if (slot.address == address) {
+            slot.dataPoint = dataPoint;
+            return;
+        }
+    }
+}
+
+IEC104PivotDataPoint*
+ExchangeAddressIndex::find(int ca, int ioa) const
+{
+    if (m_count == 0) {
         return nullptr;
     }
+
+    uint64_t address = packAddress(ca, ioa);
+    size_t mask = m_slots.size() - 1;
+
+    for (size_t i = m_hash(address) & mask;; i = (i + 1) & mask) {
+        const Slot& slot = m_slots[i];
+
+        if (!slot.dataPoint) {
+            return nullptr;
+        }
+
+        if (slot.address == address) {
+            return slot.dataPoint.get();
+        }
+    }
 }
 
 void
-IEC104PivotConfig::importExchangeConfig(const string& exchangeConfig)
+ExchangeAddressIndex::reserve(size_t count)
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotConfig::importExchangeConfig -"; //LCOV_EXCL_LINE
-    m_exchangeConfigComplete = false;
+    size_t capacity = indexCapacity(count);
 
-    m_deleteExchangeDefinitions();
+    if (capacity > m_slots.size()) {
+        m_rehash(capacity);
+    }
+}
 
-    Document document;
+void
+ExchangeAddressIndex::clear()
+{
+    m_slots.clear();
+    m_count = 0;
+}
 
-    if (document.Parse(const_cast<char*>(exchangeConfig.c_str())).HasParseError()) {
-        Iec104PivotUtility::log_fatal("%s Parsing error in exchanged_data json, offset %u: %s", beforeLog.c_str(), //LCOV_EXCL_LINE
-                                    static_cast<unsigned>(document.GetErrorOffset()), GetParseError_En(document.GetParseError())); //LCOV_EXCL_LINE
-        return;
+void
+ExchangeAddressIndex::m_rehash(size_t capacity)
+{
+    std::vector<Slot> oldSlots(capacity);
+    oldSlots.swap(m_slots);
+
+    size_t mask = m_slots.size() - 1;
+
+    for (Slot& oldSlot : oldSlots) {
+        if (!oldSlot.dataPoint) continue;
+
+        size_t i = m_hash(oldSlot.address) & mask;
+
+        while (m_slots[i].dataPoint) {
+            i = (i + 1) & mask;
+        }
+
+        m_slots[i].address = oldSlot.address;
+        m_slots[i].dataPoint.swap(oldSlot.dataPoint);
+    }
+}
+
+static bool
+isAddressBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+/*
+ * Parse a non negative decimal integer from the range [begin, end), at most 10 digits. Leading and trailing blanks
+ * and a leading '+' are skipped, as std::stoi did when the addresses were parsed with it.
+ */
+static bool
+parseAddressPart(const char* begin, const char* end, int& value)
+{
+    while (begin != end && isAddressBlank(*begin)) begin++;
+    while (begin != end && isAddressBlank(*(end - 1))) end--;
+
+    if (begin != end && *begin == '+') begin++;
+
+    if (begin == end || end - begin > 10) {
+        return false;
+    }
+
+    long long result = 0;
+
+    for (const char* c = begin; c != end; c++) {
+        if (*c < '0' || *c > '9') {
+            return false;
+        }
+        result = result * 10 + (*c - '0');
+    }
+
+    if (result > INT32_MAX) {
+        return false;
+    }
+
+    value = static_cast<int>(result);
+    return true;
+}
+
+IEC104PivotDataPoint*
+IEC104PivotConfig::getExchangeDefinitionsByAddress(const char* address, size_t length) const
+{
+    const char* end = address + length;
+    const char* sep = static_cast<const char*>(memchr(address, '-', length));
+
+    int ca = 0;
+    int ioa = 0;
+
+    if (sep == nullptr || !parseAddressPart(address, sep, ca) || !parseAddressPart(sep + 1, end, ioa)) {
+        return nullptr;
+    }
+
+    return m_exchangeDefinitionsAddress.find(ca, ioa);
+}
+
+/*
+ * SAX handler importing exchanged_data. The fields of a datapoint are kept in buffers reused from one datapoint to the
+ * next, its definitions are built when the datapoint ends, and the subtrees that are not used (other protocols,
+ * unknown members) are skipped without being stored.
+ */
+class ExchangeConfigParser : public BaseReaderHandler<UTF8<>, ExchangeConfigParser>
+{
+public:
+    ExchangeConfigParser(IEC104PivotConfig& config, const IEC104PivotConfig* previous): m_config(config), m_previous(previous) {};
+
+    /* the parsing was stopped by an invalid configuration, which has been logged */
+    bool isAborted() const {return m_aborted;};
+    bool isComplete() const {return m_level == Level::END;};
+
+    bool Key(const char* str, SizeType length, bool copy);
+    bool String(const char* str, SizeType length, bool copy);
+    bool StartObject();
+    bool EndObject(SizeType memberCount);
+    bool StartArray();
+    bool EndArray(SizeType elementCount);
+
+    /* numbers, booleans and null */
+    bool Default();
+
+private:
+    enum class Level {DOCUMENT, ROOT, EXCHANGED_DATA, DATAPOINTS, DATAPOINT, PROTOCOLS, PROTOCOL, OTHER_PROTOCOL, END};
+
+    enum class Field {NONE, EXCHANGED_DATA, DATAPOINTS, LABEL, PIVOT_ID, PIVOT_TYPE, PROTOCOLS, NAME, ADDRESS, TYPE_ID,
+                      ALTERNATE_MAPPING_RULE};
+
+    struct Protocol {
+        std::string address;
+        std::string typeId;
+        std::string alternateMappingRule;
+        bool hasAddress;
+        bool hasTypeId;
+    };
+
+    bool abort() {
+        m_aborted = true;
+        return false;
+    }
+
+    bool missingString(const char* key);
+    bool missingArray(const char* key);
+
+    /* value that is neither used nor expected at this place */
+    bool skipValue(bool compound);
+
+    bool endProtocol();
+    bool endDatapoint();
+
+    static bool equals(const char* str, SizeType length, const char* literal) {
+        return length == strlen(literal) && memcmp(str, literal, length) == 0;
     }
 
-    if (!document.IsObject()) return;
+    IEC104PivotConfig& m_config;
+    const IEC104PivotConfig* m_previous;
 
-    if (!m_check_object(document, "exchanged_data")) return;
+    Level m_level = Level::DOCUMENT;
+    Field m_field = Field::NONE;
+    unsigned m_skipDepth = 0;
+    bool m_aborted = false;
 
-    const Value& exchangeData = document["exchanged_data"];
+    bool m_hasExchangedData = false;
+    bool m_hasDatapoints = false;
 
-    if (!m_check_array(exchangeData, "datapoints")) return;
+    std::string m_label;
+    std::string m_pivotId;
+    std::string m_pivotType;
+    bool m_hasLabel = false;
+    bool m_hasPivotId = false;
+    bool m_hasPivotType = false;
+    bool m_hasProtocols = false;
+    bool m_hasProtocolName = false;
 
-    const Value& datapoints = exchangeData["datapoints"];
+    /* iec104 protocols of the current datapoint, the first m_protocolCount are used */
+    std::vector<Protocol> m_protocols;
+    size_t m_protocolCount = 0;
+};
 
-    for (const Value& datapoint : datapoints.GetArray())
-    {
-        if (!datapoint.IsObject()) return;
+bool
+ExchangeConfigParser::missingString(const char* key)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotConfig::importExchangeConfig -"; //LCOV_EXCL_LINE
+    Iec104PivotUtility::log_error("%s Error with the field %s, the value does not exist or is not a std::string.", beforeLog, key); //LCOV_EXCL_LINE
+    return abort();
+}
 
-        string label;
-        if (!m_retrieve(datapoint, "label", &label)) return;
+bool
+ExchangeConfigParser::missingArray(const char* key)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotConfig::importExchangeConfig -"; //LCOV_EXCL_LINE
+    Iec104PivotUtility::log_error("%s The array %s is required but not found.", beforeLog, key); //LCOV_EXCL_LINE
+    return abort();
+}
 
-        string pivotId;
-        if (!m_retrieve(datapoint, "pivot_id", &pivotId)) return;
+bool
+ExchangeConfigParser::skipValue(bool compound)
+{
+    /* the elements of datapoints and protocols must be objects, as must be the document */
+    if (m_level == Level::DOCUMENT || m_level == Level::DATAPOINTS || m_level == Level::PROTOCOLS) {
+        return abort();
+    }
 
-        string pivotType;
-        if (!m_retrieve(datapoint, "pivot_type", &pivotType)) return;
+    if (compound) m_skipDepth = 1;
 
-        if (!m_check_array(datapoint, "protocols")) return;
+    return true;
+}
 
-        for (const Value& protocol : datapoint["protocols"].GetArray()) {
+bool
+ExchangeConfigParser::Key(const char* str, SizeType length, bool copy)
+{
+    (void)copy;
 
-            if (!protocol.IsObject()) return;
-            
-            string protocolName;
-            if (!m_retrieve(protocol, JSON_PROT_NAME, &protocolName)) return;
+    if (m_skipDepth > 0) return true;
 
-            if (protocolName == PROTOCOL_IEC104)
-            {
-                string address;
-                if (!m_retrieve(protocol, JSON_PROT_ADDR, &address)) return;
+    m_field = Field::NONE;
 
-                string typeIdStr;
-                if (!m_retrieve(protocol, JSON_PROT_TYPEID, &typeIdStr)) return;
-                
-                string alternateMappingRule;
-                if (protocol.HasMember("alternate_mapping_rule")) {
-                    m_retrieve(protocol, "alternate_mapping_rule", &alternateMappingRule);
-                }
+    switch (m_level) {
+        case Level::ROOT:
+            if (equals(str, length, "exchanged_data")) m_field = Field::EXCHANGED_DATA;
+            break;
+        case Level::EXCHANGED_DATA:
+            if (equals(str, length, "datapoints")) m_field = Field::DATAPOINTS;
+            break;
+        case Level::DATAPOINT:
+            if (equals(str, length, "label")) m_field = Field::LABEL;
+            else if (equals(str, length, "pivot_id")) m_field = Field::PIVOT_ID;
+            else if (equals(str, length, "pivot_type")) m_field = Field::PIVOT_TYPE;
+            else if (equals(str, length, "protocols")) m_field = Field::PROTOCOLS;
+            break;
+        case Level::PROTOCOL:
+            if (equals(str, length, JSON_PROT_NAME)) m_field = Field::NAME;
+            else if (equals(str, length, JSON_PROT_ADDR)) m_field = Field::ADDRESS;
+            else if (equals(str, length, JSON_PROT_TYPEID)) m_field = Field::TYPE_ID;
+            else if (equals(str, length, "alternate_mapping_rule")) m_field = Field::ALTERNATE_MAPPING_RULE;
+            break;
+        default:
+            break;
+    }
 
-                size_t sepPos = address.find("-");
+    return true;
+}
 
-                if (sepPos != std::string::npos) {
-                    std::string caStr = address.substr(0, sepPos);
-                    std::string ioaStr = address.substr(sepPos + 1);
+bool
+ExchangeConfigParser::String(const char* str, SizeType length, bool copy)
+{
+    (void)copy;
 
-                    int ca = 0;
-                    int ioa = 0;
-                    try {
-                        ca = std::stoi(caStr);
-                        ioa = std::stoi(ioaStr);
-                    } catch (const std::invalid_argument &e) {
-                        Iec104PivotUtility::log_error("%s Cannot convert ca '%s' or ioa '%s' to integer: %s", //LCOV_EXCL_LINE
-                                                    beforeLog.c_str(), caStr.c_str(), ioaStr.c_str(), e.what()); //LCOV_EXCL_LINE
-                        return;
-                    } catch (const std::out_of_range &e) {
-                        Iec104PivotUtility::log_error("%s Cannot convert ca '%s' or ioa '%s' to integer: %s", //LCOV_EXCL_LINE
-                                                    beforeLog.c_str(), caStr.c_str(), ioaStr.c_str(), e.what()); //LCOV_EXCL_LINE
-                        return;
-                    }
+    if (m_skipDepth > 0) return true;
 
-                    auto newDp = std::make_shared<IEC104PivotDataPoint>(label, pivotId, pivotType, typeIdStr, ca, ioa, alternateMappingRule);
+    switch (m_field) {
+        case Field::LABEL:
+            m_label.assign(str, length);
+            m_hasLabel = true;
+            break;
+        case Field::PIVOT_ID:
+            m_pivotId.assign(str, length);
+            m_hasPivotId = true;
+            break;
+        case Field::PIVOT_TYPE:
+            m_pivotType.assign(str, length);
+            m_hasPivotType = true;
+            break;
+        case Field::NAME:
+            m_hasProtocolName = true;
 
-                    m_exchangeDefinitionsLabel[label] = newDp;
-                    m_exchangeDefinitionsAddress[address] = newDp;
-                    m_exchangeDefinitionsPivotId[pivotId] = newDp;
-                }
+            /* nothing else is read from the other protocols */
+            if (!equals(str, length, PROTOCOL_IEC104)) {
+                m_level = Level::OTHER_PROTOCOL;
+                m_skipDepth = 1;
             }
+            break;
+        case Field::ADDRESS:
+            m_protocols[m_protocolCount].address.assign(str, length);
+            m_protocols[m_protocolCount].hasAddress = true;
+            break;
+        case Field::TYPE_ID:
+            m_protocols[m_protocolCount].typeId.assign(str, length);
+            m_protocols[m_protocolCount].hasTypeId = true;
+            break;
+        case Field::ALTERNATE_MAPPING_RULE:
+            m_protocols[m_protocolCount].alternateMappingRule.assign(str, length);
+            break;
+        default:
+            return skipValue(false);
+    }
+
+    m_field = Field::NONE;
+
+    return true;
+}
+
+bool
+ExchangeConfigParser::Default()
+{
+    if (m_skipDepth > 0) return true;
+
+    m_field = Field::NONE;
+
+    return skipValue(false);
+}
+
+bool
+ExchangeConfigParser::StartObject()
+{
+    if (m_skipDepth > 0) {
+        m_skipDepth++;
+        return true;
+    }
+
+    if (m_level == Level::DOCUMENT) {
+        m_level = Level::ROOT;
+    }
+    else if (m_level == Level::ROOT && m_field == Field::EXCHANGED_DATA) {
+        m_level = Level::EXCHANGED_DATA;
+        m_hasExchangedData = true;
+    }
+    else if (m_level == Level::DATAPOINTS) {
+        m_level = Level::DATAPOINT;
+        m_hasLabel = m_hasPivotId = m_hasPivotType = m_hasProtocols = false;
+        m_protocolCount = 0;
+    }
+    else if (m_level == Level::PROTOCOLS) {
+        m_level = Level::PROTOCOL;
+        m_hasProtocolName = false;
+
+        if (m_protocols.size() == m_protocolCount) m_protocols.push_back(Protocol());
+
+        Protocol& protocol = m_protocols[m_protocolCount];
+        protocol.alternateMappingRule.clear();
+        protocol.hasAddress = protocol.hasTypeId = false;
+    }
+    else {
+        m_field = Field::NONE;
+        return skipValue(true);
+    }
+
+    m_field = Field::NONE;
+
+    return true;
+}
+
+bool
+ExchangeConfigParser::EndObject(SizeType memberCount)
+{
+    (void)memberCount;
+
+    if (m_skipDepth > 0) {
+        if (--m_skipDepth == 0 && m_level == Level::OTHER_PROTOCOL) m_level = Level::PROTOCOLS;
+        return true;
+    }
+
+    switch (m_level) {
+        case Level::PROTOCOL:
+            m_level = Level::PROTOCOLS;
+            return endProtocol();
+        case Level::DATAPOINT:
+            m_level = Level::DATAPOINTS;
+            return endDatapoint();
+        case Level::EXCHANGED_DATA:
+            m_level = Level::ROOT;
+            return m_hasDatapoints || missingArray("datapoints");
+        case Level::ROOT:
+            m_level = Level::END;
+            return m_hasExchangedData || missingArray("exchanged_data");
+        default:
+            return abort();
+    }
+}
+
+bool
+ExchangeConfigParser::StartArray()
+{
+    if (m_skipDepth > 0) {
+        m_skipDepth++;
+        return true;
+    }
+
+    if (m_level == Level::EXCHANGED_DATA && m_field == Field::DATAPOINTS) {
+        m_level = Level::DATAPOINTS;
+        m_hasDatapoints = true;
+    }
+    else if (m_level == Level::DATAPOINT && m_field == Field::PROTOCOLS) {
+        m_level = Level::PROTOCOLS;
+        m_hasProtocols = true;
+    }
+    else {
+        m_field = Field::NONE;
+        return skipValue(true);
+    }
+
+    m_field = Field::NONE;
+
+    return true;
+}
+
+bool
+ExchangeConfigParser::EndArray(SizeType elementCount)
+{
+    (void)elementCount;
+
+    if (m_skipDepth > 0) {
+        m_skipDepth--;
+        return true;
+    }
+
+    if (m_level == Level::PROTOCOLS) {
+        m_level = Level::DATAPOINT;
+    }
+    else if (m_level == Level::DATAPOINTS) {
+        m_level = Level::EXCHANGED_DATA;
+    }
+    else {
+        return abort();
+    }
+
+    return true;
+}
+
+bool
+ExchangeConfigParser::endProtocol()
+{
+    if (!m_hasProtocolName) return missingString(JSON_PROT_NAME);
+
+    Protocol& protocol = m_protocols[m_protocolCount];
+
+    if (!protocol.hasAddress) return missingString(JSON_PROT_ADDR);
+    if (!protocol.hasTypeId) return missingString(JSON_PROT_TYPEID);
+
+    m_protocolCount++;
+
+    return true;
+}
+
+bool
+ExchangeConfigParser::endDatapoint()
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotConfig::importExchangeConfig -"; //LCOV_EXCL_LINE
+
+    if (!m_hasLabel) return missingString("label");
+    if (!m_hasPivotId) return missingString("pivot_id");
+    if (!m_hasPivotType) return missingString("pivot_type");
+    if (!m_hasProtocols) return missingArray("protocols");
+
+    uint64_t labelHash = ExchangeDefinitionIndex::hash(m_label.data(), m_label.size());
+    uint64_t pivotIdHash = ExchangeDefinitionIndex::hash(m_pivotId.data(), m_pivotId.size());
+
+    for (size_t i = 0; i < m_protocolCount; i++) {
+        const Protocol& protocol = m_protocols[i];
+        const char* address = protocol.address.data();
+        const char* sep = static_cast<const char*>(memchr(address, '-', protocol.address.size()));
+
+        /* an address without separator is not an iec104 address */
+        if (sep == nullptr) continue;
+
+        int ca = 0;
+        int ioa = 0;
+
+        if (!parseAddressPart(address, sep, ca) || !parseAddressPart(sep + 1, address + protocol.address.size(), ioa)) {
+            Iec104PivotUtility::log_error("%s Cannot convert address '%s' of %s to ca and ioa", //LCOV_EXCL_LINE
+                                          beforeLog, protocol.address.c_str(), m_label.c_str()); //LCOV_EXCL_LINE
+            return abort();
+        }
+
+        m_config.m_addDefinition(m_label, labelHash, m_pivotId, pivotIdHash, m_pivotType, protocol.typeId, ca, ioa,
+                                 protocol.alternateMappingRule, m_previous);
+    }
+
+    return true;
+}
+
+bool
+IEC104PivotConfig::isImportedFrom(const string& exchangeConfig) const
+{
+    return m_sourceImported && m_sourceSize == exchangeConfig.size() &&
+           m_sourceHash == ExchangeDefinitionIndex::hash(exchangeConfig.data(), exchangeConfig.size());
+}
+
+void
+IEC104PivotConfig::importExchangeConfig(const string& exchangeConfig, const IEC104PivotConfig* previous)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotConfig::importExchangeConfig -"; //LCOV_EXCL_LINE
+    m_exchangeConfigComplete = false;
+    m_changes = ExchangeConfigChanges();
+
+    m_deleteExchangeDefinitions();
+
+    m_sourceImported = true;
+    m_sourceSize = exchangeConfig.size();
+    m_sourceHash = ExchangeDefinitionIndex::hash(exchangeConfig.data(), exchangeConfig.size());
+
+    ExchangeConfigParser parser(*this, previous);
+    Reader reader;
+    StringStream stream(exchangeConfig.c_str());
+
+    if (reader.Parse(stream, parser).IsError()) {
+        if (!parser.isAborted()) {
+            Iec104PivotUtility::log_fatal("%s Parsing error in exchanged_data json, offset %u: %s", beforeLog, //LCOV_EXCL_LINE
+                                        static_cast<unsigned>(reader.GetErrorOffset()), GetParseError_En(reader.GetParseErrorCode())); //LCOV_EXCL_LINE
+
+            /* as when the whole document was parsed first, an invalid JSON gives no definition */
+            m_deleteExchangeDefinitions();
+            m_changes = ExchangeConfigChanges();
         }
+        return;
+    }
+
+    if (!parser.isComplete()) return;
+
+    m_finishImport(previous);
+}
+
+void
+IEC104PivotConfig::m_addDefinition(const string& label, uint64_t labelHash, const string& pivotId, uint64_t pivotIdHash, const string& pivotType,
+                                   const string& typeIdStr, int ca, int ioa, const string& alternateMappingRule, const IEC104PivotConfig* previous)
+{
+    /* a definition unchanged since the previous configuration is shared with it, with its templates */
+    std::shared_ptr<IEC104PivotDataPoint> newDp = previous ? previous->m_exchangeDefinitionsLabel.findShared(label) : nullptr;
+
+    if (!newDp) {
+        newDp = std::make_shared<IEC104PivotDataPoint>(label, pivotId, pivotType, typeIdStr, ca, ioa, alternateMappingRule);
+        m_changes.added++;
+    }
+    else if (!newDp->hasDefinition(label, pivotId, pivotType, typeIdStr, ca, ioa, alternateMappingRule)) {
+        newDp = std::make_shared<IEC104PivotDataPoint>(label, pivotId, pivotType, typeIdStr, ca, ioa, alternateMappingRule);
+        m_changes.updated++;
+    }
+    else {
+        m_changes.unchanged++;
+    }
+
+    m_exchangeDefinitionsLabel.insert(label, labelHash, newDp);
+    m_exchangeDefinitionsAddress.insert(ca, ioa, newDp);
+    m_exchangeDefinitionsPivotId.insert(pivotId, pivotIdHash, newDp);
+    m_definitions.push_back(newDp);
+}
+
+void
+IEC104PivotConfig::m_finishImport(const IEC104PivotConfig* previous)
+{
+    if (previous) {
+        size_t kept = m_changes.updated + m_changes.unchanged;
+        size_t previousCount = previous->m_exchangeDefinitionsLabel.size();
+        m_changes.removed = previousCount > kept ? previousCount - kept : 0;
     }
 
     m_exchangeConfigComplete = true;
@@ -172,41 +820,255 @@ IEC104PivotConfig::m_deleteExchangeDefinitions()
     m_exchangeDefinitionsLabel.clear();
     m_exchangeDefinitionsAddress.clear();
     m_exchangeDefinitionsPivotId.clear();
+    m_definitions.clear();
 }
 
-bool IEC104PivotConfig::m_check_string(const rapidjson::Value& json, const char* key) {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotConfig::m_check_string -"; //LCOV_EXCL_LINE
-    if (!json.HasMember(key) || !json[key].IsString()) {
-        Iec104PivotUtility::log_error("%s Error with the field %s, the value does not exist or is not a std::string.", beforeLog.c_str(), key); //LCOV_EXCL_LINE
-        return false;
+/*
+ * Binary image of a compiled configuration: a header, then entryCount entries, then the string pool.
+ * Integers are in the byte order of the machine that wrote the image, which is only read back by the same host.
+ */
+namespace {
+
+const char IMAGE_MAGIC[8] = {'I', '1', '0', '4', 'P', 'V', 'C', 'F'};
+
+struct ImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint64_t entryCount;
+    uint64_t stringPoolSize;
+    uint64_t payloadChecksum;
+};
+
+struct ImageString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct ImageEntry {
+    uint64_t labelHash;
+    uint64_t pivotIdHash;
+    ImageString label;
+    ImageString pivotId;
+    ImageString pivotType;
+    ImageString typeId;
+    ImageString alternateMappingRule;
+    int32_t ca;
+    int32_t ioa;
+};
+
+/*
+ * Read-only mapping of a whole file, unmapped on destruction
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+
+        struct stat fileStat;
+
+        if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+            void* data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (data != MAP_FAILED) {
+                m_data = static_cast<const char*>(data);
+                m_size = (size_t)fileStat.st_size;
+            }
+        }
+
+        close(fd);
     }
+
+    ~MappedFile() {
+        if (m_data) munmap(const_cast<char*>(m_data), m_size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const {return m_data;};
+    size_t size() const {return m_size;};
+
+private:
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+bool
+appendImageString(std::string& pool, const std::string& value, ImageString& imageString)
+{
+    if (pool.size() + value.size() > UINT32_MAX) return false;
+
+    imageString.offset = (uint32_t)pool.size();
+    imageString.length = (uint32_t)value.size();
+    pool += value;
+
     return true;
 }
 
-bool IEC104PivotConfig::m_check_array(const rapidjson::Value& json, const char* key) {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotConfig::m_check_array -"; //LCOV_EXCL_LINE
-    if (!json.HasMember(key) || !json[key].IsArray()) {
-        Iec104PivotUtility::log_error("%s The array %s is required but not found.", beforeLog.c_str(), key); //LCOV_EXCL_LINE
+bool
+isValidImageString(const ImageString& imageString, uint64_t poolSize)
+{
+    return (uint64_t)imageString.offset + imageString.length <= poolSize;
+}
+
+}
+
+constexpr uint32_t IEC104PivotConfig::IMAGE_VERSION;
+
+bool
+IEC104PivotConfig::writeImage(const std::string& path) const
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotConfig::writeImage -"; //LCOV_EXCL_LINE
+
+    if (!m_exchangeConfigComplete || !m_sourceImported) return false;
+
+    std::vector<ImageEntry> entries(m_definitions.size());
+    std::string pool;
+
+    for (size_t i = 0; i < m_definitions.size(); i++) {
+        IEC104PivotDataPoint& definition = *m_definitions[i];
+        ImageEntry& entry = entries[i];
+
+        entry.labelHash = ExchangeDefinitionIndex::hash(definition.getLabel().data(), definition.getLabel().size());
+        entry.pivotIdHash = ExchangeDefinitionIndex::hash(definition.getPivotId().data(), definition.getPivotId().size());
+        entry.ca = definition.getCA();
+        entry.ioa = definition.getIOA();
+
+        if (!appendImageString(pool, definition.getLabel(), entry.label) ||
+            !appendImageString(pool, definition.getPivotId(), entry.pivotId) ||
+            !appendImageString(pool, definition.getPivotType(), entry.pivotType) ||
+            !appendImageString(pool, definition.getTypeId(), entry.typeId) ||
+            !appendImageString(pool, definition.getAlternateMappingRule(), entry.alternateMappingRule)) {
+            Iec104PivotUtility::log_warn("%s String pool too large for an image", beforeLog); //LCOV_EXCL_LINE
+            return false;
+        }
+    }
+
+    ImageHeader header;
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.version = IMAGE_VERSION;
+    header.entrySize = sizeof(ImageEntry);
+    header.sourceHash = m_sourceHash;
+    header.sourceSize = m_sourceSize;
+    header.entryCount = entries.size();
+    header.stringPoolSize = pool.size();
+
+    uint64_t checksum = ExchangeDefinitionIndex::hash(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(ImageEntry));
+    header.payloadChecksum = checksum ^ ExchangeDefinitionIndex::hash(pool.data(), pool.size());
+
+    /* written aside then renamed, so that a reader never maps a partly written image */
+    std::string temporaryPath = path + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+
+    if (!file) {
+        Iec104PivotUtility::log_warn("%s Cannot create %s: %s", beforeLog, temporaryPath.c_str(), strerror(errno)); //LCOV_EXCL_LINE
         return false;
     }
-    return true;
-}
 
-bool IEC104PivotConfig::m_check_object(const rapidjson::Value& json, const char* key) {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotConfig::m_check_object -"; //LCOV_EXCL_LINE
-    if (!json.HasMember(key) || !json[key].IsObject()) {
-        Iec104PivotUtility::log_error("%s The array %s is required but not found.", beforeLog.c_str(), key); //LCOV_EXCL_LINE
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   (entries.empty() || fwrite(entries.data(), sizeof(ImageEntry), entries.size(), file) == entries.size()) &&
+                   (pool.empty() || fwrite(pool.data(), 1, pool.size(), file) == pool.size());
+
+    if (fclose(file) != 0) written = false;
+
+    if (!written || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        Iec104PivotUtility::log_warn("%s Cannot write %s: %s", beforeLog, path.c_str(), strerror(errno)); //LCOV_EXCL_LINE
+        unlink(temporaryPath.c_str());
         return false;
     }
+
     return true;
 }
 
-bool IEC104PivotConfig::m_retrieve(const rapidjson::Value& json, const char* key, std::string* target) {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - IEC104PivotConfig::m_retrieve -"; //LCOV_EXCL_LINE
-    if (!json.HasMember(key) || !json[key].IsString()) {
-        Iec104PivotUtility::log_error("%s Error with the field %s, the value does not exist or is not a std::string.", beforeLog.c_str(), key); //LCOV_EXCL_LINE
+bool
+IEC104PivotConfig::loadImage(const std::string& path, const string& exchangeConfig, const IEC104PivotConfig* previous)
+{
+    constexpr const char* beforeLog = PLUGIN_NAME " - IEC104PivotConfig::loadImage -"; //LCOV_EXCL_LINE
+    m_exchangeConfigComplete = false;
+    m_sourceImported = false;
+    m_changes = ExchangeConfigChanges();
+
+    m_deleteExchangeDefinitions();
+
+    MappedFile image(path);
+
+    if (!image.data()) return false;
+
+    uint64_t sourceHash = ExchangeDefinitionIndex::hash(exchangeConfig.data(), exchangeConfig.size());
+
+    if (image.size() < sizeof(ImageHeader)) {
+        Iec104PivotUtility::log_warn("%s Image %s truncated, ignored", beforeLog, path.c_str()); //LCOV_EXCL_LINE
+        return false;
+    }
+
+    ImageHeader header;
+    memcpy(&header, image.data(), sizeof(header));
+
+    if (memcmp(header.magic, IMAGE_MAGIC, sizeof(header.magic)) != 0 || header.version != IMAGE_VERSION ||
+        header.entrySize != sizeof(ImageEntry)) {
+        Iec104PivotUtility::log_warn("%s Image %s has another format, ignored", beforeLog, path.c_str()); //LCOV_EXCL_LINE
+        return false;
+    }
+
+    if (header.sourceHash != sourceHash || header.sourceSize != exchangeConfig.size()) {
+        Iec104PivotUtility::log_info("%s Image %s compiled from another exchanged_data, ignored", beforeLog, path.c_str()); //LCOV_EXCL_LINE
+        return false;
+    }
+
+    size_t payloadSize = image.size() - sizeof(ImageHeader);
+
+    if (header.entryCount > payloadSize / sizeof(ImageEntry) ||
+        header.stringPoolSize != payloadSize - header.entryCount * sizeof(ImageEntry)) {
+        Iec104PivotUtility::log_warn("%s Image %s has an invalid size, ignored", beforeLog, path.c_str()); //LCOV_EXCL_LINE
         return false;
     }
-    *target = json[key].GetString();
+
+    const char* entryData = image.data() + sizeof(ImageHeader);
+    const char* pool = entryData + header.entryCount * sizeof(ImageEntry);
+
+    uint64_t checksum = ExchangeDefinitionIndex::hash(entryData, header.entryCount * sizeof(ImageEntry)) ^
+                        ExchangeDefinitionIndex::hash(pool, header.stringPoolSize);
+
+    if (checksum != header.payloadChecksum) {
+        Iec104PivotUtility::log_warn("%s Image %s is damaged, ignored", beforeLog, path.c_str()); //LCOV_EXCL_LINE
+        return false;
+    }
+
+    m_exchangeDefinitionsLabel.reserve(header.entryCount);
+    m_exchangeDefinitionsAddress.reserve(header.entryCount);
+    m_exchangeDefinitionsPivotId.reserve(header.entryCount);
+    m_definitions.reserve(header.entryCount);
+
+    for (uint64_t i = 0; i < header.entryCount; i++) {
+        ImageEntry entry;
+        memcpy(&entry, entryData + i * sizeof(ImageEntry), sizeof(entry));
+
+        if (!isValidImageString(entry.label, header.stringPoolSize) || !isValidImageString(entry.pivotId, header.stringPoolSize) ||
+            !isValidImageString(entry.pivotType, header.stringPoolSize) || !isValidImageString(entry.typeId, header.stringPoolSize) ||
+            !isValidImageString(entry.alternateMappingRule, header.stringPoolSize)) {
+            Iec104PivotUtility::log_warn("%s Image %s has an invalid entry, ignored", beforeLog, path.c_str()); //LCOV_EXCL_LINE
+            m_deleteExchangeDefinitions();
+            m_changes = ExchangeConfigChanges();
+            return false;
+        }
+
+        m_addDefinition(std::string(pool + entry.label.offset, entry.label.length), entry.labelHash,
+                        std::string(pool + entry.pivotId.offset, entry.pivotId.length), entry.pivotIdHash,
+                        std::string(pool + entry.pivotType.offset, entry.pivotType.length),
+                        std::string(pool + entry.typeId.offset, entry.typeId.length), entry.ca, entry.ioa,
+                        std::string(pool + entry.alternateMappingRule.offset, entry.alternateMappingRule.length), previous);
+    }
+
+    m_sourceImported = true;
+    m_sourceSize = exchangeConfig.size();
+    m_sourceHash = sourceHash;
+
+    m_finishImport(previous);
+
     return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,215 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter asynchronous log sink.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include <chrono>
+#include <cstdio>
+
+#include "iec104_pivot_log_sink.hpp"
+
+using namespace Iec104PivotUtility;
+
+std::atomic<bool> Iec104PivotUtility::asyncLogEnabled(false);
+
+bool Iec104PivotUtility::enqueueAsyncLog(LogLevel level, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    bool queued = AsyncLogSink::getInstance().enqueue(level, format, args);
+    va_end(args);
+    return queued;
+}
+
+constexpr size_t AsyncLogSink::CAPACITY;
+constexpr size_t AsyncLogSink::MESSAGE_SIZE;
+
+AsyncLogSink&
+AsyncLogSink::getInstance()
+{
+    static AsyncLogSink instance;
+    return instance;
+}
+
+AsyncLogSink::AsyncLogSink():
+    m_enqueuePos(0),
+    m_written(0),
+    m_dropped(0),
+    m_activeProducers(0),
+    m_stopRequested(false)
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+
+    m_buffer = new Record[CAPACITY];
+
+    for (size_t i = 0; i < CAPACITY; i++) {
+        m_buffer[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+    /* at exit the records of the users still registered are written */
+    {
+        std::lock_guard<std::mutex> guard(m_controlMutex);
+        m_users = (m_users > 0) ? 1 : 0;
+    }
+
+    stop();
+    delete[] m_buffer;
+}
+
+void
+AsyncLogSink::start()
+{
+    std::lock_guard<std::mutex> guard(m_controlMutex);
+
+    if (m_users++ > 0) return;
+
+    m_stopRequested.store(false);
+    m_thread = std::thread(&AsyncLogSink::run, this);
+    asyncLogEnabled.store(true);
+}
+
+void
+AsyncLogSink::stop()
+{
+    std::lock_guard<std::mutex> guard(m_controlMutex);
+
+    if (m_users == 0 || --m_users > 0) return;
+
+    /* new records go to the synchronous path from now on, the thread writes what is still queued */
+    asyncLogEnabled.store(false);
+    m_stopRequested.store(true);
+    m_thread.join();
+}
+
+bool
+AsyncLogSink::enqueue(LogLevel level, const char* format, va_list args)
+{
+    /* the producer is counted before it checks that the sink runs: stop() clears the flag before the writer thread
+       waits for the producers, so a producer either sees the sink stopped or is waited for (both are seq_cst) */
+    m_activeProducers.fetch_add(1);
+
+    /* records queued while no writer thread runs would only be written after the next start() */
+    if (!asyncLogEnabled.load()) {
+        m_activeProducers.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    push(level, format, args);
+
+    m_activeProducers.fetch_sub(1, std::memory_order_release);
+
+    /* a record dropped by push() is reported by the writer thread, it must not be logged synchronously as well */
+    return true;
+}
+
+void
+AsyncLogSink::push(LogLevel level, const char* format, va_list args)
+{
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Record* record = nullptr;
+
+    for (;;) {
+        record = &m_buffer[pos & (CAPACITY - 1)];
+        size_t sequence = record->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            /* buffer full: drop the record rather than blocking the caller */
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    record->level = level;
+    vsnprintf(record->message, MESSAGE_SIZE, format, args);
+    record->sequence.store(pos + 1, std::memory_order_release);
+}
+
+size_t
+AsyncLogSink::drain()
+{
+    size_t count = 0;
+
+    for (;;) {
+        Record& record = m_buffer[m_dequeuePos & (CAPACITY - 1)];
+
+        if (record.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) break;
+
+        switch (record.level) {
+            case LogLevel::DEBUG:
+                Logger::getLogger()->debug("%s", record.message);
+                break;
+            case LogLevel::INFO:
+                Logger::getLogger()->info("%s", record.message);
+                break;
+            case LogLevel::WARNING:
+                Logger::getLogger()->warn("%s", record.message);
+                break;
+            case LogLevel::ERROR:
+                Logger::getLogger()->error("%s", record.message);
+                break;
+            case LogLevel::FATAL:
+                Logger::getLogger()->fatal("%s", record.message);
+                break;
+        }
+
+        record.sequence.store(m_dequeuePos + CAPACITY, std::memory_order_release);
+        m_dequeuePos++;
+        count++;
+    }
+
+    if (count > 0) {
+        m_written.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    return count;
+}
+
+void
+AsyncLogSink::reportDropped()
+{
+    uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+
+    if (dropped != m_droppedReported) {
+        Logger::getLogger()->warn("%s - AsyncLogSink - Log buffer overflow, %lu records dropped (%lu in total)", PLUGIN_NAME,
+                                  static_cast<unsigned long>(dropped - m_droppedReported), static_cast<unsigned long>(dropped));
+        m_droppedReported = dropped;
+    }
+}
+
+void
+AsyncLogSink::run()
+{
+    while (!m_stopRequested.load()) {
+        if (drain() == 0) {
+            reportDropped();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    /* a producer that saw the sink enabled just before stop() may still be publishing its record */
+    while (m_activeProducers.load() != 0) {
+        drain();
+        std::this_thread::yield();
+    }
+
+    drain();
+    reportDropped();
+}
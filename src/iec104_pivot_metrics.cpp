@@ -0,0 +1,235 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter runtime metrics.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include <cstdlib>
+#include <new>
+
+#include "iec104_pivot_metrics.hpp"
+
+using namespace Iec104PivotUtility;
+
+constexpr unsigned LatencyBuckets::SUB_BUCKET_BITS;
+constexpr unsigned LatencyBuckets::MAX_EXPONENT;
+constexpr size_t LatencyBuckets::COUNT;
+constexpr size_t MetricsSnapshot::COUNTER_COUNT;
+constexpr size_t MetricsShard::CACHE_LINE_SIZE;
+
+const char*
+Iec104PivotUtility::metricsDirectionToString(MetricsDirection direction)
+{
+    switch (direction) {
+        case MetricsDirection::IEC104_TO_PIVOT: return "iec104_to_pivot";
+        case MetricsDirection::PIVOT_TO_IEC104: return "pivot_to_iec104";
+        default: return "unknown";
+    }
+}
+
+const char*
+Iec104PivotUtility::metricsOutcomeToString(MetricsOutcome outcome)
+{
+    switch (outcome) {
+        case MetricsOutcome::CONVERTED: return "converted";
+        case MetricsOutcome::PASSTHROUGH: return "passthrough";
+        case MetricsOutcome::TYPE_MISMATCH: return "type_mismatch";
+        case MetricsOutcome::DROPPED_INVALID: return "dropped_invalid";
+        case MetricsOutcome::DROPPED_UNKNOWN_ADDRESS: return "dropped_unknown_address";
+        case MetricsOutcome::DROPPED_NOT_FROM_IEC104: return "dropped_not_from_iec104";
+        case MetricsOutcome::SUPPRESSED_UNCHANGED: return "suppressed_unchanged";
+        default: return "unknown";
+    }
+}
+
+const char*
+Iec104PivotUtility::metricsLatencyToString(MetricsLatency latency)
+{
+    switch (latency) {
+        case MetricsLatency::INGEST: return "ingest";
+        case MetricsLatency::CONVERT_DATA_OBJECT_TO_PIVOT: return "convertDataObjectToPivot";
+        case MetricsLatency::CONVERT_OPERATION_OBJECT_TO_PIVOT: return "convertOperationObjectToPivot";
+        case MetricsLatency::CONVERT_PIVOT_TO_DATA_OBJECT: return "convertDatapointToIEC104DataObject";
+        case MetricsLatency::CONVERT_PIVOT_TO_OPERATION_OBJECT: return "convertReadingToIEC104OperationObject";
+        default: return "unknown";
+    }
+}
+
+size_t
+LatencyBuckets::indexOf(uint64_t valueNs)
+{
+    if (valueNs < (1u << SUB_BUCKET_BITS)) return (size_t)valueNs;
+
+    unsigned exponent = 63 - (unsigned)__builtin_clzll(valueNs);
+
+    if (exponent > MAX_EXPONENT) return COUNT - 1;
+
+    /* the bits following the leading one select the sub-bucket */
+    size_t subBucket = (size_t)(valueNs >> (exponent - SUB_BUCKET_BITS)) & ((1u << SUB_BUCKET_BITS) - 1);
+
+    return ((size_t)(exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) | subBucket;
+}
+
+uint64_t
+LatencyBuckets::lowerBound(size_t index)
+{
+    if (index < (1u << SUB_BUCKET_BITS)) return index;
+
+    unsigned exponent = (unsigned)(index >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = index & ((1u << SUB_BUCKET_BITS) - 1);
+
+    return ((1ull << SUB_BUCKET_BITS) | subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t
+LatencyHistogram::getPercentileNs(double quantile) const
+{
+    if (m_count == 0) return 0;
+
+    uint64_t rank = (uint64_t)(quantile * (double)m_count);
+    if (rank >= m_count) rank = m_count - 1;
+
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+        seen += m_buckets[i];
+
+        if (seen > rank) {
+            uint64_t upperBound = (i + 1 < m_buckets.size()) ? LatencyBuckets::lowerBound(i + 1) - 1 : m_maxNs;
+            return upperBound < m_maxNs ? upperBound : m_maxNs;
+        }
+    }
+
+    return m_maxNs;
+}
+
+MetricsSnapshot::MetricsSnapshot():
+    m_counters(COUNTER_COUNT, 0),
+    m_latencies((size_t)MetricsLatency::COUNT)
+{
+}
+
+uint64_t
+MetricsSnapshot::getTotal(MetricsDirection direction, MetricsOutcome outcome) const
+{
+    uint64_t total = 0;
+
+    for (size_t type = 0; type < (size_t)Iec104AsduType::COUNT; type++) {
+        total += getCount(direction, (Iec104AsduType)type, outcome);
+    }
+
+    return total;
+}
+
+MetricsShard::MetricsShard()
+{
+    /* std::atomic is not zero-initialized by its default constructor */
+    for (std::atomic<uint64_t>& counter : m_counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+
+    for (Histogram& histogram : m_latencies) {
+        for (std::atomic<uint64_t>& bucket : histogram.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.sumNs.store(0, std::memory_order_relaxed);
+        histogram.maxNs.store(0, std::memory_order_relaxed);
+    }
+}
+
+void
+MetricsShard::recordLatency(MetricsLatency latency, uint64_t valueNs)
+{
+    Histogram& histogram = m_latencies[(size_t)latency];
+
+    increment(histogram.buckets[LatencyBuckets::indexOf(valueNs)], 1);
+    increment(histogram.count, 1);
+    increment(histogram.sumNs, valueNs);
+
+    if (valueNs > histogram.maxNs.load(std::memory_order_relaxed)) {
+        histogram.maxNs.store(valueNs, std::memory_order_relaxed);
+    }
+}
+
+MetricsRegistry::MetricsRegistry(size_t maxShards):
+    m_shards(new std::atomic<MetricsShard*>[maxShards]),
+    m_maxShards(maxShards)
+{
+    for (size_t i = 0; i < m_maxShards; i++) {
+        m_shards[i].store(nullptr);
+    }
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    for (size_t i = 0; i < m_maxShards; i++) {
+        MetricsShard* shard = m_shards[i].load();
+
+        if (shard) {
+            shard->~MetricsShard();
+            free(shard);
+        }
+    }
+}
+
+MetricsShard&
+MetricsRegistry::createShard(size_t worker)
+{
+    /* operator new does not honour the alignment of over-aligned types before C++17 */
+    void* memory = nullptr;
+
+    if (posix_memalign(&memory, MetricsShard::CACHE_LINE_SIZE, sizeof(MetricsShard)) != 0) {
+        throw std::bad_alloc();
+    }
+
+    MetricsShard* shard = new (memory) MetricsShard();
+    MetricsShard* expected = nullptr;
+
+    if (!m_shards[worker].compare_exchange_strong(expected, shard, std::memory_order_acq_rel)) {
+        shard->~MetricsShard();
+        free(shard);
+        return *expected;
+    }
+
+    return *shard;
+}
+
+MetricsSnapshot
+MetricsRegistry::snapshot() const
+{
+    MetricsSnapshot snapshot;
+
+    for (size_t i = 0; i < m_maxShards; i++) {
+        const MetricsShard* shard = m_shards[i].load(std::memory_order_acquire);
+
+        if (!shard) continue;
+
+        for (size_t counter = 0; counter < MetricsSnapshot::COUNTER_COUNT; counter++) {
+            snapshot.m_counters[counter] += shard->m_counters[counter].load(std::memory_order_relaxed);
+        }
+
+        for (size_t latency = 0; latency < (size_t)MetricsLatency::COUNT; latency++) {
+            const MetricsShard::Histogram& source = shard->m_latencies[latency];
+            LatencyHistogram& histogram = snapshot.m_latencies[latency];
+
+            for (size_t bucket = 0; bucket < LatencyBuckets::COUNT; bucket++) {
+                histogram.m_buckets[bucket] += source.buckets[bucket].load(std::memory_order_relaxed);
+            }
+
+            histogram.m_count += source.count.load(std::memory_order_relaxed);
+            histogram.m_sumNs += source.sumNs.load(std::memory_order_relaxed);
+
+            uint64_t maxNs = source.maxNs.load(std::memory_order_relaxed);
+            if (maxNs > histogram.m_maxNs) histogram.m_maxNs = maxNs;
+        }
+    }
+
+    return snapshot;
+}
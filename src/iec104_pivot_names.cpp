@@ -0,0 +1,111 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter names and constant values of the converted trees.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include "iec104_pivot_names.hpp"
+
+/* defined in a single translation unit: they are built when the plugin library is loaded, before any conversion */
+namespace Iec104PivotNames {
+
+/* pivot tree */
+const std::string PIVOT("PIVOT");
+const std::string GTIS("GTIS");
+const std::string GTIM("GTIM");
+const std::string GTIC("GTIC");
+const std::string SpsTyp("SpsTyp");
+const std::string MvTyp("MvTyp");
+const std::string DpsTyp("DpsTyp");
+const std::string SpcTyp("SpcTyp");
+const std::string DpcTyp("DpcTyp");
+const std::string IncTyp("IncTyp");
+const std::string ApcTyp("ApcTyp");
+const std::string BscTyp("BscTyp");
+const std::string Identifier("Identifier");
+const std::string ComingFrom("ComingFrom");
+const std::string Cause("Cause");
+const std::string Confirmation("Confirmation");
+const std::string TmOrg("TmOrg");
+const std::string TmValidity("TmValidity");
+const std::string Select("Select");
+const std::string stVal("stVal");
+const std::string ctlVal("ctlVal");
+const std::string mag("mag");
+const std::string f("f");
+const std::string i("i");
+const std::string valWtr("valWtr");
+const std::string posVal("posVal");
+const std::string transInd("transInd");
+const std::string q("q");
+const std::string Validity("Validity");
+const std::string Source("Source");
+const std::string DetailQuality("DetailQuality");
+const std::string badReference("badReference");
+const std::string failure("failure");
+const std::string inconsistent("inconsistent");
+const std::string inaccurate("inaccurate");
+const std::string oldData("oldData");
+const std::string oscillatory("oscillatory");
+const std::string outOfRange("outOfRange");
+const std::string overflow("overflow");
+const std::string operatorBlocked("operatorBlocked");
+const std::string test("test");
+const std::string t("t");
+const std::string SecondSinceEpoch("SecondSinceEpoch");
+const std::string FractionOfSecond("FractionOfSecond");
+const std::string TimeQuality("TimeQuality");
+const std::string clockFailure("clockFailure");
+const std::string clockNotSynchronized("clockNotSynchronized");
+const std::string leapSecondKnown("leapSecondKnown");
+const std::string timeAccuracy("timeAccuracy");
+
+/* IEC 104 data object */
+const std::string data_object("data_object");
+const std::string do_type("do_type");
+const std::string do_ca("do_ca");
+const std::string do_ioa("do_ioa");
+const std::string do_cot("do_cot");
+const std::string do_test("do_test");
+const std::string do_negative("do_negative");
+const std::string do_value("do_value");
+const std::string do_comingfrom("do_comingfrom");
+const std::string do_quality_iv("do_quality_iv");
+const std::string do_quality_bl("do_quality_bl");
+const std::string do_quality_ov("do_quality_ov");
+const std::string do_quality_sb("do_quality_sb");
+const std::string do_quality_nt("do_quality_nt");
+const std::string do_ts("do_ts");
+const std::string do_ts_iv("do_ts_iv");
+const std::string do_ts_su("do_ts_su");
+const std::string do_ts_sub("do_ts_sub");
+
+/* IEC 104 command object */
+const std::string command_object("command_object");
+const std::string co_type("co_type");
+const std::string co_ca("co_ca");
+const std::string co_ioa("co_ioa");
+const std::string co_cot("co_cot");
+const std::string co_test("co_test");
+const std::string co_negative("co_negative");
+const std::string co_se("co_se");
+const std::string co_value("co_value");
+const std::string co_comingfrom("co_comingfrom");
+const std::string co_ts("co_ts");
+
+/* values */
+const std::string iec104("iec104");
+const std::string good("good");
+const std::string invalid("invalid");
+const std::string questionable("questionable");
+const std::string reserved("reserved");
+const std::string process("process");
+const std::string substituted("substituted");
+const std::string genuine("genuine");
+
+}
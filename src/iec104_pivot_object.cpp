@@ -11,15 +11,26 @@
 
 
 #include <sys/time.h>
+#include <string>
+#include <unordered_map>
 #include <datapoint.h>
 
+#include "iec104_pivot_clock.hpp"
+#include "iec104_pivot_datapoint_pool.hpp"
 #include "iec104_pivot_filter_config.hpp"
+#include "iec104_pivot_names.hpp"
 #include "iec104_pivot_object.hpp"
 #include "iec104_pivot_utility.hpp"
 
+namespace Names = Iec104PivotNames;
+
 static Datapoint*
-createDp(const string& name)
+createDp(DatapointPool* pool, const string& name)
 {
+    if (pool) {
+        return pool->createDict(name);
+    }
+
     vector<Datapoint*>* datapoints = new vector<Datapoint*>;
 
     DatapointValue dpv(datapoints, true);
@@ -31,8 +42,12 @@ createDp(const string& name)
 
 template <class T>
 static Datapoint*
-createDpWithValue(const string& name, const T value)
+createDpWithValue(DatapointPool* pool, const string& name, const T value)
 {
+    if (pool) {
+        return pool->createValue(name, value);
+    }
+
     DatapointValue dpv(value);
 
     Datapoint* dp = new Datapoint(name, dpv);
@@ -41,13 +56,24 @@ createDpWithValue(const string& name, const T value)
 }
 
 static Datapoint*
-addElement(Datapoint* dp, const string& name)
+cloneDp(DatapointPool* pool, Datapoint* source)
+{
+    if (pool) {
+        return pool->clone(source);
+    }
+
+    /* DatapointValue copies are deep: the clone shares nothing with the source */
+    return new Datapoint(source->getName(), source->getData());
+}
+
+static Datapoint*
+addElement(DatapointPool* pool, Datapoint* dp, const string& name)
 {
     DatapointValue& dpv = dp->getData();
 
     std::vector<Datapoint*>* subDatapoints = dpv.getDpVec();
 
-    Datapoint* element = createDp(name);
+    Datapoint* element = createDp(pool, name);
 
     if (element) {
        subDatapoints->push_back(element);
@@ -58,13 +84,13 @@ addElement(Datapoint* dp, const string& name)
 
 template <class T>
 static Datapoint*
-addElementWithValue(Datapoint* dp, const string& name, const T value)
+addElementWithValue(DatapointPool* pool, Datapoint* dp, const string& name, const T value)
 {
     DatapointValue& dpv = dp->getData();
 
     std::vector<Datapoint*>* subDatapoints = dpv.getDpVec();
 
-    Datapoint* element = createDpWithValue(name, value);
+    Datapoint* element = createDpWithValue(pool, name, value);
 
     if (element) {
        subDatapoints->push_back(element);
@@ -94,136 +120,81 @@ getChild(Datapoint* dp, const string& name)
     return childDp;
 }
 
-static const string
-getValueStr(Datapoint* dp)
+static PivotParseStatus
+readValueStr(Datapoint* dp, string& out)
 {
     DatapointValue& dpv = dp->getData();
 
-    if (dpv.getType() == DatapointValue::T_STRING) {
-        return dpv.toStringValue();
-    }
-    else {
-        throw PivotObjectException("datapoint " + dp->getName() + " has not a string value");
+    if (dpv.getType() != DatapointValue::T_STRING) {
+        return PivotParseStatus(PivotParseStatus::NOT_A_STRING, dp);
     }
-}
 
-static const string
-getChildValueStr(Datapoint* dp, const string& name)
-{
-    Datapoint* childDp = getChild(dp, name);
+    out = dpv.toStringValue();
 
-    if (childDp) {
-        return getValueStr(childDp);
-    }
-    else {
-        throw PivotObjectException("No such child: " + name);
-    }
+    return PivotParseStatus();
 }
 
-static long
-getValueInt(Datapoint* dp)
+static PivotParseStatus
+readValueInt(Datapoint* dp, long& out)
 {
     DatapointValue& dpv = dp->getData();
 
-    if (dpv.getType() == DatapointValue::T_INTEGER) {
-        return dpv.toInt();
+    if (dpv.getType() != DatapointValue::T_INTEGER) {
+        return PivotParseStatus(PivotParseStatus::NOT_AN_INT, dp);
     }
-    else {
-        throw PivotObjectException("datapoint " + dp->getName() + " has not an int value");
-    }
-}
 
-static int
-getChildValueInt(Datapoint* dp, const string& name)
-{
-    Datapoint* childDp = getChild(dp, name);
+    out = dpv.toInt();
 
-    if (childDp) {
-        return getValueInt(childDp);
-    }
-    else {
-        throw PivotObjectException("No such child: " + name);
-    }
+    return PivotParseStatus();
 }
 
-static float
-getValueFloat(Datapoint* dp)
+static PivotParseStatus
+readValueFlag(Datapoint* dp, bool& out)
 {
-    DatapointValue& dpv = dp->getData();
-
-    if (dpv.getType() == DatapointValue::T_FLOAT) {
-        return (float) dpv.toDouble();
-    }
-    else {
-        throw PivotObjectException("datapoint " + dp->getName() + " has not a float value");
-    }
-}
-
-void
-PivotTimestamp::setTimeInMs(long ms){
-    uint32_t timeval32 = (uint32_t) (ms/ 1000LL);
+    long value = 0;
+    PivotParseStatus status = readValueInt(dp, value);
 
-    m_valueArray[0] = (timeval32 / 0x1000000 & 0xff);
-    m_valueArray[1] = (timeval32 / 0x10000 & 0xff);
-    m_valueArray[2] = (timeval32 / 0x100 & 0xff);
-    m_valueArray[3] = (timeval32 & 0xff);
+    if (status.ok()) out = (value > 0);
 
-    uint32_t remainder = (ms % 1000LL);
-    uint32_t fractionOfSecond = (remainder) * 16777 + ((remainder * 216) / 1000);
-
-    m_valueArray[4] = ((fractionOfSecond >> 16) & 0xff);
-    m_valueArray[5] = ((fractionOfSecond >> 8) & 0xff);
-    m_valueArray[6] = (fractionOfSecond & 0xff);
+    return status;
 }
 
-uint64_t
-PivotTimestamp::getTimeInMs(){
-    uint32_t timeval32;
-
-    timeval32 = m_valueArray[3];
-    timeval32 += m_valueArray[2] * 0x100;
-    timeval32 += m_valueArray[1] * 0x10000;
-    timeval32 += m_valueArray[0] * 0x1000000;
-
-    uint32_t fractionOfSecond = 0;
-
-    fractionOfSecond = (m_valueArray[4] << 16);
-    fractionOfSecond += (m_valueArray[5] << 8);
-    fractionOfSecond += (m_valueArray[6]);
+static PivotParseStatus
+readValueFloat(Datapoint* dp, float& out)
+{
+    DatapointValue& dpv = dp->getData();
 
-    uint32_t remainder = fractionOfSecond / 16777;
+    if (dpv.getType() != DatapointValue::T_FLOAT) {
+        return PivotParseStatus(PivotParseStatus::NOT_A_FLOAT, dp);
+    }
 
-    uint64_t msVal = (timeval32 * 1000LL) + remainder;
+    out = (float) dpv.toDouble();
 
-    return (uint64_t) msVal;
+    return PivotParseStatus();
 }
 
-int
-PivotTimestamp::FractionOfSecond(){
-    uint32_t fractionOfSecond = 0;
+constexpr size_t PivotTimestamp::ENCODED_SIZE;
 
-    fractionOfSecond = (m_valueArray[4] << 16);
-    fractionOfSecond += (m_valueArray[5] << 8);
-    fractionOfSecond += (m_valueArray[6]);
-
-    return fractionOfSecond;
+void
+PivotTimestamp::encodeTimesInMs(const long* ms, uint8_t* values, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        encodeTimeInMs(ms[i], values + i * ENCODED_SIZE);
+    }
 }
 
-int
-PivotTimestamp::SecondSinceEpoch(){
-    int32_t timeval32;
-
-    timeval32 = m_valueArray[3];
-    timeval32 += m_valueArray[2] * 0x100;
-    timeval32 += m_valueArray[1] * 0x10000;
-    timeval32 += m_valueArray[0] * 0x1000000;
-
-    return timeval32;
+void
+PivotTimestamp::decodeTimesInMs(const uint8_t* values, uint64_t* ms, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        ms[i] = decodeTimeInMs(values + i * ENCODED_SIZE);
+    }
 }
 
-void
+PivotParseStatus
 PivotTimestamp::handleTimeQuality(Datapoint* timeQuality)
 {
+    PivotParseStatus status;
     DatapointValue& dpv = timeQuality->getData();
 
     if (dpv.getType() == DatapointValue::T_DP_DICT)
@@ -232,35 +203,44 @@ PivotTimestamp::handleTimeQuality(Datapoint* timeQuality)
 
         for (Datapoint* child : *datapoints)
         {
-            if (child->getName() == "clockFailure") {
-                if (getValueInt(child) > 0)
-                    m_clockFailure = true;
-                else
-                    m_clockFailure = false;
+            const std::string& name = child->getName();
+
+            if (name == Names::clockFailure) {
+                status = readValueFlag(child, m_clockFailure);
             }
-            else if (child->getName() == "clockNotSynchronized") {
-                if (getValueInt(child) > 0)
-                    m_clockNotSynchronized = true;
-                else
-                    m_clockNotSynchronized = false;
+            else if (name == Names::clockNotSynchronized) {
+                status = readValueFlag(child, m_clockNotSynchronized);
             }
-            else if (child->getName() == "leapSecondKnown") {
-                if (getValueInt(child) > 0)
-                    m_leapSecondKnown = true;
-                else
-                    m_leapSecondKnown = false;
+            else if (name == Names::leapSecondKnown) {
+                status = readValueFlag(child, m_leapSecondKnown);
             }
-            else if (child->getName() == "timeAccuracy") {
-                m_timeAccuracy = getValueInt(child);
+            else if (name == Names::timeAccuracy) {
+                long timeAccuracy = 0;
+                status = readValueInt(child, timeAccuracy);
+                if (status.ok()) m_timeAccuracy = (int)timeAccuracy;
             }
+
+            if (!status.ok()) return status;
         }
     }
+
+    return status;
 }
 
 PivotTimestamp::PivotTimestamp(Datapoint* timestampData)
 {
+    PivotParseStatus status = parse(timestampData);
+
+    if (!status.ok()) {
+        throw PivotObjectException(status.toString());
+    }
+}
+
+PivotParseStatus
+PivotTimestamp::parse(Datapoint* timestampData)
+{
+    PivotParseStatus status;
     DatapointValue& dpv = timestampData->getData();
-    m_valueArray = new uint8_t[7];
 
     if (dpv.getType() == DatapointValue::T_DP_DICT)
     {
@@ -268,131 +248,404 @@ PivotTimestamp::PivotTimestamp(Datapoint* timestampData)
 
         for (Datapoint* child : *datapoints)
         {
-            if (child->getName() == "SecondSinceEpoch") {
-                uint32_t secondSinceEpoch = getValueInt(child);
+            const std::string& name = child->getName();
+            long value = 0;
+
+            if (name == Names::SecondSinceEpoch) {
+                status = readValueInt(child, value);
+                uint32_t secondSinceEpoch = (uint32_t)value;
 
-                m_valueArray[0] = (secondSinceEpoch / 0x1000000 & 0xff);
-                m_valueArray[1] = (secondSinceEpoch / 0x10000 & 0xff);
-                m_valueArray[2] = (secondSinceEpoch / 0x100 & 0xff);
-                m_valueArray[3] = (secondSinceEpoch & 0xff);
+                m_valueArray[0] = (uint8_t)(secondSinceEpoch >> 24);
+                m_valueArray[1] = (uint8_t)(secondSinceEpoch >> 16);
+                m_valueArray[2] = (uint8_t)(secondSinceEpoch >> 8);
+                m_valueArray[3] = (uint8_t)secondSinceEpoch;
             }
-            else if (child->getName() == "FractionOfSecond") {
-                uint32_t fractionOfSecond = getValueInt(child);
+            else if (name == Names::FractionOfSecond) {
+                status = readValueInt(child, value);
+                uint32_t fractionOfSecond = (uint32_t)value;
 
-                m_valueArray[4] = ((fractionOfSecond >> 16) & 0xff);
-                m_valueArray[5] = ((fractionOfSecond >> 8) & 0xff);
-                m_valueArray[6] = (fractionOfSecond & 0xff);
+                m_valueArray[4] = (uint8_t)(fractionOfSecond >> 16);
+                m_valueArray[5] = (uint8_t)(fractionOfSecond >> 8);
+                m_valueArray[6] = (uint8_t)fractionOfSecond;
             }
-            else if (child->getName() == "TimeQuality") {
-                handleTimeQuality(child);
+            else if (name == Names::TimeQuality) {
+                status = handleTimeQuality(child);
             }
+
+            if (!status.ok()) return status;
         }
     }
+
+    return status;
 }
 
 PivotTimestamp::PivotTimestamp(long ms)
 {
-    m_valueArray = new uint8_t[7];
-    uint32_t timeval32 = (uint32_t) (ms/ 1000LL);
+    encodeTimeInMs(ms, m_valueArray);
+}
 
-    m_valueArray[0] = (timeval32 / 0x1000000 & 0xff);
-    m_valueArray[1] = (timeval32 / 0x10000 & 0xff);
-    m_valueArray[2] = (timeval32 / 0x100 & 0xff);
-    m_valueArray[3] = (timeval32 & 0xff);
+uint64_t
+PivotTimestamp::GetCurrentTimeInMs()
+{
+    struct timeval now;
 
-    uint32_t remainder = (ms % 1000LL);
-    uint32_t fractionOfSecond = (remainder) * 16777 + ((remainder * 216) / 1000);
+    gettimeofday(&now, nullptr);
 
-    m_valueArray[4] = ((fractionOfSecond >> 16) & 0xff);
-    m_valueArray[5] = ((fractionOfSecond >> 8) & 0xff);
-    m_valueArray[6] = (fractionOfSecond & 0xff);
+    return ((uint64_t) now.tv_sec * 1000LL) + (now.tv_usec / 1000);
 }
 
-PivotTimestamp::~PivotTimestamp()
+namespace {
+
+struct ElementRule {
+    int parent;                 /* element searched in, -1 for the PIVOT root */
+    const std::string* name;    /* nullptr for the logical node and the CDC, which have several possible names */
+};
+
+constexpr int ROOT = -1;
+constexpr uint8_t ABSENT = 0xff;
+constexpr size_t MAX_PLAN_ELEMENTS = 32;
+
+/* names of the shape key are taken down to the children of the CDC, the deepest elements of the plan */
+constexpr int SHAPE_KEY_DEPTH = 3;
+
+/* a thread parsing more distinct shapes starts over with an empty cache */
+constexpr size_t MAX_SHAPE_PLANS = 256;
+
+const std::string* const lnNames[] = {&Names::GTIS, &Names::GTIM, &Names::GTIC};
+const PivotObject::PivotClass lnClasses[] = {PivotObject::GTIS, PivotObject::GTIM, PivotObject::GTIC};
+
+const std::string* const cdcNames[] = {&Names::SpsTyp, &Names::MvTyp, &Names::DpsTyp, &Names::SpcTyp, &Names::DpcTyp,
+                                       &Names::IncTyp, &Names::ApcTyp, &Names::BscTyp};
+const PivotObject::PivotCdc cdcTypes[] = {PivotObject::SPS, PivotObject::MV, PivotObject::DPS, PivotObject::SPC,
+                                          PivotObject::DPC, PivotObject::INC, PivotObject::APC, PivotObject::BSC};
+
+/*
+ * Child index of each element, the same for all the trees of a shape
+ */
+struct ShapePlan {
+    uint8_t index[MAX_PLAN_ELEMENTS];
+    PivotObject::PivotClass pivotClass;
+    PivotObject::PivotCdc pivotCdc;
+};
+
+struct ShapePlanCache {
+    std::unordered_map<std::string, ShapePlan> plans;
+    /* reused for each tree so that computing the key does not allocate */
+    std::string key;
+};
+
+/* one cache per thread, conversion threads parse without sharing anything */
+thread_local ShapePlanCache shapePlanCache;
+
+/*
+ * Append the names of the children of a node and of their descendants down to depth, with markers for the
+ * start and end of each dictionary so that trees with the same key have the same structure
+ */
+void
+appendShape(std::string& key, Datapoint* dp, int depth)
 {
-    delete[] m_valueArray;
+    DatapointValue& dpv = dp->getData();
+
+    if (dpv.getType() != DatapointValue::T_DP_DICT) return;
+
+    key += '\x01';
+
+    for (Datapoint* child : *dpv.getDpVec()) {
+        key += child->getName();
+        key += '\0';
+
+        if (depth > 1) appendShape(key, child, depth - 1);
+    }
+
+    key += '\x02';
 }
 
-uint64_t
-PivotTimestamp::GetCurrentTimeInMs()
+/* Index of the first child with one of the names, -1 if none */
+int
+findChild(Datapoint* dp, const std::string* const* names, size_t nameCount, size_t& nameIndex)
 {
-    struct timeval now;
+    DatapointValue& dpv = dp->getData();
 
-    gettimeofday(&now, nullptr);
+    if (dpv.getType() != DatapointValue::T_DP_DICT) return -1;
 
-    return ((uint64_t) now.tv_sec * 1000LL) + (now.tv_usec / 1000);
+    std::vector<Datapoint*>* datapoints = dpv.getDpVec();
+
+    for (size_t i = 0; i < datapoints->size(); i++) {
+        const std::string& name = (*datapoints)[i]->getName();
+
+        for (nameIndex = 0; nameIndex < nameCount; nameIndex++) {
+            if (name == *names[nameIndex]) return (int)i;
+        }
+    }
+
+    return -1;
 }
 
-Datapoint*
-PivotObject::getCdc(Datapoint* dp)
+std::string
+childNames(Datapoint* dp)
+{
+    std::vector<std::string> names;
+    DatapointValue& dpv = dp->getData();
+
+    if (dpv.getType() == DatapointValue::T_DP_DICT) {
+        for (Datapoint* child : *dpv.getDpVec()) {
+            names.push_back(child->getName());
+        }
+    }
+
+    return Iec104PivotUtility::join(names);
+}
+
+}
+
+std::string
+PivotParseStatus::toString() const
+{
+    switch (m_reason) {
+        case OK:
+            return "ok";
+        case NOT_PIVOT:
+            return "No pivot object";
+        case NOT_A_DICT:
+            return "pivot object not found";
+        case UNSUPPORTED_TYPE:
+            return "pivot object type not supported: " + childNames(m_dp);
+        case MISSING_CHILD:
+            return std::string("No such child: ") + m_name;
+        case NOT_A_STRING:
+            return "datapoint " + m_dp->getName() + " has not a string value";
+        case NOT_AN_INT:
+            return "datapoint " + m_dp->getName() + " has not an int value";
+        case NOT_A_FLOAT:
+            return "datapoint " + m_dp->getName() + " has not a float value";
+        case CDC_MISSING:
+            return "CDC type missing";
+        case CDC_UNKNOWN:
+            return "CDC type unknown: " + childNames(m_dp);
+        case CDC_UNSUPPORTED:
+            return "CDC type unknown";
+        case INVALID_VALIDITY:
+            return "Validity has invalid value " + m_dp->getData().toStringValue();
+        case INVALID_SOURCE:
+            return "Source has invalid value " + m_dp->getData().toStringValue();
+    }
+
+    return "unknown error"; //LCOV_EXCL_LINE
+}
+
+size_t
+PivotObject::getShapePlanCount()
+{
+    return shapePlanCache.plans.size();
+}
+
+void
+PivotObject::findElements(Datapoint* pivotData, bool operation, Datapoint* (&elements)[ELEMENT_COUNT])
+{
+    /* parents are listed before their children */
+    static const ElementRule rules[ELEMENT_COUNT] = {
+        {ROOT, nullptr},                    /* LN */
+        {LN, &Names::Identifier},           /* IDENTIFIER */
+        {LN, &Names::ComingFrom},           /* COMING_FROM */
+        {LN, &Names::Cause},                /* CAUSE */
+        {CAUSE, &Names::stVal},             /* CAUSE_ST_VAL */
+        {LN, &Names::Confirmation},         /* CONFIRMATION */
+        {CONFIRMATION, &Names::stVal},      /* CONFIRMATION_ST_VAL */
+        {LN, &Names::TmOrg},                /* TM_ORG */
+        {TM_ORG, &Names::stVal},            /* TM_ORG_ST_VAL */
+        {LN, &Names::TmValidity},           /* TM_VALIDITY */
+        {TM_VALIDITY, &Names::stVal},       /* TM_VALIDITY_ST_VAL */
+        {LN, &Names::Select},               /* SELECT */
+        {SELECT, &Names::stVal},            /* SELECT_ST_VAL */
+        {LN, nullptr},                      /* CDC */
+        {CDC, &Names::q},                   /* Q */
+        {CDC, &Names::t},                   /* T */
+        {CDC, &Names::stVal},               /* ST_VAL */
+        {CDC, &Names::ctlVal},              /* CTL_VAL */
+        {CDC, &Names::mag},                 /* MAG */
+        {CDC, &Names::valWtr},              /* VAL_WTR */
+    };
+
+    static_assert(ELEMENT_COUNT <= MAX_PLAN_ELEMENTS, "plan too small for the pivot elements");
+
+    ShapePlanCache& cache = shapePlanCache;
+
+    cache.key.assign(1, operation ? 'O' : 'D');
+    appendShape(cache.key, pivotData, SHAPE_KEY_DEPTH);
+
+    std::unordered_map<std::string, ShapePlan>::const_iterator found = cache.plans.find(cache.key);
+
+    if (found != cache.plans.end()) {
+        const ShapePlan& plan = found->second;
+
+        for (int i = 0; i < ELEMENT_COUNT; i++) {
+            Datapoint* parent = (rules[i].parent == ROOT) ? pivotData : elements[rules[i].parent];
+
+            elements[i] = (parent && plan.index[i] != ABSENT) ? (*parent->getData().getDpVec())[plan.index[i]] : nullptr;
+        }
+
+        m_ln = elements[LN];
+        m_pivotClass = plan.pivotClass;
+        m_pivotCdc = plan.pivotCdc;
+
+        return;
+    }
+
+    /* new shape: generic walk, the first child with the name of an element is taken */
+    ShapePlan plan;
+    bool cacheable = true;
+
+    /* only meaningful when the logical node and the CDC are found */
+    plan.pivotClass = PivotClass::GTIS;
+    plan.pivotCdc = PivotCdc::SPS;
+
+    for (int i = 0; i < ELEMENT_COUNT; i++) {
+        Datapoint* parent = (rules[i].parent == ROOT) ? pivotData : elements[rules[i].parent];
+        int index = -1;
+        size_t nameIndex = 0;
+
+        if (parent == nullptr) {
+            /* not searched */
+        }
+        else if (i == LN) {
+            /* commands only come from a GTIC logical node */
+            index = operation ? findChild(parent, lnNames + 2, 1, nameIndex) : findChild(parent, lnNames, 3, nameIndex);
+            if (index >= 0) plan.pivotClass = lnClasses[operation ? 2 : nameIndex];
+        }
+        else if (i == CDC) {
+            index = findChild(parent, cdcNames, sizeof(cdcNames) / sizeof(cdcNames[0]), nameIndex);
+            if (index >= 0) plan.pivotCdc = cdcTypes[nameIndex];
+        }
+        else {
+            index = findChild(parent, &rules[i].name, 1, nameIndex);
+        }
+
+        elements[i] = (index >= 0) ? (*parent->getData().getDpVec())[index] : nullptr;
+
+        if (index >= ABSENT) cacheable = false;
+        plan.index[i] = (index >= 0) ? (uint8_t)index : ABSENT;
+    }
+
+    m_ln = elements[LN];
+    m_pivotClass = plan.pivotClass;
+    m_pivotCdc = plan.pivotCdc;
+
+    if (cacheable) {
+        if (cache.plans.size() >= MAX_SHAPE_PLANS) cache.plans.clear();
+
+        cache.plans.insert(std::make_pair(cache.key, plan));
+    }
+}
+
+PivotParseStatus
+PivotObject::getCdc(Datapoint* dp, Datapoint*& cdcDp)
 {
-    Datapoint* cdcDp = nullptr;
-    std::vector<std::string> unknownChildrenNames;
+    cdcDp = nullptr;
 
     DatapointValue& dpv = dp->getData();
     if (dpv.getType() != DatapointValue::T_DP_DICT) {
-        throw PivotObjectException("CDC type missing");
+        return PivotParseStatus(PivotParseStatus::CDC_MISSING, dp);
     }
 
     std::vector<Datapoint*>* datapoints = dpv.getDpVec();
     for (Datapoint* child : *datapoints) {
-        if (child->getName() == "SpsTyp") {
+        const std::string& name = child->getName();
+
+        if (name == Names::SpsTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::SPS;
             break; //LCOV_EXCL_LINE
         }
-        else if (child->getName() == "MvTyp") {
+        else if (name == Names::MvTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::MV;
             break; //LCOV_EXCL_LINE
         }
-        else if (child->getName() == "DpsTyp") {
+        else if (name == Names::DpsTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::DPS;
             break; //LCOV_EXCL_LINE
         }
-        else if (child->getName() == "SpcTyp") {
+        else if (name == Names::SpcTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::SPC;
             break; //LCOV_EXCL_LINE
         }
-        else if (child->getName() == "DpcTyp") {
+        else if (name == Names::DpcTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::DPC;
             break; //LCOV_EXCL_LINE
         }
-        else if (child->getName() == "IncTyp") {
+        else if (name == Names::IncTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::INC;
             break; //LCOV_EXCL_LINE
         }
-        else if (child->getName() == "ApcTyp") {
+        else if (name == Names::ApcTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::APC;
             break; //LCOV_EXCL_LINE
         }
-        else if (child->getName() == "BscTyp") {
+        else if (name == Names::BscTyp) {
             cdcDp = child;
             m_pivotCdc = PivotCdc::BSC;
             break; //LCOV_EXCL_LINE
         }
-        else {
-            unknownChildrenNames.push_back(child->getName());
-        }
-        if (cdcDp != nullptr) {
-            break; //LCOV_EXCL_LINE
-        }
     }
     if(cdcDp == nullptr) {
-        throw PivotObjectException("CDC type unknown: " + Iec104PivotUtility::join(unknownChildrenNames));
+        return PivotParseStatus(PivotParseStatus::CDC_UNKNOWN, dp);
     }
 
-    return cdcDp;
+    return PivotParseStatus();
 }
 
 void
+PivotObject::initFromTemplate(IEC104PivotDataPoint* exchangeConfig, const char* pivotLN, const char* valueType)
+{
+    Datapoint* outputTemplate = exchangeConfig->getPivotTemplate();
+
+    if (outputTemplate) {
+        m_dp = cloneDp(m_pool, outputTemplate);
+        m_ln = (*m_dp->getData().getDpVec())[0];
+        m_cdc = (*m_ln->getData().getDpVec())[1];
+
+        if (m_ln->getName() == pivotLN && m_cdc->getName() == valueType) return;
+
+        /* the caller asks for another shape than the one of the configured type */
+        if (m_pool) m_pool->release(m_dp); else delete m_dp;
+    }
+
+    m_dp = createDp(m_pool, Names::PIVOT);
+    m_ln = addElement(m_pool, m_dp, pivotLN);
+    addElementWithValue(m_pool, m_ln, Names::ComingFrom, Names::iec104);
+    m_cdc = addElement(m_pool, m_ln, valueType);
+    setIdentifier(exchangeConfig->getPivotId());
+}
+
+Datapoint*
+PivotObject::createPivotTemplate(IEC104PivotDataPoint* exchangeConfig)
+{
+    /* same logical node and CDC as chosen by the conversions in IEC104PivotFilter for each ASDU type */
+    const Iec104AsduTraits& traits = Iec104PivotUtility::getAsduTraits(exchangeConfig->getAsduType());
+
+    if (traits.pivotLN == nullptr) return nullptr;
+
+    const char* pivotLN = traits.pivotLN;
+    const char* valueType = traits.pivotCdc;
+
+    Datapoint* outputTemplate = createDp(nullptr, Names::PIVOT);
+    Datapoint* ln = addElement(nullptr, outputTemplate, pivotLN);
+    addElementWithValue(nullptr, ln, Names::ComingFrom, Names::iec104);
+    addElement(nullptr, ln, valueType);
+    addElementWithValue(nullptr, ln, Names::Identifier, exchangeConfig->getPivotId());
+
+    return outputTemplate;
+}
+
+PivotParseStatus
 PivotDataObject::handleDetailQuality(Datapoint* detailQuality)
 {
+    PivotParseStatus status;
     DatapointValue& dpv = detailQuality->getData();
 
     if (dpv.getType() == DatapointValue::T_DP_DICT) {
@@ -400,824 +653,887 @@ PivotDataObject::handleDetailQuality(Datapoint* detailQuality)
 
         for (Datapoint* child : *datapoints)
         {
-            if (child->getName() == "badReference") {
-                if (getValueInt(child) > 0)
-                    m_badReference = true;
-                else
-                    m_badReference = false;
+            const std::string& name = child->getName();
+
+            if (name == Names::badReference) {
+                status = readValueFlag(child, m_badReference);
             }
-            else if (child->getName() == "failure") {
-                if (getValueInt(child) > 0)
-                    m_failure = true;
-                else
-                    m_failure = false;
+            else if (name == Names::failure) {
+                status = readValueFlag(child, m_failure);
             }
-            else if (child->getName() == "inconsistent") {
-                if (getValueInt(child) > 0)
-                    m_inconsistent = true;
-                else
-                    m_inconsistent = false;
+            else if (name == Names::inconsistent) {
+                status = readValueFlag(child, m_inconsistent);
             }
-            else if (child->getName() == "inaccurate") {
-                if (getValueInt(child) > 0)
-                    m_inaccurate = true;
-                else
-                    m_inaccurate = false;
+            else if (name == Names::inaccurate) {
+                status = readValueFlag(child, m_inaccurate);
             }
-            else if (child->getName() == "oldData") {
-                if (getValueInt(child) > 0)
-                    m_oldData = true;
-                else
-                    m_oldData = false;
+            else if (name == Names::oldData) {
+                status = readValueFlag(child, m_oldData);
             }
-            else if (child->getName() == "oscillatory") {
-                if (getValueInt(child) > 0)
-                    m_oscillatory = true;
-                else
-                    m_oscillatory = false;
+            else if (name == Names::oscillatory) {
+                status = readValueFlag(child, m_oscillatory);
             }
-            else if (child->getName() == "outOfRange") {
-                if (getValueInt(child) > 0)
-                    m_outOfRange = true;
-                else
-                    m_outOfRange = false;
+            else if (name == Names::outOfRange) {
+                status = readValueFlag(child, m_outOfRange);
             }
-            else if (child->getName() == "overflow") {
-                if (getValueInt(child) > 0)
-                    m_overflow = true;
-                else
-                    m_overflow = false;
+            else if (name == Names::overflow) {
+                status = readValueFlag(child, m_overflow);
             }
+
+            if (!status.ok()) return status;
         }
     }
+
+    return status;
 }
 
-void
+PivotParseStatus
 PivotDataObject::handleQuality(Datapoint* q)
 {
+    PivotParseStatus status;
     DatapointValue& dpv = q->getData();
 
     if (dpv.getType() == DatapointValue::T_DP_DICT) {
         std::vector<Datapoint*>* datapoints = dpv.getDpVec();
 
         for (Datapoint* child : *datapoints) {
-            if (child->getName() == "Validity") {
-                string validityStr = getValueStr(child);
+            const std::string& name = child->getName();
+
+            if (name == Names::Validity) {
+                string validityStr;
+                status = readValueStr(child, validityStr);
 
-                if (validityStr != "good") {
-                    if (validityStr == "invalid") {
+                if (status.ok() && validityStr != Names::good) {
+                    if (validityStr == Names::invalid) {
                         m_validity = Validity::INVALID;
                     }
-                    else if (validityStr == "questionable") {
+                    else if (validityStr == Names::questionable) {
                         m_validity = Validity::QUESTIONABLE;
                     }
-                    else if (validityStr == "reserved") {
+                    else if (validityStr == Names::reserved) {
                         m_validity = Validity::RESERVED;
                     }
                     else {
-                        throw PivotObjectException("Validity has invalid value " + validityStr);
+                        return PivotParseStatus(PivotParseStatus::INVALID_VALIDITY, child);
                     }
                 }
             }
-            else if (child->getName() == "Source") {
-
-                string sourceStr = getValueStr(child);
+            else if (name == Names::Source) {
+                string sourceStr;
+                status = readValueStr(child, sourceStr);
 
-                if (sourceStr != "process") {
-                    if (sourceStr == "substituted") {
+                if (status.ok() && sourceStr != Names::process) {
+                    if (sourceStr == Names::substituted) {
                         m_source = Source::SUBSTITUTED;
                     }
                     else {
-                        throw PivotObjectException("Source has invalid value " + sourceStr);
+                        return PivotParseStatus(PivotParseStatus::INVALID_SOURCE, child);
                     }
                 }
             }
-            else if (child->getName() == "DetailQuality") {
-                handleDetailQuality(child);
+            else if (name == Names::DetailQuality) {
+                status = handleDetailQuality(child);
             }
-            else if (child->getName() == "operatorBlocked") {
-                if (getValueInt(child) > 0)
-                    m_operatorBlocked = true;
-                else
-                    m_operatorBlocked = false;
+            else if (name == Names::operatorBlocked) {
+                status = readValueFlag(child, m_operatorBlocked);
             }
-            else if (child->getName() == "test") {
-                if (getValueInt(child) > 0)
-                    m_test = true;
-                else
-                    m_test = false;
+            else if (name == Names::test) {
+                status = readValueFlag(child, m_test);
             }
+
+            if (!status.ok()) return status;
         }
     }
+
+    return status;
+}
+
+PivotDataObject::PivotDataObject(Datapoint* pivotData, DatapointPool* pool)
+{
+    m_pool = pool;
+
+    PivotParseStatus status = parse(pivotData);
+
+    if (!status.ok()) {
+        throw PivotObjectException(status.toString());
+    }
 }
 
-PivotDataObject::PivotDataObject(Datapoint* pivotData)
+PivotParseStatus
+PivotDataObject::parse(Datapoint* pivotData)
 {
-    if (pivotData->getName() != "PIVOT") {
-        throw PivotObjectException("No pivot object");
+    PivotParseStatus status;
+
+    if (pivotData->getName() != Names::PIVOT) {
+        return PivotParseStatus(PivotParseStatus::NOT_PIVOT, pivotData);
     }
     
     m_dp = pivotData;
     m_ln = nullptr;
-    std::vector<std::string> unknownChildrenNames;
-
-    Datapoint* childDp = nullptr;
 
     DatapointValue& dpv = pivotData->getData();
     if (dpv.getType() != DatapointValue::T_DP_DICT) {
-        throw PivotObjectException("pivot object not found");
+        return PivotParseStatus(PivotParseStatus::NOT_A_DICT, pivotData);
     }
 
-    std::vector<Datapoint*>* datapoints = dpv.getDpVec();
-    for (Datapoint* child : *datapoints) {
-        if (child->getName() == "GTIS") {
-            m_pivotClass = PivotClass::GTIS;
-            m_ln = child;
-            break; //LCOV_EXCL_LINE
-        }
-        else if (child->getName() == "GTIM") {
-            m_pivotClass = PivotClass::GTIM;
-            m_ln = child;
-            break; //LCOV_EXCL_LINE
-        }
-        else if (child->getName() == "GTIC") {
-            m_pivotClass = PivotClass::GTIC;
-            m_ln = child;
-            break; //LCOV_EXCL_LINE
-        }
-        else {
-            unknownChildrenNames.push_back(child->getName());
-        }
-    }
+    Datapoint* elements[ELEMENT_COUNT];
+    findElements(pivotData, false, elements);
 
     if (m_ln == nullptr) {
-        throw PivotObjectException("pivot object type not supported: " + Iec104PivotUtility::join(unknownChildrenNames));
+        return PivotParseStatus(PivotParseStatus::UNSUPPORTED_TYPE, pivotData);
     }
 
-    m_identifier = getChildValueStr(m_ln, "Identifier");
+    if (elements[IDENTIFIER] == nullptr) {
+        return PivotParseStatus(PivotParseStatus::MISSING_CHILD, m_ln, "Identifier");
+    }
 
-    Datapoint* comingFromDp = getChild(m_ln,"ComingFrom");
+    status = readValueStr(elements[IDENTIFIER], m_identifier);
+    if (!status.ok()) return status;
 
-    if(comingFromDp){
-        m_comingFrom = getChildValueStr(m_ln, "ComingFrom");
+    if (elements[COMING_FROM]) {
+        status = readValueStr(elements[COMING_FROM], m_comingFrom);
+        if (!status.ok()) return status;
     }
 
-    Datapoint* cause = getChild(m_ln, "Cause");
+    if (elements[CAUSE]) {
+        if (elements[CAUSE_ST_VAL] == nullptr) {
+            return PivotParseStatus(PivotParseStatus::MISSING_CHILD, elements[CAUSE], "stVal");
+        }
 
-    if (cause) {
-        m_cause = getChildValueInt(cause, "stVal");
+        long cause = 0;
+        status = readValueInt(elements[CAUSE_ST_VAL], cause);
+        if (!status.ok()) return status;
+        m_cause = (int)cause;
     }
 
-    Datapoint* confirmation = getChild(m_ln, "Confirmation");
+    if (elements[CONFIRMATION]) {
+        if (elements[CONFIRMATION_ST_VAL] == nullptr) {
+            return PivotParseStatus(PivotParseStatus::MISSING_CHILD, elements[CONFIRMATION], "stVal");
+        }
 
-    if (confirmation) {
-        int confirmationVal = getChildValueInt(confirmation, "stVal");
+        long confirmationVal = 0;
+        status = readValueInt(elements[CONFIRMATION_ST_VAL], confirmationVal);
+        if (!status.ok()) return status;
 
-        if (confirmationVal > 0) {
+        if ((int)confirmationVal > 0) {
             m_confirmation = true;
         }
     }
 
-    Datapoint* tmOrg = getChild(m_ln, "TmOrg");
-
-    if (tmOrg) {
-        string tmOrgValue = getChildValueStr(tmOrg, "stVal");
-
-        if (tmOrgValue == "substituted") {
-            m_timestampSubstituted = true;
-        }
-        else {
-            m_timestampSubstituted = false;
+    if (elements[TM_ORG]) {
+        if (elements[TM_ORG_ST_VAL] == nullptr) {
+            return PivotParseStatus(PivotParseStatus::MISSING_CHILD, elements[TM_ORG], "stVal");
         }
-    }
 
-    Datapoint* tmValidity  = getChild(m_ln, "TmValidity");
+        string tmOrgValue;
+        status = readValueStr(elements[TM_ORG_ST_VAL], tmOrgValue);
+        if (!status.ok()) return status;
 
-    if (tmValidity) {
-        string tmValidityValue = getChildValueStr(tmValidity, "stVal");
+        m_timestampSubstituted = (tmOrgValue == Names::substituted);
+    }
 
-        if (tmValidityValue == "invalid") {
-            m_timestampInvalid = true;
+    if (elements[TM_VALIDITY]) {
+        if (elements[TM_VALIDITY_ST_VAL] == nullptr) {
+            return PivotParseStatus(PivotParseStatus::MISSING_CHILD, elements[TM_VALIDITY], "stVal");
         }
-        else {
-            m_timestampInvalid = false;
-        }
-    }
 
-    Datapoint* cdc = getCdc(m_ln);
+        string tmValidityValue;
+        status = readValueStr(elements[TM_VALIDITY_ST_VAL], tmValidityValue);
+        if (!status.ok()) return status;
 
-    if (cdc) {
-        Datapoint* q = getChild(cdc, "q");
+        m_timestampInvalid = (tmValidityValue == Names::invalid);
+    }
 
-        if (q) {
-            handleQuality(q);
-        }
+    /* fails with the names found when there is no known CDC */
+    if (elements[CDC] == nullptr) {
+        Datapoint* cdc = nullptr;
+        status = getCdc(m_ln, cdc);
+        if (!status.ok()) return status;
+    }
 
-        Datapoint* t = getChild(cdc, "t");
+    Datapoint* q = elements[Q];
 
-        if (t) {
-            m_timestamp = new PivotTimestamp(t);
-        }
+    if (q) {
+        status = handleQuality(q);
+        if (!status.ok()) return status;
+    }
 
-        switch (m_pivotCdc) {
-            case PivotCdc::SPS:
-            case PivotCdc::SPC:
-            {
-                Datapoint* stVal = getChild(cdc, (m_pivotCdc == PivotCdc::SPS) ? "stVal" : "ctlVal");
-                if (stVal) {
-                    hasIntVal = true;
-                    intVal = getValueInt(stVal) > 0 ? 1 : 0;
-                }
-                break; //LCOV_EXCL_LINE
-            }
+    Datapoint* t = elements[T];
 
-            case PivotCdc::DPS:
-            case PivotCdc::DPC:
-            {
-                Datapoint* stVal = getChild(cdc, (m_pivotCdc == PivotCdc::DPS) ? "stVal" : "ctlVal");
-                if (stVal) {
-                    hasIntVal = true;
-                    string stValStr = getValueStr(stVal);
+    if (t) {
+        status = m_timestamp.parse(t);
+        if (!status.ok()) return status;
+        m_hasTimestamp = true;
+    }
 
-                    if (stValStr == "intermediate-state") intVal = 0;
-                    else if (stValStr == "off") intVal = 1;
-                    else if (stValStr == "on") intVal = 2;
-                    else if (stValStr == "bad-state") intVal = 3;
-                }
-                break; //LCOV_EXCL_LINE
+    switch (m_pivotCdc) {
+        case PivotCdc::SPS:
+        case PivotCdc::SPC:
+        {
+            Datapoint* stVal = elements[(m_pivotCdc == PivotCdc::SPS) ? ST_VAL : CTL_VAL];
+            if (stVal) {
+                hasIntVal = true;
+                status = readValueInt(stVal, intVal);
+                intVal = intVal > 0 ? 1 : 0;
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            case PivotCdc::MV:
-            {
-                Datapoint* mag = getChild(cdc, "mag");
-                if (mag) {
-                    Datapoint* mag_f = getChild(mag, "f");
-                    if (mag_f) {
-                        hasIntVal = false;
-                        floatVal = getValueFloat(mag_f);
-                    } else {
-                        Datapoint* mag_i = getChild(mag, "i");
-                        if (mag_i) {
-                            hasIntVal = true;
-                            intVal = getValueInt(mag_i);
-                        }
-                    }
-                }
-                break; //LCOV_EXCL_LINE
+        case PivotCdc::DPS:
+        case PivotCdc::DPC:
+        {
+            Datapoint* stVal = elements[(m_pivotCdc == PivotCdc::DPS) ? ST_VAL : CTL_VAL];
+            if (stVal) {
+                hasIntVal = true;
+                string value;
+                status = readValueStr(stVal, value);
+                if (status.ok()) Iec104PivotUtility::parseDoublePoint(value, intVal);
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            case PivotCdc::BSC:
-            {
-                Datapoint* valWtr = getChild(cdc, "valWtr");
-                if (valWtr) {
-                    Datapoint* valWtrPosVal = getChild(valWtr, "posVal");
-                    if (valWtrPosVal) {
-                        intVal = getValueInt(valWtrPosVal);
-                    }
-                    Datapoint* valWtrTransInd = getChild(valWtr, "transInd");
-                    if (valWtrTransInd) {
-                        m_transient = static_cast<bool>(getValueInt(valWtrTransInd));
-                    }
+        case PivotCdc::MV:
+        {
+            Datapoint* mag = elements[MAG];
+            if (mag) {
+                Datapoint* mag_f = getChild(mag, Names::f);
+                if (mag_f) {
+                    hasIntVal = false;
+                    status = readValueFloat(mag_f, floatVal);
                 } else {
-                    Datapoint* value = getChild(cdc, "ctlVal");
-                    if (value) {
+                    Datapoint* mag_i = getChild(mag, Names::i);
+                    if (mag_i) {
                         hasIntVal = true;
-                        string valStr = getValueStr(value);
-
-                        if (valStr == "stop") intVal = 0;
-                        else if (valStr == "lower") intVal = 1;
-                        else if (valStr == "higher") intVal = 2;
-                        else if (valStr == "reserved") intVal = 3;
+                        status = readValueInt(mag_i, intVal);
                     }
                 }
-                break; //LCOV_EXCL_LINE
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            case PivotCdc::INC:
-            case PivotCdc::APC:
-            {
-                Datapoint* value = getChild(cdc, "ctlVal");
+        case PivotCdc::BSC:
+        {
+            Datapoint* valWtr = elements[VAL_WTR];
+            if (valWtr) {
+                Datapoint* valWtrPosVal = getChild(valWtr, Names::posVal);
+                if (valWtrPosVal) {
+                    status = readValueInt(valWtrPosVal, intVal);
+                    if (!status.ok()) return status;
+                }
+                Datapoint* valWtrTransInd = getChild(valWtr, Names::transInd);
+                if (valWtrTransInd) {
+                    long transInd = 0;
+                    status = readValueInt(valWtrTransInd, transInd);
+                    m_transient = static_cast<bool>(transInd);
+                }
+            } else {
+                Datapoint* value = elements[CTL_VAL];
                 if (value) {
-                    hasIntVal = (m_pivotCdc == PivotCdc::INC);
-                    if (hasIntVal) {
-                        intVal = getValueInt(value);
-                    } else {
-                        floatVal = getValueFloat(value);
-                    }
+                    hasIntVal = true;
+                    string command;
+                    status = readValueStr(value, command);
+                    if (status.ok()) Iec104PivotUtility::parseStepCommand(command, intVal);
                 }
-                break; //LCOV_EXCL_LINE
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            default:
-                throw PivotObjectException("CDC element not found or CDC type unknown");
+        case PivotCdc::INC:
+        case PivotCdc::APC:
+        {
+            Datapoint* value = elements[CTL_VAL];
+            if (value) {
+                hasIntVal = (m_pivotCdc == PivotCdc::INC);
+                if (hasIntVal) {
+                    status = readValueInt(value, intVal);
+                } else {
+                    status = readValueFloat(value, floatVal);
+                }
+            }
+            break; //LCOV_EXCL_LINE
         }
+
+        default:
+            return PivotParseStatus(PivotParseStatus::CDC_UNSUPPORTED, m_ln);
     }
-}
 
-PivotDataObject::~PivotDataObject()
-{
-    if (m_timestamp) delete m_timestamp;
+    return status;
 }
 
 PivotDataObject::PivotDataObject(const string& pivotLN, const string& valueType)
 {
-    m_dp = createDp("PIVOT");
+    m_dp = createDp(m_pool, Names::PIVOT);
 
-    m_ln = addElement(m_dp, pivotLN);
+    m_ln = addElement(m_pool, m_dp, pivotLN);
 
-    addElementWithValue(m_ln, "ComingFrom", "iec104");
+    addElementWithValue(m_pool, m_ln, Names::ComingFrom, Names::iec104);
 
-    m_cdc = addElement(m_ln, valueType);
+    m_cdc = addElement(m_pool, m_ln, valueType);
 }
 
-PivotOperationObject::~PivotOperationObject()
+PivotDataObject::PivotDataObject(IEC104PivotDataPoint* exchangeConfig, const char* pivotLN, const char* valueType, DatapointPool* pool)
 {
-    if (m_timestamp) delete m_timestamp;
+    m_pool = pool;
+    initFromTemplate(exchangeConfig, pivotLN, valueType);
 }
 
 PivotOperationObject::PivotOperationObject(const string& pivotLN, const string& valueType)
 {
-    m_dp = createDp("PIVOT");
+    m_dp = createDp(m_pool, Names::PIVOT);
 
-    m_ln = addElement(m_dp, pivotLN);
+    m_ln = addElement(m_pool, m_dp, pivotLN);
 
-    addElementWithValue(m_ln, "ComingFrom", "iec104");
+    addElementWithValue(m_pool, m_ln, Names::ComingFrom, Names::iec104);
 
-    m_cdc = addElement(m_ln, valueType);
+    m_cdc = addElement(m_pool, m_ln, valueType);
 
 }
 
+PivotOperationObject::PivotOperationObject(IEC104PivotDataPoint* exchangeConfig, const char* pivotLN, const char* valueType, DatapointPool* pool)
+{
+    m_pool = pool;
+    initFromTemplate(exchangeConfig, pivotLN, valueType);
+}
 
-PivotOperationObject::PivotOperationObject(Datapoint* pivotData)
+PivotOperationObject::PivotOperationObject(Datapoint* pivotData, DatapointPool* pool)
 {
-    if (pivotData->getName() != "PIVOT") {
-        throw PivotObjectException("No pivot object");
-    }
-    
-    m_dp = pivotData;
-    m_ln = nullptr;
-    std::vector<std::string> unknownChildrenNames;
+    m_pool = pool;
 
-    Datapoint* childDp = nullptr;
+    PivotParseStatus status = parse(pivotData);
 
-    DatapointValue& dpv = pivotData->getData();
+    if (!status.ok()) {
+        throw PivotObjectException(status.toString());
+    }
+}
 
-    if (dpv.getType() == DatapointValue::T_DP_DICT) {
-        std::vector<Datapoint*>* datapoints = dpv.getDpVec();
+PivotParseStatus
+PivotOperationObject::parse(Datapoint* pivotData)
+{
+    PivotParseStatus status;
 
-        for (Datapoint* child : *datapoints) {
-            if (child->getName() == "GTIC") {
-                m_pivotClass = PivotClass::GTIC;
-                m_ln = child;
-                break; //LCOV_EXCL_LINE
-            }
-            else {
-                unknownChildrenNames.push_back(child->getName());
-            }
-        }
+    if (pivotData->getName() != Names::PIVOT) {
+        return PivotParseStatus(PivotParseStatus::NOT_PIVOT, pivotData);
     }
+    
+    m_dp = pivotData;
+    m_ln = nullptr;
+
+    Datapoint* elements[ELEMENT_COUNT];
+    findElements(pivotData, true, elements);
 
     if (m_ln == nullptr) {
-        throw PivotObjectException("pivot object type not supported: " + Iec104PivotUtility::join(unknownChildrenNames));
+        return PivotParseStatus(PivotParseStatus::UNSUPPORTED_TYPE, pivotData);
     }
 
-    m_identifier = getChildValueStr(m_ln, "Identifier");
+    if (elements[IDENTIFIER] == nullptr) {
+        return PivotParseStatus(PivotParseStatus::MISSING_CHILD, m_ln, "Identifier");
+    }
 
-    Datapoint* comingFromDp = getChild(m_ln,"ComingFrom");
+    status = readValueStr(elements[IDENTIFIER], m_identifier);
+    if (!status.ok()) return status;
 
-    if(comingFromDp){
-        m_comingFrom = getChildValueStr(m_ln, "ComingFrom");
+    if (elements[COMING_FROM]) {
+        status = readValueStr(elements[COMING_FROM], m_comingFrom);
+        if (!status.ok()) return status;
     }
-    Datapoint* cause = getChild(m_ln, "Cause");
 
-    if (cause) {
-        m_cause = getChildValueInt(cause, "stVal");
+    if (elements[CAUSE]) {
+        if (elements[CAUSE_ST_VAL] == nullptr) {
+            return PivotParseStatus(PivotParseStatus::MISSING_CHILD, elements[CAUSE], "stVal");
+        }
+
+        long cause = 0;
+        status = readValueInt(elements[CAUSE_ST_VAL], cause);
+        if (!status.ok()) return status;
+        m_cause = (int)cause;
     }
 
-    Datapoint* confirmation = getChild(m_ln, "Confirmation");
+    if (elements[CONFIRMATION]) {
+        if (elements[CONFIRMATION_ST_VAL] == nullptr) {
+            return PivotParseStatus(PivotParseStatus::MISSING_CHILD, elements[CONFIRMATION], "stVal");
+        }
 
-    if (confirmation) {
-        int confirmationVal = getChildValueInt(confirmation, "stVal");
+        long confirmationVal = 0;
+        status = readValueInt(elements[CONFIRMATION_ST_VAL], confirmationVal);
+        if (!status.ok()) return status;
 
-        if (confirmationVal > 0) {
+        if ((int)confirmationVal > 0) {
             m_confirmation = true;
         }
     }
 
-    Datapoint* select = getChild(m_ln, "Select");
+    if (elements[SELECT]) {
+        Datapoint* stVal = elements[SELECT_ST_VAL];
 
-    if(select){
-        Datapoint* stVal = getChild(select, "stVal");
-            if (stVal) {
-                if (getValueInt(stVal) > 0) {
-                    m_select = 1;
-                }
-                else {
-                    m_select = 0;
-                }
+        if (stVal) {
+            long select = 0;
+            status = readValueInt(stVal, select);
+            if (!status.ok()) return status;
+
+            m_select = (select > 0) ? 1 : 0;
         }
     }
 
+    /* fails with the names found when there is no known CDC */
+    if (elements[CDC] == nullptr) {
+        Datapoint* cdc = nullptr;
+        status = getCdc(m_ln, cdc);
+        if (!status.ok()) return status;
+    }
 
-    Datapoint* cdc = getCdc(m_ln);
+    Datapoint* q = elements[Q];
 
-    if (cdc) {
-        Datapoint* q = getChild(cdc, "q");
+    if(q){
+        Datapoint* test = getChild(q, Names::test);
 
-        if(q){
-            m_test = getChildValueInt(q,"test");
+        if (test == nullptr) {
+            return PivotParseStatus(PivotParseStatus::MISSING_CHILD, q, "test");
         }
 
-        Datapoint* t = getChild(cdc, "t");
+        long testVal = 0;
+        status = readValueInt(test, testVal);
+        if (!status.ok()) return status;
+        m_test = ((int)testVal != 0);
+    }
 
-        if (t) {
-            m_timestamp = new PivotTimestamp(t);
-        }
+    Datapoint* t = elements[T];
 
-        switch (m_pivotCdc) {
-            case PivotCdc::SPC:
-            {
-                Datapoint* stVal = getChild(cdc, "ctlVal");
-                if (stVal) {
-                    hasIntVal = true;
-                    intVal = getValueInt(stVal) > 0 ? 1 : 0;
-                }
-                break; //LCOV_EXCL_LINE
-            }
-
-            case PivotCdc::DPC:
-            {
-                Datapoint* stVal = getChild(cdc, "ctlVal");
-                if (stVal) {
-                    hasIntVal = true;
-                    string stValStr = getValueStr(stVal);
+    if (t) {
+        status = m_timestamp.parse(t);
+        if (!status.ok()) return status;
+        m_hasTimestamp = true;
+    }
 
-                    if (stValStr == "intermediate-state") intVal = 0;
-                    else if (stValStr == "off") intVal = 1;
-                    else if (stValStr == "on") intVal = 2;
-                    else if (stValStr == "bad-state") intVal = 3;
-                }
-                break; //LCOV_EXCL_LINE
+    switch (m_pivotCdc) {
+        case PivotCdc::SPC:
+        {
+            Datapoint* stVal = elements[CTL_VAL];
+            if (stVal) {
+                hasIntVal = true;
+                status = readValueInt(stVal, intVal);
+                intVal = intVal > 0 ? 1 : 0;
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            case PivotCdc::INC:
-            {
-                Datapoint* value = getChild(cdc, "ctlVal");
-                if (value) {
-                    hasIntVal = true;
-                    intVal = getValueInt(value);
-                }
-                break; //LCOV_EXCL_LINE
+        case PivotCdc::DPC:
+        {
+            Datapoint* stVal = elements[CTL_VAL];
+            if (stVal) {
+                hasIntVal = true;
+                string value;
+                status = readValueStr(stVal, value);
+                if (status.ok()) Iec104PivotUtility::parseDoublePoint(value, intVal);
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            case PivotCdc::APC:
-            {
-                Datapoint* value = getChild(cdc, "ctlVal");
-                if (value) {
-                    hasIntVal = false;
-                    floatVal = getValueFloat(value);
-                }
-                break; //LCOV_EXCL_LINE
+        case PivotCdc::INC:
+        {
+            Datapoint* value = elements[CTL_VAL];
+            if (value) {
+                hasIntVal = true;
+                status = readValueInt(value, intVal);
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            case PivotCdc::BSC:
-            {
-                Datapoint* value = getChild(cdc, "ctlVal");
-                if (value) {
-                    hasIntVal = true;
-                    string valStr = getValueStr(value);
-
-                    if (valStr == "stop") intVal = 0;
-                    else if (valStr == "lower") intVal = 1;
-                    else if (valStr == "higher") intVal = 2;
-                    else if (valStr == "reserved") intVal = 3;
-                }
-                break; //LCOV_EXCL_LINE
+        case PivotCdc::APC:
+        {
+            Datapoint* value = elements[CTL_VAL];
+            if (value) {
+                hasIntVal = false;
+                status = readValueFloat(value, floatVal);
             }
+            break; //LCOV_EXCL_LINE
+        }
 
-            default:
-                throw PivotObjectException("CDC type unknown");
+        case PivotCdc::BSC:
+        {
+            Datapoint* value = elements[CTL_VAL];
+            if (value) {
+                hasIntVal = true;
+                string command;
+                status = readValueStr(value, command);
+                if (status.ok()) Iec104PivotUtility::parseStepCommand(command, intVal);
+            }
+            break; //LCOV_EXCL_LINE
         }
+
+        default:
+            return PivotParseStatus(PivotParseStatus::CDC_UNSUPPORTED, m_ln);
     }
-    else {
-        throw PivotObjectException("CDC element not found or CDC type unknown");
-    }
+
+    return status;
 }
 
 void
 PivotObject::setIdentifier(const string& identifier)
 {
-    addElementWithValue(m_ln, "Identifier", identifier);
+    addElementWithValue(m_pool, m_ln, Names::Identifier, identifier);
 }
 
 
 void
 PivotOperationObject::setSelect(int select)
 {
-    Datapoint* selectDp = addElement(m_ln, "Select");
-    addElementWithValue(selectDp, "stVal", (long)select);
+    Datapoint* selectDp = addElement(m_pool, m_ln, Names::Select);
+    addElementWithValue(m_pool, selectDp, Names::stVal, (long)select);
 }
 
 void
 PivotObject::setTest(bool value)
 {
-    Datapoint* q = addElement(m_cdc, "q");
+    Datapoint* q = addElement(m_pool, m_cdc, Names::q);
 
-    addElementWithValue(q, "test", (long)value);
+    addElementWithValue(m_pool, q, Names::test, (long)value);
 }
 
 void
 PivotObject::setCause(int cause)
 {
-    Datapoint* causeDp = addElement(m_ln, "Cause");
+    Datapoint* causeDp = addElement(m_pool, m_ln, Names::Cause);
 
-    addElementWithValue(causeDp, "stVal", (long)cause);
+    addElementWithValue(m_pool, causeDp, Names::stVal, (long)cause);
 }
 
 void
 PivotDataObject::setStVal(bool value)
 {
-    addElementWithValue(m_cdc, "stVal", (long)(value ? 1 : 0));
+    addElementWithValue(m_pool, m_cdc, Names::stVal, (long)(value ? 1 : 0));
 }
 
 void
 PivotDataObject::setStValStr(const std::string& value)
 {
-    addElementWithValue(m_cdc, "stVal", value);
+    addElementWithValue(m_pool, m_cdc, Names::stVal, value);
 }
 
 void
 PivotObject::setCtlValBool(bool value)
 {
-    addElementWithValue(m_cdc, "ctlVal", (long)(value ? 1 : 0));
+    addElementWithValue(m_pool, m_cdc, Names::ctlVal, (long)(value ? 1 : 0));
 }
 
 void
 PivotObject::setCtlValStr(const std::string& value)
 {
-    addElementWithValue(m_cdc, "ctlVal", value);
+    addElementWithValue(m_pool, m_cdc, Names::ctlVal, value);
 }
 
 void
 PivotObject::setCtlValI(int value)
 {
-    addElementWithValue(m_cdc, "ctlVal", (long)value);
+    addElementWithValue(m_pool, m_cdc, Names::ctlVal, (long)value);
 }
 
 void
 PivotObject::setCtlValF(float value)
 {
-    addElementWithValue(m_cdc, "ctlVal", (float)value);
+    addElementWithValue(m_pool, m_cdc, Names::ctlVal, (float)value);
 }
 
 void
 PivotDataObject::setMagF(float value)
 {
-    Datapoint* mag = addElement(m_cdc, "mag");
+    Datapoint* mag = addElement(m_pool, m_cdc, Names::mag);
 
-    addElementWithValue(mag, "f", value);
+    addElementWithValue(m_pool, mag, Names::f, value);
 }
 
 void
 PivotDataObject::setMagI(int value)
 {
-    Datapoint* mag = addElement(m_cdc, "mag");
+    Datapoint* mag = addElement(m_pool, m_cdc, Names::mag);
 
-    addElementWithValue(mag, "i", (long)value);
+    addElementWithValue(m_pool, mag, Names::i, (long)value);
 }
 
 void
 PivotDataObject::setPosVal(int value, bool trans)
 {
-    Datapoint* wtr = addElement(m_cdc, "valWtr");
+    Datapoint* wtr = addElement(m_pool, m_cdc, Names::valWtr);
 
-    addElementWithValue(wtr, "posVal", (long)value);
-    addElementWithValue(wtr, "transInd", (long)trans);
+    addElementWithValue(m_pool, wtr, Names::posVal, (long)value);
+    addElementWithValue(m_pool, wtr, Names::transInd, (long)trans);
 }
 
 void
 PivotObject::setConfirmation(bool value)
 {
-    Datapoint* confirmation = addElement(m_ln, "Confirmation");
+    Datapoint* confirmation = addElement(m_pool, m_ln, Names::Confirmation);
 
     if (confirmation) {
-        addElementWithValue(confirmation, "stVal", (long)(value ? 1 : 0));
+        addElementWithValue(m_pool, confirmation, Names::stVal, (long)(value ? 1 : 0));
     }
 }
 
 void
 PivotDataObject::addQuality(bool bl, bool iv, bool nt, bool ov, bool sb, bool test)
 {
-    Datapoint* q = addElement(m_cdc, "q");
+    Datapoint* q = addElement(m_pool, m_cdc, Names::q);
 
     if (nt || ov) {
-        Datapoint* detailQuality = addElement(q, "DetailQuality");
+        Datapoint* detailQuality = addElement(m_pool, q, Names::DetailQuality);
 
         if (nt)
-            addElementWithValue(detailQuality, "oldData", (long)1);
+            addElementWithValue(m_pool, detailQuality, Names::oldData, (long)1);
 
         if (ov)
-            addElementWithValue(detailQuality, "overflow", (long)1);
+            addElementWithValue(m_pool, detailQuality, Names::overflow, (long)1);
     }
 
     if (sb) {
-        addElementWithValue(q, "Source", "substituted");
+        addElementWithValue(m_pool, q, Names::Source, Names::substituted);
     }
     else {
-        addElementWithValue(q, "Source", "process");
+        addElementWithValue(m_pool, q, Names::Source, Names::process);
     }
 
     if (bl) {
-        addElementWithValue(q, "operatorBlocked", (long)1);
+        addElementWithValue(m_pool, q, Names::operatorBlocked, (long)1);
     }
 
     if (test) {
-        addElementWithValue(q, "test", (long)1);
+        addElementWithValue(m_pool, q, Names::test, (long)1);
     }
 
     if (iv) {
-        addElementWithValue(q, "Validity", "invalid");
+        addElementWithValue(m_pool, q, Names::Validity, Names::invalid);
     }
     else if (ov || nt) {
-        addElementWithValue(q, "Validity", "questionable");
+        addElementWithValue(m_pool, q, Names::Validity, Names::questionable);
     }
     else {
-        addElementWithValue(q, "Validity", "good");
+        addElementWithValue(m_pool, q, Names::Validity, Names::good);
     }
 }
 
 void
 PivotDataObject::addTmOrg(bool substituted)
 {
-    Datapoint* tmOrg = addElement(m_ln, "TmOrg");
+    Datapoint* tmOrg = addElement(m_pool, m_ln, Names::TmOrg);
 
     if (substituted)
-        addElementWithValue(tmOrg, "stVal", "substituted");
+        addElementWithValue(m_pool, tmOrg, Names::stVal, Names::substituted);
     else
-        addElementWithValue(tmOrg, "stVal", "genuine");
+        addElementWithValue(m_pool, tmOrg, Names::stVal, Names::genuine);
 }
 
 void
 PivotDataObject::addTmValidity(bool invalid)
 {
-    Datapoint* tmValidity = addElement(m_ln, "TmValidity");
+    Datapoint* tmValidity = addElement(m_pool, m_ln, Names::TmValidity);
 
     if (invalid)
-        addElementWithValue(tmValidity, "stVal", "invalid");
+        addElementWithValue(m_pool, tmValidity, Names::stVal, Names::invalid);
     else
-        addElementWithValue(tmValidity, "stVal", "good");
+        addElementWithValue(m_pool, tmValidity, Names::stVal, Names::good);
 }
 
 void
 PivotDataObject::addTimestamp(long ts, bool iv, bool su, bool sub)
 {
-    Datapoint* t = addElement(m_cdc, "t");
+    Datapoint* t = addElement(m_pool, m_cdc, Names::t);
 
-    m_timestamp = new PivotTimestamp(ts);
+    m_timestamp.setTimeInMs(ts);
+    m_hasTimestamp = true;
 
-    addElementWithValue(t, "SecondSinceEpoch",(long) m_timestamp->SecondSinceEpoch());
-    addElementWithValue(t, "FractionOfSecond", (long) m_timestamp->FractionOfSecond());
+    addElementWithValue(m_pool, t, Names::SecondSinceEpoch,(long) m_timestamp.SecondSinceEpoch());
+    addElementWithValue(m_pool, t, Names::FractionOfSecond, (long) m_timestamp.FractionOfSecond());
 
-    Datapoint* timeQuality = addElement(t, "TimeQuality");
+    Datapoint* timeQuality = addElement(m_pool, t, Names::TimeQuality);
 
-    addElementWithValue(timeQuality, "clockFailure", (long)(iv ? 1 : 0));
-    addElementWithValue(timeQuality, "leapSecondKnown", (long)1);
-    addElementWithValue(timeQuality, "timeAccuracy", (long)10);
+    addElementWithValue(m_pool, timeQuality, Names::clockFailure, (long)(iv ? 1 : 0));
+    addElementWithValue(m_pool, timeQuality, Names::leapSecondKnown, (long)1);
+    addElementWithValue(m_pool, timeQuality, Names::timeAccuracy, (long)10);
 }
 
 void
 PivotOperationObject::addTimestamp(long ts)
 {
-    Datapoint* t = addElement(m_cdc, "t");
+    Datapoint* t = addElement(m_pool, m_cdc, Names::t);
+
+    m_timestamp.setTimeInMs(ts);
+    m_hasTimestamp = true;
 
-    m_timestamp = new PivotTimestamp(ts);
+    addElementWithValue(m_pool, t, Names::SecondSinceEpoch,(long) m_timestamp.SecondSinceEpoch());
+    addElementWithValue(m_pool, t, Names::FractionOfSecond, (long) m_timestamp.FractionOfSecond());
+}
+
+Datapoint*
+PivotDataObject::createIec104DataObjectTemplate(IEC104PivotDataPoint* exchangeConfig)
+{
+    Datapoint* dataObject = createDp(nullptr, Names::data_object);
+
+    addElementWithValue(nullptr, dataObject, Names::do_type, exchangeConfig->getTypeId());
+    addElementWithValue(nullptr, dataObject, Names::do_ca, (long)(exchangeConfig->getCA()));
+    addElementWithValue(nullptr, dataObject, Names::do_ioa, (long)(exchangeConfig->getIOA()));
+
+    return dataObject;
+}
 
-    addElementWithValue(t, "SecondSinceEpoch",(long) m_timestamp->SecondSinceEpoch());
-    addElementWithValue(t, "FractionOfSecond", (long) m_timestamp->FractionOfSecond());
+Datapoint*
+PivotDataObject::toIec104DataObject(IEC104PivotDataPoint* exchangeConfig, const Iec104PivotUtility::ConversionClock& clock)
+{
+    return toIec104DataObject(exchangeConfig, clock, Iec104PivotUtility::StepPositionFormat::STRING);
 }
 
 Datapoint*
-PivotDataObject::toIec104DataObject(IEC104PivotDataPoint* exchangeConfig)
+PivotDataObject::toIec104DataObject(IEC104PivotDataPoint* exchangeConfig, const Iec104PivotUtility::ConversionClock& clock,
+                                    Iec104PivotUtility::StepPositionFormat stepPositionFormat)
 {
-    Datapoint* dataObject = createDp("data_object");
+    Datapoint* dataObjectTemplate = exchangeConfig->getIec104DataObjectTemplate();
+    Datapoint* dataObject = nullptr;
+
+    if (dataObjectTemplate) {
+        dataObject = cloneDp(m_pool, dataObjectTemplate);
+    }
+    else {
+        dataObject = createIec104DataObjectTemplate(exchangeConfig);
+    }
 
     if (dataObject) {
-        addElementWithValue(dataObject, "do_type", exchangeConfig->getTypeId());
-        addElementWithValue(dataObject, "do_ca", (long)(exchangeConfig->getCA()));
-        addElementWithValue(dataObject, "do_ioa", (long)(exchangeConfig->getIOA()));
-        addElementWithValue(dataObject, "do_cot", (long)getCause());
+        addElementWithValue(m_pool, dataObject, Names::do_cot, (long)getCause());
 
-        addElementWithValue(dataObject, "do_test", (long)(Test() ? 1 : 0));
+        addElementWithValue(m_pool, dataObject, Names::do_test, (long)(Test() ? 1 : 0));
 
         if (getValidity() == Validity::INVALID) {
-            addElementWithValue(dataObject, "do_quality_iv", (long)1);
+            addElementWithValue(m_pool, dataObject, Names::do_quality_iv, (long)1);
         } else if (getValidity() == Validity::QUESTIONABLE && (Inconsistent() || Inaccurate())) {
-            addElementWithValue(dataObject, "do_quality_iv", (long)1);
+            addElementWithValue(m_pool, dataObject, Names::do_quality_iv, (long)1);
         } else {
-            addElementWithValue(dataObject, "do_quality_iv", (long)0);
+            addElementWithValue(m_pool, dataObject, Names::do_quality_iv, (long)0);
         }
 
-        addElementWithValue(dataObject, "do_quality_bl", (long)(OperatorBlocked() ? 1 : 0));
+        addElementWithValue(m_pool, dataObject, Names::do_quality_bl, (long)(OperatorBlocked() ? 1 : 0));
 
         if (getSource() == Source::SUBSTITUTED) {
-            addElementWithValue(dataObject, "do_quality_sb", (long)1);
+            addElementWithValue(m_pool, dataObject, Names::do_quality_sb, (long)1);
         }
         else {
-            addElementWithValue(dataObject, "do_quality_sb", (long)0);
+            addElementWithValue(m_pool, dataObject, Names::do_quality_sb, (long)0);
         }
 
-        addElementWithValue(dataObject, "do_quality_nt", (long)(OldData() ? 1 : 0));
+        addElementWithValue(m_pool, dataObject, Names::do_quality_nt, (long)(OldData() ? 1 : 0));
 
         if(m_pivotCdc == PivotCdc::BSC){
-            if(exchangeConfig->getTypeId()[0] == 'M')
-                addElementWithValue(dataObject, "do_value", "["+to_string(intVal)+","+ string(isTransient()?"true":"false") +"]");
+            if(exchangeConfig->getTypeId()[0] == 'M') {
+                if (stepPositionFormat == Iec104PivotUtility::StepPositionFormat::STRUCTURED) {
+                    Datapoint* value = addElement(m_pool, dataObject, Names::do_value);
+                    addElementWithValue(m_pool, value, Names::posVal, intVal);
+                    addElementWithValue(m_pool, value, Names::transInd, (long)(isTransient() ? 1 : 0));
+                }
+                else {
+                    char position[Iec104PivotUtility::STEP_POSITION_MAX_LENGTH];
+                    size_t length = Iec104PivotUtility::formatStepPosition(intVal, isTransient(), position);
+
+                    addElementWithValue(m_pool, dataObject, Names::do_value, std::string(position, length));
+                }
+            }
             else
-                addElementWithValue(dataObject, "do_value", intVal);
+                addElementWithValue(m_pool, dataObject, Names::do_value, intVal);
         }
 
         else {
             if (hasIntVal)
-                addElementWithValue(dataObject, "do_value", intVal);
+                addElementWithValue(m_pool, dataObject, Names::do_value, intVal);
             else
-                addElementWithValue(dataObject, "do_value", (double)floatVal);
+                addElementWithValue(m_pool, dataObject, Names::do_value, (double)floatVal);
         }
 
         if (m_pivotClass == PivotClass::GTIM) {
-            addElementWithValue(dataObject, "do_quality_ov", (long)(Overflow() ? 1 : 0));
+            addElementWithValue(m_pool, dataObject, Names::do_quality_ov, (long)(Overflow() ? 1 : 0));
         }
 
         if(m_pivotClass == PivotClass::GTIC){
-            addElementWithValue(dataObject, "do_negative", (long)(isConfirmation() ? 1 : 0));
+            addElementWithValue(m_pool, dataObject, Names::do_negative, (long)(isConfirmation() ? 1 : 0));
         }
 
-        if (m_timestamp) {
-            addElementWithValue(dataObject, "do_ts", ((long)(uint64_t)m_timestamp->getTimeInMs()));
+        if (m_hasTimestamp) {
+            addElementWithValue(m_pool, dataObject, Names::do_ts, ((long)(uint64_t)m_timestamp.getTimeInMs()));
 
-            bool timeInvalid = m_timestamp->ClockFailure() || m_timestamp->ClockNotSynchronized();
+            bool timeInvalid = m_timestamp.ClockFailure() || m_timestamp.ClockNotSynchronized();
 
             if (timeInvalid || IsTimestampInvalid()) {
-                addElementWithValue(dataObject, "do_ts_iv", (long)1);
+                addElementWithValue(m_pool, dataObject, Names::do_ts_iv, (long)1);
             }
 
             //addElementWithValue(dataObject, "do_ts_su", (long)0);
 
             if (IsTimestampSubstituted()) {
-                addElementWithValue(dataObject, "do_ts_sub", (long)1);
+                addElementWithValue(m_pool, dataObject, Names::do_ts_sub, (long)1);
             }
         }
         else {
-            addElementWithValue(dataObject, "do_ts", (long)PivotTimestamp::GetCurrentTimeInMs());
-            addElementWithValue(dataObject, "do_ts_sub", (long)1);
+            addElementWithValue(m_pool, dataObject, Names::do_ts, (long)clock.nowMs());
+            addElementWithValue(m_pool, dataObject, Names::do_ts_sub, (long)1);
         }
     }
 
     return dataObject;
 }
 
+Datapoint*
+PivotOperationObject::createIec104OperationObjectTemplate(IEC104PivotDataPoint* exchangeConfig)
+{
+    Datapoint* commandObject = createDp(nullptr, Names::command_object);
+
+    addElementWithValue(nullptr, commandObject, Names::co_type, exchangeConfig->getTypeId());
+    addElementWithValue(nullptr, commandObject, Names::co_ca, (long)exchangeConfig->getCA());
+    addElementWithValue(nullptr, commandObject, Names::co_ioa, (long)exchangeConfig->getIOA());
+
+    return commandObject;
+}
+
 std::vector<Datapoint*>
 PivotOperationObject::toIec104OperationObject(IEC104PivotDataPoint* exchangeConfig)
 {
     std::vector<Datapoint*> commandObject;
+    commandObject.reserve(9);
 
-    string asduType = exchangeConfig->getTypeId();
-    Datapoint* type = createDpWithValue("co_type",asduType);
-    commandObject.push_back(type);
+    Datapoint* commandTemplate = exchangeConfig->getIec104OperationObjectTemplate();
 
-    Datapoint* ca = createDpWithValue("co_ca",(long)exchangeConfig->getCA());
-    commandObject.push_back(ca);
-
-    Datapoint* ioa = createDpWithValue("co_ioa",(long)exchangeConfig->getIOA());
-    commandObject.push_back(ioa);
+    if (commandTemplate) {
+        for (Datapoint* element : *commandTemplate->getData().getDpVec()) {
+            commandObject.push_back(cloneDp(m_pool, element));
+        }
+    }
+    else {
+        commandObject.push_back(createDpWithValue(m_pool, Names::co_type, exchangeConfig->getTypeId()));
+        commandObject.push_back(createDpWithValue(m_pool, Names::co_ca, (long)exchangeConfig->getCA()));
+        commandObject.push_back(createDpWithValue(m_pool, Names::co_ioa, (long)exchangeConfig->getIOA()));
+    }
 
-    Datapoint* cot = createDpWithValue("co_cot",(long)getCause());
+    Datapoint* cot = createDpWithValue(m_pool, Names::co_cot,(long)getCause());
     commandObject.push_back(cot);
 
-    Datapoint* negative = createDpWithValue("co_negative",(long) isConfirmation());
+    Datapoint* negative = createDpWithValue(m_pool, Names::co_negative,(long) isConfirmation());
     commandObject.push_back(negative);
 
-    Datapoint* se = createDpWithValue("co_se",(long)getSelect());
+    Datapoint* se = createDpWithValue(m_pool, Names::co_se,(long)getSelect());
     commandObject.push_back(se);
 
-    Datapoint* test = createDpWithValue("co_test", (long)Test());
+    Datapoint* test = createDpWithValue(m_pool, Names::co_test, (long)Test());
     commandObject.push_back(test);
 
     long time = 0;
 
-    if (m_timestamp) {
-        time = m_timestamp->getTimeInMs();
+    if (m_hasTimestamp) {
+        time = m_timestamp.getTimeInMs();
     }
 
-    bool hasTime = asduType.find('T') != std::string::npos && time!= 0;
+    bool hasTime = Iec104PivotUtility::asduHasTimestamp(exchangeConfig->getAsduType()) && time!= 0;
 
-    Datapoint* ts = createDpWithValue("co_ts",(long) (hasTime ? time : 0));
+    Datapoint* ts = createDpWithValue(m_pool, Names::co_ts,(long) (hasTime ? time : 0));
     commandObject.push_back(ts);
 
     Datapoint* value = nullptr;
 
     if(hasIntVal)
-        value = createDpWithValue("co_value",(long) intVal);
+        value = createDpWithValue(m_pool, Names::co_value,(long) intVal);
     else
-        value = createDpWithValue("co_value", (double)floatVal);
+        value = createDpWithValue(m_pool, Names::co_value, (double)floatVal);
 
     commandObject.push_back(value);
 
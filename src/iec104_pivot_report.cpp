@@ -0,0 +1,130 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter report by exception.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include "iec104_pivot_report.hpp"
+
+using namespace Iec104PivotUtility;
+
+constexpr uint16_t ReportState::TIMESTAMP_FLAGS;
+constexpr uint64_t ReportByException::DEFAULT_ALWAYS_SENT_CAUSES;
+
+static constexpr int MAX_CAUSE = 63;
+
+static void
+skipBlanks(const char*& p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+}
+
+static bool
+readCause(const char*& p, const char* end, int& cause)
+{
+    skipBlanks(p, end);
+
+    if (p == end || *p < '0' || *p > '9') return false;
+
+    cause = 0;
+
+    while (p < end && *p >= '0' && *p <= '9') {
+        cause = cause * 10 + (*p - '0');
+        if (cause > MAX_CAUSE) return false;
+        p++;
+    }
+
+    skipBlanks(p, end);
+
+    return true;
+}
+
+bool
+Iec104PivotUtility::parseCauseList(const std::string& value, uint64_t& causes)
+{
+    const char* p = value.data();
+    const char* end = p + value.size();
+    uint64_t parsed = 0;
+
+    skipBlanks(p, end);
+
+    while (p < end) {
+        int first = 0;
+        int last = 0;
+
+        if (!readCause(p, end, first)) return false;
+
+        last = first;
+
+        if (p < end && *p == '-') {
+            p++;
+            if (!readCause(p, end, last) || last < first) return false;
+        }
+
+        for (int cause = first; cause <= last; cause++) {
+            parsed |= 1ULL << cause;
+        }
+
+        if (p < end) {
+            if (*p != ',') return false;
+            p++;
+            /* no empty item after a comma */
+            skipBlanks(p, end);
+            if (p == end) return false;
+        }
+    }
+
+    causes = parsed;
+
+    return true;
+}
+
+void
+ReportByException::setEnabled(bool enabled)
+{
+    /* the objects sent while the filter was disabled are not in the recorded states, a new generation
+       invalidates them all at once */
+    if (enabled && !m_enabled) m_generation++;
+
+    m_enabled = enabled;
+}
+
+bool
+ReportByException::mustSend(const ReportState& last, const ReportState& current, int cot, uint64_t nowMs) const
+{
+    if (!m_enabled) return true;
+
+    bool send = (last.generation != m_generation);
+
+    if (!send && cot >= 0 && cot <= MAX_CAUSE && (m_alwaysSentCauses & (1ULL << cot))) send = true;
+
+    if (!send) {
+        uint16_t comparedFlags = m_compareTimestamp ? 0xffff : (uint16_t)~ReportState::TIMESTAMP_FLAGS;
+
+        send = (current.value != last.value) || ((current.flags ^ last.flags) & comparedFlags) ||
+               (m_compareTimestamp && current.timestamp != last.timestamp);
+    }
+
+    /* a clock set back also sends the state again */
+    if (!send && m_refreshIntervalMs > 0) {
+        send = (nowMs < last.sentMs) || (nowMs - last.sentMs >= m_refreshIntervalMs);
+    }
+
+    return send;
+}
+
+void
+ReportByException::recordSent(ReportState& last, const ReportState& current, uint64_t nowMs) const
+{
+    /* the objects sent while disabled are not recorded, see setEnabled */
+    if (!m_enabled) return;
+
+    last = current;
+    last.sentMs = nowMs;
+    last.generation = m_generation;
+}
@@ -9,9 +9,14 @@
  * 
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <sstream>
 #include "iec104_pivot_utility.hpp"
 
+std::atomic<int> Iec104PivotUtility::minLogLevel(static_cast<int>(Iec104PivotUtility::LogLevel::WARNING));
+
 std::string Iec104PivotUtility::join(const std::vector<std::string> &list, const std::string &sep /*= ", "*/)
 {
     std::string ret;
@@ -23,3 +28,279 @@ std::string Iec104PivotUtility::join(const std::vector<std::string> &list, const
     }
     return ret;
 }
+
+void Iec104PivotUtility::refreshLogLevel()
+{
+    const std::string& level = Logger::getLogger()->getMinLevel();
+    LogLevel minLevel = LogLevel::WARNING;
+
+    if (level == "debug") {
+        minLevel = LogLevel::DEBUG;
+    }
+    else if (level == "info") {
+        minLevel = LogLevel::INFO;
+    }
+    else if (level == "warning") {
+        minLevel = LogLevel::WARNING;
+    }
+    else if (level == "error") {
+        minLevel = LogLevel::ERROR;
+    }
+    else if (level == "fatal") {
+        minLevel = LogLevel::FATAL;
+    }
+
+    minLogLevel.store(static_cast<int>(minLevel), std::memory_order_relaxed);
+}
+
+constexpr unsigned int Iec104PivotUtility::LogThrottle::BURST;
+constexpr uint64_t Iec104PivotUtility::LogThrottle::WINDOW_MS;
+constexpr size_t Iec104PivotUtility::LogThrottle::MAX_KEYS;
+constexpr uint64_t Iec104PivotUtility::LogThrottle::FLUSH_INTERVAL_MS;
+
+static uint64_t
+steadyClockMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Throttles of the process, flushed together. The call site throttles are function statics: the registry is built
+ * by the first of them, so it is destroyed after all of them.
+ */
+static std::mutex&
+throttleRegistryMutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::vector<Iec104PivotUtility::LogThrottle*>&
+throttleRegistry()
+{
+    static std::vector<Iec104PivotUtility::LogThrottle*> throttles;
+    return throttles;
+}
+
+static std::atomic<uint64_t> nextThrottleFlushMs(0);
+
+Iec104PivotUtility::LogThrottle::LogThrottle(const char* site, unsigned int burst, uint64_t windowMs):
+    m_site(site), m_burst(burst), m_windowMs(windowMs)
+{
+    std::lock_guard<std::mutex> guard(throttleRegistryMutex());
+    throttleRegistry().push_back(this);
+}
+
+Iec104PivotUtility::LogThrottle::~LogThrottle()
+{
+    std::lock_guard<std::mutex> guard(throttleRegistryMutex());
+    std::vector<LogThrottle*>& throttles = throttleRegistry();
+    throttles.erase(std::remove(throttles.begin(), throttles.end(), this), throttles.end());
+}
+
+static const std::string OVERFLOW_KEY("<other>");
+static constexpr uint64_t OVERFLOW_INTEGER_KEY = UINT64_MAX;
+
+static std::string
+integerKeyToString(uint64_t key)
+{
+    if (key == OVERFLOW_INTEGER_KEY) return OVERFLOW_KEY;
+
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%u-%u", static_cast<unsigned int>(key >> 32), static_cast<unsigned int>(key & 0xffffffffu));
+
+    return buffer;
+}
+
+template <class Key>
+bool Iec104PivotUtility::LogThrottle::allowKey(std::unordered_map<Key, KeyState>& states, const Key& key, const Key& overflowKey,
+                                               uint64_t nowMs, Key& summaryKey, uint64_t& suppressed, uint64_t& elapsedMs)
+{
+    auto it = states.find(key);
+    if (it == states.end()) {
+        const Key& stateKey = states.size() < MAX_KEYS ? key : overflowKey;
+        auto inserted = states.emplace(stateKey, KeyState());
+        it = inserted.first;
+        if (inserted.second) {
+            it->second.windowStart = nowMs;
+        }
+    }
+
+    KeyState& state = it->second;
+
+    if (nowMs - state.windowStart >= m_windowMs) {
+        suppressed = state.suppressed;
+        if (suppressed > 0) summaryKey = it->first;
+        elapsedMs = nowMs - state.windowStart;
+        state.windowStart = nowMs;
+        state.logged = 0;
+        state.suppressed = 0;
+    }
+
+    if (state.logged < m_burst) {
+        state.logged++;
+        return true;
+    }
+
+    state.suppressed++;
+    return false;
+}
+
+bool Iec104PivotUtility::LogThrottle::allow(const std::string& key)
+{
+    return allow(key, steadyClockMs());
+}
+
+bool Iec104PivotUtility::LogThrottle::allow(const std::string& key, uint64_t nowMs)
+{
+    uint64_t suppressed = 0;
+    uint64_t elapsedMs = 0;
+    std::string summaryKey;
+    bool logged = false;
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        logged = allowKey(m_states, key, OVERFLOW_KEY, nowMs, summaryKey, suppressed, elapsedMs);
+    }
+
+    /* logged outside of the lock, the log helpers may block on syslog */
+    if (suppressed > 0) {
+        logSummary(Summary{m_site, summaryKey, suppressed, elapsedMs});
+    }
+
+    return logged;
+}
+
+bool Iec104PivotUtility::LogThrottle::allow(uint64_t key)
+{
+    return allow(key, steadyClockMs());
+}
+
+bool Iec104PivotUtility::LogThrottle::allow(uint64_t key, uint64_t nowMs)
+{
+    uint64_t suppressed = 0;
+    uint64_t elapsedMs = 0;
+    uint64_t summaryKey = 0;
+    bool logged = false;
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        logged = allowKey(m_integerStates, key, OVERFLOW_INTEGER_KEY, nowMs, summaryKey, suppressed, elapsedMs);
+    }
+
+    if (suppressed > 0) {
+        logSummary(Summary{m_site, integerKeyToString(summaryKey), suppressed, elapsedMs});
+    }
+
+    return logged;
+}
+
+void Iec104PivotUtility::LogThrottle::logSummary(const Summary& summary)
+{
+    /* the key is a label, an address or a pivot ID depending on the call site */
+    log_warn("%s - LogThrottle - suppressed %lu occurrences for key %s in %lus: \"%s\"", PLUGIN_NAME, //LCOV_EXCL_LINE
+            static_cast<unsigned long>(summary.suppressed), summary.key.c_str(), //LCOV_EXCL_LINE
+            static_cast<unsigned long>(summary.elapsedMs / 1000), summary.site); //LCOV_EXCL_LINE
+}
+
+static const std::string&
+summaryKeyToString(const std::string& key)
+{
+    return key;
+}
+
+static std::string
+summaryKeyToString(uint64_t key)
+{
+    return integerKeyToString(key);
+}
+
+template <class Key>
+void Iec104PivotUtility::LogThrottle::collectExpired(std::unordered_map<Key, KeyState>& states, uint64_t nowMs,
+                                                     std::vector<Summary>& summaries)
+{
+    for (auto it = states.begin(); it != states.end();) {
+        const KeyState& state = it->second;
+
+        if (nowMs - state.windowStart < m_windowMs) {
+            ++it;
+            continue;
+        }
+
+        /* a key occurring again starts a new window, as a key never seen */
+        if (state.suppressed > 0) {
+            summaries.push_back(Summary{m_site, summaryKeyToString(it->first), state.suppressed, nowMs - state.windowStart});
+        }
+
+        it = states.erase(it);
+    }
+}
+
+void Iec104PivotUtility::LogThrottle::collectExpired(uint64_t nowMs, std::vector<Summary>& summaries)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    collectExpired(m_states, nowMs, summaries);
+    collectExpired(m_integerStates, nowMs, summaries);
+}
+
+size_t Iec104PivotUtility::LogThrottle::flush(uint64_t nowMs)
+{
+    std::vector<Summary> summaries;
+
+    collectExpired(nowMs, summaries);
+
+    for (const Summary& summary : summaries) {
+        logSummary(summary);
+    }
+
+    return summaries.size();
+}
+
+void Iec104PivotUtility::LogThrottle::flushAll(uint64_t nowMs)
+{
+    std::vector<Summary> summaries;
+
+    {
+        std::lock_guard<std::mutex> guard(throttleRegistryMutex());
+
+        for (LogThrottle* throttle : throttleRegistry()) {
+            throttle->collectExpired(nowMs, summaries);
+        }
+    }
+
+    /* a throttle may be destroyed meanwhile, the summaries only refer to its site, the format string of a call site */
+    for (const Summary& summary : summaries) {
+        logSummary(summary);
+    }
+}
+
+void Iec104PivotUtility::LogThrottle::flushExpired()
+{
+    uint64_t nowMs = steadyClockMs();
+    uint64_t nextMs = nextThrottleFlushMs.load(std::memory_order_relaxed);
+
+    /* a single caller flushes per interval */
+    if (nowMs < nextMs ||
+        !nextThrottleFlushMs.compare_exchange_strong(nextMs, nowMs + FLUSH_INTERVAL_MS, std::memory_order_relaxed)) {
+        return;
+    }
+
+    flushAll(nowMs);
+}
+
+uint64_t Iec104PivotUtility::LogThrottle::getSuppressedCount(const std::string& key)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = m_states.find(key);
+    return it == m_states.end() ? 0 : it->second.suppressed;
+}
+
+uint64_t Iec104PivotUtility::LogThrottle::getSuppressedCount(uint64_t key)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = m_integerStates.find(key);
+    return it == m_integerStates.end() ? 0 : it->second.suppressed;
+}
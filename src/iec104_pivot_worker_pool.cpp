@@ -0,0 +1,121 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter conversion worker pool.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ * Author: Michael Zillgith (michael.zillgith at mz-automation.de)
+ *
+ */
+
+#include "iec104_pivot_worker_pool.hpp"
+
+using namespace Iec104PivotUtility;
+
+WorkerPool::WorkerPool(size_t threadCount):
+    m_nextIndex(0)
+{
+    for (size_t i = 0; i < threadCount; i++) {
+        m_threads.push_back(std::thread(&WorkerPool::work, this, i + 1));
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_stopRequested = true;
+    }
+
+    m_jobCondition.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void
+WorkerPool::processChunks(size_t worker)
+{
+    for (;;) {
+        size_t begin = m_nextIndex.fetch_add(m_chunkSize);
+
+        if (begin >= m_count) break;
+
+        size_t end = begin + m_chunkSize < m_count ? begin + m_chunkSize : m_count;
+
+        try {
+            (*m_task)(begin, end, worker);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            if (!m_exception) m_exception = std::current_exception();
+        }
+    }
+}
+
+void
+WorkerPool::run(size_t count, size_t chunkSize, const Task& task)
+{
+    if (count == 0) return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+
+        m_task = &task;
+        m_count = count;
+        m_chunkSize = chunkSize > 0 ? chunkSize : 1;
+        m_nextIndex.store(0);
+        m_exception = nullptr;
+        m_busyThreads = m_threads.size();
+        m_generation++;
+    }
+
+    m_jobCondition.notify_all();
+
+    processChunks(0);
+
+    std::exception_ptr exception;
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        m_doneCondition.wait(lock, [this] {return m_busyThreads == 0;});
+
+        m_task = nullptr;
+        exception = m_exception;
+        m_exception = nullptr;
+    }
+
+    if (exception) std::rethrow_exception(exception);
+}
+
+void
+WorkerPool::work(size_t worker)
+{
+    uint64_t generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+
+            m_jobCondition.wait(lock, [this, generation] {return m_stopRequested || m_generation != generation;});
+
+            if (m_stopRequested) return;
+
+            generation = m_generation;
+        }
+
+        processChunks(worker);
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            m_busyThreads--;
+        }
+
+        m_doneCondition.notify_one();
+    }
+}
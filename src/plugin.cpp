@@ -99,6 +99,82 @@ static const char *default_config = QUOTE({
                                     ]
                                 }
                             })
+            },
+            "async_logging": {
+                "description": "Write warnings and errors from a background thread so that bursts of log messages do not block the readings flow",
+                "type": "boolean",
+                "displayName": "Asynchronous logging",
+                "order": "2",
+                "default": "false"
+            },
+            "conversion_threads": {
+                "description": "Number of additional threads converting large reading sets in parallel (0 to convert all readings in the calling thread)",
+                "type": "integer",
+                "displayName": "Conversion threads",
+                "order": "3",
+                "default": "0",
+                "minimum": "0",
+                "maximum": "64"
+            },
+            "parallel_threshold": {
+                "description": "Minimum number of readings in a set for the set to be converted by the conversion threads",
+                "type": "integer",
+                "displayName": "Parallel conversion threshold",
+                "order": "4",
+                "default": "1024",
+                "minimum": "1"
+            },
+            "config_cache_dir": {
+                "description": "Directory where the compiled exchanged_data is kept as a binary image, loaded instead of parsing the JSON on the next start (empty to disable)",
+                "type": "string",
+                "displayName": "Configuration cache directory",
+                "order": "5",
+                "default": ""
+            },
+            "timestamp_clock": {
+                "description": "Time given to the objects received without a timestamp: read once per reading set (batch), for each object (object), or for each object from the cheaper coarse clock, precise to a few ms (coarse)",
+                "type": "enumeration",
+                "options": ["batch", "object", "coarse"],
+                "displayName": "Timestamp clock",
+                "order": "6",
+                "default": "batch"
+            },
+            "step_position_format": {
+                "description": "do_value of the step positions (M_ST) sent to the IEC 104 side: \"[position,transient]\" string (string), or dictionary with the posVal and transInd integers (structured). Both are accepted from the IEC 104 side",
+                "type": "enumeration",
+                "options": ["string", "structured"],
+                "displayName": "Step position format",
+                "order": "7",
+                "default": "string"
+            },
+            "report_by_exception": {
+                "description": "Only send the monitoring objects received from the IEC 104 side whose value or quality changed since the last one sent for their exchanged data entry",
+                "type": "boolean",
+                "displayName": "Report by exception",
+                "order": "8",
+                "default": "false"
+            },
+            "report_refresh_interval": {
+                "description": "Time in seconds after which an unchanged object is sent again by report by exception (0 to never send it again)",
+                "type": "integer",
+                "displayName": "Report refresh interval",
+                "order": "9",
+                "default": "0",
+                "minimum": "0"
+            },
+            "report_compare_timestamp": {
+                "description": "Report by exception also sends the objects whose only change is their timestamp",
+                "type": "boolean",
+                "displayName": "Report timestamp changes",
+                "order": "10",
+                "default": "false"
+            },
+            "report_always_sent_cot": {
+                "description": "Causes of transmission always sent by report by exception, as a list of causes and ranges (interrogation responses by default)",
+                "type": "string",
+                "displayName": "Causes always reported",
+                "order": "11",
+                "default": "20-41"
             }
 		});
 
@@ -132,8 +208,9 @@ PLUGIN_HANDLE plugin_init(ConfigCategory* config,
                           OUTPUT_HANDLE *outHandle,
                           OUTPUT_STREAM output)
 {
-    std::string beforeLog = Iec104PivotUtility::PluginName + " - plugin_init -"; //LCOV_EXCL_LINE
-    Iec104PivotUtility::log_info("%s Initializing the plugin", beforeLog.c_str()); //LCOV_EXCL_LINE
+    constexpr const char* beforeLog = PLUGIN_NAME " - plugin_init -"; //LCOV_EXCL_LINE
+    Iec104PivotUtility::refreshLogLevel();
+    Iec104PivotUtility::log_info("%s Initializing the plugin", beforeLog); //LCOV_EXCL_LINE
 
     IEC104PivotFilter* pivotFilter = new IEC104PivotFilter(PLUGIN_NAME,
                                 config, outHandle, output);
@@ -0,0 +1,100 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter test helpers.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#ifndef _IEC104_PIVOT_DATAPOINT_BUILDERS_H
+#define _IEC104_PIVOT_DATAPOINT_BUILDERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <datapoint.h>
+
+/*
+ * Builders of the IEC 104 objects received by the filter, shared by the unit tests and the benchmarks
+ */
+
+template <class T>
+static Datapoint* createDatapoint(const std::string& dataname,
+                                    const T value)
+{
+    DatapointValue dp_value = DatapointValue(value);
+    return new Datapoint(dataname, dp_value);
+}
+
+template <class T>
+static std::vector<Datapoint*> createCommandObject(const char* type, long ca, long ioa, long cot,
+    long negative, long se, long test, long ts, const T value)
+    {
+    std::vector<Datapoint*> commandObject;
+
+    Datapoint* type1 = createDatapoint("co_type",(std::string)type);
+    commandObject.push_back(type1);
+
+    Datapoint* ca1 = createDatapoint("co_ca",(long)ca);
+    commandObject.push_back(ca1);
+
+    Datapoint* ioa1 = createDatapoint("co_ioa",(long)ioa);
+    commandObject.push_back(ioa1);
+
+    Datapoint* cot1 = createDatapoint("co_cot",(long)cot);
+    commandObject.push_back(cot1);
+
+    Datapoint* negative1 = createDatapoint("co_negative",(long)negative);
+    commandObject.push_back(negative1);
+
+    Datapoint* se1 = createDatapoint("co_se",(long)se);
+    commandObject.push_back(se1);
+
+    Datapoint* test1 = createDatapoint("co_test",(long)test);
+    commandObject.push_back(test1);
+
+    Datapoint* ts1 = createDatapoint("co_ts",(long)ts);
+    commandObject.push_back(ts1);
+
+    Datapoint* value1 = createDatapoint("co_value", value);
+    commandObject.push_back(value1);
+
+    return commandObject;
+}
+
+template <class T>
+static Datapoint* createDataObject(int test, const char* type, int ca, int ioa, int cot,
+    const T value, bool iv, bool bl, bool ov, bool sb, bool nt, long msTime, bool isInvalid, bool isSummerTime, bool isSubst)
+{
+    auto* datapoints = new std::vector<Datapoint*>;
+
+    datapoints->push_back(createDatapoint("do_type", type));
+    datapoints->push_back(createDatapoint("do_ca", (int64_t)ca));
+    datapoints->push_back(createDatapoint("do_oa", (int64_t)0));
+    datapoints->push_back(createDatapoint("do_cot", (int64_t)cot));
+    datapoints->push_back(createDatapoint("do_test", (int64_t)0));
+    datapoints->push_back(createDatapoint("do_negative", (int64_t)0));
+    datapoints->push_back(createDatapoint("do_ioa", (int64_t)ioa));
+    datapoints->push_back(createDatapoint("do_value", value));
+    datapoints->push_back(createDatapoint("do_quality_iv", (int64_t)iv));
+    datapoints->push_back(createDatapoint("do_quality_bl", (int64_t)bl));
+    datapoints->push_back(createDatapoint("do_quality_ov", (int64_t)ov));
+    datapoints->push_back(createDatapoint("do_quality_sb", (int64_t)sb));
+    datapoints->push_back(createDatapoint("do_quality_nt", (int64_t)nt));
+
+    if (msTime != 0) {
+         datapoints->push_back(createDatapoint("do_ts", msTime));
+         datapoints->push_back(createDatapoint("do_ts_iv", isInvalid ? 1L : 0L));
+         datapoints->push_back(createDatapoint("do_ts_su", isSummerTime ? 1L : 0L));
+         datapoints->push_back(createDatapoint("do_ts_sub", isSubst ? 1L : 0L));
+    }
+
+    DatapointValue dpv(datapoints, true);
+
+    Datapoint* dp = new Datapoint("data_object", dpv);
+
+    return dp;
+}
+
+#endif /* _IEC104_PIVOT_DATAPOINT_BUILDERS_H */
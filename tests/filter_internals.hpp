@@ -0,0 +1,92 @@
+/*
+ * FledgePower IEC 104 <-> pivot filter test helpers.
+ *
+ * Copyright (c) 2022, RTE (https://www.rte-france.com)
+ *
+ * Released under the Apache 2.0 Licence
+ *
+ */
+
+#ifndef _IEC104_PIVOT_FILTER_INTERNALS_H
+#define _IEC104_PIVOT_FILTER_INTERNALS_H
+
+#include <string>
+#include <vector>
+#include <reading.h>
+
+#include "iec104_pivot_filter.hpp"
+
+/*
+ * Access to the conversion steps of a filter, shared by the unit tests and the benchmarks. Each step runs with the
+ * configuration and the settings current when it is called, as ingest would.
+ */
+class IEC104PivotFilterInternals
+{
+public:
+    typedef IEC104PivotFilter::PendingReport PendingReport;
+
+    explicit IEC104PivotFilterInternals(IEC104PivotFilter& filter): m_filter(filter) {};
+
+    /* Report by exception pre-pass of ingest */
+    void suppressUnchangedDataObjects(std::vector<Reading*>& readings)
+    {
+        Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig>::Reader config = m_filter.m_config.acquire();
+        Iec104PivotUtility::SnapshotPointer<IEC104PivotFilter::RuntimeSettings>::Reader settings = m_filter.m_settings.acquire();
+
+        m_filter.suppressUnchangedDataObjects(*config, settings->reportByException, readings, m_filter.m_metrics.getShard(0),
+                                              clock(*settings));
+    }
+
+    /* Reports left by the pre-pass, the conversion marks the converted ones */
+    std::vector<PendingReport>& getPendingReports() {return m_filter.m_pendingReports;};
+
+    void recordSentDataObjects() {m_filter.recordSentDataObjects();};
+
+    /* Conversion steps of ingest, called with a configuration and a clock obtained once from the filter */
+    Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig>::Reader acquireConfig() {return m_filter.m_config.acquire();};
+
+    Iec104PivotUtility::ConversionClock clock()
+    {
+        Iec104PivotUtility::SnapshotPointer<IEC104PivotFilter::RuntimeSettings>::Reader settings = m_filter.m_settings.acquire();
+
+        return clock(*settings);
+    }
+
+    static void readDataObjectAttributes(const std::vector<Datapoint*>& datapoints, IEC104PivotFilter::Iec104DataObject& dataObject)
+    {
+        IEC104PivotFilter::readDataObjectAttributes(datapoints, dataObject);
+    }
+
+    Datapoint* convertDataObjectToPivot(IEC104PivotFilter::Iec104DataObject& dataObject, IEC104PivotDataPoint* exchangeConfig,
+                                        DatapointPool& pool, const Iec104PivotUtility::ConversionClock& clock)
+    {
+        return m_filter.convertDataObjectToPivot(dataObject, exchangeConfig, pool, m_filter.m_metrics.getShard(0), clock);
+    }
+
+    Datapoint* convertOperationObjectToPivot(const IEC104PivotConfig& config, const std::vector<Datapoint*>& datapoints,
+                                             DatapointPool& pool, const Iec104PivotUtility::ConversionClock& clock)
+    {
+        return m_filter.convertOperationObjectToPivot(config, datapoints, pool, m_filter.m_metrics.getShard(0), clock);
+    }
+
+    /* Last state sent for the definition of a label, the definition must exist */
+    Iec104PivotUtility::ReportState getReportState(const std::string& label)
+    {
+        Iec104PivotUtility::SnapshotPointer<IEC104PivotConfig>::Reader config = m_filter.m_config.acquire();
+
+        return config->getExchangeDefinitionsByLabel(label)->getReportState();
+    }
+
+private:
+    Iec104PivotUtility::ConversionClock clock(const IEC104PivotFilter::RuntimeSettings& settings)
+    {
+        Iec104PivotUtility::TimeSource timeSource = m_filter.m_timeSource.load();
+
+        return Iec104PivotUtility::ConversionClock(timeSource ? timeSource : Iec104PivotUtility::realtimeClockMs,
+                                                   settings.clockMode);
+    }
+
+    IEC104PivotFilter& m_filter;
+};
+
+#endif /* _IEC104_PIVOT_FILTER_INTERNALS_H */
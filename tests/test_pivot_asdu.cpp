@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <climits>
+#include <string>
+
+#include "iec104_pivot_asdu.hpp"
+
+using namespace Iec104PivotUtility;
+
+TEST(PivotIEC104PluginAsdu, ParseAsduType)
+{
+    // Every supported type name round-trips through its identifier
+    for (int i = 1; i < static_cast<int>(Iec104AsduType::COUNT); i++) {
+        Iec104AsduType type = static_cast<Iec104AsduType>(i);
+        ASSERT_EQ(type, parseAsduType(std::string(asduTypeToString(type))));
+    }
+
+    ASSERT_EQ(Iec104AsduType::M_SP_TB_1, parseAsduType("M_SP_TB_1"));
+    ASSERT_EQ(Iec104AsduType::C_SE_TC_1, parseAsduType("C_SE_TC_1"));
+
+    ASSERT_EQ(Iec104AsduType::UNKNOWN, parseAsduType(""));
+    ASSERT_EQ(Iec104AsduType::UNKNOWN, parseAsduType("M_SP_TB"));
+    ASSERT_EQ(Iec104AsduType::UNKNOWN, parseAsduType("M_SP_TB_2"));
+    ASSERT_EQ(Iec104AsduType::UNKNOWN, parseAsduType("M_SP_TB_1 "));
+    ASSERT_EQ(Iec104AsduType::UNKNOWN, parseAsduType("M_IT_NA_1"));
+    ASSERT_EQ(Iec104AsduType::UNKNOWN, parseAsduType("m_sp_tb_1"));
+    ASSERT_STREQ("UNKNOWN", asduTypeToString(Iec104AsduType::UNKNOWN));
+}
+
+TEST(PivotIEC104PluginAsdu, AsduTimestamp)
+{
+    ASSERT_FALSE(asduHasTimestamp(Iec104AsduType::UNKNOWN));
+
+    // Same rule as the ASDU naming convention: the fifth character is 'T' for types with a timestamp
+    for (int i = 1; i < static_cast<int>(Iec104AsduType::COUNT); i++) {
+        Iec104AsduType type = static_cast<Iec104AsduType>(i);
+        ASSERT_EQ(asduTypeToString(type)[5] == 'T', asduHasTimestamp(type)) << asduTypeToString(type);
+    }
+}
+
+TEST(PivotIEC104PluginAsdu, AsduTypeCompatibility)
+{
+    ASSERT_TRUE(isAsduTypeCompatible(Iec104AsduType::M_SP_NA_1, Iec104AsduType::M_SP_TB_1));
+    ASSERT_TRUE(isAsduTypeCompatible(Iec104AsduType::M_ME_TE_1, Iec104AsduType::M_ME_NB_1));
+    ASSERT_TRUE(isAsduTypeCompatible(Iec104AsduType::C_RC_TA_1, Iec104AsduType::C_RC_TA_1));
+
+    ASSERT_FALSE(isAsduTypeCompatible(Iec104AsduType::M_SP_NA_1, Iec104AsduType::M_DP_NA_1));
+    ASSERT_FALSE(isAsduTypeCompatible(Iec104AsduType::M_ME_NA_1, Iec104AsduType::M_ME_NC_1));
+    ASSERT_FALSE(isAsduTypeCompatible(Iec104AsduType::C_SE_NA_1, Iec104AsduType::C_SE_NC_1));
+    ASSERT_FALSE(isAsduTypeCompatible(Iec104AsduType::UNKNOWN, Iec104AsduType::UNKNOWN));
+    ASSERT_FALSE(isAsduTypeCompatible(Iec104AsduType::UNKNOWN, Iec104AsduType::M_SP_NA_1));
+
+    ASSERT_EQ(Iec104AsduFamily::SE_FLOAT, getAsduFamily(Iec104AsduType::C_SE_TC_1));
+    ASSERT_EQ(Iec104AsduFamily::UNKNOWN, getAsduFamily(Iec104AsduType::COUNT));
+}
+
+TEST(PivotIEC104PluginAsdu, AsduTraits)
+{
+    static_assert(getAsduTraits(Iec104AsduType::M_ME_TE_1).valueKind == Iec104ValueKind::SCALED, "traits are constant");
+
+    // The command flag and pivot logical node follow the type name
+    for (int i = 1; i < static_cast<int>(Iec104AsduType::COUNT); i++) {
+        const Iec104AsduTraits& traits = getAsduTraits(static_cast<Iec104AsduType>(i));
+
+        ASSERT_STREQ(asduTypeToString(static_cast<Iec104AsduType>(i)), traits.name);
+        ASSERT_EQ(traits.name[0] == 'C', traits.isCommand) << traits.name;
+        ASSERT_STREQ(traits.isCommand ? "GTIC" : (traits.family == Iec104AsduFamily::SP || traits.family == Iec104AsduFamily::DP) ? "GTIS" : "GTIM", traits.pivotLN) << traits.name;
+    }
+
+    ASSERT_STREQ("DpcTyp", getAsduTraits(Iec104AsduType::C_DC_TA_1).pivotCdc);
+    ASSERT_STREQ("IncTyp", getAsduTraits(Iec104AsduType::C_SE_NB_1).pivotCdc);
+    ASSERT_EQ(nullptr, getAsduTraits(Iec104AsduType::COUNT).pivotLN);
+
+    long value = -1;
+
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(parseDoublePoint(doublePointToString(i), value));
+        ASSERT_EQ(i, value);
+        ASSERT_TRUE(parseStepCommand(*stepCommandToString(i), value));
+        ASSERT_EQ(i, value);
+    }
+
+    ASSERT_FALSE(parseDoublePoint("on ", value));
+    ASSERT_EQ(3, value);
+    ASSERT_EQ(nullptr, stepCommandToString(4));
+}
+
+TEST(PivotIEC104PluginAsdu, StepPositionCodec)
+{
+    char buffer[STEP_POSITION_MAX_LENGTH];
+    long position = 0;
+    bool transient = false;
+
+    // Every position of the 7 bit range round-trips with both transient states
+    for (long i = -64; i < 64; i++) {
+        for (bool t : {false, true}) {
+            size_t length = formatStepPosition(i, t, buffer);
+
+            ASSERT_EQ(std::string("[") + std::to_string(i) + (t ? ",true]" : ",false]"), std::string(buffer, length));
+            ASSERT_EQ('\0', buffer[length]);
+            ASSERT_TRUE(parseStepPosition(buffer, length, position, transient)) << buffer;
+            ASSERT_EQ(i, position);
+            ASSERT_EQ(t, transient);
+        }
+    }
+
+    ASSERT_EQ("[-9223372036854775808,false]", std::string(buffer, formatStepPosition(LONG_MIN, false, buffer)));
+
+    ASSERT_TRUE(parseStepPosition(" [ -12 , true ] ", position, transient));
+    ASSERT_EQ(-12, position);
+    ASSERT_TRUE(transient);
+    ASSERT_TRUE(parseStepPosition("[+5,false]", position, transient));
+    ASSERT_EQ(5, position);
+    ASSERT_FALSE(transient);
+
+    const char* invalid[] = {"", "[", "[]", "[1]", "[1,]", "[,true]", "1,true", "[1,true", "[1,true]x", "[1,True]",
+                             "[1,1]", "[1 2,true]", "[-,true]", "[1.5,true]", "[1,truex]", "[1234567890123456789,true]"};
+
+    for (const char* value : invalid) {
+        ASSERT_FALSE(parseStepPosition(value, position, transient)) << value;
+    }
+
+    StepPositionFormat format = StepPositionFormat::STRING;
+
+    ASSERT_TRUE(parseStepPositionFormat("structured", format));
+    ASSERT_EQ(StepPositionFormat::STRUCTURED, format);
+    ASSERT_TRUE(parseStepPositionFormat("string", format));
+    ASSERT_EQ(StepPositionFormat::STRING, format);
+    ASSERT_FALSE(parseStepPositionFormat("json", format));
+    ASSERT_EQ(StepPositionFormat::STRING, format);
+}
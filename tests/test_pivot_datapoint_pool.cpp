@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <datapoint.h>
+
+#include "iec104_pivot_datapoint_pool.hpp"
+
+static Datapoint*
+createTree()
+{
+    auto* children = new std::vector<Datapoint*>;
+
+    DatapointValue type(std::string("M_SP_NA_1"));
+    children->push_back(new Datapoint("do_type", type));
+    DatapointValue ca((long)45);
+    children->push_back(new Datapoint("do_ca", ca));
+    DatapointValue value(1.5);
+    children->push_back(new Datapoint("do_value", value));
+
+    DatapointValue dpv(children, true);
+
+    return new Datapoint("data_object", dpv);
+}
+
+TEST(PivotIEC104PluginDatapointPool, CreateWithoutReleasedNodes)
+{
+    DatapointPool pool;
+
+    Datapoint* dict = pool.createDict("PIVOT");
+    ASSERT_EQ("PIVOT", dict->getName());
+    ASSERT_EQ(DatapointValue::T_DP_DICT, dict->getData().getType());
+    ASSERT_TRUE(dict->getData().getDpVec()->empty());
+
+    Datapoint* leaf = pool.createValue("stVal", (long)1);
+    ASSERT_EQ(1, leaf->getData().toInt());
+
+    ASSERT_EQ(0, pool.getHitCount());
+    ASSERT_EQ(2, pool.getMissCount());
+
+    delete dict;
+    delete leaf;
+}
+
+TEST(PivotIEC104PluginDatapointPool, ReleasedNodesAreReused)
+{
+    DatapointPool pool;
+
+    Datapoint* tree = createTree();
+    pool.release(tree);
+
+    ASSERT_EQ(4, pool.getFreeNodeCount());
+
+    Datapoint* dict = pool.createDict("GTIS");
+    ASSERT_EQ(tree, dict);
+    ASSERT_EQ("GTIS", dict->getName());
+    ASSERT_TRUE(dict->getData().getDpVec()->empty());
+
+    // Released string leaves can hold any kind of value
+    Datapoint* integer = pool.createValue("stVal", (long)7);
+    ASSERT_EQ(DatapointValue::T_INTEGER, integer->getData().getType());
+    ASSERT_EQ(7, integer->getData().toInt());
+
+    Datapoint* real = pool.createValue("f", 2.5f);
+    ASSERT_EQ(DatapointValue::T_FLOAT, real->getData().getType());
+    ASSERT_DOUBLE_EQ(2.5, real->getData().toDouble());
+
+    Datapoint* text = pool.createValue("Validity", "good");
+    ASSERT_EQ(DatapointValue::T_STRING, text->getData().getType());
+    ASSERT_EQ("good", text->getData().toStringValue());
+
+    ASSERT_EQ(4, pool.getHitCount());
+    ASSERT_EQ(0, pool.getMissCount());
+    ASSERT_EQ(0, pool.getFreeNodeCount());
+
+    Datapoint* missed = pool.createValue("stVal", (long)0);
+    ASSERT_EQ(1, pool.getMissCount());
+
+    dict->getData().getDpVec()->push_back(integer);
+    dict->getData().getDpVec()->push_back(real);
+    dict->getData().getDpVec()->push_back(text);
+    dict->getData().getDpVec()->push_back(missed);
+    delete dict;
+}
+
+TEST(PivotIEC104PluginDatapointPool, Clone)
+{
+    DatapointPool pool;
+
+    Datapoint* tree = createTree();
+    Datapoint* copy = pool.clone(tree);
+
+    ASSERT_NE(tree, copy);
+    ASSERT_EQ(tree->getData().toString(), copy->getData().toString());
+    ASSERT_EQ("data_object", copy->getName());
+
+    // Modifying the copy does not change the source
+    (*copy->getData().getDpVec())[1]->getData().setValue((long)46);
+    ASSERT_EQ(45, (*tree->getData().getDpVec())[1]->getData().toInt());
+
+    pool.release(copy);
+    ASSERT_EQ(4, pool.getFreeNodeCount());
+
+    Datapoint* recycled = pool.clone(tree);
+    ASSERT_EQ(tree->getData().toString(), recycled->getData().toString());
+    ASSERT_EQ(4, pool.getHitCount());
+
+    delete tree;
+    delete recycled;
+}
@@ -0,0 +1,389 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+#include <datapoint.h>
+
+#include "iec104_pivot_filter_config.hpp"
+#include "iec104_pivot_object.hpp"
+
+TEST(PivotIEC104PluginConfig, ExchangeDefinitionIndex)
+{
+    ExchangeDefinitionIndex index;
+
+    ASSERT_EQ(0, index.size());
+    ASSERT_EQ(nullptr, index.find("TS1"));
+
+    std::vector<std::shared_ptr<IEC104PivotDataPoint>> dataPoints;
+
+    for (int i = 0; i < 1000; i++) {
+        std::string label = "TS" + std::to_string(i);
+        dataPoints.push_back(std::make_shared<IEC104PivotDataPoint>(label, "ID" + std::to_string(i), "SpsTyp", "M_SP_NA_1", 45, i, ""));
+        index.insert(label, dataPoints.back());
+    }
+
+    ASSERT_EQ(1000, index.size());
+
+    for (int i = 0; i < 1000; i++) {
+        std::string label = "TS" + std::to_string(i);
+        ASSERT_EQ(dataPoints[i].get(), index.find(label));
+        ASSERT_EQ(dataPoints[i].get(), index.find(label.c_str(), label.size()));
+    }
+
+    // Keys are compared on their full length
+    ASSERT_EQ(nullptr, index.find("TS1", 2));
+    ASSERT_EQ(nullptr, index.find("TS1000"));
+    ASSERT_EQ(nullptr, index.find(""));
+
+    // Inserting an existing key replaces the definition
+    auto replacement = std::make_shared<IEC104PivotDataPoint>("TS1", "ID-new", "SpsTyp", "M_SP_TB_1", 45, 1, "");
+    index.insert("TS1", replacement);
+    ASSERT_EQ(1000, index.size());
+    ASSERT_EQ(replacement.get(), index.find("TS1"));
+
+    index.clear();
+    ASSERT_EQ(0, index.size());
+    ASSERT_EQ(nullptr, index.find("TS2"));
+}
+
+TEST(PivotIEC104PluginConfig, ExchangeAddressIndex)
+{
+    ExchangeAddressIndex index;
+
+    ASSERT_EQ(nullptr, index.find(45, 672));
+
+    std::vector<std::shared_ptr<IEC104PivotDataPoint>> dataPoints;
+
+    for (int i = 0; i < 1000; i++) {
+        dataPoints.push_back(std::make_shared<IEC104PivotDataPoint>("TS" + std::to_string(i), "ID" + std::to_string(i), "SpsTyp", "M_SP_NA_1", 1 + i % 3, i, ""));
+        index.insert(1 + i % 3, i, dataPoints.back());
+    }
+
+    ASSERT_EQ(1000, index.size());
+
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(dataPoints[i].get(), index.find(1 + i % 3, i));
+    }
+
+    // CA and IOA are not interchangeable
+    ASSERT_EQ(nullptr, index.find(4, 1));
+    ASSERT_EQ(nullptr, index.find(2, 0));
+    ASSERT_NE(ExchangeAddressIndex::packAddress(1, 2), ExchangeAddressIndex::packAddress(2, 1));
+
+    index.clear();
+    ASSERT_EQ(0, index.size());
+    ASSERT_EQ(nullptr, index.find(1, 0));
+}
+
+TEST(PivotIEC104PluginConfig, ExchangeDefinitionLookup)
+{
+    IEC104PivotConfig config;
+
+    config.importExchangeConfig(R"({
+        "exchanged_data": {
+            "datapoints": [
+                {
+                    "label": "TS1",
+                    "pivot_id": "ID-45-672",
+                    "pivot_type": "SpsTyp",
+                    "protocols": [
+                        {"name": "iec104", "address": "45-672", "typeid": "M_SP_NA_1"}
+                    ]
+                },
+                {
+                    "label": "TM1",
+                    "pivot_id": "ID-45-984",
+                    "pivot_type": "MvTyp",
+                    "protocols": [
+                        {"name": "iec104", "address": "45-984", "typeid": "M_ME_NA_1"}
+                    ]
+                }
+            ]
+        }
+    })");
+
+    IEC104PivotDataPoint* ts1 = config.getExchangeDefinitionsByLabel("TS1");
+    ASSERT_NE(nullptr, ts1);
+    ASSERT_EQ(672, ts1->getIOA());
+    ASSERT_EQ(Iec104AsduType::M_SP_NA_1, ts1->getAsduType());
+    ASSERT_EQ(ts1, config.getExchangeDefinitionsByAddress("45-672"));
+    ASSERT_EQ(ts1, config.getExchangeDefinitionsByPivotId("ID-45-672"));
+
+    const char* address = "45-984 trailing";
+    IEC104PivotDataPoint* tm1 = config.getExchangeDefinitionsByAddress(address, 6);
+    ASSERT_NE(nullptr, tm1);
+    ASSERT_EQ("TM1", tm1->getLabel());
+
+    ASSERT_EQ(ts1, config.getExchangeDefinitionsByAddress(45, 672));
+    ASSERT_EQ(tm1, config.getExchangeDefinitionsByAddress(45, 984));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByAddress(672, 45));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByAddress("45"));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByAddress("45-"));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByAddress("-672"));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByAddress("45-672x"));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByAddress("45-99999999999"));
+
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByLabel("TS2"));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByAddress("45-673"));
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByPivotId("ID-45-673"));
+}
+
+TEST(PivotIEC104PluginConfig, OutputTemplates)
+{
+    IEC104PivotDataPoint measure("TM1", "ID-45-984", "MvTyp", "M_ME_NC_1", 45, 984, "");
+
+    Datapoint* pivotTemplate = measure.getPivotTemplate();
+    ASSERT_NE(nullptr, pivotTemplate);
+    ASSERT_EQ("PIVOT", pivotTemplate->getName());
+    Datapoint* ln = (*pivotTemplate->getData().getDpVec())[0];
+    ASSERT_EQ("GTIM", ln->getName());
+    std::vector<Datapoint*>* lnChildren = ln->getData().getDpVec();
+    ASSERT_EQ(3, lnChildren->size());
+    ASSERT_EQ("ComingFrom", (*lnChildren)[0]->getName());
+    ASSERT_EQ("MvTyp", (*lnChildren)[1]->getName());
+    ASSERT_EQ("Identifier", (*lnChildren)[2]->getName());
+    ASSERT_EQ("ID-45-984", (*lnChildren)[2]->getData().toStringValue());
+
+    Datapoint* dataObjectTemplate = measure.getIec104DataObjectTemplate();
+    ASSERT_NE(nullptr, dataObjectTemplate);
+    std::vector<Datapoint*>* doChildren = dataObjectTemplate->getData().getDpVec();
+    ASSERT_EQ(3, doChildren->size());
+    ASSERT_EQ("do_type", (*doChildren)[0]->getName());
+    ASSERT_EQ("do_ca", (*doChildren)[1]->getName());
+    ASSERT_EQ(45, (*doChildren)[1]->getData().toInt());
+    ASSERT_EQ("do_ioa", (*doChildren)[2]->getName());
+    ASSERT_EQ(984, (*doChildren)[2]->getData().toInt());
+    ASSERT_EQ(nullptr, measure.getIec104OperationObjectTemplate());
+
+    // Objects built from the template are independent copies
+    PivotDataObject first(&measure, "GTIM", "MvTyp");
+    first.setCause(3);
+    PivotDataObject second(&measure, "GTIM", "MvTyp");
+    ASSERT_EQ(3, ln->getData().getDpVec()->size());
+    ASSERT_EQ(3, (*second.toDatapoint()->getData().getDpVec())[0]->getData().getDpVec()->size());
+    delete first.toDatapoint();
+    delete second.toDatapoint();
+
+    // A shape that differs from the configured type is still built from scratch
+    PivotDataObject other(&measure, "GTIS", "SpsTyp");
+    Datapoint* otherLn = (*other.toDatapoint()->getData().getDpVec())[0];
+    ASSERT_EQ("GTIS", otherLn->getName());
+    ASSERT_EQ("ID-45-984", (*otherLn->getData().getDpVec())[2]->getData().toStringValue());
+    delete other.toDatapoint();
+
+    IEC104PivotDataPoint command("C1", "ID-45-200", "SpcTyp", "C_SC_NA_1", 45, 200, "");
+    Datapoint* operationTemplate = command.getIec104OperationObjectTemplate();
+    ASSERT_NE(nullptr, operationTemplate);
+    std::vector<Datapoint*>* coChildren = operationTemplate->getData().getDpVec();
+    ASSERT_EQ(3, coChildren->size());
+    ASSERT_EQ("co_type", (*coChildren)[0]->getName());
+    ASSERT_EQ("C_SC_NA_1", (*coChildren)[0]->getData().toStringValue());
+
+    IEC104PivotDataPoint unknown("X1", "ID-X1", "SpsTyp", "M_XX_NA_1", 45, 1, "");
+    ASSERT_EQ(nullptr, unknown.getPivotTemplate());
+    ASSERT_EQ(nullptr, unknown.getIec104DataObjectTemplate());
+}
+
+static std::string
+exchangedData(const std::string& datapoints)
+{
+    return R"({"exchanged_data":{"datapoints":[)" + datapoints + "]}}";
+}
+
+static const char* TS1 = R"({"label":"TS1","pivot_id":"ID-45-672","pivot_type":"SpsTyp","protocols":[{"name":"iec104","address":"45-672","typeid":"M_SP_NA_1"}]})";
+static const char* TM1 = R"({"label":"TM1","pivot_id":"ID-45-984","pivot_type":"MvTyp","protocols":[{"name":"iec104","address":"45-984","typeid":"M_ME_NA_1"}]})";
+static const char* TM1_FLOAT = R"({"label":"TM1","pivot_id":"ID-45-984","pivot_type":"MvTyp","protocols":[{"name":"iec104","address":"45-984","typeid":"M_ME_NC_1"}]})";
+static const char* TS2 = R"({"label":"TS2","pivot_id":"ID-45-872","pivot_type":"SpsTyp","protocols":[{"name":"iec104","address":"45-872","typeid":"M_SP_TB_1"}]})";
+
+TEST(PivotIEC104PluginConfig, StreamingImport)
+{
+    // Members in any order, other protocols and unknown members skipped whatever they contain
+    IEC104PivotConfig config;
+    config.importExchangeConfig(R"({"version":{"major":1,"tags":["a",{"b":[]}]},"exchanged_data":{"name":"SAMPLE","datapoints":[)"
+        R"({"protocols":[{"name":"tase2","address":"S_114562","typeid":"Data_RealQ","extra":[[{"name":"iec104"}]]},)"
+        R"({"typeid":"M_ME_NC_1","address":"45-984","name":"iec104","alternate_mapping_rule":"rule"}],)"
+        R"("pivot_type":"MvTyp","label":"TM1","pivot_id":"ID-45-984","comment":null,"scale":1.5},)"
+        R"({"label":"TS3","pivot_id":"ID-TS3","pivot_type":"SpsTyp","protocols":[{"name":"iec104","address":"4500","typeid":"M_SP_NA_1"}]},)"
+        + std::string(TS1) + "]}}");
+
+    ASSERT_TRUE(config.isComplete());
+    ASSERT_EQ(2, config.getChanges().added);
+
+    IEC104PivotDataPoint* tm1 = config.getExchangeDefinitionsByAddress(45, 984);
+    ASSERT_NE(nullptr, tm1);
+    ASSERT_EQ("TM1", tm1->getLabel());
+    ASSERT_EQ("M_ME_NC_1", tm1->getTypeId());
+    ASSERT_EQ("rule", tm1->getAlternateMappingRule());
+    ASSERT_EQ(tm1, config.getExchangeDefinitionsByPivotId("ID-45-984"));
+    ASSERT_NE(nullptr, config.getExchangeDefinitionsByLabel("TS1"));
+
+    // An address without separator is not an IEC 104 address
+    ASSERT_EQ(nullptr, config.getExchangeDefinitionsByLabel("TS3"));
+
+    // The datapoints before an invalid one are kept, the configuration is not complete
+    IEC104PivotConfig missingType;
+    missingType.importExchangeConfig(exchangedData(std::string(TS1) +
+        R"(,{"label":"TS2","pivot_id":"ID-45-872","protocols":[{"name":"iec104","address":"45-872","typeid":"M_SP_TB_1"}]})"));
+    ASSERT_FALSE(missingType.isComplete());
+    ASSERT_NE(nullptr, missingType.getExchangeDefinitionsByLabel("TS1"));
+    ASSERT_EQ(nullptr, missingType.getExchangeDefinitionsByLabel("TS2"));
+
+    IEC104PivotConfig invalidAddress;
+    invalidAddress.importExchangeConfig(exchangedData(
+        R"({"label":"TS2","pivot_id":"ID-45-872","pivot_type":"SpsTyp","protocols":[{"name":"iec104","address":"45-8x2","typeid":"M_SP_TB_1"}]})"));
+    ASSERT_FALSE(invalidAddress.isComplete());
+
+    // Blanks around the CA and the IOA and a '+' sign are accepted, as std::stoi did
+    IEC104PivotConfig blankAddress;
+    blankAddress.importExchangeConfig(exchangedData(
+        R"({"label":"TS1","pivot_id":"ID-45-672","pivot_type":"SpsTyp","protocols":[{"name":"iec104","address":" 45 - 672 ","typeid":"M_SP_NA_1"}]},)"
+        R"({"label":"TS2","pivot_id":"ID-45-872","pivot_type":"SpsTyp","protocols":[{"name":"iec104","address":"\t+45-+872","typeid":"M_SP_TB_1"}]})"));
+    ASSERT_TRUE(blankAddress.isComplete());
+    ASSERT_EQ(blankAddress.getExchangeDefinitionsByLabel("TS1"), blankAddress.getExchangeDefinitionsByAddress(45, 672));
+    ASSERT_EQ(blankAddress.getExchangeDefinitionsByLabel("TS2"), blankAddress.getExchangeDefinitionsByAddress(45, 872));
+    ASSERT_NE(nullptr, blankAddress.getExchangeDefinitionsByAddress(45, 872));
+
+    const char* invalid[] = {"45 6-672", "+-672", "45-++672", "45- ", "-45-672"};
+
+    for (const char* address : invalid) {
+        IEC104PivotConfig config;
+        config.importExchangeConfig(exchangedData(std::string(R"({"label":"TS1","pivot_id":"ID-45-672","pivot_type":"SpsTyp",)")
+            + R"("protocols":[{"name":"iec104","address":")" + address + R"(","typeid":"M_SP_NA_1"}]})"));
+        ASSERT_FALSE(config.isComplete()) << address;
+    }
+
+    IEC104PivotConfig missingAddress;
+    missingAddress.importExchangeConfig(exchangedData(
+        R"({"label":"TS2","pivot_id":"ID-45-872","pivot_type":"SpsTyp","protocols":[{"name":"iec104","typeid":"M_SP_TB_1"}]})"));
+    ASSERT_FALSE(missingAddress.isComplete());
+
+    IEC104PivotConfig missingDatapoints;
+    missingDatapoints.importExchangeConfig(R"({"exchanged_data":{"datapoints":{}}})");
+    ASSERT_FALSE(missingDatapoints.isComplete());
+
+    IEC104PivotConfig notObject;
+    notObject.importExchangeConfig(R"({"exchanged_data":{"datapoints":[1]}})");
+    ASSERT_FALSE(notObject.isComplete());
+
+    // An invalid JSON gives no definition at all
+    IEC104PivotConfig truncated;
+    truncated.importExchangeConfig(exchangedData(std::string(TS1) + "," + TS2).substr(0, 250));
+    ASSERT_FALSE(truncated.isComplete());
+    ASSERT_EQ(nullptr, truncated.getExchangeDefinitionsByLabel("TS1"));
+}
+
+TEST(PivotIEC104PluginConfig, IncrementalImport)
+{
+    const std::string firstData = exchangedData(std::string(TS1) + "," + TM1);
+
+    IEC104PivotConfig first;
+    first.importExchangeConfig(firstData);
+
+    ASSERT_TRUE(first.isImportedFrom(firstData));
+    ASSERT_FALSE(first.isImportedFrom(exchangedData(TS1)));
+    ASSERT_EQ(2, first.getChanges().added);
+
+    // TS1 unchanged, TM1 with another type, TS2 added
+    IEC104PivotConfig second;
+    second.importExchangeConfig(exchangedData(std::string(TS1) + "," + TM1_FLOAT + "," + TS2), &first);
+
+    ASSERT_EQ(1, second.getChanges().added);
+    ASSERT_EQ(1, second.getChanges().updated);
+    ASSERT_EQ(0, second.getChanges().removed);
+    ASSERT_EQ(1, second.getChanges().unchanged);
+
+    // The unchanged definition is shared with its templates, the updated one is rebuilt
+    IEC104PivotDataPoint* ts1 = second.getExchangeDefinitionsByLabel("TS1");
+    ASSERT_EQ(first.getExchangeDefinitionsByLabel("TS1"), ts1);
+    ASSERT_EQ(ts1, second.getExchangeDefinitionsByAddress(45, 672));
+    ASSERT_EQ(ts1, second.getExchangeDefinitionsByPivotId("ID-45-672"));
+
+    IEC104PivotDataPoint* tm1 = second.getExchangeDefinitionsByLabel("TM1");
+    ASSERT_NE(first.getExchangeDefinitionsByLabel("TM1"), tm1);
+    ASSERT_EQ(Iec104AsduType::M_ME_NC_1, tm1->getAsduType());
+    ASSERT_EQ(Iec104AsduType::M_ME_NA_1, first.getExchangeDefinitionsByLabel("TM1")->getAsduType());
+    ASSERT_NE(nullptr, second.getExchangeDefinitionsByLabel("TS2"));
+
+    // TS1 removed
+    std::unique_ptr<IEC104PivotConfig> third(new IEC104PivotConfig());
+    third->importExchangeConfig(exchangedData(std::string(TM1_FLOAT) + "," + TS2), &second);
+
+    ASSERT_EQ(0, third->getChanges().added);
+    ASSERT_EQ(1, third->getChanges().removed);
+    ASSERT_EQ(2, third->getChanges().unchanged);
+    ASSERT_EQ(nullptr, third->getExchangeDefinitionsByLabel("TS1"));
+    ASSERT_EQ(nullptr, third->getExchangeDefinitionsByAddress(45, 672));
+    ASSERT_EQ(tm1, third->getExchangeDefinitionsByAddress(45, 984));
+
+    // Shared definitions outlive the configuration they were built for
+    IEC104PivotDataPoint* ts2 = third->getExchangeDefinitionsByLabel("TS2");
+    second.importExchangeConfig(exchangedData(TS1));
+    ASSERT_EQ(ts2, third->getExchangeDefinitionsByPivotId("ID-45-872"));
+    ASSERT_NE(nullptr, ts2->getPivotTemplate());
+}
+
+TEST(PivotIEC104PluginConfig, BinaryImage)
+{
+    char directory[] = "/tmp/iec104pivot_image_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(directory));
+    const std::string path = std::string(directory) + "/config.cfgimg";
+
+    const std::string data = exchangedData(std::string(TS1) + "," + TM1_FLOAT + "," + TS2);
+
+    IEC104PivotConfig compiled;
+    compiled.importExchangeConfig(data);
+    ASSERT_TRUE(compiled.writeImage(path));
+
+    // The image gives the same definitions as the JSON
+    IEC104PivotConfig loaded;
+    ASSERT_TRUE(loaded.loadImage(path, data));
+    ASSERT_TRUE(loaded.isComplete());
+    ASSERT_TRUE(loaded.isImportedFrom(data));
+    ASSERT_EQ(3, loaded.getChanges().added);
+
+    IEC104PivotDataPoint* tm1 = loaded.getExchangeDefinitionsByLabel("TM1");
+    ASSERT_NE(nullptr, tm1);
+    ASSERT_EQ(tm1, loaded.getExchangeDefinitionsByAddress(45, 984));
+    ASSERT_EQ(tm1, loaded.getExchangeDefinitionsByPivotId("ID-45-984"));
+    ASSERT_EQ(Iec104AsduType::M_ME_NC_1, tm1->getAsduType());
+    ASSERT_EQ("MvTyp", tm1->getPivotType());
+    ASSERT_NE(nullptr, tm1->getPivotTemplate());
+    ASSERT_NE(nullptr, loaded.getExchangeDefinitionsByAddress(45, 672));
+    ASSERT_NE(nullptr, loaded.getExchangeDefinitionsByLabel("TS2"));
+
+    // Definitions unchanged since the previous configuration are shared, as with the JSON
+    IEC104PivotConfig reloaded;
+    ASSERT_TRUE(reloaded.loadImage(path, data, &loaded));
+    ASSERT_EQ(3, reloaded.getChanges().unchanged);
+    ASSERT_EQ(tm1, reloaded.getExchangeDefinitionsByLabel("TM1"));
+
+    // An image compiled from another exchanged_data is ignored
+    IEC104PivotConfig stale;
+    ASSERT_FALSE(stale.loadImage(path, exchangedData(TS1)));
+    ASSERT_FALSE(stale.isComplete());
+    ASSERT_EQ(nullptr, stale.getExchangeDefinitionsByLabel("TS1"));
+
+    // So is a damaged image
+    FILE* file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(nullptr, file);
+    fseek(file, -1, SEEK_END);
+    fputc('#', file);
+    fclose(file);
+
+    IEC104PivotConfig damaged;
+    ASSERT_FALSE(damaged.loadImage(path, data));
+    ASSERT_EQ(nullptr, damaged.getExchangeDefinitionsByLabel("TS1"));
+
+    ASSERT_FALSE(damaged.loadImage(std::string(directory) + "/missing.cfgimg", data));
+
+    // Incomplete configurations are not written
+    IEC104PivotConfig invalid;
+    invalid.importExchangeConfig("{}");
+    ASSERT_FALSE(invalid.writeImage(path));
+
+    unlink(path.c_str());
+    rmdir(directory);
+}
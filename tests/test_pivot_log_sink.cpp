@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "iec104_pivot_log_sink.hpp"
+#include "iec104_pivot_utility.hpp"
+
+using namespace Iec104PivotUtility;
+
+TEST(PivotIEC104PluginLogSink, StartStopFlush)
+{
+    AsyncLogSink& sink = AsyncLogSink::getInstance();
+
+    sink.start();
+    ASSERT_TRUE(sink.isRunning());
+    ASSERT_TRUE(asyncLogEnabled.load());
+
+    uint64_t writtenBefore = sink.getWrittenCount();
+    uint64_t droppedBefore = sink.getDroppedCount();
+
+    for (int i = 0; i < 10; i++) {
+        ASSERT_NO_THROW(log_warn("Asynchronous warning %d", i));
+        ASSERT_NO_THROW(log_error("Asynchronous error %d", i));
+    }
+
+    sink.stop();
+    ASSERT_FALSE(sink.isRunning());
+    ASSERT_FALSE(asyncLogEnabled.load());
+
+    // stop() writes every queued record before returning
+    ASSERT_EQ(20, (sink.getWrittenCount() - writtenBefore) + (sink.getDroppedCount() - droppedBefore));
+
+    // once stopped the helpers log synchronously again
+    ASSERT_NO_THROW(log_warn("Synchronous warning %s", "after stop"));
+    ASSERT_FALSE(enqueueAsyncLog(LogLevel::WARNING, "%s", "not queued"));
+
+    // a second stop is a no-op
+    ASSERT_NO_THROW(sink.stop());
+}
+
+TEST(PivotIEC104PluginLogSink, OverflowIsCounted)
+{
+    AsyncLogSink& sink = AsyncLogSink::getInstance();
+
+    sink.start();
+
+    uint64_t writtenBefore = sink.getWrittenCount();
+    uint64_t droppedBefore = sink.getDroppedCount();
+
+    const int threadCount = 4;
+    const int recordsPerThread = 5000;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; t++) {
+        threads.push_back(std::thread([t, recordsPerThread]() {
+            for (int i = 0; i < recordsPerThread; i++) {
+                enqueueAsyncLog(LogLevel::WARNING, "Flood from thread %d: %d", t, i);
+            }
+        }));
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    sink.stop();
+
+    uint64_t written = sink.getWrittenCount() - writtenBefore;
+    uint64_t dropped = sink.getDroppedCount() - droppedBefore;
+
+    ASSERT_EQ(static_cast<uint64_t>(threadCount * recordsPerThread), written + dropped);
+}
+
+TEST(PivotIEC104PluginLogSink, SharedByUsers)
+{
+    AsyncLogSink& sink = AsyncLogSink::getInstance();
+
+    // Two filter instances use the sink: it runs until both stopped using it
+    sink.start();
+    sink.start();
+    ASSERT_TRUE(sink.isRunning());
+
+    sink.stop();
+    ASSERT_TRUE(sink.isRunning());
+    ASSERT_TRUE(enqueueAsyncLog(LogLevel::WARNING, "%s", "still queued"));
+
+    sink.stop();
+    ASSERT_FALSE(sink.isRunning());
+
+    // More stops than starts do not stop the next user
+    sink.stop();
+    sink.start();
+    ASSERT_TRUE(sink.isRunning());
+    sink.stop();
+    ASSERT_FALSE(sink.isRunning());
+}
+
+TEST(PivotIEC104PluginLogSink, StopWhileLogging)
+{
+    AsyncLogSink& sink = AsyncLogSink::getInstance();
+
+    // Each record is either written by the sink, dropped and counted, or refused and logged synchronously
+    for (int round = 0; round < 20; round++) {
+        uint64_t writtenBefore = sink.getWrittenCount();
+        uint64_t droppedBefore = sink.getDroppedCount();
+        std::atomic<uint64_t> refused(0);
+        std::atomic<bool> started(false);
+
+        sink.start();
+
+        std::thread producer([&]() {
+            started.store(true);
+
+            for (int i = 0; i < 2000; i++) {
+                if (!enqueueAsyncLog(LogLevel::ERROR, "Error while stopping %d", i)) refused.fetch_add(1);
+            }
+        });
+
+        while (!started.load()) std::this_thread::yield();
+
+        sink.stop();
+        producer.join();
+
+        ASSERT_EQ(2000, (sink.getWrittenCount() - writtenBefore) + (sink.getDroppedCount() - droppedBefore) + refused.load());
+    }
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "iec104_pivot_metrics.hpp"
+
+using namespace Iec104PivotUtility;
+
+TEST(PivotIEC104PluginMetrics, LatencyBuckets)
+{
+    // Small values have a bucket of their own
+    for (uint64_t value = 0; value < 8; value++) {
+        ASSERT_EQ(value, LatencyBuckets::indexOf(value));
+        ASSERT_EQ(value, LatencyBuckets::lowerBound(value));
+    }
+
+    // Each value falls between the bounds of its bucket, which are less than 12.5% apart
+    for (uint64_t value = 8; value < 1000000; value = value * 9 / 8 + 1) {
+        size_t index = LatencyBuckets::indexOf(value);
+
+        ASSERT_LE(LatencyBuckets::lowerBound(index), value);
+        ASSERT_GT(LatencyBuckets::lowerBound(index + 1), value);
+        ASSERT_LE(LatencyBuckets::lowerBound(index + 1) - LatencyBuckets::lowerBound(index), LatencyBuckets::lowerBound(index) / 8);
+    }
+
+    ASSERT_EQ(LatencyBuckets::COUNT - 1, LatencyBuckets::indexOf(UINT64_MAX));
+}
+
+TEST(PivotIEC104PluginMetrics, Snapshot)
+{
+    MetricsRegistry registry(4);
+
+    MetricsShard& shard = registry.getShard(0);
+    ASSERT_EQ(&shard, &registry.getShard(0));
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(&shard) % MetricsShard::CACHE_LINE_SIZE);
+
+    shard.count(MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_SP_TB_1, MetricsOutcome::CONVERTED);
+    shard.count(MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_SP_TB_1, MetricsOutcome::CONVERTED);
+    shard.count(MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_DP_TB_1, MetricsOutcome::CONVERTED);
+    registry.getShard(3).count(MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_SP_TB_1, MetricsOutcome::CONVERTED);
+    registry.getShard(3).count(MetricsDirection::PIVOT_TO_IEC104, Iec104AsduType::C_SC_NA_1, MetricsOutcome::TYPE_MISMATCH);
+
+    for (uint64_t latency = 1; latency <= 100; latency++) {
+        shard.recordLatency(MetricsLatency::INGEST, latency * 1000);
+    }
+
+    MetricsSnapshot snapshot = registry.snapshot();
+
+    ASSERT_EQ(3, snapshot.getCount(MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_SP_TB_1, MetricsOutcome::CONVERTED));
+    ASSERT_EQ(0, snapshot.getCount(MetricsDirection::PIVOT_TO_IEC104, Iec104AsduType::M_SP_TB_1, MetricsOutcome::CONVERTED));
+    ASSERT_EQ(4, snapshot.getTotal(MetricsDirection::IEC104_TO_PIVOT, MetricsOutcome::CONVERTED));
+    ASSERT_EQ(1, snapshot.getTotal(MetricsDirection::PIVOT_TO_IEC104, MetricsOutcome::TYPE_MISMATCH));
+
+    const LatencyHistogram& ingest = snapshot.getLatency(MetricsLatency::INGEST);
+
+    ASSERT_EQ(100, ingest.getCount());
+    ASSERT_EQ(100000, ingest.getMaxNs());
+    ASSERT_DOUBLE_EQ(50500.0, ingest.getMeanNs());
+
+    // Quantiles are known within the width of a bucket
+    ASSERT_GE(ingest.getPercentileNs(0.5), 50000);
+    ASSERT_LE(ingest.getPercentileNs(0.5), 50000 * 9 / 8);
+    ASSERT_GE(ingest.getPercentileNs(0.99), 99000);
+    ASSERT_EQ(100000, ingest.getPercentileNs(1.0));
+
+    ASSERT_EQ(0, snapshot.getLatency(MetricsLatency::CONVERT_DATA_OBJECT_TO_PIVOT).getCount());
+    ASSERT_EQ(0, snapshot.getLatency(MetricsLatency::CONVERT_DATA_OBJECT_TO_PIVOT).getPercentileNs(0.5));
+}
+
+TEST(PivotIEC104PluginMetrics, ConversionRecord)
+{
+    MetricsRegistry registry(1);
+    MetricsShard& shard = registry.getShard(0);
+
+    {
+        ConversionRecord record(shard, MetricsLatency::CONVERT_PIVOT_TO_DATA_OBJECT, MetricsDirection::PIVOT_TO_IEC104);
+    }
+    {
+        ConversionRecord record(shard, MetricsLatency::CONVERT_PIVOT_TO_DATA_OBJECT, MetricsDirection::PIVOT_TO_IEC104);
+        record.setAsduType(Iec104AsduType::M_ME_NC_1);
+        record.setOutcome(MetricsOutcome::CONVERTED);
+    }
+
+    MetricsSnapshot snapshot = registry.snapshot();
+
+    // Without an outcome the conversion is counted as dropped
+    ASSERT_EQ(1, snapshot.getCount(MetricsDirection::PIVOT_TO_IEC104, Iec104AsduType::UNKNOWN, MetricsOutcome::DROPPED_INVALID));
+    ASSERT_EQ(1, snapshot.getCount(MetricsDirection::PIVOT_TO_IEC104, Iec104AsduType::M_ME_NC_1, MetricsOutcome::CONVERTED));
+    ASSERT_EQ(2, snapshot.getLatency(MetricsLatency::CONVERT_PIVOT_TO_DATA_OBJECT).getCount());
+}
+
+TEST(PivotIEC104PluginMetrics, ConcurrentShards)
+{
+    MetricsRegistry registry(4);
+    std::vector<std::thread> threads;
+
+    for (size_t worker = 0; worker < 4; worker++) {
+        threads.push_back(std::thread([&registry, worker] {
+            MetricsShard& shard = registry.getShard(worker);
+
+            for (int i = 0; i < 10000; i++) {
+                shard.count(MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_ME_NA_1, MetricsOutcome::PASSTHROUGH);
+                shard.recordLatency(MetricsLatency::INGEST, (uint64_t)i);
+            }
+        }));
+    }
+
+    // Snapshots can be taken while the shards are written
+    for (int i = 0; i < 10; i++) {
+        ASSERT_LE(registry.snapshot().getLatency(MetricsLatency::INGEST).getCount(), 40000);
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    MetricsSnapshot snapshot = registry.snapshot();
+
+    ASSERT_EQ(40000, snapshot.getCount(MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_ME_NA_1, MetricsOutcome::PASSTHROUGH));
+    ASSERT_EQ(40000, snapshot.getLatency(MetricsLatency::INGEST).getCount());
+    ASSERT_EQ(9999, snapshot.getLatency(MetricsLatency::INGEST).getMaxNs());
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+
+#include "iec104_pivot_report.hpp"
+
+using Iec104PivotUtility::ReportByException;
+using Iec104PivotUtility::ReportState;
+using Iec104PivotUtility::parseCauseList;
+
+namespace {
+
+ReportState makeState(uint64_t value, uint16_t flags, int64_t timestamp = 0)
+{
+    ReportState state;
+
+    state.value = value;
+    state.flags = flags;
+    state.timestamp = timestamp;
+
+    return state;
+}
+
+/* Decide and record the state when it is sent, as ingest does for an object converted */
+bool send(const ReportByException& report, ReportState& last, const ReportState& current, int cot, uint64_t nowMs)
+{
+    if (!report.mustSend(last, current, cot, nowMs)) return false;
+
+    report.recordSent(last, current, nowMs);
+
+    return true;
+}
+
+}
+
+TEST(PivotIEC104PluginReport, ParseCauseList)
+{
+    uint64_t causes = 0;
+
+    ASSERT_TRUE(parseCauseList("20-41", causes));
+    ASSERT_EQ(ReportByException::DEFAULT_ALWAYS_SENT_CAUSES, causes);
+
+    ASSERT_TRUE(parseCauseList(" 3 , 5-6,63", causes));
+    ASSERT_EQ((1ULL << 3) | (1ULL << 5) | (1ULL << 6) | (1ULL << 63), causes);
+
+    ASSERT_TRUE(parseCauseList("", causes));
+    ASSERT_EQ(0, causes);
+
+    causes = 1;
+
+    const char* invalid[] = {"64", "1,", ",1", "5-3", "1-", "-1", "a", "1 2", "1;2", "20-64"};
+
+    for (const char* value : invalid) {
+        ASSERT_FALSE(parseCauseList(value, causes)) << value;
+        ASSERT_EQ(1, causes) << value;
+    }
+}
+
+TEST(PivotIEC104PluginReport, SendOnChange)
+{
+    ReportByException report;
+    ReportState last;
+
+    // Disabled: everything is sent and nothing is recorded
+    ASSERT_TRUE(send(report, last, makeState(1, ReportState::HAS_VALUE), 3, 1000));
+    ASSERT_EQ(0, last.generation);
+
+    report.setEnabled(true);
+
+    // First state of a definition, then the same value and quality
+    ASSERT_TRUE(send(report, last, makeState(1, ReportState::HAS_VALUE), 1, 1000));
+    ASSERT_FALSE(send(report, last, makeState(1, ReportState::HAS_VALUE), 1, 2000));
+    ASSERT_FALSE(send(report, last, makeState(1, ReportState::HAS_VALUE), 3, 3000));
+
+    // Value and quality changes
+    ASSERT_TRUE(send(report, last, makeState(2, ReportState::HAS_VALUE), 3, 4000));
+    ASSERT_TRUE(send(report, last, makeState(2, ReportState::HAS_VALUE | ReportState::QUALITY_IV), 3, 5000));
+    ASSERT_FALSE(send(report, last, makeState(2, ReportState::HAS_VALUE | ReportState::QUALITY_IV), 2, 6000));
+
+    // Interrogation responses are always sent
+    ASSERT_TRUE(send(report, last, makeState(2, ReportState::HAS_VALUE | ReportState::QUALITY_IV), 20, 7000));
+    ASSERT_TRUE(send(report, last, makeState(2, ReportState::HAS_VALUE | ReportState::QUALITY_IV), 41, 7000));
+    ASSERT_FALSE(send(report, last, makeState(2, ReportState::HAS_VALUE | ReportState::QUALITY_IV), 42, 7000));
+
+    report.setAlwaysSentCauses(1ULL << 5);
+    ASSERT_FALSE(send(report, last, makeState(2, ReportState::HAS_VALUE | ReportState::QUALITY_IV), 20, 7000));
+    ASSERT_TRUE(send(report, last, makeState(2, ReportState::HAS_VALUE | ReportState::QUALITY_IV), 5, 7000));
+}
+
+TEST(PivotIEC104PluginReport, Timestamp)
+{
+    ReportByException report;
+    ReportState last;
+    uint16_t timed = ReportState::HAS_VALUE | ReportState::TS;
+
+    report.setEnabled(true);
+
+    ASSERT_TRUE(send(report, last, makeState(1, timed, 1000), 3, 1000));
+
+    // The timestamp and its flags are ignored by default
+    ASSERT_FALSE(send(report, last, makeState(1, timed, 2000), 3, 2000));
+    ASSERT_FALSE(send(report, last, makeState(1, timed | ReportState::TS_IV, 2000), 3, 2000));
+    ASSERT_FALSE(send(report, last, makeState(1, ReportState::HAS_VALUE), 3, 2000));
+
+    report.setCompareTimestamp(true);
+
+    ASSERT_TRUE(send(report, last, makeState(1, timed, 3000), 3, 3000));
+    ASSERT_FALSE(send(report, last, makeState(1, timed, 3000), 3, 3000));
+    ASSERT_TRUE(send(report, last, makeState(1, timed | ReportState::TS_SU, 3000), 3, 3000));
+}
+
+TEST(PivotIEC104PluginReport, Refresh)
+{
+    ReportByException report;
+    ReportState last;
+
+    report.setEnabled(true);
+    report.setRefreshIntervalMs(10000);
+
+    ASSERT_TRUE(send(report, last, makeState(1, ReportState::HAS_VALUE), 1, 100000));
+    ASSERT_FALSE(send(report, last, makeState(1, ReportState::HAS_VALUE), 1, 109999));
+    ASSERT_TRUE(send(report, last, makeState(1, ReportState::HAS_VALUE), 1, 110000));
+
+    // The interval starts again from the last state sent, changes included
+    ASSERT_TRUE(send(report, last, makeState(2, ReportState::HAS_VALUE), 3, 115000));
+    ASSERT_FALSE(send(report, last, makeState(2, ReportState::HAS_VALUE), 1, 124999));
+
+    // Clock set back
+    ASSERT_TRUE(send(report, last, makeState(2, ReportState::HAS_VALUE), 1, 50000));
+}
+
+TEST(PivotIEC104PluginReport, EnableAgain)
+{
+    ReportByException report;
+    ReportState last;
+
+    report.setEnabled(true);
+    ASSERT_TRUE(send(report, last, makeState(1, ReportState::HAS_VALUE), 3, 1000));
+
+    // Objects sent while disabled are not recorded: the state is sent again once enabled
+    report.setEnabled(false);
+    ASSERT_TRUE(send(report, last, makeState(0, ReportState::HAS_VALUE), 3, 2000));
+    report.setEnabled(true);
+    ASSERT_TRUE(send(report, last, makeState(1, ReportState::HAS_VALUE), 3, 3000));
+    ASSERT_FALSE(send(report, last, makeState(1, ReportState::HAS_VALUE), 3, 4000));
+
+    // Enabling an enabled filter keeps the states
+    report.setEnabled(true);
+    ASSERT_FALSE(send(report, last, makeState(1, ReportState::HAS_VALUE), 3, 5000));
+}
+
+TEST(PivotIEC104PluginReport, RecordOnlySent)
+{
+    ReportByException report;
+    ReportState last;
+
+    report.setEnabled(true);
+
+    // Deciding does not record: an object not sent in the end is compared again
+    ASSERT_TRUE(report.mustSend(last, makeState(1, ReportState::HAS_VALUE), 3, 1000));
+    ASSERT_TRUE(report.mustSend(last, makeState(1, ReportState::HAS_VALUE), 3, 2000));
+
+    report.recordSent(last, makeState(1, ReportState::HAS_VALUE), 2000);
+    ASSERT_EQ(2000, last.sentMs);
+    ASSERT_FALSE(report.mustSend(last, makeState(1, ReportState::HAS_VALUE), 3, 3000));
+
+    // Nothing is recorded while disabled
+    report.setEnabled(false);
+    report.recordSent(last, makeState(2, ReportState::HAS_VALUE), 4000);
+    ASSERT_EQ(1, last.value);
+}
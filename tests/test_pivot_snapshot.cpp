@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "iec104_pivot_snapshot.hpp"
+
+namespace {
+
+struct Version {
+    Version(int value, std::atomic<int>& deleted): value(value), deleted(deleted) {};
+    ~Version() {deleted.fetch_add(1);}
+
+    int value;
+    std::atomic<int>& deleted;
+};
+
+}
+
+using Iec104PivotUtility::SnapshotPointer;
+
+TEST(PivotIEC104PluginSnapshot, PublishReplacesVersion)
+{
+    std::atomic<int> deleted(0);
+
+    {
+        SnapshotPointer<Version> pointer(std::unique_ptr<Version>(new Version(1, deleted)));
+
+        ASSERT_EQ(1, pointer.acquire()->value);
+
+        pointer.publish(std::unique_ptr<Version>(new Version(2, deleted)));
+
+        // The previous version is deleted as soon as it has no reader
+        ASSERT_EQ(1, deleted.load());
+        ASSERT_EQ(2, pointer.acquire()->value);
+    }
+
+    ASSERT_EQ(2, deleted.load());
+}
+
+TEST(PivotIEC104PluginSnapshot, ReaderKeepsVersion)
+{
+    std::atomic<int> deleted(0);
+    SnapshotPointer<Version> pointer(std::unique_ptr<Version>(new Version(1, deleted)));
+
+    {
+        SnapshotPointer<Version>::Reader reader = pointer.acquire();
+
+        // publish does not wait for the reader of the previous version, which is retired
+        std::thread publisher([&] {
+            pointer.publish(std::unique_ptr<Version>(new Version(2, deleted)));
+        });
+        publisher.join();
+
+        ASSERT_EQ(2, pointer.acquire()->value);
+        ASSERT_EQ(0, deleted.load());
+        ASSERT_EQ(1U, pointer.getRetiredCount());
+        ASSERT_EQ(1, reader->value);
+    }
+
+    // Deleted by the next acquire once its reader is gone
+    ASSERT_EQ(0, deleted.load());
+    ASSERT_EQ(2, pointer.acquire()->value);
+    ASSERT_EQ(1, deleted.load());
+    ASSERT_EQ(0U, pointer.getRetiredCount());
+
+    // or by the next publish
+    {
+        SnapshotPointer<Version>::Reader reader = pointer.acquire();
+
+        pointer.publish(std::unique_ptr<Version>(new Version(3, deleted)));
+        ASSERT_EQ(1, deleted.load());
+    }
+
+    pointer.publish(std::unique_ptr<Version>(new Version(4, deleted)));
+    ASSERT_EQ(3, deleted.load());
+    ASSERT_EQ(0U, pointer.getRetiredCount());
+}
+
+TEST(PivotIEC104PluginSnapshot, RetiredVersionsDeletedWithPointer)
+{
+    std::atomic<int> deleted(0);
+
+    {
+        SnapshotPointer<Version> pointer(std::unique_ptr<Version>(new Version(1, deleted)));
+        SnapshotPointer<Version>::Reader reader = pointer.acquire();
+
+        pointer.publish(std::unique_ptr<Version>(new Version(2, deleted)));
+        ASSERT_EQ(1U, pointer.getRetiredCount());
+        ASSERT_EQ(0, deleted.load());
+    }
+
+    ASSERT_EQ(2, deleted.load());
+}
+
+TEST(PivotIEC104PluginSnapshot, ConcurrentReaders)
+{
+    std::atomic<int> deleted(0);
+    SnapshotPointer<Version> pointer(std::unique_ptr<Version>(new Version(0, deleted)));
+    std::atomic<bool> stop(false);
+    std::atomic<bool> invalidVersion(false);
+    std::vector<std::thread> readers;
+
+    for (int i = 0; i < 4; i++) {
+        readers.push_back(std::thread([&] {
+            int lastValue = 0;
+
+            while (!stop.load()) {
+                SnapshotPointer<Version>::Reader reader = pointer.acquire();
+
+                // Versions are only seen in publication order
+                if (reader->value < lastValue) invalidVersion.store(true);
+                lastValue = reader->value;
+            }
+        }));
+    }
+
+    for (int value = 1; value <= 200; value++) {
+        pointer.publish(std::unique_ptr<Version>(new Version(value, deleted)));
+    }
+
+    stop.store(true);
+
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_FALSE(invalidVersion.load());
+
+    // The versions left by the readers are deleted by the first acquire after them
+    ASSERT_EQ(200, pointer.acquire()->value);
+    ASSERT_EQ(200, deleted.load());
+    ASSERT_EQ(0U, pointer.getRetiredCount());
+}
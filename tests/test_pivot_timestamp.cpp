@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "iec104_pivot_object.hpp"
+#include "datapoint_builders.hpp"
+
+namespace {
+
+/* Encoding and decoding as done before the codec was shared, the reference for bit-exactness */
+void legacyEncode(long ms, uint8_t* valueArray)
+{
+    uint32_t timeval32 = (uint32_t) (ms/ 1000LL);
+
+    valueArray[0] = (timeval32 / 0x1000000 & 0xff);
+    valueArray[1] = (timeval32 / 0x10000 & 0xff);
+    valueArray[2] = (timeval32 / 0x100 & 0xff);
+    valueArray[3] = (timeval32 & 0xff);
+
+    uint32_t remainder = (ms % 1000LL);
+    uint32_t fractionOfSecond = (remainder) * 16777 + ((remainder * 216) / 1000);
+
+    valueArray[4] = ((fractionOfSecond >> 16) & 0xff);
+    valueArray[5] = ((fractionOfSecond >> 8) & 0xff);
+    valueArray[6] = (fractionOfSecond & 0xff);
+}
+
+uint64_t legacyDecode(const uint8_t* valueArray)
+{
+    uint32_t timeval32 = valueArray[3];
+    timeval32 += valueArray[2] * 0x100;
+    timeval32 += valueArray[1] * 0x10000;
+    timeval32 += (uint32_t)valueArray[0] * 0x1000000;
+
+    uint32_t fractionOfSecond = (valueArray[4] << 16);
+    fractionOfSecond += (valueArray[5] << 8);
+    fractionOfSecond += (valueArray[6]);
+
+    return (timeval32 * 1000LL) + fractionOfSecond / 16777;
+}
+
+std::vector<long> sampleTimes()
+{
+    std::vector<long> times = {0, 1, 999, 1000, 1001, 1669123796250, 1669123796999, 4294967295999, -1, -999, -1000};
+
+    for (long ms = 1669123796000; ms < 1669123799000; ms++) {
+        times.push_back(ms);
+    }
+
+    for (long ms = 1; ms < 4294967296000; ms = ms * 3 + 7) {
+        times.push_back(ms);
+    }
+
+    return times;
+}
+
+}
+
+TEST(PivotIEC104PluginTimestamp, BitExactEncoding)
+{
+    for (long ms : sampleTimes()) {
+        uint8_t expected[PivotTimestamp::ENCODED_SIZE];
+        uint8_t value[PivotTimestamp::ENCODED_SIZE];
+
+        legacyEncode(ms, expected);
+        PivotTimestamp::encodeTimeInMs(ms, value);
+
+        ASSERT_EQ(0, memcmp(expected, value, PivotTimestamp::ENCODED_SIZE)) << ms;
+        ASSERT_EQ(legacyDecode(expected), PivotTimestamp::decodeTimeInMs(value)) << ms;
+
+        PivotTimestamp timestamp(ms);
+
+        ASSERT_EQ(legacyDecode(expected), timestamp.getTimeInMs()) << ms;
+        ASSERT_EQ((int32_t)PivotTimestamp::decodeSecondSinceEpoch(expected), timestamp.SecondSinceEpoch());
+        ASSERT_EQ((int)PivotTimestamp::decodeFractionOfSecond(expected), timestamp.FractionOfSecond());
+
+        // Whole milliseconds survive the round trip
+        if (ms >= 0) {
+            ASSERT_EQ((uint64_t)ms, timestamp.getTimeInMs());
+        }
+    }
+}
+
+TEST(PivotIEC104PluginTimestamp, BatchCodec)
+{
+    std::vector<long> times = sampleTimes();
+    std::vector<uint8_t> values(times.size() * PivotTimestamp::ENCODED_SIZE);
+    std::vector<uint64_t> decoded(times.size());
+
+    PivotTimestamp::encodeTimesInMs(times.data(), values.data(), times.size());
+    PivotTimestamp::decodeTimesInMs(values.data(), decoded.data(), times.size());
+
+    for (size_t i = 0; i < times.size(); i++) {
+        uint8_t expected[PivotTimestamp::ENCODED_SIZE];
+
+        legacyEncode(times[i], expected);
+
+        ASSERT_EQ(0, memcmp(expected, &values[i * PivotTimestamp::ENCODED_SIZE], PivotTimestamp::ENCODED_SIZE)) << times[i];
+        ASSERT_EQ(legacyDecode(expected), decoded[i]) << times[i];
+    }
+}
+
+TEST(PivotIEC104PluginTimestamp, FromDatapoint)
+{
+    PivotTimestamp empty;
+
+    ASSERT_EQ(0, empty.getTimeInMs());
+
+    std::vector<Datapoint*>* elements = new std::vector<Datapoint*>;
+    elements->push_back(createDatapoint("SecondSinceEpoch", (long)1669123796));
+    elements->push_back(createDatapoint("FractionOfSecond", (long)4194304));
+
+    DatapointValue dpv(elements, true);
+    Datapoint t("t", dpv);
+
+    PivotTimestamp timestamp(&t);
+
+    ASSERT_EQ(1669123796, timestamp.SecondSinceEpoch());
+    ASSERT_EQ(4194304, timestamp.FractionOfSecond());
+    ASSERT_EQ(1669123796250, timestamp.getTimeInMs());
+}
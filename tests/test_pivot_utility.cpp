@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include "iec104_pivot_filter_config.hpp"
 #include "iec104_pivot_utility.hpp"
 
 TEST(PivotIEC104PluginUtility, Join)
@@ -26,4 +27,91 @@ TEST(PivotIEC104PluginUtility, Logs)
     ASSERT_NO_THROW(Iec104PivotUtility::log_warn(text.c_str(), "warning"));
     ASSERT_NO_THROW(Iec104PivotUtility::log_error(text.c_str(), "error"));
     ASSERT_NO_THROW(Iec104PivotUtility::log_fatal(text.c_str(), "fatal"));
-}
\ No newline at end of file
+}
+TEST(PivotIEC104PluginUtility, LogLevelCache)
+{
+    Logger::getLogger()->setMinLevel("debug");
+    Iec104PivotUtility::refreshLogLevel();
+    ASSERT_TRUE(Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::DEBUG));
+    ASSERT_TRUE(Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::ERROR));
+
+    Logger::getLogger()->setMinLevel("error");
+    Iec104PivotUtility::refreshLogLevel();
+    ASSERT_FALSE(Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::DEBUG));
+    ASSERT_FALSE(Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::WARNING));
+    ASSERT_TRUE(Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::ERROR));
+
+    // Arguments of a disabled lazy log call are never evaluated
+    int evaluated = 0;
+    IEC104_PIVOT_LOG_DEBUG("This message is at level %s (%d)", "debug", ++evaluated);
+    ASSERT_EQ(0, evaluated);
+
+    Logger::getLogger()->setMinLevel("warning");
+    Iec104PivotUtility::refreshLogLevel();
+    ASSERT_TRUE(Iec104PivotUtility::isLogLevelEnabled(Iec104PivotUtility::LogLevel::WARNING));
+}
+TEST(PivotIEC104PluginUtility, LogThrottle)
+{
+    Iec104PivotUtility::LogThrottle throttle("%s Test message for label %s", 3, 10000);
+
+    // The first occurrences of a window are logged, the following ones are counted
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(throttle.allow("TS1", 1000 + i));
+    }
+    for (int i = 0; i < 100; i++) {
+        ASSERT_FALSE(throttle.allow("TS1", 2000 + i));
+    }
+    ASSERT_EQ(100, throttle.getSuppressedCount("TS1"));
+
+    // Each label has its own budget
+    ASSERT_TRUE(throttle.allow("TM1", 3000));
+    ASSERT_EQ(0, throttle.getSuppressedCount("TM1"));
+
+    // A new window starts after the window duration, the summary resets the counter
+    ASSERT_TRUE(throttle.allow("TS1", 11000));
+    ASSERT_EQ(0, throttle.getSuppressedCount("TS1"));
+    ASSERT_TRUE(throttle.allow("TS1", 11001));
+    ASSERT_TRUE(throttle.allow("TS1", 11002));
+    ASSERT_FALSE(throttle.allow("TS1", 11003));
+    ASSERT_EQ(1, throttle.getSuppressedCount("TS1"));
+
+    ASSERT_EQ(0, throttle.getSuppressedCount("unknown"));
+}
+
+TEST(PivotIEC104PluginUtility, LogThrottleFlush)
+{
+    Iec104PivotUtility::LogThrottle throttle("%s Test message for address %s", 1, 10000);
+
+    ASSERT_TRUE(throttle.allow("45-672", 1000));
+    ASSERT_FALSE(throttle.allow("45-672", 1001));
+    ASSERT_TRUE(throttle.allow("45-984", 5000));
+
+    // The summary of a window is logged once it is over, without another occurrence of the key
+    ASSERT_EQ(0, throttle.flush(10999));
+    ASSERT_EQ(1, throttle.getSuppressedCount("45-672"));
+    ASSERT_EQ(1, throttle.flush(11000));
+    ASSERT_EQ(0, throttle.getSuppressedCount("45-672"));
+
+    // A flushed key starts a new window
+    ASSERT_TRUE(throttle.allow("45-672", 11001));
+    ASSERT_FALSE(throttle.allow("45-672", 11002));
+
+    // Keys without suppressed occurrences are forgotten without summary
+    ASSERT_EQ(0, throttle.flush(15000));
+    ASSERT_FALSE(throttle.allow("45-672", 15001));
+
+    // Integer keys, such as packed addresses, have their own states
+    ASSERT_TRUE(throttle.allow(ExchangeAddressIndex::packAddress(45, 672), 16000));
+    ASSERT_FALSE(throttle.allow(ExchangeAddressIndex::packAddress(45, 672), 16001));
+    ASSERT_TRUE(throttle.allow(ExchangeAddressIndex::packAddress(672, 45), 16002));
+    ASSERT_EQ(1, throttle.getSuppressedCount(ExchangeAddressIndex::packAddress(45, 672)));
+    ASSERT_EQ(2, throttle.getSuppressedCount("45-672"));
+
+    // All the throttles of the process are flushed together
+    Iec104PivotUtility::LogThrottle::flushAll(21001);
+    ASSERT_EQ(0, throttle.getSuppressedCount("45-672"));
+    ASSERT_TRUE(throttle.allow("45-672", 21002));
+    ASSERT_EQ(1, throttle.getSuppressedCount(ExchangeAddressIndex::packAddress(45, 672)));
+    Iec104PivotUtility::LogThrottle::flushAll(26001);
+    ASSERT_EQ(0, throttle.getSuppressedCount(ExchangeAddressIndex::packAddress(45, 672)));
+}
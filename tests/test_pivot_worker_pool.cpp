@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "iec104_pivot_worker_pool.hpp"
+
+TEST(PivotIEC104PluginWorkerPool, ProcessesEachIndexOnce)
+{
+    Iec104PivotUtility::WorkerPool pool(3);
+
+    ASSERT_EQ(3, pool.getThreadCount());
+
+    std::vector<std::atomic<int>> visits(10000);
+    for (auto& visit : visits) visit.store(0);
+
+    std::atomic<bool> invalidWorker(false);
+
+    // The same pool runs several jobs in a row
+    for (int run = 0; run < 20; run++) {
+        pool.run(visits.size(), 7, [&](size_t begin, size_t end, size_t worker) {
+            if (worker > 3 || end - begin > 7) invalidWorker.store(true);
+
+            for (size_t i = begin; i < end; i++) {
+                visits[i].fetch_add(1);
+            }
+        });
+    }
+
+    ASSERT_FALSE(invalidWorker.load());
+
+    for (auto& visit : visits) {
+        ASSERT_EQ(20, visit.load());
+    }
+}
+
+TEST(PivotIEC104PluginWorkerPool, EmptyRange)
+{
+    Iec104PivotUtility::WorkerPool pool(2);
+
+    int calls = 0;
+    pool.run(0, 16, [&](size_t, size_t, size_t) {calls++;});
+
+    ASSERT_EQ(0, calls);
+}
+
+TEST(PivotIEC104PluginWorkerPool, WithoutThreads)
+{
+    // The calling thread does all the work when the pool has no thread
+    Iec104PivotUtility::WorkerPool pool(0);
+
+    size_t processed = 0;
+    pool.run(100, 30, [&](size_t begin, size_t end, size_t worker) {
+        ASSERT_EQ(0, worker);
+        processed += end - begin;
+    });
+
+    ASSERT_EQ(100, processed);
+}
+
+TEST(PivotIEC104PluginWorkerPool, TaskException)
+{
+    Iec104PivotUtility::WorkerPool pool(2);
+
+    ASSERT_THROW(pool.run(1000, 10, [](size_t begin, size_t, size_t) {
+        if (begin == 500) throw std::runtime_error("conversion failed");
+    }), std::runtime_error);
+
+    // The pool is still usable after a failed job
+    std::atomic<size_t> processed(0);
+    pool.run(1000, 10, [&](size_t begin, size_t end, size_t) {processed.fetch_add(end - begin);});
+
+    ASSERT_EQ(1000, processed.load());
+}
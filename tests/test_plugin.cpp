@@ -3,9 +3,19 @@
 #include <reading_set.h>
 #include <filter.h>
 #include <string>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
 #include <rapidjson/document.h>
 
+#include "iec104_pivot_filter.hpp"
+#include "iec104_pivot_log_sink.hpp"
 #include "iec104_pivot_object.hpp"
+#include "datapoint_builders.hpp"
+#include "filter_internals.hpp"
 
 using namespace std;
 using namespace rapidjson;
@@ -436,84 +446,6 @@ static string exchanged_data = QUOTE({
 static int outputHandlerCalled = 0;
 static Reading* lastReading = nullptr;
 
-template <class T>
-static Datapoint* createDatapoint(const std::string& dataname,
-                                    const T value)
-{
-    DatapointValue dp_value = DatapointValue(value);
-    return new Datapoint(dataname, dp_value);
-}
-
-template <class T>
-static std::vector<Datapoint*> createCommandObject(const char* type, long ca, long ioa, long cot,
-    long negative, long se, long test, long ts, const T value)
-    {
-    std::vector<Datapoint*> commandObject;
-
-    Datapoint* type1 = createDatapoint("co_type",(std::string)type);
-    commandObject.push_back(type1);
-
-    Datapoint* ca1 = createDatapoint("co_ca",(long)ca);
-    commandObject.push_back(ca1);
-
-    Datapoint* ioa1 = createDatapoint("co_ioa",(long)ioa);
-    commandObject.push_back(ioa1);
-
-    Datapoint* cot1 = createDatapoint("co_cot",(long)cot);
-    commandObject.push_back(cot1);
-
-    Datapoint* negative1 = createDatapoint("co_negative",(long)negative);
-    commandObject.push_back(negative1);
-
-    Datapoint* se1 = createDatapoint("co_se",(long)se);
-    commandObject.push_back(se1);
-
-    Datapoint* test1 = createDatapoint("co_test",(long)test);
-    commandObject.push_back(test1);
-
-    Datapoint* ts1 = createDatapoint("co_ts",(long)ts);
-    commandObject.push_back(ts1);
-
-    Datapoint* value1 = createDatapoint("co_value", value);
-    commandObject.push_back(value1);
-
-    return commandObject;
-}
-
-template <class T>
-static Datapoint* createDataObject(int test, const char* type, int ca, int ioa, int cot,
-    const T value, bool iv, bool bl, bool ov, bool sb, bool nt, long msTime, bool isInvalid, bool isSummerTime, bool isSubst)
-{
-    auto* datapoints = new vector<Datapoint*>;
-
-    datapoints->push_back(createDatapoint("do_type", type));
-    datapoints->push_back(createDatapoint("do_ca", (int64_t)ca));
-    datapoints->push_back(createDatapoint("do_oa", (int64_t)0));
-    datapoints->push_back(createDatapoint("do_cot", (int64_t)cot));
-    datapoints->push_back(createDatapoint("do_test", (int64_t)0));
-    datapoints->push_back(createDatapoint("do_negative", (int64_t)0));
-    datapoints->push_back(createDatapoint("do_ioa", (int64_t)ioa));
-    datapoints->push_back(createDatapoint("do_value", value));
-    datapoints->push_back(createDatapoint("do_quality_iv", (int64_t)iv));
-    datapoints->push_back(createDatapoint("do_quality_bl", (int64_t)bl));
-    datapoints->push_back(createDatapoint("do_quality_ov", (int64_t)ov));
-    datapoints->push_back(createDatapoint("do_quality_sb", (int64_t)sb));
-    datapoints->push_back(createDatapoint("do_quality_nt", (int64_t)nt));
-
-    if (msTime != 0) {
-         datapoints->push_back(createDatapoint("do_ts", msTime));
-         datapoints->push_back(createDatapoint("do_ts_iv", isInvalid ? 1L : 0L));
-         datapoints->push_back(createDatapoint("do_ts_su", isSummerTime ? 1L : 0L));
-         datapoints->push_back(createDatapoint("do_ts_sub", isSubst ? 1L : 0L));
-    }
-
-    DatapointValue dpv(datapoints, true);
-
-    Datapoint* dp = new Datapoint("data_object", dpv);
-
-    return dp;
-}
-
 template <class T>
 
 static Datapoint* createFakeDataObject(int doTest, const char* type, int ca, int ioa, int cot,
@@ -841,6 +773,857 @@ TEST(PivotIEC104Plugin, Plugin_ingest)
     plugin_shutdown(handle);
 }
 
+TEST(PivotIEC104Plugin, PassthroughDatapointsNotCopied)
+{
+    outputHandlerCalled = 0;
+
+    vector<Datapoint*> dataobjects;
+
+    dataobjects.push_back(createDataObject(1,"M_SP_NA_1", 41, 1, 3, (int64_t)1, false, false, false, false, false, 0, false, false, false));
+    DatapointValue otherValue((long)12);
+    dataobjects.push_back(new Datapoint("other", otherValue));
+
+    Reading* unknownReading = new Reading(std::string("UNKNOWN"), dataobjects);
+    unknownReading->setId(1);
+
+    Datapoint* unknownDataObject = unknownReading->getReadingData()[0];
+    Datapoint* otherDatapoint = unknownReading->getReadingData()[1];
+
+    vector<Datapoint*> mixedObjects;
+
+    mixedObjects.push_back(new Datapoint("other", otherValue));
+    mixedObjects.push_back(createDataObject(1,"M_SP_NA_1", 45, 672, 3, (int64_t)1, false, false, false, false, false, 0, false, false, false));
+
+    Reading* mixedReading = new Reading(std::string("TS1"), mixedObjects);
+    mixedReading->setId(2);
+
+    Datapoint* mixedOther = mixedReading->getReadingData()[0];
+
+    vector<Reading*> readings;
+
+    readings.push_back(unknownReading);
+    readings.push_back(mixedReading);
+
+    ReadingSet readingSet;
+
+    readingSet.append(readings);
+
+    ConfigCategory config("exchanged_data", exchanged_data);
+
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, testOutputStream);
+
+    ASSERT_TRUE(handle != nullptr);
+
+    plugin_ingest(handle, &readingSet);
+
+    ASSERT_EQ(1, outputHandlerCalled);
+
+    // Datapoints of a reading with nothing to convert are forwarded as they are
+    ASSERT_EQ(2, unknownReading->getReadingData().size());
+    ASSERT_EQ(unknownDataObject, unknownReading->getReadingData()[0]);
+    ASSERT_EQ(otherDatapoint, unknownReading->getReadingData()[1]);
+
+    // Converted datapoints are replaced in place, the others keep their object
+    ASSERT_EQ(2, mixedReading->getReadingData().size());
+    ASSERT_EQ(mixedOther, mixedReading->getReadingData()[0]);
+    ASSERT_EQ("PIVOT", mixedReading->getReadingData()[1]->getName());
+
+    plugin_shutdown(handle);
+}
+
+TEST(PivotIEC104Plugin, DatapointPoolRecycling)
+{
+    ConfigCategory config("exchanged_data", exchanged_data);
+
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, testOutputStream);
+
+    ASSERT_TRUE(handle != nullptr);
+
+    const DatapointPool& pool = static_cast<IEC104PivotFilter*>(handle)->getDatapointPool();
+
+    for (int i = 0; i < 10; i++) {
+        vector<Datapoint*> dataobjects;
+
+        dataobjects.push_back(createDataObject(1,"M_SP_TB_1", 45, 872, 3, (int64_t)1, false, false, false, false, false, 1668631513250, false, false, false));
+
+        Reading* reading = new Reading(std::string("TS2"), dataobjects);
+        reading->setId(1);
+
+        vector<Reading*> readings;
+        readings.push_back(reading);
+
+        ReadingSet readingSet;
+        readingSet.append(readings);
+
+        uint64_t missCount = pool.getMissCount();
+
+        plugin_ingest(handle, &readingSet);
+
+        ASSERT_EQ("PIVOT", reading->getReadingData()[0]->getName());
+
+        if (i == 0) {
+            // Nothing has been released yet when the first reading is converted
+            ASSERT_EQ(0, pool.getHitCount());
+        }
+        else {
+            // The input nodes of the previous reading are used to build the output tree
+            ASSERT_LT(pool.getMissCount() - missCount, 10);
+        }
+    }
+
+    ASSERT_GT(pool.getHitCount(), 0);
+
+    plugin_shutdown(handle);
+}
+
+TEST(PivotIEC104Plugin, ConversionMetrics)
+{
+    ConfigCategory config("exchanged_data", exchanged_data);
+
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, testOutputStream);
+
+    ASSERT_TRUE(handle != nullptr);
+
+    vector<Datapoint*> converted;
+    converted.push_back(createDataObject(1,"M_SP_TB_1", 45, 872, 3, (int64_t)1, false, false, false, false, false, 1668631513250, false, false, false));
+    vector<Datapoint*> mismatch;
+    mismatch.push_back(createDataObject(1,"M_SP_TB_1", 45, 890, 3, (int64_t)1, false, false, false, false, false, 1668631513250, false, false, false));
+    vector<Datapoint*> passthrough;
+    passthrough.push_back(createDataObject(1,"M_SP_NA_1", 45, 4242, 3, (int64_t)1, false, false, false, false, false, 0, false, false, false));
+
+    Reading* mismatchReading = new Reading(std::string("TS3"), mismatch);
+    Reading* unknownCommand = new Reading(std::string("IEC104Command"), createCommandObject("C_SC_TA_1", 45, 4242, 6, 0, 0, 0, 2421512, 1L));
+
+    vector<Reading*> readings;
+    readings.push_back(new Reading(std::string("TS2"), converted));
+    readings.push_back(mismatchReading);
+    readings.push_back(new Reading(std::string("UNKNOWN"), passthrough));
+    readings.push_back(unknownCommand);
+
+    ReadingSet readingSet;
+    readingSet.append(readings);
+
+    plugin_ingest(handle, &readingSet);
+
+    Iec104PivotUtility::MetricsSnapshot metrics = static_cast<IEC104PivotFilter*>(handle)->getMetricsSnapshot();
+    const Iec104PivotUtility::MetricsDirection toPivot = Iec104PivotUtility::MetricsDirection::IEC104_TO_PIVOT;
+
+    ASSERT_EQ(1, metrics.getCount(toPivot, Iec104AsduType::M_SP_TB_1, Iec104PivotUtility::MetricsOutcome::CONVERTED));
+    ASSERT_EQ(1, metrics.getCount(toPivot, Iec104AsduType::M_SP_TB_1, Iec104PivotUtility::MetricsOutcome::TYPE_MISMATCH));
+    ASSERT_EQ(1, metrics.getCount(toPivot, Iec104AsduType::M_SP_NA_1, Iec104PivotUtility::MetricsOutcome::PASSTHROUGH));
+    ASSERT_EQ(1, metrics.getCount(toPivot, Iec104AsduType::C_SC_TA_1, Iec104PivotUtility::MetricsOutcome::DROPPED_UNKNOWN_ADDRESS));
+    ASSERT_EQ(0, metrics.getTotal(Iec104PivotUtility::MetricsDirection::PIVOT_TO_IEC104, Iec104PivotUtility::MetricsOutcome::CONVERTED));
+
+    ASSERT_EQ(1, metrics.getLatency(Iec104PivotUtility::MetricsLatency::INGEST).getCount());
+    ASSERT_EQ(2, metrics.getLatency(Iec104PivotUtility::MetricsLatency::CONVERT_DATA_OBJECT_TO_PIVOT).getCount());
+    ASSERT_EQ(1, metrics.getLatency(Iec104PivotUtility::MetricsLatency::CONVERT_OPERATION_OBJECT_TO_PIVOT).getCount());
+
+    // The converted reading goes back through the filter
+    std::vector<Reading*>* output = readingSet.getAllReadingsPtr();
+    ASSERT_EQ(2, output->size());
+
+    ReadingSet pivotSet;
+    std::vector<Reading*> pivotReadings(1, (*output)[0]);
+    output->erase(output->begin());
+    pivotSet.append(pivotReadings);
+
+    plugin_ingest(handle, &pivotSet);
+
+    metrics = static_cast<IEC104PivotFilter*>(handle)->getMetricsSnapshot();
+
+    ASSERT_EQ(1, metrics.getCount(Iec104PivotUtility::MetricsDirection::PIVOT_TO_IEC104, Iec104AsduType::M_SP_TB_1,
+                                  Iec104PivotUtility::MetricsOutcome::CONVERTED));
+    ASSERT_EQ(2, metrics.getLatency(Iec104PivotUtility::MetricsLatency::INGEST).getCount());
+
+    delete mismatchReading;
+    delete unknownCommand;
+
+    plugin_shutdown(handle);
+}
+
+TEST(PivotIEC104Plugin, ReconfigureDuringIngest)
+{
+    ConfigCategory config("exchanged_data", exchanged_data);
+
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, [](OUTPUT_HANDLE*, READINGSET*) {});
+
+    ASSERT_TRUE(handle != nullptr);
+
+    std::atomic<bool> notConverted(false);
+
+    // Readings ingested while the configuration is replaced always see a complete configuration
+    std::thread ingestThread([&] {
+        for (int i = 0; i < 200; i++) {
+            vector<Datapoint*> dataobjects;
+            dataobjects.push_back(createDataObject(1,"M_SP_TB_1", 45, 872, 3, (int64_t)1, false, false, false, false, false, 1668631513250, false, false, false));
+
+            vector<Reading*> readings;
+            readings.push_back(new Reading(std::string("TS2"), dataobjects));
+
+            ReadingSet readingSet;
+            readingSet.append(readings);
+
+            plugin_ingest(handle, &readingSet);
+
+            if (readingSet.getAllReadings().size() != 1 || readingSet.getAllReadings()[0]->getReadingData()[0]->getName() != "PIVOT") {
+                notConverted.store(true);
+            }
+        }
+    });
+
+    for (int i = 0; i < 20; i++) {
+        static_cast<IEC104PivotFilter*>(handle)->reconfigure(&config);
+    }
+
+    ingestThread.join();
+
+    ASSERT_FALSE(notConverted.load());
+
+    plugin_shutdown(handle);
+}
+
+static std::vector<std::string> outputReadings;
+
+static void collectOutputStream(OUTPUT_HANDLE * handle, READINGSET* readingSet)
+{
+    for (Reading* reading : readingSet->getAllReadings()) {
+        outputReadings.push_back(reading->getAssetName() + " " + reading->toJSON());
+    }
+}
+
+static std::vector<std::string>
+convertReadingsWithConfig(const std::string& configJson, int readingCount)
+{
+    ConfigCategory config("exchanged_data", configJson);
+
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, collectOutputStream);
+
+    vector<Reading*> readings;
+    vector<Reading*> mismatchingReadings;
+
+    for (int i = 0; i < readingCount; i++) {
+        vector<Datapoint*> dataobjects;
+        Reading* reading = nullptr;
+
+        switch (i % 4) {
+            case 0:
+                dataobjects.push_back(createDataObject(1,"M_SP_TB_1", 45, 872, 3, (int64_t)(i % 2), false, false, false, false, false, 1668631513250 + i, false, false, false));
+                reading = new Reading(std::string("TS2"), dataobjects);
+                break;
+            case 1:
+                dataobjects.push_back(createDataObject(1,"M_DP_TB_1", 45, 890, 3, (int64_t)2, false, false, false, false, false, 1668631513250 + i, false, false, false));
+                reading = new Reading(std::string("TS3"), dataobjects);
+                break;
+            case 2:
+                dataobjects.push_back(createDataObject(1,"M_SP_NA_1", 41, i, 3, (int64_t)1, false, false, false, false, false, 0, false, false, false));
+                reading = new Reading(std::string("UNKNOWN"), dataobjects);
+                break;
+            default:
+                // type does not match the configuration: the reading is removed from the set
+                dataobjects.push_back(createDataObject(1,"M_SP_TB_1", 45, 890, 3, (int64_t)1, false, false, false, false, false, 1668631513250 + i, false, false, false));
+                reading = new Reading(std::string("TS3"), dataobjects);
+                mismatchingReadings.push_back(reading);
+                break;
+        }
+
+        reading->setId(i + 1);
+        readings.push_back(reading);
+    }
+
+    ReadingSet readingSet;
+
+    readingSet.append(readings);
+
+    outputReadings.clear();
+
+    plugin_ingest(handle, &readingSet);
+
+    for (Reading* reading : mismatchingReadings) {
+        delete reading;
+    }
+
+    plugin_shutdown(handle);
+
+    return outputReadings;
+}
+
+TEST(PivotIEC104Plugin, ParallelConversionKeepsOrder)
+{
+    std::string parallelConfig = exchanged_data.substr(0, exchanged_data.rfind('}')) + QUOTE(,
+        "conversion_threads" : {
+            "description" : "conversion threads",
+            "type" : "integer",
+            "default" : "3"
+        },
+        "parallel_threshold" : {
+            "description" : "parallel threshold",
+            "type" : "integer",
+            "default" : "100"
+        }
+    });
+
+    ConfigCategory config("exchanged_data", parallelConfig);
+    config.setItemsValueFromDefault();
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, collectOutputStream);
+    ASSERT_EQ(3, static_cast<IEC104PivotFilter*>(handle)->getConversionThreadCount());
+    plugin_shutdown(handle);
+
+    std::vector<std::string> serialOutput = convertReadingsWithConfig(exchanged_data, 2000);
+    std::vector<std::string> parallelOutput = convertReadingsWithConfig(parallelConfig, 2000);
+
+    ASSERT_EQ(1500, serialOutput.size());
+    ASSERT_EQ(serialOutput, parallelOutput);
+
+    // Below the threshold the set is converted in the calling thread
+    ASSERT_EQ(convertReadingsWithConfig(exchanged_data, 50), convertReadingsWithConfig(parallelConfig, 50));
+}
+
+static std::vector<std::string>
+listDirectory(const std::string& directory)
+{
+    std::vector<std::string> names;
+    DIR* dir = opendir(directory.c_str());
+
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") names.push_back(name);
+    }
+
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+
+    return names;
+}
+
+/* Start and stop a filter with the configuration cache in the directory */
+static void
+startWithConfigCache(const std::string& filterName, const std::string& directory, const std::string& exchangedData)
+{
+    std::string cacheConfig = exchangedData.substr(0, exchangedData.rfind('}')) + QUOTE(,
+        "config_cache_dir" : {
+            "description" : "configuration cache directory",
+            "type" : "string",
+            "default" : ) + "\"" + directory + "\"}}";
+
+    ConfigCategory config(filterName, cacheConfig);
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, testOutputStream);
+    plugin_shutdown(handle);
+}
+
+TEST(PivotIEC104Plugin, ConfigCacheOfFiltersWithPrefixNames)
+{
+    char directory[] = "/tmp/iec104pivot_cache_XXXXXX";
+    ASSERT_NE(nullptr, mkdtemp(directory));
+
+    std::string otherExchangedData = exchanged_data;
+    otherExchangedData.replace(otherExchangedData.find("ID-45-672"), 9, "ID-45-673");
+
+    // "iec104" is a prefix of the names of the other filters
+    startWithConfigCache("iec104-2", directory, exchanged_data);
+    startWithConfigCache("iec104_north", directory, exchanged_data);
+    startWithConfigCache("iec104", directory, exchanged_data);
+
+    std::vector<std::string> images = listDirectory(directory);
+    ASSERT_EQ(3, images.size());
+
+    // A new exchanged_data only replaces the image of its own filter
+    startWithConfigCache("iec104", directory, otherExchangedData);
+
+    std::vector<std::string> newImages = listDirectory(directory);
+    ASSERT_EQ(3, newImages.size());
+
+    for (const std::string& name : images) {
+        bool ownImage = (name.compare(0, 7, "iec104-") == 0 && name.compare(0, 9, "iec104-2-") != 0);
+        ASSERT_EQ(!ownImage, std::find(newImages.begin(), newImages.end(), name) != newImages.end()) << name;
+    }
+
+    startWithConfigCache("iec104-2", directory, otherExchangedData);
+    ASSERT_EQ(3, listDirectory(directory).size());
+
+    for (const std::string& name : listDirectory(directory)) {
+        unlink((std::string(directory) + "/" + name).c_str());
+    }
+
+    rmdir(directory);
+}
+
+TEST(PivotIEC104Plugin, AsyncLoggingOfSeveralFilters)
+{
+    std::string asyncConfig = exchanged_data.substr(0, exchanged_data.rfind('}')) + QUOTE(,
+        "async_logging" : {
+            "description" : "asynchronous logging",
+            "type" : "boolean",
+            "default" : "true"
+        }});
+
+    ConfigCategory config("exchanged_data", asyncConfig);
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE first = plugin_init(&config, NULL, testOutputStream);
+    PLUGIN_HANDLE second = plugin_init(&config, NULL, testOutputStream);
+
+    Iec104PivotUtility::AsyncLogSink& sink = Iec104PivotUtility::AsyncLogSink::getInstance();
+    ASSERT_TRUE(sink.isRunning());
+
+    // Disabling it for one filter, even twice, or shutting it down keeps it for the other one
+    std::string syncConfig = asyncConfig;
+    syncConfig.replace(syncConfig.rfind("\"true\""), 6, "\"false\"");
+    ConfigCategory newConfig("exchanged_data", syncConfig);
+    newConfig.setItemsValueFromDefault();
+
+    static_cast<IEC104PivotFilter*>(first)->reconfigure(&newConfig);
+    static_cast<IEC104PivotFilter*>(first)->reconfigure(&newConfig);
+    ASSERT_TRUE(sink.isRunning());
+
+    plugin_shutdown(first);
+    ASSERT_TRUE(sink.isRunning());
+
+    plugin_shutdown(second);
+    ASSERT_FALSE(sink.isRunning());
+}
+
+static std::atomic<int> convertedOutputReadings(0);
+
+static void countConvertedOutputStream(OUTPUT_HANDLE * handle, READINGSET* readingSet)
+{
+    for (Reading* reading : readingSet->getAllReadings()) {
+        if (getDatapoint(reading, "PIVOT")) convertedOutputReadings.fetch_add(1);
+    }
+}
+
+static std::string
+configWithConversionThreads(int threadCount)
+{
+    return exchanged_data.substr(0, exchanged_data.rfind('}')) + QUOTE(,
+        "parallel_threshold" : {
+            "description" : "parallel threshold",
+            "type" : "integer",
+            "default" : "100"
+        },
+        "conversion_threads" : {
+            "description" : "conversion threads",
+            "type" : "integer",
+            "default" : ) + "\"" + std::to_string(threadCount) + "\"}}";
+}
+
+TEST(PivotIEC104Plugin, ReconfigureThreadsWhileIngesting)
+{
+    ConfigCategory config("exchanged_data", configWithConversionThreads(2));
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, countConvertedOutputStream);
+    IEC104PivotFilter* filter = static_cast<IEC104PivotFilter*>(handle);
+
+    const int rounds = 40;
+    const int readingCount = 300;
+    std::atomic<bool> ingestDone(false);
+
+    convertedOutputReadings.store(0);
+
+    // The conversion threads are replaced while sets are converted by the previous ones
+    std::thread ingestThread([&] {
+        for (int round = 0; round < rounds; round++) {
+            vector<Reading*> readings;
+
+            for (int i = 0; i < readingCount; i++) {
+                vector<Datapoint*> dataobjects;
+                dataobjects.push_back(createDataObject(1,"M_SP_TB_1", 45, 872, 3, (int64_t)(i % 2), false, false, false, false, false, 1668631513250 + i, false, false, false));
+                readings.push_back(new Reading(std::string("TS2"), dataobjects));
+            }
+
+            ReadingSet readingSet;
+            readingSet.append(readings);
+
+            plugin_ingest(handle, &readingSet);
+        }
+
+        ingestDone.store(true);
+    });
+
+    int reconfigurations = 0;
+
+    while (!ingestDone.load()) {
+        ConfigCategory newConfig("exchanged_data", configWithConversionThreads(reconfigurations % 4));
+        newConfig.setItemsValueFromDefault();
+
+        filter->reconfigure(&newConfig);
+        reconfigurations++;
+    }
+
+    ingestThread.join();
+
+    ASSERT_EQ(rounds * readingCount, convertedOutputReadings.load());
+    ASSERT_LT(0, reconfigurations);
+    ASSERT_EQ((size_t)((reconfigurations - 1) % 4), filter->getConversionThreadCount());
+
+    plugin_shutdown(handle);
+}
+
+static std::atomic<int> timeSourceCalls(0);
+
+static uint64_t countingTimeSource()
+{
+    return (uint64_t)(timeSourceCalls.fetch_add(1) + 1) * 1000;
+}
+
+static std::vector<std::string>
+convertWithClockMode(const char* clockMode)
+{
+    std::string clockConfig = exchanged_data.substr(0, exchanged_data.rfind('}')) + QUOTE(,
+        "timestamp_clock" : {
+            "description" : "timestamp clock",
+            "type" : "enumeration",
+            "options" : ["batch", "object", "coarse"],
+            "default" : ) + "\"" + clockMode + "\"}}";
+
+    ConfigCategory config("exchanged_data", clockConfig);
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, collectOutputStream);
+    static_cast<IEC104PivotFilter*>(handle)->setTimeSource(countingTimeSource);
+
+    timeSourceCalls.store(0);
+    outputReadings.clear();
+
+    // Two objects without timestamp and one with its own timestamp
+    vector<Datapoint*> dataobjects;
+    dataobjects.push_back(createDataObject(1,"M_SP_NA_1", 45, 672, 3, (int64_t)1, false, false, false, false, false, 0, false, false, false));
+    dataobjects.push_back(createDataObject(1,"M_SP_NA_1", 45, 672, 3, (int64_t)0, false, false, false, false, false, 0, false, false, false));
+    dataobjects.push_back(createDataObject(1,"M_SP_TB_1", 45, 672, 3, (int64_t)0, false, false, false, false, false, 1669123796250, false, false, false));
+
+    Reading* reading = new Reading(std::string("TS1"), dataobjects);
+    reading->setId(1);
+
+    vector<Reading*> readings;
+    readings.push_back(reading);
+
+    ReadingSet readingSet;
+    readingSet.append(readings);
+
+    plugin_ingest(handle, &readingSet);
+    plugin_shutdown(handle);
+
+    return outputReadings;
+}
+
+TEST(PivotIEC104Plugin, TimestampClockModes)
+{
+    // Sampled once for the whole set: both objects without timestamp get the same time
+    std::vector<std::string> output = convertWithClockMode("batch");
+    ASSERT_EQ(1, output.size());
+    ASSERT_EQ(1, timeSourceCalls.load());
+    ASSERT_NE(std::string::npos, output[0].find("\"SecondSinceEpoch\":1,"));
+    ASSERT_EQ(std::string::npos, output[0].find("\"SecondSinceEpoch\":2,"));
+    ASSERT_NE(std::string::npos, output[0].find("\"SecondSinceEpoch\":1669123796,"));
+
+    // Sampled for each object that needs it
+    output = convertWithClockMode("object");
+    ASSERT_EQ(1, output.size());
+    ASSERT_EQ(2, timeSourceCalls.load());
+    ASSERT_NE(std::string::npos, output[0].find("\"SecondSinceEpoch\":1,"));
+    ASSERT_NE(std::string::npos, output[0].find("\"SecondSinceEpoch\":2,"));
+
+    output = convertWithClockMode("coarse");
+    ASSERT_EQ(2, timeSourceCalls.load());
+
+    Iec104PivotUtility::ClockMode mode = Iec104PivotUtility::ClockMode::BATCH;
+    ASSERT_FALSE(Iec104PivotUtility::parseClockMode("precise", mode));
+    ASSERT_EQ(Iec104PivotUtility::ClockMode::BATCH, mode);
+
+    // The coarse clock may lag behind the precise one by a tick at most
+    uint64_t coarse = Iec104PivotUtility::coarseRealtimeClockMs();
+    ASSERT_NEAR(Iec104PivotUtility::realtimeClockMs(), coarse, 100);
+}
+
+static std::vector<std::string>
+convertWithStepPositionFormat(const char* format, Datapoint* dataobject)
+{
+    std::string formatConfig = exchanged_data.substr(0, exchanged_data.rfind('}')) + QUOTE(,
+        "step_position_format" : {
+            "description" : "step position format",
+            "type" : "enumeration",
+            "options" : ["string", "structured"],
+            "default" : ) + "\"" + format + "\"}}";
+
+    ConfigCategory config("exchanged_data", formatConfig);
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, collectOutputStream);
+
+    outputReadings.clear();
+
+    vector<Datapoint*> dataobjects;
+    dataobjects.push_back(dataobject);
+
+    Reading* reading = new Reading(std::string("TM250"), dataobjects);
+    reading->setId(1);
+
+    vector<Reading*> readings;
+    readings.push_back(reading);
+
+    ReadingSet readingSet;
+    readingSet.append(readings);
+
+    plugin_ingest(handle, &readingSet);
+    plugin_shutdown(handle);
+
+    return outputReadings;
+}
+
+TEST(PivotIEC104Plugin, StepPositionFormats)
+{
+    // The reading takes the pivot tree, one object per conversion
+    auto createBscTyp = [] {
+        PivotDataObject bscTyp("GTIM", "BscTyp");
+
+        bscTyp.setIdentifier("ID-45-920");
+        bscTyp.setCause(3);
+        bscTyp.setPosVal(-5, true);
+        bscTyp.addQuality(false, false, false, false, false, false);
+
+        return bscTyp.toDatapoint();
+    };
+
+    std::vector<std::string> output = convertWithStepPositionFormat("string", createBscTyp());
+    ASSERT_EQ(1, output.size());
+    ASSERT_NE(std::string::npos, output[0].find("\"do_value\":\"[-5,true]\""));
+
+    output = convertWithStepPositionFormat("structured", createBscTyp());
+    ASSERT_EQ(1, output.size());
+    ASSERT_NE(std::string::npos, output[0].find("\"do_value\":{\"posVal\":-5, \"transInd\":1}"));
+
+    // A structured value is read back whatever the configured format
+    Datapoint* dataobject = createDataObject(1,"M_ST_NA_1", 45, 920, 3, "[0,false]", false, false, false, false, false, 0, false, false, false);
+    std::vector<Datapoint*>* elements = dataobject->getData().getDpVec();
+
+    for (Datapoint*& element : *elements) {
+        if (element->getName() == "do_value") {
+            std::vector<Datapoint*>* position = new std::vector<Datapoint*>;
+            position->push_back(createDatapoint("posVal", (int64_t)-7));
+            position->push_back(createDatapoint("transInd", (int64_t)1));
+
+            DatapointValue positionValue(position, true);
+
+            delete element;
+            element = new Datapoint("do_value", positionValue);
+        }
+    }
+
+    output = convertWithStepPositionFormat("string", dataobject);
+    ASSERT_EQ(1, output.size());
+    ASSERT_NE(std::string::npos, output[0].find("\"valWtr\":{\"posVal\":-7, \"transInd\":1}"));
+
+    // A malformed position is not converted to position 0
+    output = convertWithStepPositionFormat("string", createDataObject(1,"M_ST_NA_1", 45, 920, 3, "[x,true]", false, false, false, false, false, 0, false, false, false));
+    ASSERT_EQ(1, output.size());
+    ASSERT_EQ(std::string::npos, output[0].find("\"posVal\""));
+}
+
+static uint64_t reportTimeMs = 0;
+
+static uint64_t reportTimeSource()
+{
+    return reportTimeMs;
+}
+
+/* Number of readings sent for a single point object of TS1 */
+static size_t
+ingestReportedObject(PLUGIN_HANDLE handle, int cot, int64_t value, bool iv)
+{
+    outputReadings.clear();
+
+    vector<Datapoint*> dataobjects;
+    dataobjects.push_back(createDataObject(1,"M_SP_NA_1", 45, 672, cot, value, iv, false, false, false, false, 0, false, false, false));
+
+    Reading* reading = new Reading(std::string("TS1"), dataobjects);
+    reading->setId(1);
+
+    vector<Reading*> readings;
+    readings.push_back(reading);
+
+    ReadingSet readingSet;
+    readingSet.append(readings);
+
+    plugin_ingest(handle, &readingSet);
+
+    return outputReadings.size();
+}
+
+TEST(PivotIEC104Plugin, ReportByException)
+{
+    std::string reportConfig = exchanged_data.substr(0, exchanged_data.rfind('}')) + QUOTE(,
+        "report_by_exception" : {
+            "description" : "report by exception",
+            "type" : "boolean",
+            "default" : "true"
+        },
+        "report_refresh_interval" : {
+            "description" : "refresh interval",
+            "type" : "integer",
+            "default" : "60"
+        }});
+
+    ConfigCategory config("exchanged_data", reportConfig);
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, collectOutputStream);
+    static_cast<IEC104PivotFilter*>(handle)->setTimeSource(reportTimeSource);
+
+    reportTimeMs = 1000000;
+
+    // Cyclic scans of an unchanged value are only sent once
+    ASSERT_EQ(1, ingestReportedObject(handle, 1, 1, false));
+    ASSERT_EQ(0, ingestReportedObject(handle, 1, 1, false));
+    ASSERT_EQ(0, ingestReportedObject(handle, 2, 1, false));
+
+    // Value and quality changes are sent
+    ASSERT_EQ(1, ingestReportedObject(handle, 3, 0, false));
+    ASSERT_EQ(1, ingestReportedObject(handle, 3, 0, true));
+    ASSERT_EQ(0, ingestReportedObject(handle, 1, 0, true));
+
+    // Interrogation responses are always sent
+    ASSERT_EQ(1, ingestReportedObject(handle, 20, 0, true));
+
+    // Forced refresh
+    reportTimeMs += 59999;
+    ASSERT_EQ(0, ingestReportedObject(handle, 1, 0, true));
+    reportTimeMs += 1;
+    ASSERT_EQ(1, ingestReportedObject(handle, 1, 0, true));
+
+    Iec104PivotUtility::MetricsSnapshot metrics = static_cast<IEC104PivotFilter*>(handle)->getMetricsSnapshot();
+
+    ASSERT_EQ(4, metrics.getCount(Iec104PivotUtility::MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_SP_NA_1,
+                                  Iec104PivotUtility::MetricsOutcome::SUPPRESSED_UNCHANGED));
+    ASSERT_EQ(5, metrics.getCount(Iec104PivotUtility::MetricsDirection::IEC104_TO_PIVOT, Iec104AsduType::M_SP_NA_1,
+                                  Iec104PivotUtility::MetricsOutcome::CONVERTED));
+
+    // Objects of one set are compared in order, and a set left without objects is not sent
+    outputReadings.clear();
+
+    vector<Reading*> readings;
+
+    for (int64_t value : {0, 1, 1, 0}) {
+        vector<Datapoint*> dataobjects;
+        dataobjects.push_back(createDataObject(1,"M_SP_NA_1", 45, 672, 1, value, true, false, false, false, false, 0, false, false, false));
+        readings.push_back(new Reading(std::string("TS1"), dataobjects));
+    }
+
+    ReadingSet readingSet;
+    readingSet.append(readings);
+
+    plugin_ingest(handle, &readingSet);
+
+    ASSERT_EQ(2, outputReadings.size());
+    ASSERT_NE(std::string::npos, outputReadings[0].find("\"stVal\":1"));
+    ASSERT_NE(std::string::npos, outputReadings[1].find("\"stVal\":0"));
+
+    ASSERT_EQ(0, ingestReportedObject(handle, 1, 0, true));
+
+    plugin_shutdown(handle);
+}
+
+/* One reading of a single point object of TS1 per value */
+static vector<Reading*>
+createReportedReadings(std::initializer_list<int64_t> values)
+{
+    vector<Reading*> readings;
+
+    for (int64_t value : values) {
+        vector<Datapoint*> dataobjects;
+        dataobjects.push_back(createDataObject(1,"M_SP_NA_1", 45, 672, 3, value, false, false, false, false, false, 0, false, false, false));
+        readings.push_back(new Reading(std::string("TS1"), dataobjects));
+    }
+
+    return readings;
+}
+
+static void
+deleteReadings(vector<Reading*>& readings)
+{
+    for (Reading* reading : readings) {
+        delete reading;
+    }
+
+    readings.clear();
+}
+
+TEST(PivotIEC104Plugin, ReportByExceptionOfDroppedObject)
+{
+    std::string reportConfig = exchanged_data.substr(0, exchanged_data.rfind('}')) + QUOTE(,
+        "report_by_exception" : {
+            "description" : "report by exception",
+            "type" : "boolean",
+            "default" : "true"
+        }});
+
+    ConfigCategory config("exchanged_data", reportConfig);
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, collectOutputStream);
+    static_cast<IEC104PivotFilter*>(handle)->setTimeSource(reportTimeSource);
+    IEC104PivotFilterInternals filter(*static_cast<IEC104PivotFilter*>(handle));
+
+    reportTimeMs = 1000000;
+
+    // A converted object is recorded as sent
+    vector<Reading*> readings = createReportedReadings({1});
+    filter.suppressUnchangedDataObjects(readings);
+    ASSERT_EQ(1, filter.getPendingReports().size());
+    filter.getPendingReports()[0].converted = true;
+    filter.recordSentDataObjects();
+    ASSERT_EQ(1, filter.getReportState("TS1").value);
+    deleteReadings(readings);
+
+    // Objects of a set are compared with the one pending before them, a dropped object is not recorded
+    readings = createReportedReadings({0, 0});
+    filter.suppressUnchangedDataObjects(readings);
+    ASSERT_EQ(1, filter.getPendingReports().size());
+    ASSERT_EQ(1, readings[0]->getReadingData().size());
+    ASSERT_EQ(0, readings[1]->getReadingData().size());
+    filter.recordSentDataObjects();
+    ASSERT_EQ(1, filter.getReportState("TS1").value);
+    deleteReadings(readings);
+
+    // The same object is then sent again
+    readings = createReportedReadings({0});
+    filter.suppressUnchangedDataObjects(readings);
+    ASSERT_EQ(1, filter.getPendingReports().size());
+    filter.getPendingReports()[0].converted = true;
+    filter.recordSentDataObjects();
+    ASSERT_EQ(0, filter.getReportState("TS1").value);
+    deleteReadings(readings);
+
+    // A set whose conversion did not complete leaves nothing pending for the next one
+    readings = createReportedReadings({1});
+    filter.suppressUnchangedDataObjects(readings);
+    ASSERT_EQ(1, filter.getPendingReports().size());
+    deleteReadings(readings);
+
+    readings = createReportedReadings({0, 1});
+    filter.suppressUnchangedDataObjects(readings);
+    ASSERT_EQ(1, filter.getPendingReports().size());
+    ASSERT_EQ(0, readings[0]->getReadingData().size());
+    ASSERT_EQ(1, readings[1]->getReadingData().size());
+    filter.getPendingReports()[0].converted = true;
+    filter.recordSentDataObjects();
+    ASSERT_EQ(1, filter.getReportState("TS1").value);
+    deleteReadings(readings);
+
+    plugin_shutdown(handle);
+}
+
 TEST(PivotIEC104Plugin, OperationPlugin_ingest_1)
 {
     outputHandlerCalled = 0;
@@ -943,6 +1726,79 @@ TEST(PivotIEC104Plugin, M_SP_TB_1)
     plugin_shutdown(handle);
 }
 
+TEST(PivotIEC104Plugin, M_SP_TB_1_DuplicateAttributes)
+{
+    outputHandlerCalled = 0;
+
+    auto* datapoints = new vector<Datapoint*>;
+
+    // The first occurrence of an attribute with the expected value type is used
+    datapoints->push_back(createDatapoint("do_cot", std::string("3")));
+    datapoints->push_back(createDatapoint("do_type", "M_SP_TB_1"));
+    datapoints->push_back(createDatapoint("do_ca", (int64_t)45));
+    datapoints->push_back(createDatapoint("do_ioa", (int64_t)872));
+    datapoints->push_back(createDatapoint("do_cot", (int64_t)3));
+    datapoints->push_back(createDatapoint("do_cot", (int64_t)20));
+    datapoints->push_back(createDatapoint("do_value", (int64_t)1));
+    datapoints->push_back(createDatapoint("do_value", (int64_t)0));
+    datapoints->push_back(createDatapoint("do_type", "M_DP_TB_1"));
+    datapoints->push_back(createDatapoint("do_quality", (int64_t)1));
+    datapoints->push_back(createDatapoint("do_ts", (long)1668631513250));
+    datapoints->push_back(createDatapoint("unknown", (int64_t)1));
+
+    DatapointValue dpv(datapoints, true);
+
+    vector<Datapoint*> dataobjects;
+
+    dataobjects.push_back(new Datapoint("data_object", dpv));
+
+    Reading* reading = new Reading(std::string("TS2"), dataobjects);
+
+    reading->setId(1); // Required: otherwise there will be a "move depends on unitilized value" error
+
+    vector<Reading*> readings;
+
+    readings.push_back(reading);
+
+    ReadingSet readingSet;
+
+    readingSet.append(readings);
+
+    ConfigCategory config("exchanged_data", exchanged_data);
+
+    config.setItemsValueFromDefault();
+
+    PLUGIN_HANDLE handle = plugin_init(&config, NULL, testOutputStream);
+
+    ASSERT_TRUE(handle != nullptr);
+
+    plugin_ingest(handle, &readingSet);
+
+    ASSERT_EQ(1, outputHandlerCalled);
+
+    ASSERT_NE(nullptr, lastReading);
+
+    Datapoint* pivot = getDatapoint(lastReading, "PIVOT");
+    ASSERT_NE(nullptr, pivot);
+    Datapoint* gtis = getChild(pivot, "GTIS");
+    ASSERT_NE(nullptr, gtis);
+    Datapoint* spsTyp = getChild(gtis, "SpsTyp");
+    ASSERT_NE(nullptr, spsTyp);
+    Datapoint* stVal = getChild(spsTyp, "stVal");
+    ASSERT_NE(nullptr, stVal);
+    ASSERT_TRUE(isValueInt(stVal));
+    ASSERT_EQ(1, getValueInt(stVal));
+
+    Datapoint* cause = getChild(gtis, "Cause");
+    ASSERT_NE(nullptr, cause);
+    Datapoint* causeStVal = getChild(cause, "stVal");
+    ASSERT_NE(nullptr, causeStVal);
+    ASSERT_TRUE(isValueInt(causeStVal));
+    ASSERT_EQ(3, getValueInt(causeStVal));
+
+    plugin_shutdown(handle);
+}
+
 TEST(PivotIEC104Plugin, M_DP_TB_1)
 {
     outputHandlerCalled = 0;
@@ -5422,4 +6278,170 @@ TEST(PivotIEC104Plugin, PluginIngestWrongDataPointName)
     ASSERT_EQ(1, getValueInt(doValue));
 
     plugin_shutdown(handle);
-}
\ No newline at end of file
+}
+static Datapoint* createMvTyp(float value, int cause, bool causeFirst)
+{
+    PivotDataObject mvTyp("GTIM", "MvTyp");
+
+    // The order of the elements gives the shape of the tree
+    if (causeFirst) {
+        mvTyp.setCause(cause);
+        mvTyp.setIdentifier("ID-45-984");
+    }
+    else {
+        mvTyp.setIdentifier("ID-45-984");
+        mvTyp.setCause(cause);
+    }
+
+    mvTyp.setMagF(value);
+    mvTyp.addQuality(false, false, false, true, false, false);
+    mvTyp.addTimestamp(1669123796250, false, false, false);
+
+    return mvTyp.toDatapoint();
+}
+
+static void checkMvTyp(Datapoint* dp, float value, int cause)
+{
+    IEC104PivotDataPoint exchangeConfig("TM1", "ID-45-984", "MvTyp", "M_ME_NC_1", 45, 984, "");
+    Iec104PivotUtility::ConversionClock clock(Iec104PivotUtility::realtimeClockMs, Iec104PivotUtility::ClockMode::BATCH);
+
+    PivotDataObject pivot(dp);
+
+    ASSERT_EQ("ID-45-984", pivot.getIdentifier());
+    ASSERT_EQ(cause, pivot.getCause());
+    ASSERT_TRUE(pivot.Overflow());
+
+    Datapoint* dataobject = pivot.toIec104DataObject(&exchangeConfig, clock);
+
+    ASSERT_FLOAT_EQ(value, getChild(dataobject, "do_value")->getData().toDouble());
+    ASSERT_EQ(1669123796250, getValueInt(getChild(dataobject, "do_ts")));
+
+    delete dataobject;
+    delete dp;
+}
+
+TEST(PivotIEC104Plugin, PivotShapePlanCache)
+{
+    // Plans are cached per thread: a new thread starts with an empty cache
+    std::thread parser([] {
+        ASSERT_EQ(0, PivotObject::getShapePlanCount());
+
+        checkMvTyp(createMvTyp(0.5f, 3, false), 0.5f, 3);
+        ASSERT_EQ(1, PivotObject::getShapePlanCount());
+
+        // Same shape: parsed with the cached plan
+        checkMvTyp(createMvTyp(-2.25f, 20, false), -2.25f, 20);
+        ASSERT_EQ(1, PivotObject::getShapePlanCount());
+
+        // Same elements in another order: a plan of its own
+        checkMvTyp(createMvTyp(1.0f, 1, true), 1.0f, 1);
+        checkMvTyp(createMvTyp(7.5f, 5, true), 7.5f, 5);
+        ASSERT_EQ(2, PivotObject::getShapePlanCount());
+
+        // Missing elements are not found through the plan of a similar tree
+        PivotDataObject withoutCause("GTIM", "MvTyp");
+        withoutCause.setIdentifier("ID-45-984");
+        withoutCause.setMagF(0.5f);
+        Datapoint* dp = withoutCause.toDatapoint();
+        ASSERT_EQ(0, PivotDataObject(dp).getCause());
+        ASSERT_EQ(0, PivotDataObject(dp).getCause());
+        ASSERT_EQ(3, PivotObject::getShapePlanCount());
+        delete dp;
+
+        // Parse errors are the same for a known shape
+        PivotDataObject withoutIdentifier("GTIM", "MvTyp");
+        withoutIdentifier.setMagF(0.5f);
+        dp = withoutIdentifier.toDatapoint();
+        ASSERT_THROW(PivotDataObject pivot(dp), PivotObjectException);
+        ASSERT_THROW(PivotDataObject pivot(dp), PivotObjectException);
+        // Commands are only read from a GTIC logical node
+        ASSERT_THROW(PivotOperationObject pivot(dp), PivotObjectException);
+        delete dp;
+    });
+
+    parser.join();
+}
+
+static std::string
+parseErrorOfThrowingConstructor(Datapoint* dp)
+{
+    try {
+        PivotDataObject pivot(dp);
+    }
+    catch (PivotObjectException& e) {
+        return e.getContext();
+    }
+
+    return "";
+}
+
+TEST(PivotIEC104Plugin, PivotParseStatus)
+{
+    DatapointPool pool;
+
+    // Root of another name
+    Datapoint* dp = createDp("NOT_PIVOT");
+    PivotDataObject notPivot(&pool);
+    PivotParseStatus status = notPivot.parse(dp);
+    ASSERT_EQ(PivotParseStatus::NOT_PIVOT, status.getReason());
+    ASSERT_EQ("No pivot object", status.toString());
+    delete dp;
+
+    // Mandatory element missing: same message from the status and from the throwing constructor
+    PivotDataObject withoutIdentifier("GTIS", "SpsTyp");
+    withoutIdentifier.setStVal(true);
+    dp = withoutIdentifier.toDatapoint();
+    PivotDataObject missingChild(&pool);
+    status = missingChild.parse(dp);
+    ASSERT_EQ(PivotParseStatus::MISSING_CHILD, status.getReason());
+    ASSERT_EQ("No such child: Identifier", status.toString());
+    ASSERT_EQ(status.toString(), parseErrorOfThrowingConstructor(dp));
+    delete dp;
+
+    // Unknown quality value, the message is built from the tree when asked for
+    PivotDataObject badValidity("GTIS", "SpsTyp");
+    badValidity.setIdentifier("ID-45-672");
+    badValidity.setStVal(true);
+    badValidity.addQuality(false, false, false, false, false, false);
+    dp = badValidity.toDatapoint();
+    Datapoint* validity = getChild(getChild(getChild(getChild(dp, "GTIS"), "SpsTyp"), "q"), "Validity");
+    validity->getData() = DatapointValue(std::string("broken"));
+    PivotDataObject invalidValue(&pool);
+    status = invalidValue.parse(dp);
+    ASSERT_EQ(PivotParseStatus::INVALID_VALIDITY, status.getReason());
+    ASSERT_EQ("Validity has invalid value broken", status.toString());
+    ASSERT_EQ(status.toString(), parseErrorOfThrowingConstructor(dp));
+    delete dp;
+
+    // Value of another type
+    PivotDataObject badType("GTIS", "SpsTyp");
+    badType.setIdentifier("ID-45-672");
+    badType.setCause(3);
+    dp = badType.toDatapoint();
+    getChild(getChild(getChild(dp, "GTIS"), "Cause"), "stVal")->getData() = DatapointValue(std::string("3"));
+    PivotDataObject wrongType(&pool);
+    status = wrongType.parse(dp);
+    ASSERT_EQ(PivotParseStatus::NOT_AN_INT, status.getReason());
+    ASSERT_EQ("datapoint stVal has not an int value", status.toString());
+    delete dp;
+
+    // Commands are only read from a GTIC logical node
+    PivotDataObject dataObject("GTIS", "SpsTyp");
+    dataObject.setIdentifier("ID-45-672");
+    dp = dataObject.toDatapoint();
+    PivotOperationObject operation(&pool);
+    status = operation.parse(dp);
+    ASSERT_EQ(PivotParseStatus::UNSUPPORTED_TYPE, status.getReason());
+    ASSERT_EQ("pivot object type not supported: GTIS", status.toString());
+    delete dp;
+
+    // Valid tree
+    PivotDataObject valid("GTIS", "SpsTyp");
+    valid.setIdentifier("ID-45-672");
+    valid.setStVal(true);
+    dp = valid.toDatapoint();
+    PivotDataObject parsed(&pool);
+    ASSERT_TRUE(parsed.parse(dp).ok());
+    ASSERT_EQ("ID-45-672", parsed.getIdentifier());
+    delete dp;
+}